@@ -9,7 +9,8 @@ enum GLProgramAttributes {
 	ATTR_TEXCOORD = 8,
 	ATTR_TANGENT = 9,
 	ATTR_BITANGENT = 10,
-	ATTR_NORMAL = 11
+	ATTR_NORMAL = 11,
+	ATTR_INSTANCE_TRANSFORM = 12 // a mat4, occupying 12 to 15
 };
 
 #endif /*GLPROGRAMATTRIBUTES_H_*/
@@ -6,6 +6,7 @@
 #include "math/Vector2.h"
 #include "math/Vector3.h"
 #include "math/Matrix4.h"
+#include "util/SmallVector.h"
 #include <vector>
 
 class Plane3;
@@ -35,6 +36,12 @@ public:
 	virtual scene::INodePtr createBrush() = 0;
 
 	virtual IBrushSettings& getSettings() = 0;
+
+	// Returns the number of heap allocations made for winding storage by this module on
+	// the calling thread so far: the util::SmallVectors (which hold the face windings) and
+	// the FixedWinding clipping buffers, see util::AllocationCounter. Any other allocation,
+	// e.g. by the containers used to build the B-Rep, is not included.
+	virtual std::size_t getWindingStorageAllocationCount() = 0;
 };
 
 enum class PrefabType : int
@@ -82,7 +89,9 @@ struct WindingVertex
 
 // A Winding consists of several connected WindingVertex objects,
 // each of which holding information about a single corner point.
-typedef std::vector<WindingVertex> IWinding;
+// Windings of up to four vertices (the faces of most brushes) are
+// stored within the face, without allocating any heap memory.
+typedef util::SmallVector<WindingVertex, 4> IWinding;
 
 /**
  * greebo: The texture definition structure containing the scale,
@@ -285,6 +294,9 @@ public:
 	// Classify this brush against the given plane, used by clipper and CSG algorithms
 	virtual BrushSplitType classifyPlane(const Plane3& plane) const = 0;
 
+	// Calculates the intersection of the given plane with this brush, as shown by the clipper
+	virtual IWinding getWindingForPlane(const Plane3& plane) const = 0;
+
 	// Method used internally to recalculate the brush windings
 	virtual void evaluateBRep() const = 0;
 };
@@ -302,6 +314,11 @@ public:
 
 	// Returns the IBrush interface
 	virtual IBrush& getIBrush() = 0;
+
+	// The clipper plane last assigned to this brush and its intersection with the brush,
+	// which is kept until either of them changes
+	virtual const Plane3& getClipPlane() const = 0;
+	virtual const IWinding& getClipPlaneWinding() const = 0;
 };
 typedef std::shared_ptr<IBrushNode> IBrushNodePtr;
 
@@ -6,6 +6,16 @@
 namespace scene
 {
 
+// The hash function used to calculate node fingerprints
+enum class FingerprintHash
+{
+    // SHA256 checksums, suitable to be stored and compared across sessions
+    SHA256,
+
+    // A much faster non-cryptographic hash, only to be compared within the same session
+    Fast,
+};
+
 /**
  * Prototype of a comparable scene node, providing hash information
  * for comparison to another node. Nodes of the same type can be compared against each other.
@@ -19,7 +29,20 @@ public:
     // Returns the fingerprint (checksum) of this node, to allow for quick 
     // matching against other nodes of the same type. Fingerprints of different
     // types are not comparable, be sure to check the node type first.
-    virtual std::string getFingerprint() = 0;
+    // Fingerprints calculated with different hash types are not comparable either.
+    // Nodes keep the calculated values until they are changed, subsequent calls are cheap.
+    virtual std::string getFingerprint(FingerprintHash hash) = 0;
+
+    // Returns the SHA256 fingerprint of this node
+    std::string getFingerprint()
+    {
+        return getFingerprint(FingerprintHash::SHA256);
+    }
+
+    // Called by a comparable child node about to change. Nodes including the
+    // fingerprints of their children in their own need to drop their cached values.
+    virtual void onChildFingerprintChanged()
+    {}
 };
 
 // The number of digits that are considered when hashing floating point values in fingerprinting
@@ -199,6 +199,11 @@ public:
     /// Create and return a particle node for the named particle system
 	virtual IParticleNodePtr createParticleNode(const std::string& name) = 0;
 
+	// Number of particle bunch simulations taken from the cache since startup,
+	// and the number of simulations run since no cached result was found
+	virtual std::size_t getSimulationCacheHitCount() const = 0;
+	virtual std::size_t getSimulationCacheMissCount() const = 0;
+
 	/**
 	 * Writes the named particle declaration to the file it is associated with,
 	 * replacing any existing declaration with the same name in that file.
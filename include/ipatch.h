@@ -101,6 +101,10 @@ public:
 	// Returns a copy of the fully tesselated patch geometry (slow!)
 	virtual PatchMesh getTesselatedPatchMesh() const = 0;
 
+	// Returns a copy of the coarser geometry used to render the patch at the
+	// given level of detail, level 0 being the full tesselation (slow!)
+	virtual PatchMesh getLevelOfDetailMesh(std::size_t levelOfDetail) const = 0;
+
 	// Returns a copy of the render indices which can be passed to GL_QUAD_STRIPS (slow)
 	virtual PatchRenderIndices getRenderIndices() const = 0;
 
@@ -264,6 +268,11 @@ public:
 	virtual scene::INodePtr createPatch(PatchDefType type) = 0;
 
 	virtual IPatchSettings& getSettings() = 0;
+
+	// Number of patch tesselations copied from the cache since startup,
+	// and the number of tesselations generated since no cached one was found
+	virtual std::size_t getTesselationCacheHitCount() const = 0;
+	virtual std::size_t getTesselationCacheMissCount() const = 0;
 };
 
 }
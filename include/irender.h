@@ -2,6 +2,8 @@
 
 #include "imodule.h"
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "math/Vector3.h"
 #include "math/AABB.h"
@@ -222,16 +224,24 @@ inline std::ostream& operator<< (std::ostream& os, const RendererLight& l)
  * \brief Interface for an object which can test its intersection with a
  * RendererLight.
  *
- * Objects which implement this interface define a intersectsLight() function
- * which determines whether the given light intersects the object.
+ * Objects which implement this interface provide their world-space bounds,
+ * a light is affecting the object if its lightAABB() intersects these bounds.
+ * This allows the renderer to find the lights of many objects at once using
+ * a spatial lookup structure.
  */
 class LitObject
 {
 public:
     virtual ~LitObject() {}
 
+    /// Return the world-space bounds used for the light intersection test
+    virtual const AABB& getLitObjectBounds() const = 0;
+
     /// Test if the given light intersects the LitObject
-    virtual bool intersectsLight(const RendererLight& light) const = 0;
+    bool intersectsLight(const RendererLight& light) const
+    {
+        return light.lightAABB().intersects(getLitObjectBounds());
+    }
 };
 typedef std::shared_ptr<LitObject> LitObjectPtr;
 
@@ -289,6 +299,8 @@ const int c_attr_TexCoord0 = 1;
 const int c_attr_Tangent = 3;
 const int c_attr_Binormal = 4;
 
+class InstancedDrawing;
+
 /**
  * \brief
  * Data object passed to the backend OpenGLRenderable::render() method
@@ -307,15 +319,20 @@ class RenderInfo
     // Cube map mode
     IShaderLayer::CubeMapMode _cubeMapMode;
 
+    // Instancing support for renderBatch(), NULL if not available
+    InstancedDrawing* _instancedDrawing;
+
 public:
 
     /// Default constructor
     RenderInfo(RenderStateFlags flags = RENDER_DEFAULT,
                const Vector3& viewer = Vector3(0, 0, 0),
-               IShaderLayer::CubeMapMode cubeMode = IShaderLayer::CUBE_MAP_NONE)
+               IShaderLayer::CubeMapMode cubeMode = IShaderLayer::CUBE_MAP_NONE,
+               InstancedDrawing* instancedDrawing = nullptr)
     : _flags(flags),
       _viewerLocation(viewer),
-      _cubeMapMode(cubeMode)
+      _cubeMapMode(cubeMode),
+      _instancedDrawing(instancedDrawing)
     { }
 
     /// Check if a flag is set
@@ -341,6 +358,15 @@ public:
     {
         return _cubeMapMode;
     }
+
+    /**
+     * Get the instancing support of the current pass, which is only set while
+     * drawing a batch and if the GL state allows it. Can be NULL.
+     */
+    InstancedDrawing* getInstancedDrawing() const
+    {
+        return _instancedDrawing;
+    }
 };
 
 /**
@@ -365,6 +391,67 @@ public:
      * Submit OpenGL render calls.
      */
     virtual void render(const RenderInfo& info) const = 0;
+
+    /**
+     * \brief
+     * Returns a non-NULL key if this object can be drawn together with other
+     * objects returning the same key, using a single renderBatch() call.
+     * The backend groups such objects if their order doesn't matter, e.g.
+     * repeated model surfaces or brush faces stored in the same buffer.
+     */
+    virtual const void* getBatchKey() const
+    {
+        return nullptr;
+    }
+
+    /// An object of a batch along with its transform, see renderBatch()
+    struct BatchEntry
+    {
+        const OpenGLRenderable* renderable;
+        const Matrix4* transform;
+    };
+
+    /**
+     * \brief
+     * Draw all the given objects, which all returned the same key as this
+     * one in getBatchKey(). The transforms are relative to the current
+     * modelview matrix, which must be left unchanged. Only called if
+     * getBatchKey() returns a non-NULL key.
+     *
+     * \return
+     * The number of GL draw calls issued.
+     */
+    virtual std::size_t renderBatch(const RenderInfo& info, const BatchEntry* entries, std::size_t count) const
+    {
+        return 0;
+    }
+};
+
+/**
+ * \brief
+ * Provided by the backend through RenderInfo to objects drawing the same
+ * geometry several times in renderBatch().
+ *
+ * The transforms of the batch are passed to GL as per-instance attributes,
+ * such that all of them can be drawn in a single glDrawElementsInstanced()
+ * or glDrawArraysInstanced() call. The vertex positions, normals, texture
+ * coordinates and colours are taken from the fixed-function arrays.
+ */
+class InstancedDrawing
+{
+public:
+    virtual ~InstancedDrawing() {}
+
+    /**
+     * Sets up the transforms of the given entries for the next instanced
+     * draw call. Returns false if the GL context doesn't support this, the
+     * entries need to be drawn one by one then. Each successful call needs
+     * to be followed by end() after drawing.
+     */
+    virtual bool begin(const OpenGLRenderable::BatchEntry* entries, std::size_t count) = 0;
+
+    /// Restores the GL state changed by begin()
+    virtual void end() = 0;
 };
 
 class Matrix4;
@@ -467,6 +554,38 @@ typedef std::shared_ptr<Shader> ShaderPtr;
 
 const char* const MODULE_RENDERSYSTEM("ShaderCache");
 
+/// Timings and counters of a single shader pass during a profiled frame
+struct RenderPassProfile
+{
+    // Name of the shader owning this pass
+    std::string shader;
+
+    // CPU time spent in this pass, including the GL calls
+    double milliseconds = 0;
+
+    // Number of GL draw calls issued by the OpenGLRenderables
+    std::size_t drawCalls = 0;
+
+    // Number of OpenGLRenderables drawn as part of a batch
+    std::size_t instances = 0;
+
+    // Number of times the pass' GL state got applied
+    std::size_t stateChanges = 0;
+
+    std::size_t textureBinds = 0;
+    std::size_t programSwitches = 0;
+};
+
+/// Result of a profiled RenderSystem::render() call, see RenderSystem::profileNextFrame()
+struct RenderFrameProfile
+{
+    // CPU time spent in the whole render() call
+    double milliseconds = 0;
+
+    // All passes which had something to render, in the order of rendering
+    std::vector<RenderPassProfile> passes;
+};
+
 /**
  * \brief
  * The main interface for the backend renderer.
@@ -532,6 +651,33 @@ public:
 	 */
 	virtual void setTime(std::size_t milliSeconds) = 0;
 
+    /**
+     * \brief Return the number of times the renderable buffers had to grow
+     * during the last frame, i.e. between the two most recent render() calls.
+     *
+     * The buffers keep their capacity between frames, so this is usually 0
+     * unless the amount of rendered geometry is increasing.
+     */
+    virtual std::size_t getLastFrameAllocationCount() const = 0;
+
+    /**
+     * \brief Return the number of bytes uploaded to GL buffer objects
+     * during the most recent render() call.
+     *
+     * Static geometry is kept on the GPU, so this only grows with the
+     * amount of geometry that changed since the previous frame.
+     */
+    virtual std::size_t getLastFrameUploadedBytes() const = 0;
+
+    /**
+     * \brief Capture the timings and counters of the next render() call.
+     *
+     * The callback is invoked once at the end of the next frame. The
+     * counters are always compiled in, they are only maintained while a
+     * frame is being profiled.
+     */
+    virtual void profileNextFrame(const std::function<void(const RenderFrameProfile&)>& callback) = 0;
+
     /* SHADER PROGRAMS */
 
     /// Available GL programs used for backend rendering.
@@ -147,6 +147,21 @@ public:
     virtual void viewChanged() const
     { }
 
+    /**
+     * \brief Returns true if renderSolid() may be called from several threads
+     * at the same time, each one with its own collector.
+     *
+     * This requires renderSolid() to not modify any state, including lazily
+     * evaluated caches. It is invoked after viewChanged() has been called on
+     * the main thread, which can be used to bring these up to date.
+     * renderWireframe() and renderComponents() are always called from the
+     * main thread.
+     */
+    virtual bool supportsConcurrentSubmission() const
+    {
+        return false;
+    }
+
     struct Highlight
     {
         enum Flags
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "iscenegraph.h"
+#include "ispacepartition.h"
 
 namespace scene
 {
@@ -19,9 +20,20 @@ class ISceneGraphFactory :
 {
 public:
 	/**
-	 * Instantiates a new scenegraph.
+	 * Instantiates a new scenegraph, using the space partition type
+	 * chosen at startup (--space-partition=octree|aabbtree).
 	 */
 	virtual GraphPtr createSceneGraph() = 0;
+
+	/**
+	 * Instantiates a new scenegraph using the given space partition type.
+	 */
+	virtual GraphPtr createSceneGraph(SpacePartitionType type) = 0;
+
+	/**
+	 * Creates a new, empty space partition system of the given type.
+	 */
+	virtual ISpacePartitionSystemPtr createSpacePartition(SpacePartitionType type) = 0;
 };
 
 } // namespace
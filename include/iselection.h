@@ -4,6 +4,7 @@
 #include "imodule.h"
 #include "ivolumetest.h"
 #include <memory>
+#include <vector>
 #include <sigc++/signal.h>
 
 class RenderableCollector;
@@ -169,6 +170,20 @@ public:
 		 * @isComponent: is TRUE if the changed selectable is a component (like a FaceInstance, VertexInstance).
 		 */
 		virtual void selectionChanged(const scene::INodePtr& node, bool isComponent) = 0;
+
+		/**
+		 * Gets called once at the end of a bulk selection change, instead of selectionChanged()
+		 * for every single node. The given nodes are in the order they have been changed.
+		 * The default implementation passes each node on to selectionChanged(), observers
+		 * rescanning the whole selection should override this to do it only once.
+		 */
+		virtual void selectionChangedInBulk(const std::vector<scene::INodePtr>& nodes, bool isComponent)
+		{
+			for (const auto& node : nodes)
+			{
+				selectionChanged(node, isComponent);
+			}
+		}
 	};
 
 	virtual void addObserver(Observer* observer) = 0;
@@ -214,6 +229,17 @@ public:
      */
     virtual void setSelectedAll(bool selected) = 0;
 
+    /**
+     * \brief
+     * Marks the start of a bulk selection change, like selecting everything or
+     * inverting the selection. Until the matching endBulkSelectionChange() call, the
+     * observers and the selection changed signal are not notified for each changed
+     * node. Instead, they are notified once when the outermost bulk change ends.
+     * Bulk changes can be nested, see also selection::ScopedBulkSelectionChange.
+     */
+    virtual void beginBulkSelectionChange() = 0;
+    virtual void endBulkSelectionChange() = 0;
+
   virtual void setSelectedAllComponents(bool selected) = 0;
 
     /**
@@ -50,6 +50,12 @@ public:
 		return _depth;
 	}
 
+	// The squared distance to the cursor in device coordinates, 0 if the cursor is on the object
+	float distance() const
+	{
+		return _distance;
+	}
+
 	bool isValid() const
 	{
 		return depth() < 1;
@@ -235,6 +241,9 @@ public:
   virtual void TestTriangles(const VertexPointer& vertices, const IndexPointer& indices, SelectionIntersection& best) = 0;
   virtual void TestQuads(const VertexPointer& vertices, const IndexPointer& indices, SelectionIntersection& best) = 0;
   virtual void TestQuadStrip(const VertexPointer& vertices, const IndexPointer& indices, SelectionIntersection& best) = 0;
+
+  // Returns an independent copy of this test, such that another thread can use it
+  virtual std::shared_ptr<SelectionTest> clone() const = 0;
 };
 typedef std::shared_ptr<SelectionTest> SelectionTestPtr;
 
@@ -267,6 +276,17 @@ class SelectionTestable
 public:
     virtual ~SelectionTestable() {}
 	virtual void testSelect(Selector& selector, SelectionTest& test) = 0;
+
+    /**
+     * Returns true if testSelect() may be called from a worker thread while other
+     * nodes are tested at the same time, each thread using its own Selector and
+     * SelectionTest. This requires testSelect() to not modify any shared state.
+     * The check itself is performed on the main thread.
+     */
+    virtual bool supportsConcurrentSelectionTest() const
+    {
+        return false;
+    }
 };
 typedef std::shared_ptr<SelectionTestable> SelectionTestablePtr;
 
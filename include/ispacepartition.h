@@ -7,6 +7,7 @@
 
 // Forward declaration
 class AABB;
+class PackedAABBs;
 
 namespace scene
 {
@@ -55,6 +56,10 @@ public:
 	// The child nodes of this node (either 8 or 0)
 	virtual const NodeList& getChildNodes() const = 0;
 
+	// The bounds of all child nodes in the same order as getChildNodes(),
+	// packed for batched culling through VolumeTest::TestAABBs()
+	virtual const PackedAABBs& getChildBounds() const = 0;
+
 	// Returns true if no more child nodes are below this one
 	virtual bool isLeaf() const = 0;
 
@@ -63,6 +68,13 @@ public:
 };
 typedef std::shared_ptr<ISPNode> ISPNodePtr;
 
+// The available space partition implementations
+enum class SpacePartitionType
+{
+	Octree,		// Dynamic octree with fixed cubic nodes (default)
+	AABBTree,	// Bounding volume hierarchy with tightly fitted nodes
+};
+
 /**
  * greebo: The SpacePartitionSystem interface is a simple one. All it needs
  * to do is to provide link/unlink methods for linking scene::INodes
@@ -84,6 +96,11 @@ public:
 	// Links this node into the SP tree. Returns the node it ends up being associated with
 	virtual void link(const scene::INodePtr& sceneNode) = 0;
 
+	// Links all the given nodes into the SP tree. This is equivalent to calling
+	// link() for each of them, but gives the implementation a chance to adjust its
+	// structure only once for the whole batch (e.g. when loading a map).
+	virtual void linkAll(const std::vector<scene::INodePtr>& sceneNodes) = 0;
+
 	// Unlink this node from the SP tree, returns true if this was successful
 	// (node had been linked before)
 	virtual bool unlink(const scene::INodePtr& sceneNode) = 0;
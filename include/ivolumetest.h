@@ -30,6 +30,7 @@ class Plane3;
 class Matrix4;
 class AABB;
 class Segment;
+class PackedAABBs;
 
 class VolumeTest
 {
@@ -49,6 +50,9 @@ public:
   virtual VolumeIntersectionValue TestAABB(const AABB& aabb) const = 0;
   /// \brief Returns the intersection of \p aabb transformed by \p localToWorld and volume.
   virtual VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const = 0;
+  /// \brief Writes the intersection of each of the \p aabbs and volume to \p results.
+  /// Boxes very close to the volume's boundary may be reported as VOLUME_PARTIAL.
+  virtual void TestAABBs(const PackedAABBs& aabbs, VolumeIntersectionValue* results) const = 0;
 
   virtual bool fill() const = 0;
 
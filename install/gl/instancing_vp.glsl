@@ -0,0 +1,59 @@
+#version 120
+
+// Draws the same geometry several times in one call, the transform of each
+// instance is passed as per-instance attribute. There's no fragment shader,
+// the fixed-function pipeline takes over after this.
+
+// Object to view transform of the current instance, relative to the modelview
+attribute mat4      attr_InstanceTransform;
+
+// Mirrors the fixed-function lighting state
+uniform bool        u_lighting;
+uniform bool        u_light0;
+uniform bool        u_light1;
+
+// Ambient and diffuse part of the fixed-function lighting, using the vertex
+// colour as material (GL_COLOR_MATERIAL with GL_AMBIENT_AND_DIFFUSE)
+vec3 lightContribution(vec4 position, vec4 ambient, vec4 diffuse, vec3 vertex, vec3 normal)
+{
+    vec3 direction = position.w == 0.0 ?
+        normalize(position.xyz) : normalize(position.xyz - vertex);
+
+    return ambient.rgb * gl_Color.rgb +
+        max(dot(normal, direction), 0.0) * diffuse.rgb * gl_Color.rgb;
+}
+
+void main()
+{
+    vec4 vertex = attr_InstanceTransform * gl_Vertex;
+
+    gl_Position = gl_ModelViewProjectionMatrix * vertex;
+    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+
+    if (!u_lighting)
+    {
+        gl_FrontColor = gl_Color;
+        return;
+    }
+
+    // The instance transforms are rotations with mostly uniform scale,
+    // renormalising is good enough instead of the inverse transpose
+    vec3 normal = normalize(gl_NormalMatrix * (mat3(attr_InstanceTransform) * gl_Normal));
+    vec3 eyeVertex = (gl_ModelViewMatrix * vertex).xyz;
+
+    vec3 colour = gl_FrontMaterial.emission.rgb + gl_LightModel.ambient.rgb * gl_Color.rgb;
+
+    if (u_light0)
+    {
+        colour += lightContribution(gl_LightSource[0].position,
+            gl_LightSource[0].ambient, gl_LightSource[0].diffuse, eyeVertex, normal);
+    }
+
+    if (u_light1)
+    {
+        colour += lightContribution(gl_LightSource[1].position,
+            gl_LightSource[1].ambient, gl_LightSource[1].diffuse, eyeVertex, normal);
+    }
+
+    gl_FrontColor = vec4(clamp(colour, 0.0, 1.0), gl_Color.a);
+}
@@ -1,6 +1,12 @@
 #include "Frustum.h"
 
 #include "AABB.h"
+#include "PackedAABBs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 // Normalise all planes in frustum
 void Frustum::normalisePlanes()
@@ -157,3 +163,110 @@ VolumeIntersectionValue Frustum::testIntersection(const AABB& aabb, const Matrix
 
 	return VOLUME_INSIDE;
 }
+
+namespace
+{
+
+// A frustum plane in single precision, as used by the batched AABB test
+struct PackedPlane
+{
+	float normal[3];
+	float absNormal[3];
+
+	// The plane distance, moved outwards (for the outside test) and inwards
+	// (for the inside test) to make up for the float rounding errors
+	float distOutside;
+	float distInside;
+
+	PackedPlane(const Plane3& plane)
+	{
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			normal[i] = static_cast<float>(plane.normal()[i]);
+			absNormal[i] = std::abs(normal[i]);
+		}
+
+		double margin = std::abs(plane.dist()) / (1 << 18) + 1.0 / (1 << 18);
+
+		distOutside = static_cast<float>(plane.dist() - margin);
+		distInside = static_cast<float>(plane.dist() + margin);
+	}
+};
+
+}
+
+void Frustum::testIntersection(const PackedAABBs& aabbs, VolumeIntersectionValue* results) const
+{
+	// Same plane order as the single AABB test
+	const PackedPlane planes[6] = { right, left, bottom, top, back, front };
+
+	const float* ox = aabbs.originX();
+	const float* oy = aabbs.originY();
+	const float* oz = aabbs.originZ();
+	const float* ex = aabbs.extentsX();
+	const float* ey = aabbs.extentsY();
+	const float* ez = aabbs.extentsZ();
+
+	std::size_t count = aabbs.size();
+
+#ifdef FRUSTUM_USE_SSE2
+	// The arrays are padded, so we can always process complete blocks
+	for (std::size_t block = 0; block < count; block += PackedAABBs::BLOCK_SIZE)
+	{
+		__m128 originX = _mm_loadu_ps(ox + block);
+		__m128 originY = _mm_loadu_ps(oy + block);
+		__m128 originZ = _mm_loadu_ps(oz + block);
+		__m128 extentsX = _mm_loadu_ps(ex + block);
+		__m128 extentsY = _mm_loadu_ps(ey + block);
+		__m128 extentsZ = _mm_loadu_ps(ez + block);
+
+		__m128 anyOutside = _mm_setzero_ps();
+		__m128 allInside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (const PackedPlane& plane : planes)
+		{
+			__m128 originDot = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(originX, _mm_set1_ps(plane.normal[0])),
+				_mm_mul_ps(originY, _mm_set1_ps(plane.normal[1]))),
+				_mm_mul_ps(originZ, _mm_set1_ps(plane.normal[2])));
+
+			__m128 extentsDot = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(extentsX, _mm_set1_ps(plane.absNormal[0])),
+				_mm_mul_ps(extentsY, _mm_set1_ps(plane.absNormal[1]))),
+				_mm_mul_ps(extentsZ, _mm_set1_ps(plane.absNormal[2])));
+
+			anyOutside = _mm_or_ps(anyOutside, _mm_cmplt_ps(
+				_mm_add_ps(originDot, extentsDot), _mm_set1_ps(plane.distOutside)));
+
+			allInside = _mm_and_ps(allInside, _mm_cmpge_ps(
+				_mm_sub_ps(originDot, extentsDot), _mm_set1_ps(plane.distInside)));
+		}
+
+		int outsideMask = _mm_movemask_ps(anyOutside);
+		int insideMask = _mm_movemask_ps(allInside);
+
+		for (std::size_t i = 0; i < PackedAABBs::BLOCK_SIZE && block + i < count; ++i)
+		{
+			results[block + i] = (outsideMask & (1 << i)) ? VOLUME_OUTSIDE :
+				(insideMask & (1 << i)) ? VOLUME_INSIDE : VOLUME_PARTIAL;
+		}
+	}
+#else
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		bool outside = false;
+		bool inside = true;
+
+		for (const PackedPlane& plane : planes)
+		{
+			float originDot = ox[i] * plane.normal[0] + oy[i] * plane.normal[1] + oz[i] * plane.normal[2];
+			float extentsDot = ex[i] * plane.absNormal[0] + ey[i] * plane.absNormal[1] + ez[i] * plane.absNormal[2];
+
+			outside |= originDot + extentsDot < plane.distOutside;
+			inside &= originDot - extentsDot >= plane.distInside;
+		}
+
+		results[i] = outside ? VOLUME_OUTSIDE : inside ? VOLUME_INSIDE : VOLUME_PARTIAL;
+	}
+#endif
+}
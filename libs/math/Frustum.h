@@ -13,6 +13,7 @@
 
 class AABB;
 class Plane3;
+class PackedAABBs;
 
 /**
  * \brief
@@ -63,6 +64,15 @@ public:
     /// Test the intersection of this frustum with a transformed AABB.
     VolumeIntersectionValue testIntersection(const AABB& aabb, const Matrix4& localToWorld) const;
 
+    /**
+     * Test the intersection of this frustum with all AABBs of the given
+     * sequence at once, writing aabbs.size() values to the results array.
+     * The results are conservative: boxes very close to a frustum plane
+     * can be reported as partially intersecting, even though testing the
+     * original AABB yields VOLUME_INSIDE or VOLUME_OUTSIDE.
+     */
+    void testIntersection(const PackedAABBs& aabbs, VolumeIntersectionValue* results) const;
+
     /// Enum representing the corner points of each end plane
     enum Corner
     {
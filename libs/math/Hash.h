@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <string>
 #include "Vector3.h"
 #include "SHA256.h"
 
@@ -102,4 +105,136 @@ public:
     }
 };
 
+/**
+ * Non-cryptographic 128 bit hash with the same interface as math::Hash,
+ * consuming the same byte sequence for the same calls. It is a lot faster
+ * to calculate, but the resulting strings are not meant to be persisted,
+ * they should only be compared to values calculated in the same session.
+ */
+class FastHash
+{
+private:
+    std::uint64_t _lanes[2];
+
+    // The bytes of the incomplete last word
+    std::uint64_t _pending;
+
+    // The number of bytes added so far
+    std::size_t _length;
+
+public:
+    FastHash() :
+        _lanes{ 0x243f6a8885a308d3ull, 0x13198a2e03707344ull },
+        _pending(0),
+        _length(0)
+    {}
+
+    void addSizet(std::size_t value)
+    {
+        addBytes(&value, sizeof(value));
+    }
+
+    void addDouble(double value, std::size_t significantDigits)
+    {
+        auto intValue = static_cast<std::size_t>(value * detail::RoundingFactor(significantDigits));
+        addSizet(intValue);
+    }
+
+    void addVector3(const Vector3& v, std::size_t significantDigits)
+    {
+        std::size_t components[3] =
+        {
+            static_cast<std::size_t>(v.x() * detail::RoundingFactor(significantDigits)),
+            static_cast<std::size_t>(v.y() * detail::RoundingFactor(significantDigits)),
+            static_cast<std::size_t>(v.z() * detail::RoundingFactor(significantDigits)),
+        };
+
+        addBytes(components, sizeof(components));
+    }
+
+    void addString(const std::string& str)
+    {
+        addBytes(str.data(), str.length());
+    }
+
+    operator std::string() const
+    {
+        std::uint64_t first = _lanes[0];
+        std::uint64_t second = _lanes[1];
+
+        if ((_length & 7) != 0)
+        {
+            mix(first, second, _pending);
+        }
+
+        first ^= _length;
+        second ^= _length * 0x9e3779b97f4a7c15ull;
+
+        first = finalise(first + second);
+        second = finalise(second + first);
+
+        constexpr char hexChars[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+
+        std::string hexString(32, '\0');
+
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            auto byte = ((i < 8 ? first : second) >> ((i & 7) * 8)) & 0xFF;
+
+            hexString[i*2] = hexChars[byte >> 4];
+            hexString[i*2 + 1] = hexChars[byte & 0x0F];
+        }
+
+        return hexString;
+    }
+
+private:
+    void addBytes(const void* data, std::size_t size)
+    {
+        auto bytes = static_cast<const std::uint8_t*>(data);
+
+        // Whole words can be mixed in directly as long as no bytes are pending
+        if ((_length & 7) == 0)
+        {
+            for (; size >= 8; bytes += 8, size -= 8, _length += 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, bytes, 8);
+                mix(_lanes[0], _lanes[1], word);
+            }
+        }
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            _pending |= static_cast<std::uint64_t>(bytes[i]) << ((_length & 7) * 8);
+
+            if ((++_length & 7) == 0)
+            {
+                mix(_lanes[0], _lanes[1], _pending);
+                _pending = 0;
+            }
+        }
+    }
+
+    static std::uint64_t rotateLeft(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Both lane updates are invertible, different states never collapse into the same one
+    static void mix(std::uint64_t& first, std::uint64_t& second, std::uint64_t word)
+    {
+        first = (rotateLeft(first ^ word, 29) + word) * 0x9e3779b97f4a7c15ull;
+        second = rotateLeft(second + word * 0xc2b2ae3d27d4eb4full, 31) * 0x165667b19e3779f9ull;
+    }
+
+    // The finaliser of the splitmix64 generator
+    static std::uint64_t finalise(std::uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+};
+
 }
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "math/AABB.h"
+
+/**
+ * A sequence of AABBs stored in single-precision structure-of-arrays layout,
+ * such that a whole block of them can be tested against a set of planes
+ * with SIMD instructions (see Frustum::testIntersection()).
+ *
+ * The stored boxes are slightly enlarged compared to the double-precision
+ * input, to make up for the rounding errors of the conversion and the float
+ * arithmetic. Tests against these boxes are therefore conservative: a box
+ * is never reported as outside while the original one is touching the volume.
+ *
+ * The arrays are padded to a multiple of BLOCK_SIZE, the padding elements
+ * are empty boxes at the origin.
+ */
+class PackedAABBs
+{
+public:
+	// The number of AABBs processed at once by the SIMD code paths
+	static constexpr std::size_t BLOCK_SIZE = 4;
+
+private:
+	std::size_t _size;
+
+	std::vector<float> _originX;
+	std::vector<float> _originY;
+	std::vector<float> _originZ;
+	std::vector<float> _extentsX;
+	std::vector<float> _extentsY;
+	std::vector<float> _extentsZ;
+
+public:
+	PackedAABBs() :
+		_size(0)
+	{}
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return _size == 0;
+	}
+
+	// The size including the padding elements
+	std::size_t paddedSize() const
+	{
+		return _originX.size();
+	}
+
+	void clear()
+	{
+		resize(0);
+	}
+
+	// Resize the sequence, new elements are empty boxes at the origin
+	void resize(std::size_t size)
+	{
+		std::size_t padded = (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+		// Reset the elements which are becoming padding
+		for (std::size_t i = size; i < std::min(_size, padded); ++i)
+		{
+			setElement(i, 0, 0, 0, 0, 0, 0);
+		}
+
+		_originX.resize(padded, 0);
+		_originY.resize(padded, 0);
+		_originZ.resize(padded, 0);
+		_extentsX.resize(padded, 0);
+		_extentsY.resize(padded, 0);
+		_extentsZ.resize(padded, 0);
+
+		_size = size;
+	}
+
+	void push_back(const AABB& aabb)
+	{
+		resize(_size + 1);
+		set(_size - 1, aabb);
+	}
+
+	// Stores the given AABB at the given index, which must be smaller than size()
+	void set(std::size_t index, const AABB& aabb)
+	{
+		assert(index < _size);
+
+		setElement(index,
+			packOrigin(aabb.origin.x()), packOrigin(aabb.origin.y()), packOrigin(aabb.origin.z()),
+			packExtents(aabb.origin.x(), aabb.extents.x()),
+			packExtents(aabb.origin.y(), aabb.extents.y()),
+			packExtents(aabb.origin.z(), aabb.extents.z()));
+	}
+
+	// Returns the (enlarged) AABB at the given index
+	AABB get(std::size_t index) const
+	{
+		return AABB(Vector3(_originX[index], _originY[index], _originZ[index]),
+			Vector3(_extentsX[index], _extentsY[index], _extentsZ[index]));
+	}
+
+	const float* originX() const { return _originX.data(); }
+	const float* originY() const { return _originY.data(); }
+	const float* originZ() const { return _originZ.data(); }
+	const float* extentsX() const { return _extentsX.data(); }
+	const float* extentsY() const { return _extentsY.data(); }
+	const float* extentsZ() const { return _extentsZ.data(); }
+
+private:
+	void setElement(std::size_t index, float ox, float oy, float oz, float ex, float ey, float ez)
+	{
+		_originX[index] = ox;
+		_originY[index] = oy;
+		_originZ[index] = oz;
+		_extentsX[index] = ex;
+		_extentsY[index] = ey;
+		_extentsZ[index] = ez;
+	}
+
+	static float packOrigin(double origin)
+	{
+		return static_cast<float>(origin);
+	}
+
+	// Invalid extents are kept as they are. Valid ones are enlarged by a
+	// margin well above the float rounding error at this distance from
+	// the world origin, this includes the error of converting the origin.
+	static float packExtents(double origin, double extents)
+	{
+		if (extents < 0)
+		{
+			return static_cast<float>(extents);
+		}
+
+		return static_cast<float>(extents + (std::abs(origin) + extents) * EXTENTS_MARGIN + EXTENTS_MARGIN);
+	}
+
+	static constexpr double EXTENTS_MARGIN = 1.0 / (1 << 18);
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "math/Hash.h"
+#include "math/Plane3.h"
+
+/**
+ * Associates values with planes, such that all entries with a plane equal
+ * to a given one can be found without comparing against every entry.
+ * Equality is the same as Plane3::operator==, which is tolerating small
+ * differences in the normal and the distance.
+ *
+ * The planes are sorted into grid cells twice as large as the tolerance,
+ * any plane equal to a given one is therefore stored in the same cell or
+ * in the adjacent cell on the nearer side, in each of the four dimensions.
+ */
+template<typename Value>
+class PlaneMap
+{
+private:
+	struct Cell
+	{
+		std::int64_t coords[4];
+
+		bool operator==(const Cell& other) const
+		{
+			return coords[0] == other.coords[0] && coords[1] == other.coords[1] &&
+				coords[2] == other.coords[2] && coords[3] == other.coords[3];
+		}
+	};
+
+	struct CellHash
+	{
+		std::size_t operator()(const Cell& cell) const
+		{
+			std::size_t hash = static_cast<std::size_t>(cell.coords[0]);
+
+			for (std::size_t i = 1; i < 4; ++i)
+			{
+				math::combineHash(hash, static_cast<std::size_t>(cell.coords[i]));
+			}
+
+			return hash;
+		}
+	};
+
+	typedef std::vector<std::pair<Plane3, Value>> Entries;
+
+	std::unordered_map<Cell, Entries, CellHash> _cells;
+
+public:
+	void insert(const Plane3& plane, const Value& value)
+	{
+		double coords[4];
+
+		// Planes with infinite or NaN components are never equal to anything
+		if (!getCellCoords(plane, coords)) return;
+
+		Cell cell;
+
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			cell.coords[i] = static_cast<std::int64_t>(std::floor(coords[i]));
+		}
+
+		_cells[cell].emplace_back(plane, value);
+	}
+
+	/**
+	 * Calls the given functor with the value of each entry whose plane is equal
+	 * to the given one. The functor returns false to stop the search.
+	 * Returns false if the search has been stopped.
+	 */
+	template<typename Functor>
+	bool foreachEqual(const Plane3& plane, const Functor& functor) const
+	{
+		double coords[4];
+
+		if (!getCellCoords(plane, coords)) return true;
+
+		std::int64_t nearest[4];
+		std::int64_t adjacent[4];
+
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			double cell = std::floor(coords[i]);
+
+			nearest[i] = static_cast<std::int64_t>(cell);
+			adjacent[i] = coords[i] - cell < 0.5 ? nearest[i] - 1 : nearest[i] + 1;
+		}
+
+		// Visit the 16 combinations of nearest and adjacent cells
+		for (std::size_t combination = 0; combination < 16; ++combination)
+		{
+			Cell cell;
+
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				cell.coords[i] = (combination & (1 << i)) ? adjacent[i] : nearest[i];
+			}
+
+			auto found = _cells.find(cell);
+
+			if (found == _cells.end()) continue;
+
+			for (const auto& entry : found->second)
+			{
+				if (entry.first == plane && !functor(entry.second))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void clear()
+	{
+		_cells.clear();
+	}
+
+private:
+	static bool getCellCoords(const Plane3& plane, double coords[4])
+	{
+		const double normalCellSize = 2 * EPSILON_NORMAL;
+		const double distCellSize = 2 * EPSILON_DIST;
+
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			coords[i] = plane.normal()[i] / normalCellSize;
+		}
+
+		coords[3] = plane.dist() / distCellSize;
+
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			// Stay far away from the limits of the integer cell coordinates
+			if (!std::isfinite(coords[i]) || std::abs(coords[i]) > 1e15)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include "ivolumetest.h"
+#include "math/AABB.h"
+#include "math/Vector4.h"
+
+namespace patch
+{
+
+// A level of detail is good enough if its segments are not exceeding this size on screen
+const double MAX_SEGMENT_PIXELS = 12.0;
+
+// Relative margin around MAX_SEGMENT_PIXELS before switching to another level,
+// to avoid toggling back and forth when the camera is moving around the threshold
+const double LEVEL_OF_DETAIL_HYSTERESIS = 0.25;
+
+/**
+ * Chooses the level of detail to render a tesselated patch with in the given
+ * view. Level n uses every (2^n)-th row and column of the full tesselation,
+ * level 0 is the full tesselation itself.
+ *
+ * The coarsest level whose segments are small enough on screen is chosen,
+ * based on the projected size of the patch bounds. The level chosen in the
+ * previous frame of the same view is kept until its segments exceed the
+ * upper threshold, coarser ones are only chosen once they undercut the
+ * lower one. Orthographic views always use the full tesselation.
+ *
+ * \param meshSize
+ * The number of vertices along the longer side of the full tesselation.
+ */
+inline std::size_t chooseLevelOfDetail(const AABB& worldBounds, std::size_t meshSize,
+    std::size_t numLevels, const VolumeTest& view, std::size_t previousLevel)
+{
+    // Only perspective views are using the coarser meshes, and there's nothing to reduce in small meshes
+    if (view.GetProjection().zw() == 0 || meshSize < 3)
+    {
+        return 0;
+    }
+
+    // Estimate the projected size of the bounding sphere
+    double radius = worldBounds.getExtents().getLength();
+    double distance = view.GetViewProjection().transform(Vector4(worldBounds.getOrigin(), 1)).w();
+
+    if (distance <= radius)
+    {
+        // The camera is close to or inside the patch bounds
+        return 0;
+    }
+
+    double pixels = 2 * radius * view.GetProjection().yy() * view.GetViewport().yy() / distance;
+    double segmentPixels = pixels / (meshSize - 1);
+
+    std::size_t level = 0;
+
+    for (std::size_t candidate = 1; candidate < numLevels; ++candidate)
+    {
+        double threshold = MAX_SEGMENT_PIXELS * (candidate <= previousLevel ?
+            1 + LEVEL_OF_DETAIL_HYSTERESIS : 1 - LEVEL_OF_DETAIL_HYSTERESIS);
+
+        if (segmentPixels * (std::size_t(1) << candidate) > threshold)
+        {
+            break;
+        }
+
+        level = candidate;
+    }
+
+    return level;
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ivolumetest.h"
+#include "math/AABB.h"
+#include "math/Matrix4.h"
+#include "math/PackedAABBs.h"
+
+namespace render
+{
+
+/**
+ * VolumeTest implementation representing an axis-aligned box. Can be used
+ * to find the nodes overlapping the given bounds through the space
+ * partition, e.g. by GlobalSceneGraph().foreachNodeInVolume().
+ *
+ * Only the AABB tests are meaningful, the view matrices are identity.
+ */
+class BoundsVolumeTest :
+	public VolumeTest
+{
+private:
+	AABB _bounds;
+	Matrix4 _identity;
+
+public:
+	BoundsVolumeTest(const AABB& bounds) :
+		_bounds(bounds),
+		_identity(Matrix4::getIdentity())
+	{}
+
+	bool TestPoint(const Vector3& point) const override
+	{
+		return _bounds.intersects(point);
+	}
+
+	bool TestLine(const Segment& segment) const override
+	{
+		return true;
+	}
+
+	bool TestPlane(const Plane3& plane) const override
+	{
+		return true;
+	}
+
+	bool TestPlane(const Plane3& plane, const Matrix4& localToWorld) const override
+	{
+		return true;
+	}
+
+	VolumeIntersectionValue TestAABB(const AABB& aabb) const override
+	{
+		return _bounds.intersects(aabb) ? VOLUME_PARTIAL : VOLUME_OUTSIDE;
+	}
+
+	VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const override
+	{
+		return TestAABB(AABB::createFromOrientedAABBSafe(aabb, localToWorld));
+	}
+
+	void TestAABBs(const PackedAABBs& aabbs, VolumeIntersectionValue* results) const override
+	{
+		for (std::size_t i = 0; i < aabbs.size(); ++i)
+		{
+			results[i] = TestAABB(aabbs.get(i));
+		}
+	}
+
+	bool fill() const override
+	{
+		return false;
+	}
+
+	const Matrix4& GetViewProjection() const override
+	{
+		return _identity;
+	}
+
+	const Matrix4& GetViewport() const override
+	{
+		return _identity;
+	}
+
+	const Matrix4& GetProjection() const override
+	{
+		return _identity;
+	}
+
+	const Matrix4& GetModelview() const override
+	{
+		return _identity;
+	}
+};
+
+} // namespace render
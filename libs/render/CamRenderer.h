@@ -5,8 +5,10 @@
 #include "ivolumetest.h"
 
 #include "VectorLightList.h"
+#include "LightGrid.h"
+#include "scene/ParallelChunks.h"
 
-#include <map>
+#include <cassert>
 
 namespace render
 {
@@ -26,6 +28,38 @@ public:
         ShaderPtr mergeActionShaderConflict;
     };
 
+    // Lit renderable provided via addRenderable(), for which we construct the
+    // light list with lights received via addLight().
+    struct LitRenderable
+    {
+        // Renderable information submitted with addLitObject()
+        Shader* shader = nullptr;
+        const OpenGLRenderable* renderable = nullptr;
+        const LitObject* litObject = nullptr;
+        Matrix4 local2World;
+        const IRenderEntity* entity = nullptr;
+
+        // The bounds of the LitObject (if there is one) at submission time
+        AABB litObjectBounds;
+
+        // Calculated list of intersecting lights
+        render::lib::VectorLightList lights;
+    };
+
+    /**
+     * Buffers which can be kept by views rendering frame after frame. The
+     * vectors keep their capacity (including the one of the light lists),
+     * and the light grid is only rebuilt when the lights change.
+     */
+    struct PersistentData
+    {
+        LightGrid lightGrid;
+
+        // The lit renderables of the current frame are the first N elements,
+        // the remaining ones are kept for re-use
+        std::vector<LitRenderable> litRenderables;
+    };
+
 private:
     // The VolumeTest object for object culling
     const VolumeTest& _view;
@@ -41,56 +75,64 @@ private:
 
     const HighlightShaders& _shaders;
 
-    // All lights we have received from the scene
-    std::list<const RendererLight*> _sceneLights;
+    // All lights we have received from the scene, and their bounds
+    std::vector<const RendererLight*> _sceneLights;
+    std::vector<AABB> _sceneLightBounds;
 
-    // Lit renderable provided via addRenderable(), for which we construct the
-    // light list with lights received via addLight().
-    struct LitRenderable
-    {
-        // Renderable information submitted with addLitObject()
-        const OpenGLRenderable& renderable;
-        const LitObject* litObject = nullptr;
-        Matrix4 local2World;
-        const IRenderEntity* entity = nullptr;
-
-        // Calculated list of intersecting lights (initially empty)
-        render::lib::VectorLightList lights;
-    };
-    using LitRenderables = std::vector<LitRenderable>;
+    // Either our own buffers or the ones provided by the client
+    PersistentData _ownData;
+    PersistentData& _data;
 
     // Renderables added with addLitObject() need to be stored until their
     // light lists can be calculated, which can't happen until all the lights
-    // are submitted too.
-    std::map<Shader*, LitRenderables> _litRenderables;
+    // are submitted too. This is the number of used elements in _data.litRenderables.
+    std::size_t _numLitRenderables = 0;
+
+    // The number of times the renderable buffer had to grow this frame
+    std::size_t _allocationCount = 0;
+
+    // Below this number of lit renderables, intersections are calculated on a single thread
+    static constexpr std::size_t MIN_RENDERABLES_PER_THREAD = 2048;
 
     // Intersect all received renderables wiith lights
     void calculateLightIntersections()
     {
-        // For each shader
-        for (auto i = _litRenderables.begin(); i != _litRenderables.end(); ++i)
+        // The grid is only rebuilt if any of the lights changed since the last frame
+        _data.lightGrid.update(_sceneLightBounds);
+
+        // Each renderable only writes to its own light list, so the
+        // intersection tests can be split into independent chunks
+        scene::parallelForChunks(_numLitRenderables, MIN_RENDERABLES_PER_THREAD,
+            [&](std::size_t, std::size_t begin, std::size_t end)
         {
-            // For each renderable associated with this shader
-            for (auto j = i->second.begin(); j != i->second.end(); ++j)
+            for (std::size_t i = begin; i < end; ++i)
             {
-                // Test intersection between the LitObject and each light in
-                // the scene
-                for (const RendererLight* l: _sceneLights)
+                LitRenderable& renderable = _data.litRenderables[i];
+
+                if (!renderable.litObject) continue;
+
+                // Lights are reported in submission order
+                _data.lightGrid.foreachIntersectingLight(renderable.litObjectBounds, [&](LightGrid::LightIndex index)
                 {
-                    if (j->litObject && j->litObject->intersectsLight(*l))
-                        j->lights.addLight(*l);
-                }
+                    renderable.lights.addLight(*_sceneLights[index]);
+                });
             }
-        }
+        });
     }
 
 public:
 
-    /// Initialise CamRenderer with optional highlight shaders
-    CamRenderer(const VolumeTest& view, const HighlightShaders& shaders)
+    /**
+     * Initialise CamRenderer with optional highlight shaders.
+     *
+     * Views rendering frame after frame should pass their own PersistentData
+     * instance, to avoid re-allocating the internal buffers for every frame.
+     */
+    CamRenderer(const VolumeTest& view, const HighlightShaders& shaders, PersistentData* persistentData = nullptr)
     : _view(view),
       _editMode(GlobalMapModule().getEditMode()),
-      _shaders(shaders)
+      _shaders(shaders),
+      _data(persistentData != nullptr ? *persistentData : _ownData)
     {}
 
     /**
@@ -112,21 +154,22 @@ public:
             calculateLightIntersections();
         }
 
-        // Render objects with calculated light lists
-        for (auto i = _litRenderables.begin(); i != _litRenderables.end(); ++i)
+        // Render objects with calculated light lists. Each shader receives
+        // its renderables in submission order.
+        for (std::size_t i = 0; i < _numLitRenderables; ++i)
         {
-            Shader* shader = i->first;
-            wxASSERT(shader);
-            for (auto j = i->second.begin(); j != i->second.end(); ++j)
-            {
-                const LitRenderable& lr = *j;
-                shader->addRenderable(lr.renderable, lr.local2World,
-                                      useLights ? &lr.lights : nullptr,
-                                      lr.entity);
-            }
+            const LitRenderable& lr = _data.litRenderables[i];
+            assert(lr.shader);
+
+            lr.shader->addRenderable(*lr.renderable, lr.local2World,
+                                     useLights ? &lr.lights : nullptr,
+                                     lr.entity);
         }
     }
 
+    /// The number of times the lit renderable buffer had to grow during this frame
+    std::size_t getAllocationCount() const { return _allocationCount; }
+
     /// Obtain the visible light count
     int getVisibleLights() const { return _visibleLights; }
 
@@ -152,11 +195,14 @@ public:
     void addLight(const RendererLight& light) override
     {
         // Determine if this light is visible within the view frustum
-        VolumeIntersectionValue viv = _view.TestAABB(light.lightAABB());
+        AABB lightBounds = light.lightAABB();
+
+        VolumeIntersectionValue viv = _view.TestAABB(lightBounds);
         if (viv != VOLUME_OUTSIDE)
         {
             // Store the light in our list of scene lights
             _sceneLights.push_back(&light);
+            _sceneLightBounds.push_back(lightBounds);
 
             // Count the light for the stats display
             ++_visibleLights;
@@ -194,28 +240,27 @@ public:
             _shaders.faceHighlightShader->addRenderable(renderable, localToWorld, nullptr, entity);
         }
 
-        // Construct an entry for this shader in the map if it is the first
-        // time we've seen it
-        auto iter = _litRenderables.find(&shader);
-        if (iter == _litRenderables.end())
+        // Re-use the elements of the previous frames if possible
+        if (_numLitRenderables == _data.litRenderables.size())
         {
-            // Add an entry for this shader, and pre-allocate some space in the
-            // vector to avoid too many expansions during scenegraph traversal.
-            LitRenderables emptyList;
-            emptyList.reserve(1024);
-
-            auto result = _litRenderables.insert(
-                std::make_pair(&shader, std::move(emptyList))
-            );
-            wxASSERT(result.second);
-            iter = result.first;
+            if (_data.litRenderables.size() == _data.litRenderables.capacity())
+            {
+                ++_allocationCount;
+            }
+
+            _data.litRenderables.emplace_back();
         }
-        wxASSERT(iter != _litRenderables.end());
-        wxASSERT(iter->first == &shader);
 
         // Store a LitRenderable object for this renderable
-        LitRenderable lr { renderable, litObject, localToWorld, entity };
-        iter->second.push_back(std::move(lr));
+        LitRenderable& lr = _data.litRenderables[_numLitRenderables++];
+
+        lr.shader = &shader;
+        lr.renderable = &renderable;
+        lr.litObject = litObject;
+        lr.local2World = localToWorld;
+        lr.entity = entity;
+        lr.litObjectBounds = litObject ? litObject->getLitObjectBounds() : AABB();
+        lr.lights.clear();
     }
 };
 
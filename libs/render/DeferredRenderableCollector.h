@@ -0,0 +1,130 @@
+#pragma once
+
+#include "irenderable.h"
+#include "math/Matrix4.h"
+
+#include <vector>
+
+namespace render
+{
+
+/**
+ * \brief
+ * RenderableCollector recording all submissions, such that they can be
+ * replayed into another collector later on.
+ *
+ * This allows several threads to collect renderables at the same time, each
+ * into its own DeferredRenderableCollector. The recorded sequences are then
+ * passed on to the actual collector on the thread owning it, in a defined
+ * order. Highlight flag changes are recorded too, since they are affecting
+ * how the following renderables are submitted.
+ *
+ * The recorded shaders, renderables and lights are referenced by pointer,
+ * they need to stay alive until the replay is done.
+ */
+class DeferredRenderableCollector :
+    public RenderableCollector
+{
+private:
+    enum class Type
+    {
+        Renderable,
+        Light,
+        HighlightFlag,
+    };
+
+    struct Submission
+    {
+        Type type;
+
+        // Renderable submissions
+        Shader* shader;
+        const OpenGLRenderable* renderable;
+        Matrix4 localToWorld;
+        const LitObject* litObject;
+        const IRenderEntity* entity;
+
+        // Light submissions
+        const RendererLight* light;
+
+        // Highlight flag changes
+        Highlight::Flags flags;
+        bool enabled;
+    };
+
+    std::vector<Submission> _submissions;
+
+    bool _supportsFullMaterials;
+
+public:
+    DeferredRenderableCollector(bool supportsFullMaterials) :
+        _supportsFullMaterials(supportsFullMaterials)
+    {}
+
+    void addRenderable(Shader& shader, const OpenGLRenderable& renderable,
+        const Matrix4& localToWorld, const LitObject* litObject = nullptr,
+        const IRenderEntity* entity = nullptr) override
+    {
+        _submissions.push_back({ Type::Renderable, &shader, &renderable, localToWorld,
+            litObject, entity, nullptr, Highlight::NoHighlight, false });
+    }
+
+    void addLight(const RendererLight& light) override
+    {
+        _submissions.push_back({ Type::Light, nullptr, nullptr, Matrix4::getIdentity(),
+            nullptr, nullptr, &light, Highlight::NoHighlight, false });
+    }
+
+    bool supportsFullMaterials() const override
+    {
+        return _supportsFullMaterials;
+    }
+
+    void setHighlightFlag(Highlight::Flags flags, bool enabled) override
+    {
+        _submissions.push_back({ Type::HighlightFlag, nullptr, nullptr, Matrix4::getIdentity(),
+            nullptr, nullptr, nullptr, flags, enabled });
+    }
+
+    // The number of recorded calls, to be used as position in replay()
+    std::size_t size() const
+    {
+        return _submissions.size();
+    }
+
+    void clear()
+    {
+        _submissions.clear();
+    }
+
+    // Pass the recorded calls in the range [begin, end) on to the given collector
+    void replay(RenderableCollector& collector, std::size_t begin, std::size_t end) const
+    {
+        for (auto i = _submissions.begin() + begin; i != _submissions.begin() + end; ++i)
+        {
+            switch (i->type)
+            {
+            case Type::Renderable:
+                collector.addRenderable(*i->shader, *i->renderable, i->localToWorld,
+                    i->litObject, i->entity);
+                break;
+
+            case Type::Light:
+                collector.addLight(*i->light);
+                break;
+
+            case Type::HighlightFlag:
+                collector.setHighlightFlag(i->flags, i->enabled);
+                break;
+            }
+        }
+    }
+
+    // Pass all recorded calls on to the given collector
+    void replay(RenderableCollector& collector) const
+    {
+        replay(collector, 0, _submissions.size());
+    }
+};
+
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "math/AABB.h"
+
+namespace render
+{
+
+/**
+ * A sparse uniform grid over the bounds of a set of lights, used to quickly
+ * find the lights intersecting a given AABB.
+ *
+ * Each light is referred to by its index in the bounds vector passed to
+ * update(). The grid is only rebuilt if these bounds change, so it can be
+ * kept around and reused for as long as the lights don't move.
+ *
+ * Lights covering too many cells are not stored in the grid, they are
+ * checked for every query instead. The same applies to query bounds
+ * spanning a large number of cells, these are tested against all lights.
+ *
+ * Queries don't modify the grid and can be run from several threads.
+ */
+class LightGrid
+{
+public:
+	using LightIndex = std::uint32_t;
+
+private:
+	// The maximum number of cells a light or a query is allowed to span
+	static constexpr std::size_t MAX_CELLS = 64;
+
+	// Cells are never smaller than this
+	static constexpr double MIN_CELL_SIZE = 64;
+
+	// The light bounds as passed to update()
+	std::vector<AABB> _lightBounds;
+
+	double _cellSize = MIN_CELL_SIZE;
+
+	// The lights intersecting each (non-empty) cell
+	std::unordered_map<std::uint64_t, std::vector<LightIndex>> _cells;
+
+	// Lights which are not stored in the cells
+	std::vector<LightIndex> _largeLights;
+
+	struct CellRange
+	{
+		std::int64_t min[3];
+		std::int64_t max[3];
+
+		// Returns the number of cells, or anything above MAX_CELLS for larger ranges
+		std::size_t getNumCells() const
+		{
+			std::size_t count = 1;
+
+			for (std::size_t i = 0; i < 3 && count <= MAX_CELLS; ++i)
+			{
+				count *= static_cast<std::size_t>(max[i] - min[i] + 1);
+			}
+
+			return count;
+		}
+	};
+
+public:
+	// Rebuilds the grid if the given light bounds differ from the ones of the last call
+	void update(const std::vector<AABB>& lightBounds)
+	{
+		if (lightBounds == _lightBounds)
+		{
+			return;
+		}
+
+		_lightBounds = lightBounds;
+		_cells.clear();
+		_largeLights.clear();
+
+		_cellSize = calculateCellSize();
+
+		for (LightIndex index = 0; index < _lightBounds.size(); ++index)
+		{
+			const AABB& bounds = _lightBounds[index];
+
+			// Invalid bounds don't intersect anything
+			if (!bounds.isValid())
+			{
+				continue;
+			}
+
+			CellRange range = getCellRange(bounds);
+
+			if (range.getNumCells() > MAX_CELLS)
+			{
+				_largeLights.push_back(index);
+				continue;
+			}
+
+			forEachCell(range, [&](std::uint64_t cell)
+			{
+				_cells[cell].push_back(index);
+			});
+		}
+	}
+
+	// The number of lights passed to the last update() call
+	std::size_t size() const
+	{
+		return _lightBounds.size();
+	}
+
+	/**
+	 * Invokes the given functor with the index of every light intersecting
+	 * the given bounds (as defined by AABB::intersects()), in ascending order.
+	 */
+	template<typename Functor>
+	void foreachIntersectingLight(const AABB& bounds, const Functor& functor) const
+	{
+		if (!bounds.isValid())
+		{
+			return;
+		}
+
+		CellRange range = getCellRange(bounds);
+
+		if (range.getNumCells() > MAX_CELLS)
+		{
+			// Large query, it's cheaper to check all lights
+			for (LightIndex index = 0; index < _lightBounds.size(); ++index)
+			{
+				if (_lightBounds[index].intersects(bounds))
+				{
+					functor(index);
+				}
+			}
+
+			return;
+		}
+
+		std::vector<LightIndex> candidates(_largeLights);
+
+		forEachCell(range, [&](std::uint64_t cell)
+		{
+			auto found = _cells.find(cell);
+
+			if (found != _cells.end())
+			{
+				candidates.insert(candidates.end(), found->second.begin(), found->second.end());
+			}
+		});
+
+		// Lights spanning several cells are showing up more than once
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+		for (LightIndex index : candidates)
+		{
+			if (_lightBounds[index].intersects(bounds))
+			{
+				functor(index);
+			}
+		}
+	}
+
+private:
+	// Uses twice the median light size, such that a typical light covers a few cells
+	double calculateCellSize() const
+	{
+		std::vector<double> sizes;
+		sizes.reserve(_lightBounds.size());
+
+		for (const AABB& bounds : _lightBounds)
+		{
+			if (bounds.isValid())
+			{
+				sizes.push_back(std::max({ bounds.extents.x(), bounds.extents.y(), bounds.extents.z() }));
+			}
+		}
+
+		if (sizes.empty())
+		{
+			return MIN_CELL_SIZE;
+		}
+
+		auto median = sizes.begin() + sizes.size() / 2;
+		std::nth_element(sizes.begin(), median, sizes.end());
+
+		// The extents are half the light size
+		return std::max(*median * 4, MIN_CELL_SIZE);
+	}
+
+	CellRange getCellRange(const AABB& bounds) const
+	{
+		CellRange range;
+
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			range.min[i] = getCellCoordinate(bounds.origin[i] - bounds.extents[i]);
+			range.max[i] = getCellCoordinate(bounds.origin[i] + bounds.extents[i]);
+		}
+
+		return range;
+	}
+
+	// Clamped to the range representable in the cell keys
+	std::int64_t getCellCoordinate(double value) const
+	{
+		const double limit = 1 << 20;
+		return static_cast<std::int64_t>(std::max(std::min(std::floor(value / _cellSize), limit - 1), -limit));
+	}
+
+	template<typename Functor>
+	static void forEachCell(const CellRange& range, const Functor& functor)
+	{
+		for (auto x = range.min[0]; x <= range.max[0]; ++x)
+		{
+			for (auto y = range.min[1]; y <= range.max[1]; ++y)
+			{
+				for (auto z = range.min[2]; z <= range.max[2]; ++z)
+				{
+					functor(getCellKey(x, y, z));
+				}
+			}
+		}
+	}
+
+	// Packs the cell coordinates into a single key, 21 bits per component
+	static std::uint64_t getCellKey(std::int64_t x, std::int64_t y, std::int64_t z)
+	{
+		const std::uint64_t mask = (1u << 21) - 1;
+
+		return (static_cast<std::uint64_t>(x) & mask) |
+			((static_cast<std::uint64_t>(y) & mask) << 21) |
+			((static_cast<std::uint64_t>(z) & mask) << 42);
+	}
+};
+
+}
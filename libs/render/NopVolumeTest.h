@@ -1,7 +1,9 @@
 #pragma once
 
 #include "ivolumetest.h"
+#include <algorithm>
 #include "math/Matrix4.h"
+#include "math/PackedAABBs.h"
 
 namespace render
 {
@@ -58,6 +60,11 @@ public:
 		return VOLUME_INSIDE;
 	}
 
+	void TestAABBs(const PackedAABBs& aabbs, VolumeIntersectionValue* results) const
+	{
+		std::fill(results, results + aabbs.size(), VOLUME_INSIDE);
+	}
+
 	virtual bool fill() const
 	{ 
 		return true;
@@ -5,7 +5,12 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "iscenegraph.h"
+#include "DeferredRenderableCollector.h"
+#include "scene/ParallelChunks.h"
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <vector>
 
 namespace render
 {
@@ -18,6 +23,9 @@ namespace render
  * Also provides support for highlighting selected objects by activating the
  * RenderableCollector's "highlight" flags based on the renderable object's
  * selection state.
+ *
+ * Nodes supporting concurrent submission can be dispatched on several threads,
+ * see CollectRenderablesInScene().
  */
 class RenderableCollectionWalker :
     public scene::Graph::Walker
@@ -38,24 +46,27 @@ private:
 public:
 	void dispatchRenderable(const Renderable& renderable)
 	{
-		if (_collector.supportsFullMaterials())
-		{
-			renderable.renderSolid(_collector, _volume);
-		}
-		else
-		{
-			renderable.renderWireframe(_collector, _volume);
-		}
+		dispatchRenderable(renderable, _collector);
 	}
 
     // scene::Graph::Walker implementation
     bool visit(const scene::INodePtr& node)
+    {
+        node->viewChanged();
+
+        submit(node, _collector);
+
+        return true;
+    }
+
+private:
+    // Sets the highlight flags for the given node and passes its renderables
+    // to the given collector (which is either ours or a deferred one)
+    void submit(const scene::INodePtr& node, RenderableCollector& collector) const
     {
         // greebo: Highlighting propagates to child nodes
         scene::INodePtr parent = node->getParent();
 
-        node->viewChanged();
-
 		std::size_t highlightFlags = node->getHighlightFlags();
 
         auto nodeType = node->getNodeType();
@@ -69,7 +80,7 @@ public:
 
         if (nodeType == scene::INode::Type::MergeAction)
         {
-            _collector.setHighlightFlag(RenderableCollector::Highlight::MergeAction, true);
+            collector.setHighlightFlag(RenderableCollector::Highlight::MergeAction, true);
 
             auto mergeActionNode = std::dynamic_pointer_cast<scene::IMergeActionNode>(node);
             assert(mergeActionNode);
@@ -78,94 +89,138 @@ public:
             {
             case scene::merge::ActionType::AddChildNode:
             case scene::merge::ActionType::AddEntity:
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, true);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, true);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
                 break;
 
             case scene::merge::ActionType::AddKeyValue:
             case scene::merge::ActionType::ChangeKeyValue:
             case scene::merge::ActionType::RemoveKeyValue:
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, true);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, true);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
                 break;
 
             case scene::merge::ActionType::RemoveChildNode:
             case scene::merge::ActionType::RemoveEntity:
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, true);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, true);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
                 break;
 
             case scene::merge::ActionType::ConflictResolution:
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, true);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
-                _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, true);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
+                collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
                 break;
             }
         }
         else
         {
-            _collector.setHighlightFlag(RenderableCollector::Highlight::MergeAction, false);
-            _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
-            _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
-            _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
-            _collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
+            collector.setHighlightFlag(RenderableCollector::Highlight::MergeAction, false);
+            collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionAdd, false);
+            collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionChange, false);
+            collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionRemove, false);
+            collector.setHighlightFlag(RenderableCollector::Highlight::MergeActionConflict, false);
         }
 
         if (highlightFlags & Renderable::Highlight::Selected)
         {
             if (GlobalSelectionSystem().Mode() != SelectionSystem::eComponent)
             {
-				_collector.setHighlightFlag(RenderableCollector::Highlight::Faces, true);
+				collector.setHighlightFlag(RenderableCollector::Highlight::Faces, true);
             }
             else
             {
-				_collector.setHighlightFlag(RenderableCollector::Highlight::Faces, false);
-                node->renderComponents(_collector, _volume);
+				collector.setHighlightFlag(RenderableCollector::Highlight::Faces, false);
+                node->renderComponents(collector, _volume);
             }
 
-			_collector.setHighlightFlag(RenderableCollector::Highlight::Primitives, true);
+			collector.setHighlightFlag(RenderableCollector::Highlight::Primitives, true);
 
 			// Pass on the info about whether we have a group member selected
 			if (highlightFlags & Renderable::Highlight::GroupMember)
 			{
-				_collector.setHighlightFlag(RenderableCollector::Highlight::GroupMember, true);
+				collector.setHighlightFlag(RenderableCollector::Highlight::GroupMember, true);
 			}
 			else
 			{
-				_collector.setHighlightFlag(RenderableCollector::Highlight::GroupMember, false);
+				collector.setHighlightFlag(RenderableCollector::Highlight::GroupMember, false);
 			}
         }
 		else
 		{
-			_collector.setHighlightFlag(RenderableCollector::Highlight::Primitives, false);
-			_collector.setHighlightFlag(RenderableCollector::Highlight::Faces, false);
-			_collector.setHighlightFlag(RenderableCollector::Highlight::GroupMember, false);
+			collector.setHighlightFlag(RenderableCollector::Highlight::Primitives, false);
+			collector.setHighlightFlag(RenderableCollector::Highlight::Faces, false);
+			collector.setHighlightFlag(RenderableCollector::Highlight::GroupMember, false);
 		}
 
-		dispatchRenderable(*node);
+		dispatchRenderable(*node, collector);
+    }
 
-        return true;
+    void dispatchRenderable(const Renderable& renderable, RenderableCollector& collector) const
+    {
+        if (collector.supportsFullMaterials())
+        {
+            renderable.renderSolid(collector, _volume);
+        }
+        else
+        {
+            renderable.renderWireframe(collector, _volume);
+        }
     }
 
+public:
+
     /**
      * \brief
      * Use a RenderableCollectionWalker to find all renderables in the global
      * scenegraph.
+     *
+     * In solid mode, the nodes supporting concurrent submission are
+     * dispatched on several threads, each one recording into a separate
+     * DeferredRenderableCollector. The recorded renderables are then passed
+     * on to the given collector on the calling thread, in the order of the
+     * scene traversal. The collector receives the same sequence of calls as
+     * in a single-threaded collection.
+     *
+     * \param threadMilliseconds
+     * Optional vector receiving the time spent on each thread, with the
+     * calling thread being the first element.
+     *
+     * \param minNodesPerThread
+     * Below this number of concurrently submittable nodes per thread, less
+     * threads are used.
      */
-    static void CollectRenderablesInScene(RenderableCollector& collector, const VolumeTest& volume)
+    static void CollectRenderablesInScene(RenderableCollector& collector, const VolumeTest& volume,
+        std::vector<double>* threadMilliseconds = nullptr, std::size_t minNodesPerThread = 512)
     {
+        auto start = std::chrono::steady_clock::now();
+
+        auto getMillisecondsSince = [](std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
         // Instantiate a new walker class
         RenderableCollectionWalker renderHighlightWalker(collector, volume);
 
-        // Submit renderables from scene graph
-        GlobalSceneGraph().foreachVisibleNodeInVolume(volume, renderHighlightWalker);
+        std::vector<double> workerMilliseconds;
+
+        if (collector.supportsFullMaterials() && GlobalSelectionSystem().Mode() != SelectionSystem::eComponent)
+        {
+            workerMilliseconds = renderHighlightWalker.collectConcurrently(minNodesPerThread);
+        }
+        else
+        {
+            // Submit renderables from scene graph
+            GlobalSceneGraph().foreachVisibleNodeInVolume(volume, renderHighlightWalker);
+        }
 
         // Submit any renderables that have been directly attached to the RenderSystem
 		// without belonging to an actual scene object
@@ -174,6 +229,105 @@ public:
 		{
 			walker.dispatchRenderable(renderable);
 		});
+
+        if (threadMilliseconds != nullptr)
+        {
+            threadMilliseconds->assign(1, getMillisecondsSince(start));
+            threadMilliseconds->insert(threadMilliseconds->end(), workerMilliseconds.begin(), workerMilliseconds.end());
+        }
+    }
+
+private:
+    // Returns the time spent by each worker thread
+    std::vector<double> collectConcurrently(std::size_t minNodesPerThread)
+    {
+        // The traversal and viewChanged() calls are not thread-safe, this
+        // is also evaluating the bounds of all visible nodes
+        std::vector<scene::INodePtr> nodes;
+        std::vector<std::size_t> concurrentNodes;
+
+        GlobalSceneGraph().foreachVisibleNodeInVolume(_volume, [&](const scene::INodePtr& node)
+        {
+            node->viewChanged();
+
+            if (node->supportsConcurrentSubmission())
+            {
+                // The transform is evaluated lazily on first access, which is
+                // modifying the node (and its parents). Do it here, such that
+                // the worker threads are only reading the cached matrix.
+                node->localToWorld();
+
+                concurrentNodes.push_back(nodes.size());
+            }
+
+            nodes.push_back(node);
+            return true;
+        });
+
+        std::size_t numChunks = scene::getNumParallelChunks(concurrentNodes.size(), minNodesPerThread);
+
+        // Not worth the overhead, submit everything right away
+        if (numChunks == 1)
+        {
+            for (const auto& node : nodes)
+            {
+                submit(node, _collector);
+            }
+
+            return std::vector<double>();
+        }
+
+        // Where to find the recorded calls of each concurrently submitted node
+        struct Recording
+        {
+            std::size_t chunk;
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        std::vector<Recording> recordings(concurrentNodes.size());
+        std::vector<DeferredRenderableCollector> collectors(numChunks,
+            DeferredRenderableCollector(_collector.supportsFullMaterials()));
+        std::vector<double> milliseconds(numChunks);
+
+        scene::parallelForChunks(concurrentNodes.size(), minNodesPerThread,
+            [&](std::size_t chunk, std::size_t begin, std::size_t end)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                auto& recording = recordings[i];
+
+                recording.chunk = chunk;
+                recording.begin = collectors[chunk].size();
+                submit(nodes[concurrentNodes[i]], collectors[chunk]);
+                recording.end = collectors[chunk].size();
+            }
+
+            milliseconds[chunk] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        });
+
+        // Submit everything in traversal order, the remaining nodes are dispatched right here
+        auto recording = recordings.begin();
+        auto concurrentNode = concurrentNodes.begin();
+
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (concurrentNode != concurrentNodes.end() && *concurrentNode == i)
+            {
+                collectors[recording->chunk].replay(_collector, recording->begin, recording->end);
+                ++concurrentNode;
+                ++recording;
+            }
+            else
+            {
+                submit(nodes[i], _collector);
+            }
+        }
+
+        // The first chunk has been processed by the calling thread, which is reported separately
+        return std::vector<double>(milliseconds.begin() + 1, milliseconds.end());
     }
 };
 
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <cstddef>
+#include <mutex>
+#include <vector>
 
 namespace render
 {
@@ -16,6 +19,37 @@ namespace detail
     {
         return GLsizei(array.size() * sizeof(typename Array_T::value_type));
     }
+
+    inline std::size_t& uploadedBytes()
+    {
+        static std::size_t bytes = 0;
+        return bytes;
+    }
+
+    struct VBODeletionQueue
+    {
+        std::mutex mutex;
+        std::vector<GLuint> buffers;
+    };
+
+    inline VBODeletionQueue& deletionQueue()
+    {
+        static VBODeletionQueue queue;
+        return queue;
+    }
+}
+
+/**
+ * \brief
+ * Total number of bytes uploaded through the functions in this file.
+ *
+ * This is never reset, the amount uploaded during a frame is the difference
+ * between the values before and after rendering it. Buffers are only
+ * uploaded from the thread owning the GL context, so this isn't synchronised.
+ */
+inline std::size_t getTotalUploadedVBOBytes()
+{
+    return detail::uploadedBytes();
 }
 
 /**
@@ -38,6 +72,7 @@ GLuint makeVBOFromArray(GLenum target, const Array_T& data)
 
     // Copy data
     glBufferData(target, detail::byteSize(data), &data.front(), GL_STATIC_DRAW);
+    detail::uploadedBytes() += detail::byteSize(data);
 
     // Return the VBO identifier
     return vboID;
@@ -49,6 +84,63 @@ void replaceVBOData(GLenum target, GLuint vboID, const Array_T& data)
 {
     glBindBuffer(target, vboID);
     glBufferSubData(target, 0, detail::byteSize(data), &data.front());
+    detail::uploadedBytes() += detail::byteSize(data);
+}
+
+/**
+ * \brief
+ * Upload the given array to a VBO, creating it if necessary.
+ *
+ * \param storeSize
+ * The size in bytes of the VBO's data store, which is re-used if it is
+ * matching the size of the new data. Is updated by this function.
+ */
+template<typename Array_T>
+void uploadVBOData(GLenum target, GLuint& vboID, GLsizei& storeSize,
+                   const Array_T& data)
+{
+    if (vboID == 0)
+    {
+        glGenBuffers(1, &vboID);
+        storeSize = 0;
+    }
+
+    glBindBuffer(target, vboID);
+
+    GLsizei size = detail::byteSize(data);
+
+    if (size == storeSize)
+    {
+        glBufferSubData(target, 0, size, &data.front());
+    }
+    else
+    {
+        glBufferData(target, size, &data.front(), GL_STATIC_DRAW);
+        storeSize = size;
+    }
+
+    detail::uploadedBytes() += size;
+}
+
+/**
+ * \brief
+ * Replace a range of the VBO's data store with the given elements of the
+ * array. The data store must be large enough to hold the whole array.
+ *
+ * \param first
+ * Index of the first array element to upload, which is also the element's
+ * position in the data store.
+ */
+template<typename Array_T>
+void replaceVBODataRange(GLenum target, GLuint vboID, const Array_T& data,
+                         std::size_t first, std::size_t count)
+{
+    const std::size_t elementSize = sizeof(typename Array_T::value_type);
+
+    glBindBuffer(target, vboID);
+    glBufferSubData(target, GLintptr(first * elementSize),
+                    GLsizeiptr(count * elementSize), &data[first]);
+    detail::uploadedBytes() += count * elementSize;
 }
 
 /// Delete a VBO and set its identifier to 0
@@ -60,6 +152,39 @@ inline void deleteVBO(GLuint& id)
     id = 0;
 }
 
+/**
+ * \brief
+ * Queue a VBO for deletion and set its identifier to 0.
+ *
+ * In contrast to deleteVBO() this doesn't require a current GL context, and
+ * can be called from any thread, e.g. in destructors. The queued buffers are
+ * deleted by the render system at the start of the next frame.
+ */
+inline void deleteVBOLater(GLuint& id)
+{
+    if (id == 0) return;
+
+    auto& queue = detail::deletionQueue();
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.buffers.push_back(id);
+    id = 0;
+}
+
+/// Delete all VBOs queued by deleteVBOLater(), requires a current GL context
+inline void deleteQueuedVBOs()
+{
+    auto& queue = detail::deletionQueue();
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (!queue.buffers.empty())
+    {
+        glDeleteBuffers(GLsizei(queue.buffers.size()), queue.buffers.data());
+        queue.buffers.clear();
+    }
+}
+
 /// Replace VBO data if new data is smaller than or equal to existing data
 /**
  * \param target
@@ -3,6 +3,7 @@
 #include "irenderview.h"
 
 #include "math/Frustum.h"
+#include "math/PackedAABBs.h"
 #include "math/ViewProjection.h"
 #include "math/Viewer.h"
 
@@ -149,6 +150,14 @@ public:
 		return _frustum.testIntersection(aabb, localToWorld);
 	}
 
+	void TestAABBs(const PackedAABBs& aabbs, VolumeIntersectionValue* results) const override
+	{
+#ifdef DEBUG_CULLING
+		const_cast<View*>(this)->_count_bboxs += static_cast<int>(aabbs.size());
+#endif
+		_frustum.testIntersection(aabbs, results);
+	}
+
 	const Matrix4& GetViewProjection() const override
 	{
 		return _viewproj;
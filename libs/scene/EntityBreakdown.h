@@ -5,6 +5,7 @@
 #include "iscenegraph.h"
 #include "ientity.h"
 #include "ieclass.h"
+#include "ParallelTraversal.h"
 
 namespace scene
 {
@@ -12,8 +13,7 @@ namespace scene
 /** greebo: This object traverses the scenegraph on construction
  * 			counting all occurrences of each entity class.
  */
-class EntityBreakdown :
-	public scene::NodeVisitor
+class EntityBreakdown
 {
 public:
 	typedef std::map<std::string, std::size_t> Map;
@@ -24,35 +24,7 @@ private:
 public:
 	EntityBreakdown()
 	{
-		_map.clear();
-		GlobalSceneGraph().root()->traverse(*this);
-	}
-
-	bool pre(const scene::INodePtr& node) override
-	{
-		// Is this node an entity?
-		Entity* entity = Node_getEntity(node);
-
-		if (entity != nullptr)
-		{
-			IEntityClassConstPtr eclass = entity->getEntityClass();
-			std::string ecName = eclass->getName();
-
-			auto found = _map.find(ecName);
-
-			if (found == _map.end())
-			{
-				// Entity class not yet registered, create new entry
-				_map.emplace(ecName, 1);
-			}
-			else
-			{
-				// Eclass is known, increase the counter
-				found->second++;
-			}
-		}
-
-		return true;
+		_map = foreachNodeParallel<Map>(GlobalSceneGraph().root(), CountEntities, Merge);
 	}
 
 	// Accessor method to retrieve the entity breakdown map
@@ -71,6 +43,26 @@ public:
 		return _map.end();
 	}
 
+private:
+	static void CountEntities(const scene::INodePtr& node, Map& map)
+	{
+		// Is this node an entity?
+		Entity* entity = Node_getEntity(node);
+
+		if (entity != nullptr)
+		{
+			map[entity->getEntityClass()->getName()]++;
+		}
+	}
+
+	static void Merge(Map& target, Map&& source)
+	{
+		for (const auto& pair : source)
+		{
+			target[pair.first] += pair.second;
+		}
+	}
+
 }; // class EntityBreakdown
 
 } // namespace
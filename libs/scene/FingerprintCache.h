@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include "icomparablenode.h"
+
+namespace scene
+{
+
+/**
+ * Keeps the fingerprints calculated by a comparable node, one per hash type.
+ * The owning node invalidates them whenever it is about to change, such that
+ * unchanged nodes don't need to be hashed again.
+ *
+ * The same node can be fingerprinted by several threads at once, e.g. when
+ * two comparisons share a graph: the first caller calculates the value while
+ * holding the lock, the others wait and pick it up. Invalidation happens
+ * when the node is changed, which mustn't overlap with any comparison.
+ */
+class FingerprintCache
+{
+private:
+    static constexpr std::size_t NumHashTypes = 2;
+
+    std::mutex _lock;
+    std::string _fingerprints[NumHashTypes];
+    bool _valid[NumHashTypes];
+
+public:
+    FingerprintCache() :
+        _valid{ false, false }
+    {}
+
+    // Drops the cached fingerprints, returns true if there has been any
+    bool invalidate()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        bool hadFingerprints = false;
+
+        for (std::size_t i = 0; i < NumHashTypes; ++i)
+        {
+            hadFingerprints |= _valid[i];
+            _valid[i] = false;
+        }
+
+        return hadFingerprints;
+    }
+
+    // Returns the cached fingerprint of the given type, invoking calculate() if there is none.
+    // calculate() may fingerprint other nodes, but must not access this cache again.
+    template<typename CalculateFunc>
+    std::string get(FingerprintHash hash, const CalculateFunc& calculate)
+    {
+        auto index = static_cast<std::size_t>(hash);
+
+        std::lock_guard<std::mutex> lock(_lock);
+
+        if (!_valid[index])
+        {
+            _fingerprints[index] = calculate();
+            _valid[index] = true;
+        }
+
+        return _fingerprints[index];
+    }
+};
+
+/**
+ * Invalidates the fingerprints cached by the given node and notifies its
+ * comparable parent. If the node had nothing cached, there's no need to
+ * notify the parent, it can't keep a value combined from this node's ones.
+ */
+inline void invalidateFingerprint(FingerprintCache& cache, const INode& node)
+{
+    if (!cache.invalidate())
+    {
+        return;
+    }
+
+    auto parent = std::dynamic_pointer_cast<IComparableNode>(node.getParent());
+
+    if (parent)
+    {
+        parent->onChildFingerprintChanged();
+    }
+}
+
+}
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <string>
 #include "iscenegraph.h"
 #include "imodel.h"
 #include "modelskin.h"
+#include "ParallelTraversal.h"
 
 namespace scene
 {
@@ -13,8 +15,7 @@ namespace scene
  * greebo: This object traverses the scenegraph on construction
  * counting all occurrences of each model (plus skins).
  */
-class ModelBreakdown :
-	public scene::NodeVisitor
+class ModelBreakdown
 {
 public:
 	struct ModelCount
@@ -26,7 +27,8 @@ public:
 		SkinCountMap skinCount;
 
 		ModelCount() :
-			count(0)
+			count(0),
+			polyCount(0)
 		{}
 	};
 
@@ -34,65 +36,12 @@ public:
 	typedef std::map<std::string, ModelCount> Map;
 
 private:
-	mutable Map _map;
+	Map _map;
 
 public:
 	ModelBreakdown()
 	{
-		_map.clear();
-		GlobalSceneGraph().root()->traverseChildren(*this);
-	}
-
-	bool pre(const scene::INodePtr& node) override
-	{
-		// Check if this node is a model
-		model::ModelNodePtr modelNode = Node_getModel(node);
-
-		if (modelNode)
-		{
-			// Get the actual model from the node
-			const model::IModel& model = modelNode->getIModel();
-
-			Map::iterator found = _map.find(model.getModelPath());
-
-			if (found == _map.end())
-			{
-				auto result = _map.emplace(model.getModelPath(), ModelCount());
-
-				found = result.first;
-
-				// Store the polycount in the map
-				found->second.polyCount = model.getPolyCount();
-				found->second.skinCount.clear();
-			}
-
-			// The iterator "found" is valid at this point
-			// Get a shortcut reference
-			ModelCount& modelCount = found->second;
-
-			modelCount.count++;
-
-			// Increase the skin count, check if we have a skinnable model
-			auto skinned = std::dynamic_pointer_cast<SkinnedModel>(node);
-
-			if (skinned)
-			{
-				std::string skinName = skinned->getSkin();
-
-				auto foundSkin = modelCount.skinCount.find(skinName);
-
-				if (foundSkin == modelCount.skinCount.end())
-				{
-					auto result = modelCount.skinCount.emplace(skinName, 0);
-
-					foundSkin = result.first;
-				}
-
-				foundSkin->second++;
-			}
-		}
-
-		return true;
+		_map = foreachNodeParallel<Map>(GlobalSceneGraph().root(), CountModels, Merge);
 	}
 
 	// Accessor method to retrieve the entity breakdown map
@@ -129,6 +78,60 @@ public:
 	{
 		return _map.end();
 	}
+
+private:
+	static void CountModels(const scene::INodePtr& node, Map& map)
+	{
+		// Check if this node is a model
+		model::ModelNodePtr modelNode = Node_getModel(node);
+
+		if (!modelNode) return;
+
+		// Get the actual model from the node
+		const model::IModel& model = modelNode->getIModel();
+
+		auto found = map.find(model.getModelPath());
+
+		if (found == map.end())
+		{
+			found = map.emplace(model.getModelPath(), ModelCount()).first;
+
+			// Store the polycount in the map
+			found->second.polyCount = model.getPolyCount();
+		}
+
+		ModelCount& modelCount = found->second;
+		modelCount.count++;
+
+		// Increase the skin count, check if we have a skinnable model
+		auto skinned = std::dynamic_pointer_cast<SkinnedModel>(node);
+
+		if (skinned)
+		{
+			modelCount.skinCount[skinned->getSkin()]++;
+		}
+	}
+
+	static void Merge(Map& target, Map&& source)
+	{
+		for (auto& pair : source)
+		{
+			auto found = target.find(pair.first);
+
+			if (found == target.end())
+			{
+				target.emplace(pair.first, std::move(pair.second));
+				continue;
+			}
+
+			found->second.count += pair.second.count;
+
+			for (const auto& skin : pair.second.skinCount)
+			{
+				found->second.skinCount[skin.first] += skin.second;
+			}
+		}
+	}
 };
 
 } // namespace
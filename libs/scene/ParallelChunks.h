@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace scene
+{
+
+/**
+ * Returns the number of chunks parallelForChunks() splits the given number
+ * of items into: one per hardware thread, but without going below
+ * minPerThread items per chunk. Callers keeping a state per chunk can use
+ * this to allocate it up front.
+ */
+inline std::size_t getNumParallelChunks(std::size_t count, std::size_t minPerThread)
+{
+    return std::min<std::size_t>(
+        std::max(std::thread::hardware_concurrency(), 1u),
+        count / std::max<std::size_t>(minPerThread, 1) + 1
+    );
+}
+
+/**
+ * Splits the index range [0, count) into contiguous chunks of about the same
+ * size and processes them on several threads. The calling thread takes the
+ * first chunk and returns once all chunks are done, exceptions thrown by the
+ * other chunks are re-thrown here.
+ *
+ * The chunks are numbered in index order, from 0 to getNumParallelChunks() - 1.
+ * Combining their results in chunk order gives the same outcome regardless
+ * of the number of threads and their scheduling.
+ *
+ * Starting a thread through std::async costs in the order of tens of
+ * microseconds, minPerThread should be the number of items taking clearly
+ * longer than that to process. Callers choose it from the cost of their
+ * items, small inputs are then processed on the calling thread alone.
+ *
+ * ChunkFunc signature: void(std::size_t chunk, std::size_t begin, std::size_t end)
+ */
+template<typename ChunkFunc>
+void parallelForChunks(std::size_t count, std::size_t minPerThread, const ChunkFunc& processChunk)
+{
+    std::size_t numChunks = getNumParallelChunks(count, minPerThread);
+
+    auto runChunk = [&](std::size_t chunk)
+    {
+        processChunk(chunk, count * chunk / numChunks, count * (chunk + 1) / numChunks);
+    };
+
+    std::vector<std::future<void>> workers;
+    workers.reserve(numChunks - 1);
+
+    for (std::size_t chunk = 1; chunk < numChunks; ++chunk)
+    {
+        workers.emplace_back(std::async(std::launch::async, runChunk, chunk));
+    }
+
+    runChunk(0);
+
+    for (auto& worker : workers)
+    {
+        worker.get();
+    }
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include "inode.h"
+#include "ParallelChunks.h"
+
+namespace scene
+{
+
+/**
+ * Visits all nodes below the given root (excluding the root itself) using
+ * multiple threads, for visitors that don't modify the scene.
+ *
+ * The nodes are collected in the same order as a regular traversal would
+ * visit them, and this sequence is split into contiguous chunks, one per
+ * worker thread. Each chunk is visited into its own Accumulator instance,
+ * which are then merged on the calling thread in chunk order by the given
+ * reduce function. For an associative reduce function the result is
+ * therefore identical to a single-threaded traversal, regardless of the
+ * number of threads and their scheduling.
+ *
+ * The visitor is invoked concurrently, it must only read from the nodes
+ * and must not trigger any lazy evaluation that is modifying them
+ * (like worldAABB() or localToWorld() on nodes with dirty transforms).
+ *
+ * Visitor signature:  void(const INodePtr& node, Accumulator& accumulator)
+ * Reduce signature:   void(Accumulator& target, Accumulator&& source)
+ *
+ * minNodesPerChunk avoids spawning threads for small graphs, where the
+ * overhead would outweigh the benefits.
+ */
+template<typename Accumulator, typename VisitFunc, typename ReduceFunc>
+Accumulator foreachNodeParallel(const INodePtr& root, const VisitFunc& visit, const ReduceFunc& reduce,
+    std::size_t minNodesPerChunk = 512)
+{
+    std::vector<INodePtr> nodes;
+
+    // Flattening the graph is the only part which has to be single-threaded
+    root->foreachNode([&](const INodePtr& node)
+    {
+        nodes.push_back(node);
+        return true;
+    });
+
+    std::size_t numChunks = getNumParallelChunks(nodes.size(), minNodesPerChunk);
+    std::vector<Accumulator> accumulators(numChunks);
+
+    parallelForChunks(nodes.size(), minNodesPerChunk, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            visit(nodes[i], accumulators[chunk]);
+        }
+    });
+
+    // Reduce in chunk order
+    for (std::size_t chunk = 1; chunk < numChunks; ++chunk)
+    {
+        reduce(accumulators[0], std::move(accumulators[chunk]));
+    }
+
+    return std::move(accumulators[0]);
+}
+
+}
@@ -5,6 +5,7 @@
 #include "ipatch.h"
 #include "ibrush.h"
 #include "iscenegraph.h"
+#include "ParallelTraversal.h"
 
 namespace scene
 {
@@ -13,8 +14,7 @@ namespace scene
  * greebo: This object traverses the scenegraph on construction
  * counting all occurrences of each shader.
  */
-class ShaderBreakdown :
-	public scene::NodeVisitor
+class ShaderBreakdown
 {
 public:
 	struct ShaderCount
@@ -31,37 +31,12 @@ public:
 	typedef std::map<std::string, ShaderCount> Map;
 
 private:
-	mutable Map _map;
+	Map _map;
 
 public:
 	ShaderBreakdown()
 	{
-		_map.clear();
-		GlobalSceneGraph().root()->traverseChildren(*this);
-	}
-
-	bool pre(const scene::INodePtr& node) override
-	{
-		// Check if this node is a patch
-		if (Node_isPatch(node))
-		{
-			increaseShaderCount(Node_getIPatch(node)->getShader(), false);
-			return false;
-		}
-
-		if (Node_isBrush(node))
-        {
-			auto brush = Node_getIBrush(node);
-			
-			for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
-            {
-                increaseShaderCount(brush->getFace(i).getShader(), true);
-            }
-
-			return false;
-		}
-
-		return true;
+		_map = foreachNodeParallel<Map>(GlobalSceneGraph().root(), CountShaders, Merge);
 	}
 
 	// Accessor method to retrieve the shader breakdown map
@@ -81,28 +56,34 @@ public:
 	}
 
 private:
-	// Local helper to increase the shader occurrence count
-	void increaseShaderCount(const std::string& shaderName, bool isFace)
+	static void CountShaders(const scene::INodePtr& node, Map& map)
 	{
-		// Try to look up the shader in the map
-		auto found = _map.find(shaderName);
-
-		if (found == _map.end())
+		// Check if this node is a patch
+		if (Node_isPatch(node))
 		{
-			// Shader not yet registered, create new entry
-			auto result = _map.emplace(shaderName, ShaderCount());
-
-			found = result.first;
+			map[Node_getIPatch(node)->getShader()].patchCount++;
+			return;
 		}
 
-		// Iterator is valid at this point, increase the counter
-		if (isFace)
+		if (Node_isBrush(node))
 		{
-			found->second.faceCount++;
+			auto brush = Node_getIBrush(node);
+
+			for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+			{
+				map[brush->getFace(i).getShader()].faceCount++;
+			}
 		}
-		else
+	}
+
+	static void Merge(Map& target, Map&& source)
+	{
+		for (const auto& pair : source)
 		{
-			found->second.patchCount++;
+			auto& count = target[pair.first];
+
+			count.faceCount += pair.second.faceCount;
+			count.patchCount += pair.second.patchCount;
 		}
 	}
 
@@ -1,6 +1,8 @@
 #include "GraphComparer.h"
 
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include "ientity.h"
 #include "i18n.h"
 #include "itextstream.h"
@@ -8,6 +10,8 @@
 #include "icomparablenode.h"
 #include "math/Hash.h"
 #include "scenelib.h"
+#include "scene/ParallelChunks.h"
+#include "scene/ParallelTraversal.h"
 #include "string/string.h"
 #include "command/ExecutionNotPossible.h"
 #include "NodeUtils.h"
@@ -18,12 +22,124 @@ namespace scene
 namespace merge
 {
 
-ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base)
+namespace
+{
+    // Fingerprinting a node is expensive enough to be worth a thread for a few dozen nodes
+    constexpr std::size_t MIN_FINGERPRINTS_PER_THREAD = 64;
+
+    // Comparing an entity involves its key values and all of its children
+    constexpr std::size_t MIN_ENTITY_COMPARISONS_PER_THREAD = 8;
+
+    inline bool isPrimitive(const INodePtr& node)
+    {
+        return node->getNodeType() == INode::Type::Brush || node->getNodeType() == INode::Type::Patch;
+    }
+
+    // Appends the fingerprint unless it's already in the list, the first node wins in case of a collision
+    inline void addUniqueFingerprint(std::vector<std::pair<std::string, INodePtr>>& fingerprints,
+        std::unordered_set<std::string>& seen, std::string&& fingerprint, const INodePtr& node, const INodePtr& parent)
+    {
+        if (!seen.insert(fingerprint).second)
+        {
+            rWarning() << "More than one node with the same fingerprint found in the parent node with name " << parent->name() << std::endl;
+            return;
+        }
+
+        fingerprints.emplace_back(std::move(fingerprint), node);
+    }
+}
+
+void GraphComparer::CalculateFingerprints(const INodePtr& root, FingerprintHash hash)
+{
+    calculatePrimitiveFingerprints(root, hash);
+    calculateEntityFingerprints(root, hash);
+}
+
+void GraphComparer::calculatePrimitiveFingerprints(const INodePtr& root, FingerprintHash hash)
+{
+    foreachNodeParallel<std::size_t>(root, [&](const INodePtr& node, std::size_t& count)
+    {
+        if (!isPrimitive(node)) return;
+
+        auto comparable = std::dynamic_pointer_cast<IComparableNode>(node);
+
+        if (comparable)
+        {
+            comparable->getFingerprint(hash);
+            ++count;
+        }
+    },
+    [](std::size_t& target, std::size_t&& source) { target += source; }, MIN_FINGERPRINTS_PER_THREAD);
+}
+
+GraphComparer::FingerprintList GraphComparer::collectChildFingerprints(const INodePtr& parent, FingerprintHash hash)
+{
+    FingerprintList result;
+    std::unordered_set<std::string> seen;
+
+    parent->foreachNode([&](const INodePtr& node)
+    {
+        if (!isPrimitive(node)) return true;
+
+        auto comparable = std::dynamic_pointer_cast<IComparableNode>(node);
+
+        if (comparable)
+        {
+            addUniqueFingerprint(result, seen, comparable->getFingerprint(hash), node, parent);
+        }
+
+        return true;
+    });
+
+    return result;
+}
+
+GraphComparer::FingerprintList GraphComparer::calculateEntityFingerprints(const INodePtr& root, FingerprintHash hash)
+{
+    return foreachNodeParallel<FingerprintList>(root,
+        [&](const INodePtr& node, FingerprintList& fingerprints)
+    {
+        if (node->getNodeType() != INode::Type::Entity) return;
+
+        auto comparable = std::dynamic_pointer_cast<IComparableNode>(node);
+
+        if (comparable)
+        {
+            fingerprints.emplace_back(comparable->getFingerprint(hash), node);
+        }
+    },
+    [](FingerprintList& target, FingerprintList&& source)
+    {
+        target.insert(target.end(), std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+    }, MIN_FINGERPRINTS_PER_THREAD);
+}
+
+GraphComparer::FingerprintList GraphComparer::collectEntityFingerprints(const INodePtr& root, FingerprintHash hash)
+{
+    // Entities are combining the fingerprints of their children, so the primitives are
+    // processed first, they are caching the value for the entities to pick it up.
+    calculatePrimitiveFingerprints(root, hash);
+
+    auto entityFingerprints = calculateEntityFingerprints(root, hash);
+
+    FingerprintList result;
+    std::unordered_set<std::string> seen;
+
+    for (auto& pair : entityFingerprints)
+    {
+        addUniqueFingerprint(result, seen, std::move(pair.first), pair.second, root);
+    }
+
+    return result;
+}
+
+ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base,
+    FingerprintHash hash)
 {
     auto result = std::make_shared<ComparisonResult>(source, base);
 
-    auto sourceEntities = NodeUtils::CollectEntityFingerprints(source);
-    auto baseEntities = NodeUtils::CollectEntityFingerprints(base);
+    auto sourceEntities = collectEntityFingerprints(source, hash);
+    auto baseEntities = collectEntityFingerprints(base, hash);
 
     // Filter out all the matching nodes and store them in the result
     if (sourceEntities.empty())
@@ -32,14 +148,19 @@ ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, cons
         throw cmd::ExecutionNotPossible(_("The source map doesn't contain any entities, cannot merge"));
     }
 
+    std::unordered_map<std::string, INodePtr> baseEntityLookup(baseEntities.begin(), baseEntities.end());
+    std::unordered_set<std::string> sourceFingerprints;
+
     EntityMismatchByName sourceMismatches;
 
     for (const auto& sourceEntity : sourceEntities)
     {
+        sourceFingerprints.insert(sourceEntity.first);
+
         // Check each source node for an equivalent node in the base
-        auto matchingBaseNode = baseEntities.find(sourceEntity.first);
+        auto matchingBaseNode = baseEntityLookup.find(sourceEntity.first);
 
-        if (matchingBaseNode != baseEntities.end())
+        if (matchingBaseNode != baseEntityLookup.end())
         {
             // Found an equivalent node
             result->equivalentEntities.emplace_back(ComparisonResult::Match{ sourceEntity.first, sourceEntity.second, matchingBaseNode->second });
@@ -57,7 +178,7 @@ ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, cons
     {
         // Check each source node for an equivalent node in the base
         // Matching nodes have already been checked in the above loop
-        if (sourceEntities.count(baseEntity.first) == 0)
+        if (sourceFingerprints.count(baseEntity.first) == 0)
         {
             auto entityName = NodeUtils::GetEntityName(baseEntity.second);
             baseMismatches.emplace(entityName, EntityMismatch{ baseEntity.first, baseEntity.second, entityName });
@@ -65,12 +186,13 @@ ComparisonResult::Ptr GraphComparer::Compare(const IMapRootNodePtr& source, cons
     }
 
     // Enter the second stage and try to match entities and detailing diffs
-    processDifferingEntities(*result, sourceMismatches, baseMismatches);
+    processDifferingEntities(*result, sourceMismatches, baseMismatches, hash);
 
     return result;
 }
 
-void GraphComparer::processDifferingEntities(ComparisonResult& result, const EntityMismatchByName& sourceMismatches, const EntityMismatchByName& baseMismatches)
+void GraphComparer::processDifferingEntities(ComparisonResult& result, const EntityMismatchByName& sourceMismatches,
+    const EntityMismatchByName& baseMismatches, FingerprintHash hash)
 {
     // Find all entities that are missing in either source or base (by name)
     std::list<EntityMismatchByName::value_type> missingInSource;
@@ -93,10 +215,13 @@ void GraphComparer::processDifferingEntities(ComparisonResult& result, const Ent
     std::set_difference(baseMismatches.begin(), baseMismatches.end(), sourceMismatches.begin(), sourceMismatches.end(),
         std::back_inserter(missingInSource), compareEntityNames);
 
+    std::vector<ComparisonResult::EntityDifference*> modifiedEntities;
+    modifiedEntities.reserve(matchingByName.size());
+
     for (const auto& match : matchingByName)
     {
-        auto sourceMismatch = sourceMismatches.find(match.second.entityName)->second;
-        auto baseMismatch = baseMismatches.find(match.second.entityName)->second;
+        const auto& sourceMismatch = sourceMismatches.find(match.second.entityName)->second;
+        const auto& baseMismatch = baseMismatches.find(match.second.entityName)->second;
 
         auto& entityDiff = result.differingEntities.emplace_back(ComparisonResult::EntityDifference
         {
@@ -108,13 +233,23 @@ void GraphComparer::processDifferingEntities(ComparisonResult& result, const Ent
             ComparisonResult::EntityDifference::Type::EntityPresentButDifferent
         });
 
-        // Analyse the key values
-        entityDiff.differingKeyValues = compareKeyValues(sourceMismatch.node, baseMismatch.node);
-
-        // Analyse the child nodes
-        entityDiff.differingChildren = compareChildNodes(sourceMismatch.node, baseMismatch.node);
+        modifiedEntities.push_back(&entityDiff);
     }
 
+    // Analyse the key values and the child nodes of the modified entities on several threads.
+    // The primitive fingerprints are cached at this point, the graphs are only read from.
+    parallelForChunks(modifiedEntities.size(), MIN_ENTITY_COMPARISONS_PER_THREAD,
+        [&](std::size_t, std::size_t begin, std::size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            auto& entityDiff = *modifiedEntities[i];
+
+            entityDiff.differingKeyValues = compareKeyValues(entityDiff.sourceNode, entityDiff.baseNode);
+            entityDiff.differingChildren = compareChildNodes(entityDiff.sourceNode, entityDiff.baseNode, hash);
+        }
+    });
+
     for (const auto& mismatch : missingInSource)
     {
         result.differingEntities.emplace_back(ComparisonResult::EntityDifference
@@ -226,28 +361,31 @@ std::list<ComparisonResult::KeyValueDifference> GraphComparer::compareKeyValues(
 }
 
 std::list<ComparisonResult::PrimitiveDifference> GraphComparer::compareChildNodes(
-    const INodePtr& sourceNode, const INodePtr& baseNode)
+    const INodePtr& sourceNode, const INodePtr& baseNode, FingerprintHash hash)
 {
     std::list<ComparisonResult::PrimitiveDifference> result;
 
-    auto sourceChildren = NodeUtils::CollectPrimitiveFingerprints(sourceNode);
-    auto baseChildren = NodeUtils::CollectPrimitiveFingerprints(baseNode);
+    auto sourceChildren = collectChildFingerprints(sourceNode, hash);
+    auto baseChildren = collectChildFingerprints(baseNode, hash);
 
-    std::vector<Fingerprints::value_type> missingInSource;
-    std::vector<Fingerprints::value_type> missingInBase;
+    std::unordered_set<std::string> sourceFingerprints;
+    std::unordered_set<std::string> baseFingerprints;
 
-    auto compareFingerprint = [](const Fingerprints::value_type& left, const Fingerprints::value_type& right)
+    for (const auto& pair : sourceChildren)
     {
-        return left.first < right.first;
-    };
+        sourceFingerprints.insert(pair.first);
+    }
 
-    std::set_difference(sourceChildren.begin(), sourceChildren.end(),
-        baseChildren.begin(), baseChildren.end(), std::back_inserter(missingInBase), compareFingerprint);
-    std::set_difference(baseChildren.begin(), baseChildren.end(),
-        sourceChildren.begin(), sourceChildren.end(), std::back_inserter(missingInSource), compareFingerprint);
+    for (const auto& pair : baseChildren)
+    {
+        baseFingerprints.insert(pair.first);
+    }
 
-    for (const auto& pair : missingInBase)
+    // The differences are reported in the order of the child nodes
+    for (const auto& pair : sourceChildren)
     {
+        if (baseFingerprints.count(pair.first) > 0) continue;
+
         result.emplace_back(ComparisonResult::PrimitiveDifference
         {
             pair.first,
@@ -256,8 +394,10 @@ std::list<ComparisonResult::PrimitiveDifference> GraphComparer::compareChildNode
         });
     }
 
-    for (const auto& pair : missingInSource)
+    for (const auto& pair : baseChildren)
     {
+        if (sourceFingerprints.count(pair.first) > 0) continue;
+
         result.emplace_back(ComparisonResult::PrimitiveDifference
         {
             pair.first,
@@ -4,10 +4,12 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "inode.h"
 #include "imap.h"
 #include "itextstream.h"
+#include "icomparablenode.h"
 
 #include "ComparisonResult.h"
 
@@ -25,7 +27,8 @@ namespace merge
 class GraphComparer
 {
 private:
-    using Fingerprints = std::map<std::string, INodePtr>;
+    // Fingerprints and their nodes in traversal order, without duplicate fingerprints
+    using FingerprintList = std::vector<std::pair<std::string, INodePtr>>;
 
 public:
     struct EntityMismatch
@@ -38,18 +41,39 @@ public:
     using EntityMismatchByName = std::map<std::string, EntityMismatch>;
 
 public:
-    // Compares the two graphs and returns the result
-    static ComparisonResult::Ptr Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base);
+    // Compares the two graphs and returns the result. The fingerprints in the result
+    // are calculated using the given hash type, Fast is sufficient as long as they
+    // are not compared against fingerprints of other sessions.
+    static ComparisonResult::Ptr Compare(const IMapRootNodePtr& source, const IMapRootNodePtr& base,
+        FingerprintHash hash = FingerprintHash::SHA256);
+
+    // Calculates the fingerprints of all primitives and entities in the given graph on
+    // several threads. The nodes are caching them, such that subsequent comparisons
+    // involving this graph are only reading from it.
+    static void CalculateFingerprints(const INodePtr& root, FingerprintHash hash);
 
 private:
+    static void calculatePrimitiveFingerprints(const INodePtr& root, FingerprintHash hash);
+
+    // Calculates the fingerprints of all entities in the given graph in traversal order,
+    // the ones of the primitives need to be calculated first
+    static FingerprintList calculateEntityFingerprints(const INodePtr& root, FingerprintHash hash);
+
+    // Calculates the fingerprints of all primitives and entities in the given graph
+    // on several threads, returns the ones of the entities
+    static FingerprintList collectEntityFingerprints(const INodePtr& root, FingerprintHash hash);
+
+    // Collects the fingerprints of the primitives below the given entity
+    static FingerprintList collectChildFingerprints(const INodePtr& parent, FingerprintHash hash);
+
     static void processDifferingEntities(ComparisonResult& result, const EntityMismatchByName& sourceMismatches, 
-        const EntityMismatchByName& baseMismatches);
+        const EntityMismatchByName& baseMismatches, FingerprintHash hash);
 
     static std::list<ComparisonResult::KeyValueDifference> compareKeyValues(
         const INodePtr& sourceNode, const INodePtr& baseNode);
 
     static std::list<ComparisonResult::PrimitiveDifference> compareChildNodes(
-        const INodePtr& sourceNode, const INodePtr& baseNode);
+        const INodePtr& sourceNode, const INodePtr& baseNode, FingerprintHash hash);
 };
 
 }
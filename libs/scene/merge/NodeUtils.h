@@ -1,6 +1,6 @@
 #pragma once
 
-#include <map>
+#include <unordered_map>
 #include "inode.h"
 #include "icomparablenode.h"
 #include "ientity.h"
@@ -12,7 +12,7 @@ namespace scene
 namespace merge
 {
 
-using Fingerprints = std::map<std::string, INodePtr>;
+using Fingerprints = std::unordered_map<std::string, INodePtr>;
 
 class NodeUtils
 {
@@ -35,25 +35,27 @@ public:
         return GetEntityNameOrFingerprint(member);
     }
 
-    static Fingerprints CollectEntityFingerprints(const INodePtr& root)
+    static Fingerprints CollectEntityFingerprints(const INodePtr& root,
+        FingerprintHash hash = FingerprintHash::SHA256)
     {
         return CollectNodeFingerprints(root, [](const INodePtr& node)
         {
             return node->getNodeType() == INode::Type::Entity;
-        });
+        }, hash);
     }
 
-    static Fingerprints CollectPrimitiveFingerprints(const INodePtr& parent)
+    static Fingerprints CollectPrimitiveFingerprints(const INodePtr& parent,
+        FingerprintHash hash = FingerprintHash::SHA256)
     {
         return CollectNodeFingerprints(parent, [](const INodePtr& node)
         {
             return node->getNodeType() == INode::Type::Brush || node->getNodeType() == INode::Type::Patch;
-        });
+        }, hash);
     }
 
 private:
     static Fingerprints CollectNodeFingerprints(const INodePtr& parent,
-        const std::function<bool(const INodePtr& node)>& nodePredicate)
+        const std::function<bool(const INodePtr& node)>& nodePredicate, FingerprintHash hash)
     {
         Fingerprints result;
 
@@ -67,7 +69,7 @@ private:
             if (!comparable) return true; // skip
 
             // Store the fingerprint and check for collisions
-            auto insertResult = result.try_emplace(comparable->getFingerprint(), node);
+            auto insertResult = result.try_emplace(comparable->getFingerprint(hash), node);
 
             if (!insertResult.second)
             {
@@ -1,5 +1,8 @@
 #include "ThreeWayMergeOperation.h"
 
+#include <future>
+#include <map>
+#include <unordered_map>
 #include "itextstream.h"
 #include "inamespace.h"
 #include "NodeUtils.h"
@@ -16,17 +19,29 @@ namespace merge
 // Contains lookup tables needed during analysis of the two scenes
 struct ThreeWayMergeOperation::ComparisonData
 {
+    // The source differences are processed in the order of the entity names
     std::map<std::string, std::list<ComparisonResult::EntityDifference>::const_iterator> sourceDifferences;
-    std::map<std::string, std::list<ComparisonResult::EntityDifference>::const_iterator> targetDifferences;
-    std::map<std::string, INodePtr> targetEntities;
+    std::unordered_map<std::string, std::list<ComparisonResult::EntityDifference>::const_iterator> targetDifferences;
+    std::unordered_map<std::string, INodePtr> targetEntities;
 
     ComparisonResult::Ptr baseToSource;
     ComparisonResult::Ptr baseToTarget;
 
     ComparisonData(const IMapRootNodePtr& baseRoot, const IMapRootNodePtr& sourceRoot, const IMapRootNodePtr& targetRoot)
     {
-        baseToSource = GraphComparer::Compare(sourceRoot, baseRoot);
-        baseToTarget = GraphComparer::Compare(targetRoot, baseRoot);
+        // All fingerprints are compared within this operation, the fast hash is sufficient.
+        // Both comparisons are reading the base graph, the fingerprints of its primitives
+        // and entities are calculated up front such that the comparisons don't have to
+        // wait for each other on the base nodes.
+        GraphComparer::CalculateFingerprints(baseRoot, FingerprintHash::Fast);
+
+        auto targetComparison = std::async(std::launch::async, [&]()
+        {
+            return GraphComparer::Compare(targetRoot, baseRoot, FingerprintHash::Fast);
+        });
+
+        baseToSource = GraphComparer::Compare(sourceRoot, baseRoot, FingerprintHash::Fast);
+        baseToTarget = targetComparison.get();
 
         // Create source and target entity diff dictionaries (by entity name)
         for (auto it = baseToSource->differingEntities.begin(); it != baseToSource->differingEntities.end(); ++it)
@@ -162,7 +177,7 @@ void ThreeWayMergeOperation::processEntityModification(const ComparisonResult::E
     }
 
     // Both graphs modified this entity, do an in-depth comparison
-    auto targetChildren = NodeUtils::CollectPrimitiveFingerprints(targetDiff.sourceNode);
+    auto targetChildren = NodeUtils::CollectPrimitiveFingerprints(targetDiff.sourceNode, FingerprintHash::Fast);
 
     // Every primitive change that has been done to the target map can be applied
     // to the source map, since we can't detect whether one of them has been moved or retextured
@@ -33,6 +33,11 @@ public:
         return _view;
     }
 
+    SelectionTestPtr clone() const override
+    {
+        return std::make_shared<SelectionVolume>(*this);
+    }
+
     const Vector3& getNear() const override
     {
         return _near;
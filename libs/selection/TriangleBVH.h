@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "iselectiontest.h"
+#include "ivolumetest.h"
+#include "math/AABB.h"
+#include "math/Matrix4.h"
+
+namespace selection
+{
+
+/**
+ * Returns the smallest normalised device depth of the given bounds after
+ * transforming them with the given matrix. Returns -1 (the near plane)
+ * if the bounds are reaching behind the viewer.
+ */
+inline double getNearestDepth(const AABB& bounds, const Matrix4& localToClip)
+{
+    double nearest = 1;
+
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        Vector4 clipped = localToClip.transform(Vector4(
+            bounds.origin.x() + ((corner & 1) ? bounds.extents.x() : -bounds.extents.x()),
+            bounds.origin.y() + ((corner & 2) ? bounds.extents.y() : -bounds.extents.y()),
+            bounds.origin.z() + ((corner & 4) ? bounds.extents.z() : -bounds.extents.z()),
+            1));
+
+        if (clipped.w() <= 0)
+        {
+            return -1;
+        }
+
+        nearest = std::min(nearest, clipped.z() / clipped.w());
+    }
+
+    return nearest;
+}
+
+/**
+ * Returns true if no geometry at the given depth or further away can produce
+ * a better intersection than the given one. This is only the case for
+ * intersections right below the cursor, everything else might be beaten
+ * by a polygon further away, as long as it's closer to the cursor.
+ */
+inline bool isBehindIntersection(const SelectionIntersection& best, double depth)
+{
+    return best.isValid() && best.distance() == 0 && best.depth() < depth;
+}
+
+/**
+ * Bounding volume hierarchy over the triangles of a mesh, limiting point
+ * selection tests to the triangles within the selection volume.
+ *
+ * The triangles are sorted such that the ones of a leaf are stored next to
+ * each other, each leaf is tested in a single TestTriangles() call. The
+ * hierarchy is traversed front to back, subtrees behind an intersection
+ * right below the cursor are skipped. The resulting intersection is the
+ * same as when testing all triangles at once.
+ */
+class TriangleBVH
+{
+public:
+    typedef IndexPointer::index_type Index;
+
+private:
+    static constexpr std::size_t MAX_LEAF_TRIANGLES = 8;
+
+    struct Node
+    {
+        AABB bounds;
+
+        // Leaves: the first triangle and the number of triangles
+        // Inner nodes: the first of the two adjacent children, count is 0
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    struct Triangle
+    {
+        Index indices[3];
+        AABB bounds;
+    };
+
+    std::vector<Node> _nodes;
+
+    // The indices of the triangles, in leaf order
+    std::vector<Index> _indices;
+
+public:
+    bool empty() const
+    {
+        return _nodes.empty();
+    }
+
+    void clear()
+    {
+        _nodes.clear();
+        _indices.clear();
+    }
+
+    // Build the hierarchy for the triangle list defined by the given vertices and indices
+    void build(const VertexPointer& vertices, const IndexPointer& indices)
+    {
+        clear();
+
+        std::vector<Triangle> triangles;
+
+        for (IndexPointer::iterator i = indices.begin(); i != indices.end(); i += 3)
+        {
+            Triangle triangle;
+
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                triangle.indices[corner] = *(i + corner);
+                triangle.bounds.includePoint(vertices[triangle.indices[corner]]);
+            }
+
+            triangles.push_back(triangle);
+        }
+
+        if (triangles.empty()) return;
+
+        _indices.reserve(triangles.size() * 3);
+        _nodes.emplace_back();
+
+        buildNode(0, triangles, 0, triangles.size());
+    }
+
+    /**
+     * Tests the triangles against the given selection test and assigns the best
+     * intersection. The test has to be set up with BeginMesh() already, the
+     * vertices need to be the same as the ones passed to build().
+     */
+    void testSelect(SelectionTest& test, const Matrix4& localToWorld,
+        const VertexPointer& vertices, SelectionIntersection& best) const
+    {
+        if (_nodes.empty()) return;
+
+        const VolumeTest& volume = test.getVolume();
+        Matrix4 localToClip = volume.GetViewProjection().getMultipliedBy(localToWorld);
+
+        // The nodes to visit, along with the nearest depth of their bounds
+        std::vector<std::pair<std::uint32_t, double>> stack;
+        stack.emplace_back(0, -1);
+
+        while (!stack.empty())
+        {
+            auto entry = stack.back();
+            stack.pop_back();
+
+            // The best intersection might have been found after this node has been pushed
+            if (isBehindIntersection(best, entry.second)) continue;
+
+            const Node& node = _nodes[entry.first];
+
+            if (volume.TestAABB(node.bounds, localToWorld) == VOLUME_OUTSIDE) continue;
+
+            if (node.count > 0)
+            {
+                test.TestTriangles(vertices, IndexPointer(&_indices[node.first * 3], node.count * 3), best);
+                continue;
+            }
+
+            double firstDepth = getNearestDepth(_nodes[node.first].bounds, localToClip);
+            double secondDepth = getNearestDepth(_nodes[node.first + 1].bounds, localToClip);
+
+            // Push the nearer child last, it is visited first
+            if (firstDepth < secondDepth)
+            {
+                stack.emplace_back(node.first + 1, secondDepth);
+                stack.emplace_back(node.first, firstDepth);
+            }
+            else
+            {
+                stack.emplace_back(node.first, firstDepth);
+                stack.emplace_back(node.first + 1, secondDepth);
+            }
+        }
+    }
+
+private:
+    void buildNode(std::size_t nodeIndex, std::vector<Triangle>& triangles, std::size_t begin, std::size_t end)
+    {
+        AABB bounds;
+        AABB centers;
+
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            bounds.includeAABB(triangles[i].bounds);
+            centers.includePoint(triangles[i].bounds.origin);
+        }
+
+        _nodes[nodeIndex].bounds = bounds;
+
+        if (end - begin <= MAX_LEAF_TRIANGLES)
+        {
+            _nodes[nodeIndex].first = static_cast<std::uint32_t>(_indices.size() / 3);
+            _nodes[nodeIndex].count = static_cast<std::uint32_t>(end - begin);
+
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                _indices.insert(_indices.end(), triangles[i].indices, triangles[i].indices + 3);
+            }
+
+            return;
+        }
+
+        // Split at the median along the longest axis of the triangle centers
+        std::size_t axis = 0;
+
+        for (std::size_t i = 1; i < 3; ++i)
+        {
+            if (centers.extents[i] > centers.extents[axis])
+            {
+                axis = i;
+            }
+        }
+
+        std::size_t middle = begin + (end - begin) / 2;
+
+        std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+            [&](const Triangle& a, const Triangle& b)
+        {
+            return a.bounds.origin[axis] < b.bounds.origin[axis];
+        });
+
+        // The children are stored next to each other
+        std::size_t firstChild = _nodes.size();
+        _nodes.emplace_back();
+        _nodes.emplace_back();
+
+        _nodes[nodeIndex].first = static_cast<std::uint32_t>(firstChild);
+        _nodes[nodeIndex].count = 0;
+
+        buildNode(firstChild, triangles, begin, middle);
+        buildNode(firstChild + 1, triangles, middle, end);
+    }
+};
+
+}
@@ -66,6 +66,31 @@ struct WorkZone
 	{}
 };
 
+/**
+ * Reports all selection changes happening during the lifetime
+ * of this object to the selection observers in one go.
+ */
+class ScopedBulkSelectionChange
+{
+private:
+	SelectionSystem& _selectionSystem;
+
+public:
+	ScopedBulkSelectionChange(SelectionSystem& selectionSystem = GlobalSelectionSystem()) :
+		_selectionSystem(selectionSystem)
+	{
+		_selectionSystem.beginBulkSelectionChange();
+	}
+
+	ScopedBulkSelectionChange(const ScopedBulkSelectionChange& other) = delete;
+	ScopedBulkSelectionChange& operator=(const ScopedBulkSelectionChange& other) = delete;
+
+	~ScopedBulkSelectionChange()
+	{
+		_selectionSystem.endBulkSelectionChange();
+	}
+};
+
 namespace detail
 {
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+namespace util
+{
+
+/**
+ * Per-thread count of the heap allocations made by the containers designed
+ * to avoid them on hot paths, like SmallVector and the brush winding buffers.
+ * These report each allocation through Increment(), callers take the count
+ * before and after the code in question to get the allocations in between.
+ *
+ * Every binary including this header has its own counter, the allocations
+ * made by code in a module need to be queried through that module.
+ */
+class AllocationCounter
+{
+public:
+    static void Increment()
+    {
+        ++Count();
+    }
+
+    // The number of allocations reported by the calling thread so far
+    static std::size_t Get()
+    {
+        return Count();
+    }
+
+private:
+    static std::size_t& Count()
+    {
+        static thread_local std::size_t count = 0;
+        return count;
+    }
+};
+
+}
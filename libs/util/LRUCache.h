@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace util
+{
+
+/**
+ * Associative container keeping a limited amount of values, dropping the
+ * least recently used ones when the limit is exceeded.
+ *
+ * Each value has a cost (1 by default), the total cost of the stored values
+ * is kept below the maximum passed to the constructor. Values exceeding the
+ * limit on their own are not stored at all. Dropped values can be passed to
+ * an eviction function, e.g. to recycle their memory.
+ *
+ * The cache counts the successful and unsuccessful lookups through find().
+ * It is not synchronised, callers accessing it from several threads need to
+ * hold a lock.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class LRUCache
+{
+public:
+    typedef std::function<std::size_t(const Value&)> CostFunction;
+    typedef std::function<void(Value&&)> EvictionFunction;
+
+private:
+    typedef std::pair<const Key, Value> Entry;
+
+    // Most recently used entries first
+    typedef std::list<Entry> Entries;
+    Entries _entries;
+
+    // The index refers to the keys stored in the list nodes, which don't move
+    struct KeyRefHash
+    {
+        Hash hash;
+
+        std::size_t operator()(const std::reference_wrapper<const Key>& key) const
+        {
+            return hash(key.get());
+        }
+    };
+
+    struct KeyRefEqual
+    {
+        KeyEqual equal;
+
+        bool operator()(const std::reference_wrapper<const Key>& a, const std::reference_wrapper<const Key>& b) const
+        {
+            return equal(a.get(), b.get());
+        }
+    };
+
+    typedef std::unordered_map<std::reference_wrapper<const Key>, typename Entries::iterator,
+        KeyRefHash, KeyRefEqual> Index;
+    Index _index;
+
+    std::size_t _maxCost;
+    std::size_t _totalCost;
+
+    CostFunction _getCost;
+    EvictionFunction _evict;
+
+    std::size_t _hits;
+    std::size_t _misses;
+
+public:
+    LRUCache(std::size_t maxCost, const CostFunction& getCost = CostFunction(),
+             const EvictionFunction& evict = EvictionFunction()) :
+        _maxCost(maxCost),
+        _totalCost(0),
+        _getCost(getCost),
+        _evict(evict),
+        _hits(0),
+        _misses(0)
+    {}
+
+    /**
+     * Returns the value stored for the given key and marks it as the most
+     * recently used one, or NULL if there is no such value. The pointer is
+     * valid until the next non-const call.
+     */
+    Value* find(const Key& key)
+    {
+        auto found = _index.find(std::cref(key));
+
+        if (found == _index.end())
+        {
+            ++_misses;
+            return nullptr;
+        }
+
+        ++_hits;
+
+        // Move the entry to the front, the iterators stay valid
+        _entries.splice(_entries.begin(), _entries, found->second);
+
+        return &_entries.front().second;
+    }
+
+    /**
+     * Stores the value for the given key, unless there is one already.
+     * Returns the stored value, or NULL if the value has been dropped for
+     * exceeding the limit on its own. The pointer is valid until the next
+     * non-const call.
+     */
+    Value* insert(const Key& key, Value&& value)
+    {
+        auto existing = _index.find(std::cref(key));
+
+        if (existing != _index.end())
+        {
+            _entries.splice(_entries.begin(), _entries, existing->second);
+            return &_entries.front().second;
+        }
+
+        auto cost = getCost(value);
+
+        if (cost > _maxCost)
+        {
+            if (_evict) _evict(std::move(value));
+            return nullptr;
+        }
+
+        _entries.emplace_front(key, std::move(value));
+        _index.emplace(std::cref(_entries.front().first), _entries.begin());
+        _totalCost += cost;
+
+        // Drop the least recently used entries
+        while (_totalCost > _maxCost)
+        {
+            auto last = std::prev(_entries.end());
+
+            _totalCost -= getCost(last->second);
+            _index.erase(std::cref(last->first));
+
+            if (_evict) _evict(std::move(last->second));
+
+            _entries.erase(last);
+        }
+
+        return &_entries.front().second;
+    }
+
+    // Drops all values, without passing them to the eviction function
+    void clear()
+    {
+        _index.clear();
+        _entries.clear();
+        _totalCost = 0;
+    }
+
+    std::size_t size() const
+    {
+        return _entries.size();
+    }
+
+    // Total cost of the stored values
+    std::size_t getCost() const
+    {
+        return _totalCost;
+    }
+
+    // Number of find() calls returning a value / returning NULL
+    std::size_t getHitCount() const
+    {
+        return _hits;
+    }
+
+    std::size_t getMissCount() const
+    {
+        return _misses;
+    }
+
+private:
+    std::size_t getCost(const Value& value) const
+    {
+        return _getCost ? _getCost(value) : 1;
+    }
+};
+
+}
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "AllocationCounter.h"
+
+namespace util
+{
+
+/**
+ * Sequence container with the interface of std::vector, storing up to
+ * InlineCapacity elements within the object itself. Only larger sequences
+ * are moved to the heap, after which the container behaves like a regular
+ * vector (the heap storage is kept when shrinking again).
+ *
+ * Iterators are plain pointers. Note that unlike std::vector, moving or
+ * swapping a container with inline storage moves the elements themselves,
+ * so iterators to them are not preserved in this case.
+ */
+template<typename T, std::size_t InlineCapacity>
+class SmallVector
+{
+    static_assert(InlineCapacity > 0, "Inline capacity must not be zero");
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+private:
+    T* _data;
+    size_type _size;
+    size_type _capacity;
+
+    alignas(T) unsigned char _inlineStorage[InlineCapacity * sizeof(T)];
+
+public:
+    SmallVector() :
+        _data(inlineData()),
+        _size(0),
+        _capacity(InlineCapacity)
+    {}
+
+    explicit SmallVector(size_type count) :
+        SmallVector()
+    {
+        resize(count);
+    }
+
+    SmallVector(size_type count, const T& value) :
+        SmallVector()
+    {
+        resize(count, value);
+    }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    SmallVector(InputIt first, InputIt last) :
+        SmallVector()
+    {
+        insert(end(), first, last);
+    }
+
+    SmallVector(std::initializer_list<T> values) :
+        SmallVector(values.begin(), values.end())
+    {}
+
+    SmallVector(const SmallVector& other) :
+        SmallVector()
+    {
+        reserve(other._size);
+        std::uninitialized_copy(other.begin(), other.end(), _data);
+        _size = other._size;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) :
+        SmallVector()
+    {
+        takeElements(other);
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        releaseHeapStorage();
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            assign(other.begin(), other.end());
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        if (this != &other)
+        {
+            clear();
+
+            if (!other.isInline())
+            {
+                releaseHeapStorage();
+            }
+
+            takeElements(other);
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=(std::initializer_list<T> values)
+    {
+        assign(values.begin(), values.end());
+        return *this;
+    }
+
+    void assign(size_type count, const T& value)
+    {
+        clear();
+        resize(count, value);
+    }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        insert(end(), first, last);
+    }
+
+    // Element access
+
+    reference operator[](size_type index) { return _data[index]; }
+    const_reference operator[](size_type index) const { return _data[index]; }
+
+    reference at(size_type index)
+    {
+        if (index >= _size) throw std::out_of_range("SmallVector index out of range");
+        return _data[index];
+    }
+
+    const_reference at(size_type index) const
+    {
+        if (index >= _size) throw std::out_of_range("SmallVector index out of range");
+        return _data[index];
+    }
+
+    reference front() { return _data[0]; }
+    const_reference front() const { return _data[0]; }
+    reference back() { return _data[_size - 1]; }
+    const_reference back() const { return _data[_size - 1]; }
+
+    T* data() { return _data; }
+    const T* data() const { return _data; }
+
+    // Iterators
+
+    iterator begin() { return _data; }
+    const_iterator begin() const { return _data; }
+    const_iterator cbegin() const { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator end() const { return _data + _size; }
+    const_iterator cend() const { return _data + _size; }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // Capacity
+
+    bool empty() const { return _size == 0; }
+    size_type size() const { return _size; }
+    size_type capacity() const { return _capacity; }
+
+    size_type max_size() const
+    {
+        return std::allocator_traits<std::allocator<T>>::max_size(std::allocator<T>());
+    }
+
+    // Returns true if the elements are stored within this object
+    bool isInline() const
+    {
+        return _data == inlineData();
+    }
+
+    void reserve(size_type capacity)
+    {
+        if (capacity <= _capacity) return;
+
+        T* data = std::allocator<T>().allocate(capacity);
+        AllocationCounter::Increment();
+
+        std::uninitialized_move(begin(), end(), data);
+        std::destroy(begin(), end());
+
+        releaseHeapStorage();
+
+        _data = data;
+        _capacity = capacity;
+    }
+
+    void shrink_to_fit()
+    {}
+
+    // Modifiers
+
+    void clear()
+    {
+        std::destroy(begin(), end());
+        _size = 0;
+    }
+
+    void resize(size_type count)
+    {
+        if (count < _size)
+        {
+            std::destroy(begin() + count, end());
+        }
+        else
+        {
+            reserve(count);
+            std::uninitialized_value_construct(end(), _data + count);
+        }
+
+        _size = count;
+    }
+
+    void resize(size_type count, const T& value)
+    {
+        if (count < _size)
+        {
+            std::destroy(begin() + count, end());
+            _size = count;
+        }
+        else
+        {
+            insert(end(), count - _size, value);
+        }
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (_size == _capacity)
+        {
+            // The arguments might refer to an element of this container
+            T element(std::forward<Args>(args)...);
+            grow(_size + 1);
+            ::new (static_cast<void*>(end())) T(std::move(element));
+        }
+        else
+        {
+            ::new (static_cast<void*>(end())) T(std::forward<Args>(args)...);
+        }
+
+        ++_size;
+        return back();
+    }
+
+    void pop_back()
+    {
+        --_size;
+        std::destroy_at(end());
+    }
+
+    iterator insert(const_iterator position, const T& value)
+    {
+        size_type index = position - begin();
+        emplace_back(value);
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator position, T&& value)
+    {
+        size_type index = position - begin();
+        emplace_back(std::move(value));
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator position, size_type count, const T& value)
+    {
+        size_type index = position - begin();
+        size_type oldSize = _size;
+
+        if (_size + count > _capacity)
+        {
+            T element(value);
+            grow(_size + count);
+            std::uninitialized_fill_n(end(), count, element);
+        }
+        else
+        {
+            std::uninitialized_fill_n(end(), count, value);
+        }
+
+        _size += count;
+
+        std::rotate(begin() + index, begin() + oldSize, end());
+        return begin() + index;
+    }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    iterator insert(const_iterator position, InputIt first, InputIt last)
+    {
+        size_type index = position - begin();
+        size_type oldSize = _size;
+
+        for (; first != last; ++first)
+        {
+            emplace_back(*first);
+        }
+
+        std::rotate(begin() + index, begin() + oldSize, end());
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator position, std::initializer_list<T> values)
+    {
+        return insert(position, values.begin(), values.end());
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        iterator target = begin() + (first - begin());
+
+        if (first != last)
+        {
+            iterator newEnd = std::move(target + (last - first), end(), target);
+            std::destroy(newEnd, end());
+            _size = newEnd - begin();
+        }
+
+        return target;
+    }
+
+    void swap(SmallVector& other)
+    {
+        SmallVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    bool operator==(const SmallVector& other) const
+    {
+        return _size == other._size && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const SmallVector& other) const
+    {
+        return !operator==(other);
+    }
+
+private:
+    T* inlineData()
+    {
+        return reinterpret_cast<T*>(_inlineStorage);
+    }
+
+    const T* inlineData() const
+    {
+        return reinterpret_cast<const T*>(_inlineStorage);
+    }
+
+    void grow(size_type minCapacity)
+    {
+        reserve(std::max(minCapacity, _capacity * 2));
+    }
+
+    void releaseHeapStorage()
+    {
+        if (!isInline())
+        {
+            std::allocator<T>().deallocate(_data, _capacity);
+            _data = inlineData();
+            _capacity = InlineCapacity;
+        }
+    }
+
+    // Moves the elements of the other, empty container into this one, leaving the other one empty
+    void takeElements(SmallVector& other)
+    {
+        if (other.isInline())
+        {
+            reserve(other._size);
+            std::uninitialized_move(other.begin(), other.end(), _data);
+            _size = other._size;
+            other.clear();
+        }
+        else
+        {
+            // Steal the heap storage, this container has no heap storage at this point
+            _data = other._data;
+            _size = other._size;
+            _capacity = other._capacity;
+
+            other._data = other.inlineData();
+            other._size = 0;
+            other._capacity = InlineCapacity;
+        }
+    }
+};
+
+}
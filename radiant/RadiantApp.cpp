@@ -167,6 +167,7 @@ void RadiantApp::OnInitCmdLine(wxCmdLineParser& parser)
 
 	parser.AddLongSwitch("disable-sound", _("Disable sound for this session."));
 	parser.AddLongOption("verbose", _("Verbose logging."));
+	parser.AddLongOption("space-partition", _("Space partition used by the scene graph (octree or aabbtree)."));
 
 	parser.AddParam("Map file", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL);
 	parser.AddParam("fs_game=<game>", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL);
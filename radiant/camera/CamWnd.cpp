@@ -779,12 +779,14 @@ void CamWnd::Cam_Draw()
     // Main scene render
     {
         // Front end (renderable collection from scene)
-        render::CamRenderer renderer(_view, _shaders);
-        render::RenderableCollectionWalker::CollectRenderablesInScene(renderer, _view);
+        render::CamRenderer renderer(_view, _shaders, &_rendererData);
+        std::vector<double> frontEndThreadTimes;
+        render::RenderableCollectionWalker::CollectRenderablesInScene(renderer, _view, &frontEndThreadTimes);
 
         // Accumulate render statistics
         _renderStats.setLightCount(renderer.getVisibleLights(),
                                    renderer.getTotalLights());
+        _renderStats.setFrontEndThreadTimes(frontEndThreadTimes);
         _renderStats.frontEndComplete();
 
         // Render any active mousetools
@@ -799,6 +801,9 @@ void CamWnd::Cam_Draw()
         );
         GlobalRenderSystem().render(allowedRenderFlags, _camera->getModelView(),
                                     _camera->getProjection(), _view.getViewer());
+
+        _renderStats.addAllocations(renderer.getAllocationCount() +
+                                    GlobalRenderSystem().getLastFrameAllocationCount());
     }
 
     // greebo: Draw the clipper's points (skipping the depth-test)
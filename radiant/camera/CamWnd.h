@@ -59,6 +59,9 @@ class CamWnd :
 
     render::View _view;
 
+    // Renderer buffers and light lookup, kept across frames
+    render::CamRenderer::PersistentData _rendererData;
+
     // The contained camera
     camera::ICameraView::Ptr _camera;
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <wx/stopwatch.h>
+#include <cmath>
+#include <vector>
 #include "string/string.h"
 
 namespace render
@@ -15,10 +17,16 @@ class RenderStatistics
     // Time for the render front-end only
     long _feTime = 0;
 
+    // Front-end time spent on each thread, if more than one was used
+    std::vector<double> _feThreadTimes;
+
     // Count of lights
     int _visibleLights = 0;
     int _totalLights = 0;
 
+    // Number of buffer (re-)allocations in the render front- and back-end
+    std::size_t _allocations = 0;
+
 public:
 
     /// Return the constructed string for display
@@ -31,9 +39,11 @@ public:
         return "lights: " + std::to_string(_visibleLights)
              + " / " + std::to_string(_totalLights)
              + " | f/e: " + std::to_string(_feTime) + " ms"
+             + getThreadTimeString()
              + " | b/e: " + std::to_string(beTime) + " ms"
              + " | tot: " + std::to_string(totTime) + " ms"
-             + " | fps: " + (totTime > 0 ? std::to_string(1000 / totTime) : "-");
+             + " | fps: " + (totTime > 0 ? std::to_string(1000 / totTime) : "-")
+             + " | allocs: " + std::to_string(_allocations);
     }
 
     /// Mark the front-end render stage as completed, storing the time internally
@@ -42,6 +52,12 @@ public:
         _feTime = _timer.Time();
     }
 
+    /// Set the front-end time spent on each thread in milliseconds, the first being the main thread
+    void setFrontEndThreadTimes(const std::vector<double>& milliseconds)
+    {
+        _feThreadTimes = milliseconds;
+    }
+
     /// Set the light count
     void setLightCount(int visible, int total)
     {
@@ -49,14 +65,38 @@ public:
         _totalLights += total;
     }
 
+    /// Add to the number of buffer allocations performed during this frame
+    void addAllocations(std::size_t count)
+    {
+        _allocations += count;
+    }
+
     /// Reset statistics at the beginning of a frame render
     void resetStats()
     {
         _visibleLights = _totalLights = 0;
+        _allocations = 0;
+        _feThreadTimes.clear();
 
         _feTime = 0;
         _timer.Start();
     }
+
+private:
+    // Returns the per-thread front-end times like " (3 / 2 / 2 ms)"
+    std::string getThreadTimeString() const
+    {
+        if (_feThreadTimes.size() < 2) return std::string();
+
+        std::string result = " (";
+
+        for (std::size_t i = 0; i < _feThreadTimes.size(); ++i)
+        {
+            result += (i > 0 ? " / " : "") + std::to_string(std::lround(_feThreadTimes[i]));
+        }
+
+        return result + " ms)";
+    }
 };
 
 } // namespace render
@@ -292,6 +292,15 @@ void PatchInspector::selectionChanged(const scene::INodePtr& node, bool isCompon
 	}
 }
 
+void PatchInspector::selectionChangedInBulk(const std::vector<scene::INodePtr>& nodes, bool isComponent)
+{
+	// The whole selection is scanned anyway, once is enough
+	if (!isComponent)
+	{
+		rescanSelection();
+	}
+}
+
 void PatchInspector::clearVertexChooser()
 {
 	_updateActive = true;
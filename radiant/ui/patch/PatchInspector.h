@@ -119,6 +119,7 @@ public:
 	 * patch property widgets.
 	 */
 	void selectionChanged(const scene::INodePtr& node, bool isComponent);
+	void selectionChangedInBulk(const std::vector<scene::INodePtr>& nodes, bool isComponent) override;
 
 	// Request a deferred update of the UI elements (is performed when GTK is idle)
 	void queueUpdate();
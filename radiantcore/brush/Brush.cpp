@@ -7,18 +7,15 @@
 
 #include "BrushModule.h"
 #include "BrushNode.h"
+#include "BrushWindings.h"
 #include "Face.h"
 #include "FixedWinding.h"
 #include "math/Ray.h"
 
+#include <atomic>
 #include <functional>
 
 namespace {
-    /// \brief Returns true if edge (\p x, \p y) is smaller than the epsilon used to classify winding points against a plane.
-    inline bool Edge_isDegenerate(const Vector3& x, const Vector3& y) {
-        return (y - x).getLengthSquared() < (ON_EPSILON * ON_EPSILON);
-    }
-
     inline Vector3::ElementType max_extent_2d(const Vector3& extents, int axis)
     {
         switch(axis)
@@ -44,6 +41,7 @@ Brush::Brush(BrushNode& owner) :
     _uniqueEdgePoints(GL_POINTS),
     m_planeChanged(false),
     m_transformChanged(false),
+    _brepRevision(0),
 	_detailFlag(Structural)
 {
     // Make some space for a few faces
@@ -60,6 +58,7 @@ Brush::Brush(BrushNode& owner, const Brush& other) :
     _uniqueEdgePoints(GL_POINTS),
     m_planeChanged(false),
     m_transformChanged(false),
+    _brepRevision(0),
 	_detailFlag(Structural)
 {
     copy(other);
@@ -270,6 +269,12 @@ const AABB& Brush::localAABB() const {
     return m_aabb_local;
 }
 
+std::size_t Brush::getBRepRevision() const
+{
+    evaluateBRep();
+    return _brepRevision;
+}
+
 void Brush::renderComponents(SelectionSystem::EComponentMode mode, RenderableCollector& collector,
 	const VolumeTest& volume, const Matrix4& localToWorld) const
 {
@@ -340,6 +345,8 @@ void Brush::appendFaces(const Faces& other) {
 
 void Brush::undoSave()
 {
+    _owner.invalidateFingerprint();
+
     if (_undoStateSaver != nullptr)
 	{
         _undoStateSaver->save(*this);
@@ -432,6 +439,7 @@ void Brush::reserve(std::size_t count) {
 }
 
 void Brush::push_back(Faces::value_type face) {
+    _owner.invalidateFingerprint();
     m_faces.push_back(face);
 
     if (_undoStateSaver)
@@ -447,6 +455,8 @@ void Brush::push_back(Faces::value_type face) {
 
 void Brush::pop_back()
 {
+    _owner.invalidateFingerprint();
+
     if (_undoStateSaver)
     {
         m_faces.back()->disconnectUndoSystem(*_mapFileChangeTracker);
@@ -461,6 +471,8 @@ void Brush::pop_back()
 
 void Brush::erase(std::size_t index)
 {
+    _owner.invalidateFingerprint();
+
     if (_undoStateSaver)
     {
         m_faces[index]->disconnectUndoSystem(*_mapFileChangeTracker);
@@ -475,6 +487,8 @@ void Brush::erase(std::size_t index)
 
 void Brush::onFacePlaneChanged()
 {
+    _owner.invalidateFingerprint();
+
     m_planeChanged = true;
     aabbChanged();
 }
@@ -483,11 +497,17 @@ void Brush::onFaceShaderChanged()
 {
     // When the face shader changes, no geometry change is happening
     // therefore no call to onFacePlaneChanged() is necessary
+    _owner.invalidateFingerprint();
 
     // Queue an UI update of the texture tools if any of them is listening
 	signal_faceShaderChanged().emit();
 }
 
+void Brush::onFaceTexdefChanged()
+{
+    _owner.invalidateFingerprint();
+}
+
 void Brush::onFaceConnectivityChanged()
 {
     for (auto i : m_observers)
@@ -555,37 +575,18 @@ void Brush::removeEmptyFaces() {
 
 /// \brief Constructs \p winding from the intersection of \p plane with the other planes of the brush.
 void Brush::windingForClipPlane(Winding& winding, const Plane3& plane) const {
-    FixedWinding buffer[2];
-    bool swap = false;
-
-    // get a poly that covers an effectively infinite area
-    buffer[swap].createInfinite(plane, m_maxWorldCoord + 1);
-
-    // chop the poly by all of the other faces
-    {
-        for (std::size_t i = 0;  i < m_faces.size(); ++i) {
-            const Face& clip = *m_faces[i];
-
-            if (clip.plane3() == plane
-                || !clip.plane3().isValid() || !plane_unique(i)
-                || plane == -clip.plane3())
-            {
-                continue;
-            }
-
-            buffer[!swap].clear();
-
-            {
-                // flip the plane, because we want to keep the back side
-                Plane3 clipPlane(-clip.plane3().normal(), -clip.plane3().dist());
-                buffer[swap].clip(plane, clipPlane, i, buffer[!swap]);
-            }
+    brush::windingForClipPlane(winding, plane, m_faces.size(),
+        [this](std::size_t i) -> const Plane3& { return m_faces[i]->plane3(); },
+        [this](std::size_t i) { return m_faces[i]->plane3().isValid() && plane_unique(i); },
+        m_maxWorldCoord + 1);
+}
 
-            swap = !swap;
-        }
-    }
+IWinding Brush::getWindingForPlane(const Plane3& plane) const
+{
+    Winding winding;
+    windingForClipPlane(winding, plane);
 
-    buffer[swap].writeToWinding(winding);
+    return winding;
 }
 
 void Brush::update_wireframe(RenderableWireframe& wire, const bool* faces_visible) const
@@ -983,124 +984,6 @@ bool Brush::plane_unique(std::size_t index) const {
     return true;
 }
 
-/// \brief Removes edges that are smaller than the tolerance used when generating brush windings.
-void Brush::removeDegenerateEdges() {
-    for (std::size_t i = 0;  i < m_faces.size(); ++i) {
-        Winding& winding = m_faces[i]->getWinding();
-
-        for (std::size_t index = 0; index < winding.size();) {
-            //std::size_t index = std::distance(winding.begin(), j);
-            std::size_t next = winding.next(index);
-
-            if (Edge_isDegenerate(winding[index].vertex, winding[next].vertex)) {
-                Winding& other = m_faces[winding[index].adjacent]->getWinding();
-                std::size_t adjacent = other.findAdjacent(i);
-                if (adjacent != brush::c_brush_maxFaces) {
-                    other.erase(other.begin() + adjacent);
-                }
-
-                // Delete and leave index where it is
-                winding.erase(winding.begin() + index);
-            }
-            else {
-                ++index;
-            }
-        }
-    }
-}
-
-/// \brief Invalidates faces that have only two vertices in their winding, while preserving edge-connectivity information.
-void Brush::removeDegenerateFaces() {
-    // save adjacency info for degenerate faces
-    for (std::size_t i = 0;  i < m_faces.size(); ++i) {
-        Winding& degen = m_faces[i]->getWinding();
-
-        if (degen.size() == 2) {
-            /*rConsole() << "Removed degenerate face: " << Vector3(m_faces[i]->getPlane().plane3().normal())
-                                << " - " << float(m_faces[i]->getPlane().plane3().dist()) << std::endl;*/
-
-            // this is an "edge" face, where the plane touches the edge of the brush
-            {
-                Winding& winding = m_faces[degen[0].adjacent]->getWinding();
-                std::size_t index = winding.findAdjacent(i);
-                if (index != brush::c_brush_maxFaces) {
-                    winding[index].adjacent = degen[1].adjacent;
-                }
-            }
-
-            {
-                Winding& winding = m_faces[degen[1].adjacent]->getWinding();
-                std::size_t index = winding.findAdjacent(i);
-
-                if (index != brush::c_brush_maxFaces) {
-                    winding[index].adjacent = degen[0].adjacent;
-                }
-            }
-
-            degen.resize(0);
-        }
-    }
-}
-
-/// \brief Removes edges that have the same adjacent-face as their immediate neighbour.
-void Brush::removeDuplicateEdges() {
-    // verify face connectivity graph
-    for(std::size_t i = 0; i < m_faces.size(); ++i) {
-        //if(m_faces[i]->contributes())
-            {
-                Winding& winding = m_faces[i]->getWinding();
-                for (std::size_t j = 0; j != winding.size();) {
-                    std::size_t next = winding.next(j);
-                    if (winding[j].adjacent == winding[next].adjacent) {
-                        winding.erase(winding.begin() + next);
-                    }
-                    else {
-                        ++j;
-                    }
-                }
-            }
-        }
-    }
-
-/// \brief Removes edges that do not have a matching pair in their adjacent-face.
-void Brush::verifyConnectivityGraph() {
-    // verify face connectivity graph
-    for (std::size_t i = 0; i < m_faces.size(); ++i) {
-        //if(m_faces[i]->contributes())
-        {
-            Winding& winding = m_faces[i]->getWinding();
-
-            for (std::size_t j = 0; j < winding.size();) {
-                WindingVertex& vertex = winding[j];
-
-                // remove unidirectional graph edges
-                if (vertex.adjacent == brush::c_brush_maxFaces
-                    || m_faces[vertex.adjacent]->getWinding().findAdjacent(i) == brush::c_brush_maxFaces)
-                {
-                    // Delete the offending vertex and leave the index j where it is
-                    winding.erase(winding.begin() + j);
-                }
-                else {
-                    ++j;
-                }
-            }
-
-            /*for (Winding::iterator j = winding.begin(); j != winding.end();) {
-                // remove unidirectional graph edges
-                if (j->adjacent == c_brush_maxFaces
-                    || m_faces[j->adjacent]->getWinding().findAdjacent(i) == c_brush_maxFaces)
-                {
-                    // Delete and return the new iterator
-                    j = winding.erase(j);
-                }
-                else {
-                    ++j;
-                }
-            }*/
-        }
-    }
-}
-
 /// \brief Returns true if the brush is a finite volume. A brush without a finite volume extends past the maximum world bounds and is not valid.
 bool Brush::isBounded() {
     for (const_iterator i = begin(); i != end(); ++i) {
@@ -1146,11 +1029,7 @@ bool Brush::buildWindings() {
 
     if (!degenerate) {
         // clean up connectivity information.
-        // these cleanups must be applied in a specific order.
-        removeDegenerateEdges();
-        removeDegenerateFaces();
-        removeDuplicateEdges();
-        verifyConnectivityGraph();
+        brush::cleanUpWindings(m_faces.size(), [this](std::size_t i) -> Winding& { return m_faces[i]->getWinding(); });
     }
 
     return degenerate;
@@ -1201,6 +1080,10 @@ std::size_t ProximalVertexArray_index(const ProximalVertexArray& array, const Pr
 
 /// \brief Constructs the face windings and updates anything that depends on them.
 void Brush::buildBRep() {
+  // Brushes might be evaluated on several threads at once
+  static std::atomic<std::size_t> lastRevision(0);
+  _brepRevision = ++lastRevision;
+
   bool degenerate = buildWindings();
 
   static const Vector3& colourVertexVec = GlobalBrush().getSettings().getVertexColour();
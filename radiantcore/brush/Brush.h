@@ -122,6 +122,9 @@ private:
 
 	mutable bool m_planeChanged; // b-rep evaluation required
 	mutable bool m_transformChanged; // transform evaluation required
+
+	// Unique number identifying the current b-rep, changing on each rebuild
+	std::size_t _brepRevision;
 	// ----
 
 	DetailFlag _detailFlag;
@@ -183,6 +186,7 @@ public:
 	// Face observer callbacks
 	void onFacePlaneChanged();
 	void onFaceShaderChanged();
+    void onFaceTexdefChanged();
     void onFaceConnectivityChanged();
     void onFaceEvaluateTransform();
 
@@ -203,6 +207,8 @@ public:
 
 	BrushSplitType classifyPlane(const Plane3& plane) const override;
 
+	IWinding getWindingForPlane(const Plane3& plane) const override;
+
 	void evaluateBRep() const override;
 
     void transformChanged();
@@ -212,6 +218,10 @@ public:
 
 	const AABB& localAABB() const;
 
+	// Returns a number identifying the current geometry of this brush,
+	// it's different after each change and unique among all brushes.
+	std::size_t getBRepRevision() const;
+
 	void renderComponents(SelectionSystem::EComponentMode mode, RenderableCollector& collector, const VolumeTest& volume, const Matrix4& localToWorld) const;
 
 	void transform(const Matrix4& matrix);
@@ -310,18 +320,6 @@ private:
 	/// \brief Returns true if the face identified by \p index is preceded by another plane that takes priority over it.
 	bool plane_unique(std::size_t index) const;
 
-	/// \brief Removes edges that are smaller than the tolerance used when generating brush windings.
-	void removeDegenerateEdges();
-
-	/// \brief Invalidates faces that have only two vertices in their winding, while preserving edge-connectivity information.
-	void removeDegenerateFaces();
-
-	/// \brief Removes edges that have the same adjacent-face as their immediate neighbour.
-	void removeDuplicateEdges();
-
-	/// \brief Removes edges that do not have a matching pair in their adjacent-face.
-	void verifyConnectivityGraph();
-
 	/// \brief Returns true if the brush is a finite volume. A brush without a finite volume extends past the maximum world bounds and is not valid.
 	bool isBounded();
 
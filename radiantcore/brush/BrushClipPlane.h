@@ -1,26 +1,65 @@
 #pragma once
 
+#include <limits>
 #include "math/Plane3.h"
 #include "irender.h"
 #include "irenderable.h"
 #include "Winding.h"
 
+/**
+ * The intersection of the clipper plane with a brush. The winding is only
+ * recalculated if the plane or the brush changed. The extents of the brush
+ * along the plane normal are kept as well, such that moving the plane along
+ * its normal doesn't need to clip the brushes it's not passing through.
+ *
+ * setPlane() only reads the brush, different instances can be updated on
+ * several threads, provided the brushes have been evaluated before.
+ */
 class BrushClipPlane : 
 	public OpenGLRenderable
 {
 private:
+	// Planes further away than this from all brush vertices don't produce a winding
+	static constexpr double CULL_EPSILON = 1.0;
+
 	Plane3 _plane;
 	Winding _winding;
 	ShaderPtr _shader;
 
+	// The brush revision the winding has been calculated for
+	std::size_t _windingRevision;
+
+	// The range of the brush vertices along _extentsNormal
+	Vector3 _extentsNormal;
+	double _minDist;
+	double _maxDist;
+	std::size_t _extentsRevision;
+
 public:
+	BrushClipPlane() :
+		_windingRevision(0),
+		_minDist(0),
+		_maxDist(0),
+		_extentsRevision(0)
+	{}
+
     virtual ~BrushClipPlane() {}
 
 	void setPlane(const Brush& brush, const Plane3& plane)
 	{
+		std::size_t revision = brush.getBRepRevision();
+
+		// Keep the winding if neither the brush nor the plane changed
+		if (revision == _windingRevision && 
+			plane.normal() == _plane.normal() && plane.dist() == _plane.dist())
+		{
+			return;
+		}
+
 		_plane = plane;
+		_windingRevision = revision;
 
-		if (_plane.isValid())
+		if (_plane.isValid() && mightIntersect(brush, revision))
 		{
 			brush.windingForClipPlane(_winding, _plane);
 		}
@@ -32,6 +71,16 @@ public:
 		_winding.updateNormals(_plane.normal());
 	}
 
+	const Plane3& getPlane() const
+	{
+		return _plane;
+	}
+
+	const Winding& getWinding() const
+	{
+		return _winding;
+	}
+
 	void render(const RenderInfo& info) const override
 	{
 		if (info.checkFlag(RENDER_FILL))
@@ -60,4 +109,33 @@ public:
 	{
 		collector.addRenderable(*_shader, *this, localToWorld);
 	}
+
+private:
+	// Returns false if the current plane is definitely not intersecting the brush
+	bool mightIntersect(const Brush& brush, std::size_t revision)
+	{
+		if (revision != _extentsRevision || _plane.normal() != _extentsNormal)
+		{
+			_extentsNormal = _plane.normal();
+			_extentsRevision = revision;
+			_minDist = std::numeric_limits<double>::max();
+			_maxDist = std::numeric_limits<double>::lowest();
+
+			for (const auto& face : brush)
+			{
+				for (const WindingVertex& vertex : face->getWinding())
+				{
+					double dist = _extentsNormal.dot(vertex.vertex);
+
+					_minDist = std::min(_minDist, dist);
+					_maxDist = std::max(_maxDist, dist);
+				}
+			}
+		}
+
+		// Brushes without any vertices are clipped the regular way
+		if (_minDist > _maxDist) return true;
+
+		return _plane.dist() >= _minDist - CULL_EPSILON && _plane.dist() <= _maxDist + CULL_EPSILON;
+	}
 };
@@ -18,6 +18,7 @@
 #include "messages/TextureChanged.h"
 
 #include "selection/algorithm/Primitives.h"
+#include "util/AllocationCounter.h"
 
 // ---------------------------------------------------------------------------------------
 
@@ -87,6 +88,11 @@ IBrushSettings& BrushModuleImpl::getSettings()
 	return *_settings;
 }
 
+std::size_t BrushModuleImpl::getWindingStorageAllocationCount()
+{
+	return util::AllocationCounter::Get();
+}
+
 // RegisterableModule implementation
 const std::string& BrushModuleImpl::getName() const {
 	static std::string _name(MODULE_BRUSHCREATOR);
@@ -48,6 +48,8 @@ public:
 
 	IBrushSettings& getSettings() override;
 
+	std::size_t getWindingStorageAllocationCount() override;
+
 	// ----------------------------------------------------------------------------------
 
 	// returns true if the texture lock is enabled
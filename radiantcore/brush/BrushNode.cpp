@@ -64,7 +64,22 @@ const AABB& BrushNode::localAABB() const {
 	return m_brush.localAABB();
 }
 
-std::string BrushNode::getFingerprint()
+std::string BrushNode::getFingerprint(scene::FingerprintHash hash)
+{
+    return _fingerprints.get(hash, [&]()
+    {
+        return hash == scene::FingerprintHash::Fast ?
+            calculateFingerprint<math::FastHash>() : calculateFingerprint<math::Hash>();
+    });
+}
+
+void BrushNode::invalidateFingerprint()
+{
+    scene::invalidateFingerprint(_fingerprints, *this);
+}
+
+template<typename HashType>
+std::string BrushNode::calculateFingerprint() const
 {
     constexpr std::size_t SignificantDigits = scene::SignificantFingerprintDoubleDigits;
 
@@ -73,7 +88,7 @@ std::string BrushNode::getFingerprint()
         return std::string(); // empty brushes produce an empty fingerprint
     }
 
-    math::Hash hash;
+    HashType hash;
     
     hash.addSizet(static_cast<std::size_t>(m_brush.getDetailFlag() + 1));
 
@@ -175,6 +190,12 @@ void BrushNode::invertSelectedComponents(SelectionSystem::EComponentMode mode)
 	} // switch
 }
 
+bool BrushNode::supportsConcurrentSelectionTest() const
+{
+	// Testing the face windings doesn't change anything
+	return true;
+}
+
 void BrushNode::testSelectComponents(Selector& selector, SelectionTest& test, SelectionSystem::EComponentMode mode) {
 	test.BeginMesh(localToWorld());
 
@@ -340,8 +361,8 @@ void BrushNode::DEBUG_verify() {
 	ASSERT_MESSAGE(m_faceInstances.size() == m_brush.DEBUG_size(), "FATAL: mismatch");
 }
 
-bool BrushNode::intersectsLight(const RendererLight& light) const {
-	return light.lightAABB().intersects(worldAABB());
+const AABB& BrushNode::getLitObjectBounds() const {
+	return worldAABB();
 }
 
 void BrushNode::renderComponents(RenderableCollector& collector, const VolumeTest& volume) const
@@ -406,6 +427,16 @@ void BrushNode::renderClipPlane(RenderableCollector& collector, const VolumeTest
 
 void BrushNode::viewChanged() const {
 	m_viewChanged = true;
+
+	// Bring the windings and the selected points up to date,
+	// such that renderSolid() doesn't need to modify anything
+	m_brush.evaluateBRep();
+	update_selected();
+}
+
+bool BrushNode::supportsConcurrentSubmission() const
+{
+	return true;
 }
 
 std::size_t BrushNode::getHighlightFlags()
@@ -587,6 +618,16 @@ void BrushNode::transformComponents(const Matrix4& matrix) {
 	}
 }
 
+const Plane3& BrushNode::getClipPlane() const
+{
+	return m_clipPlane.getPlane();
+}
+
+const IWinding& BrushNode::getClipPlaneWinding() const
+{
+	return m_clipPlane.getWinding();
+}
+
 void BrushNode::setClipPlane(const Plane3& plane) {
 	m_clipPlane.setPlane(m_brush, plane);
 }
@@ -14,6 +14,7 @@
 #include "BrushClipPlane.h"
 #include "transformlib.h"
 #include "scene/Node.h"
+#include "scene/FingerprintCache.h"
 
 class BrushNode :
 	public scene::SelectableNode,
@@ -33,6 +34,9 @@ class BrushNode :
 	public ITraceable,
     public scene::IComparableNode
 {
+	// Declared before the brush, its faces are invalidating it during construction
+	scene::FingerprintCache _fingerprints;
+
 	// The actual contained brush (NO reference)
 	Brush m_brush;
 
@@ -76,6 +80,8 @@ public:
 	// IBrushNode implementation
 	virtual Brush& getBrush() override;
 	virtual IBrush& getIBrush() override;
+	const Plane3& getClipPlane() const override;
+	const IWinding& getClipPlaneWinding() const override;
 
 	std::string name() const  override
     {
@@ -85,13 +91,18 @@ public:
 	Type getNodeType() const override;
 
     // IComparable implementation
-    std::string getFingerprint() override;
+    using scene::IComparableNode::getFingerprint;
+    std::string getFingerprint(scene::FingerprintHash hash) override;
+
+    // Drops the cached fingerprints, called by the Brush before any change
+    void invalidateFingerprint();
 
 	// Bounded implementation
 	virtual const AABB& localAABB() const override;
 
 	// SelectionTestable implementation
 	virtual void testSelect(Selector& selector, SelectionTest& test) override;
+	bool supportsConcurrentSelectionTest() const override;
 
 	// ComponentSelectionTestable
 	bool isSelectedComponents() const override;
@@ -138,7 +149,7 @@ public:
 	void DEBUG_verify() override;
 
 	// LitObject implementation
-	bool intersectsLight(const RendererLight& light) const override;
+	const AABB& getLitObjectBounds() const override;
 
 	// Renderable implementation
 	void renderComponents(RenderableCollector& collector, const VolumeTest& volume) const override;
@@ -147,6 +158,7 @@ public:
 	void setRenderSystem(const RenderSystemPtr& renderSystem) override;
 
 	void viewChanged() const override;
+	bool supportsConcurrentSubmission() const override;
 	std::size_t getHighlightFlags() override;
 
 	void evaluateTransform();
@@ -179,6 +191,9 @@ protected:
     void _applyTransformation() override;
 
 private:
+	template<typename HashType>
+	std::string calculateFingerprint() const;
+
 	void transformComponents(const Matrix4& matrix);
 
 	void renderSolid(RenderableCollector& collector, const VolumeTest& volume, const Matrix4& localToWorld) const;
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "ibrush.h"
+#include "math/Plane3.h"
+#include "FixedWinding.h"
+#include "Winding.h"
+
+/**
+ * The steps of the brush winding construction, usable without a Brush instance.
+ *
+ * The planes and windings are passed as functions returning the one with the
+ * given face index, such that Brush can use its faces directly and algorithms
+ * working on plain planes (like CSG) build exactly the same windings.
+ */
+namespace brush
+{
+
+/// \brief Returns true if edge (\p x, \p y) is smaller than the epsilon used to classify winding points against a plane.
+inline bool Edge_isDegenerate(const Vector3& x, const Vector3& y)
+{
+    return (y - x).getLengthSquared() < (ON_EPSILON * ON_EPSILON);
+}
+
+/// \brief Constructs \p winding from the intersection of \p plane with the usable ones of the given planes.
+/// \p infinity is the size of the initial winding, which is chopped by the planes.
+template<typename GetPlane, typename IsPlaneUsable>
+void windingForClipPlane(Winding& winding, const Plane3& plane, std::size_t numPlanes,
+    const GetPlane& getPlane, const IsPlaneUsable& isPlaneUsable, double infinity)
+{
+    FixedWinding buffer[2];
+    bool swap = false;
+
+    // get a poly that covers an effectively infinite area
+    buffer[swap].createInfinite(plane, infinity);
+
+    // chop the poly by all of the other faces
+    for (std::size_t i = 0; i < numPlanes; ++i)
+    {
+        const Plane3& clip = getPlane(i);
+
+        if (clip == plane || !isPlaneUsable(i) || plane == -clip)
+        {
+            continue;
+        }
+
+        buffer[!swap].clear();
+
+        // flip the plane, because we want to keep the back side
+        Plane3 clipPlane(-clip.normal(), -clip.dist());
+        buffer[swap].clip(plane, clipPlane, i, buffer[!swap]);
+
+        swap = !swap;
+    }
+
+    buffer[swap].writeToWinding(winding);
+}
+
+/// \brief Returns true if none of the windings has an edge extending past the maximum world bounds.
+template<typename GetWinding>
+bool windingsAreBounded(std::size_t numFaces, const GetWinding& getWinding)
+{
+    for (std::size_t i = 0; i < numFaces; ++i)
+    {
+        for (const auto& vertex : getWinding(i))
+        {
+            if (vertex.adjacent == brush::c_brush_maxFaces)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/// \brief Removes edges that are smaller than the tolerance used when generating brush windings.
+template<typename GetWinding>
+void removeDegenerateEdges(std::size_t numFaces, const GetWinding& getWinding)
+{
+    for (std::size_t i = 0; i < numFaces; ++i)
+    {
+        Winding& winding = getWinding(i);
+
+        for (std::size_t index = 0; index < winding.size();)
+        {
+            std::size_t next = winding.next(index);
+
+            if (Edge_isDegenerate(winding[index].vertex, winding[next].vertex))
+            {
+                Winding& other = getWinding(winding[index].adjacent);
+                std::size_t adjacent = other.findAdjacent(i);
+
+                if (adjacent != brush::c_brush_maxFaces)
+                {
+                    other.erase(other.begin() + adjacent);
+                }
+
+                // Delete and leave index where it is
+                winding.erase(winding.begin() + index);
+            }
+            else
+            {
+                ++index;
+            }
+        }
+    }
+}
+
+/// \brief Invalidates faces that have only two vertices in their winding, while preserving edge-connectivity information.
+template<typename GetWinding>
+void removeDegenerateFaces(std::size_t numFaces, const GetWinding& getWinding)
+{
+    // save adjacency info for degenerate faces
+    for (std::size_t i = 0; i < numFaces; ++i)
+    {
+        Winding& degen = getWinding(i);
+
+        if (degen.size() == 2)
+        {
+            // this is an "edge" face, where the plane touches the edge of the brush
+            {
+                Winding& winding = getWinding(degen[0].adjacent);
+                std::size_t index = winding.findAdjacent(i);
+
+                if (index != brush::c_brush_maxFaces)
+                {
+                    winding[index].adjacent = degen[1].adjacent;
+                }
+            }
+
+            {
+                Winding& winding = getWinding(degen[1].adjacent);
+                std::size_t index = winding.findAdjacent(i);
+
+                if (index != brush::c_brush_maxFaces)
+                {
+                    winding[index].adjacent = degen[0].adjacent;
+                }
+            }
+
+            degen.resize(0);
+        }
+    }
+}
+
+/// \brief Removes edges that have the same adjacent-face as their immediate neighbour.
+template<typename GetWinding>
+void removeDuplicateEdges(std::size_t numFaces, const GetWinding& getWinding)
+{
+    for (std::size_t i = 0; i < numFaces; ++i)
+    {
+        Winding& winding = getWinding(i);
+
+        for (std::size_t j = 0; j != winding.size();)
+        {
+            std::size_t next = winding.next(j);
+
+            if (winding[j].adjacent == winding[next].adjacent)
+            {
+                winding.erase(winding.begin() + next);
+            }
+            else
+            {
+                ++j;
+            }
+        }
+    }
+}
+
+/// \brief Removes edges that do not have a matching pair in their adjacent-face.
+template<typename GetWinding>
+void verifyConnectivityGraph(std::size_t numFaces, const GetWinding& getWinding)
+{
+    for (std::size_t i = 0; i < numFaces; ++i)
+    {
+        Winding& winding = getWinding(i);
+
+        for (std::size_t j = 0; j < winding.size();)
+        {
+            WindingVertex& vertex = winding[j];
+
+            // remove unidirectional graph edges
+            if (vertex.adjacent == brush::c_brush_maxFaces
+                || getWinding(vertex.adjacent).findAdjacent(i) == brush::c_brush_maxFaces)
+            {
+                // Delete the offending vertex and leave the index j where it is
+                winding.erase(winding.begin() + j);
+            }
+            else
+            {
+                ++j;
+            }
+        }
+    }
+}
+
+/// \brief Cleans up the connectivity information of the windings of a bounded brush.
+template<typename GetWinding>
+void cleanUpWindings(std::size_t numFaces, const GetWinding& getWinding)
+{
+    // these cleanups must be applied in a specific order.
+    removeDegenerateEdges(numFaces, getWinding);
+    removeDegenerateFaces(numFaces, getWinding);
+    removeDuplicateEdges(numFaces, getWinding);
+    verifyConnectivityGraph(numFaces, getWinding);
+}
+
+}
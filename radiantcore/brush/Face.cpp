@@ -147,6 +147,9 @@ void Face::planeChanged()
 
 void Face::realiseShader()
 {
+    // The faces using the same material are drawn from a shared buffer
+    m_winding.setVertexBuffer(brush::WindingVertexBuffer::ForMaterial(_shader.getMaterialName()));
+
     _owner.onFaceShaderChanged();
 }
 
@@ -386,6 +389,8 @@ void Face::texdefChanged()
     revertTexdef();
     EmitTextureCoordinates();
 
+    _owner.onFaceTexdefChanged();
+
     // Fire the signal to update the Texture Tools
     signal_texdefChanged().emit();
 }
@@ -640,6 +645,7 @@ void Face::alignTexture(AlignEdge align)
 
 void Face::EmitTextureCoordinates() {
     m_texdefTransformed.emitTextureCoordinates(m_winding, plane3().normal(), Matrix4::getIdentity());
+    m_winding.invalidateVertexBuffer();
 }
 
 void Face::applyDefaultTextureScale()
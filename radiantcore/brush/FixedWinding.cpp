@@ -3,6 +3,7 @@
 #include "Brush.h"
 #include "Winding.h"
 #include "itextstream.h"
+#include "util/AllocationCounter.h"
 
 namespace {
 	inline bool float_is_largest_absolute(double axis, double other) {
@@ -49,6 +50,45 @@ namespace {
 	}
 }
 
+namespace
+{
+	// The buffers of destroyed windings, reused by the next ones constructed on the same
+	// thread. Windings are used in pairs, a few more are needed by the CSG routines.
+	constexpr std::size_t MAX_SCRATCH_BUFFERS = 8;
+
+	thread_local std::vector<std::vector<FixedWindingVertex>> scratchBuffers;
+}
+
+FixedWinding::FixedWinding()
+{
+	if (!scratchBuffers.empty())
+	{
+		swap(scratchBuffers.back());
+		scratchBuffers.pop_back();
+	}
+	else
+	{
+		reserve(MAX_POINTS_ON_WINDING);
+		util::AllocationCounter::Increment();
+	}
+}
+
+FixedWinding::~FixedWinding()
+{
+	if (capacity() >= MAX_POINTS_ON_WINDING && scratchBuffers.size() < MAX_SCRATCH_BUFFERS)
+	{
+		if (scratchBuffers.capacity() < MAX_SCRATCH_BUFFERS)
+		{
+			scratchBuffers.reserve(MAX_SCRATCH_BUFFERS);
+			util::AllocationCounter::Increment();
+		}
+
+		clear();
+		scratchBuffers.emplace_back();
+		scratchBuffers.back().swap(*this);
+	}
+}
+
 void FixedWinding::writeToWinding(Winding& winding)
 {
 	// First, set the target winding to the same size as <self>
@@ -32,23 +32,24 @@ public:
 		edge(edge_),
 		adjacent(adjacent_)
 	{}
-
-	virtual ~FixedWindingVertex() {}
 };
 
 /**
  * greebo: A FixedWinding is a vector of FixedWindingVertices
  *         with a pre-allocated size of MAX_POINTS_ON_WINDING.
+ *
+ * The storage is taken from a scratch pool of the current thread and returned
+ * to it on destruction, such that building brush windings doesn't need to
+ * allocate memory once the pool is filled.
  */
 class FixedWinding :
 	public std::vector<FixedWindingVertex>
 {
 public:
-	FixedWinding() {
-		reserve(MAX_POINTS_ON_WINDING);
-	}
+	FixedWinding();
+	FixedWinding(const FixedWinding& other) = default;
 
-	virtual ~FixedWinding() {}
+	~FixedWinding();
 
 	// Writes the FixedWinding data into the given Winding
 	void writeToWinding(Winding& winding);
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "igl.h"
 #include "itextstream.h"
 #include <algorithm>
+#include <cstddef>
 #include "FixedWinding.h"
 #include "math/Ray.h"
 #include "math/Plane3.h"
@@ -54,23 +55,95 @@ namespace {
 	}
 }
 
-void Winding::drawWireframe() const
+namespace
 {
-	if (!empty())
+	inline const GLvoid* attributeOffset(std::size_t offset)
 	{
-		glVertexPointer(3, GL_DOUBLE, sizeof(WindingVertex), &front().vertex);
-		glDrawArrays(GL_LINE_LOOP, 0, GLsizei(size()));
+		return reinterpret_cast<const GLvoid*>(offset);
 	}
 }
 
-void Winding::render(const RenderInfo& info) const
+using brush::WindingRenderVertex;
+
+Winding::Winding() :
+	_vertexBufferSlot(brush::WindingVertexBuffer::NO_SLOT),
+	_vertexBufferNeedsUpdate(true)
+{}
+
+Winding::Winding(const Winding& other) :
+	IWinding(other),
+	_vertexBufferSlot(brush::WindingVertexBuffer::NO_SLOT),
+	_vertexBufferNeedsUpdate(true)
+{}
+
+Winding& Winding::operator=(const Winding& other)
 {
-    // Do not render if there are no points
-	if (empty())
-    {
-		return;
+	IWinding::operator=(other);
+
+	// Keep our own slot, it will be refilled on the next render call
+	_vertexBufferNeedsUpdate = true;
+
+	return *this;
+}
+
+Winding::~Winding()
+{
+	setVertexBuffer(brush::WindingVertexBuffer::Ptr());
+}
+
+void Winding::setVertexBuffer(const brush::WindingVertexBuffer::Ptr& buffer)
+{
+	if (_vertexBuffer == buffer) return;
+
+	if (_vertexBufferSlot != brush::WindingVertexBuffer::NO_SLOT)
+	{
+		_vertexBuffer->release(_vertexBufferSlot);
+		_vertexBufferSlot = brush::WindingVertexBuffer::NO_SLOT;
+	}
+
+	_vertexBuffer = buffer;
+	_vertexBufferNeedsUpdate = true;
+}
+
+void Winding::updateVertexBuffer() const
+{
+	if (!_vertexBuffer)
+	{
+		// Not part of a face, use a buffer of our own
+		_vertexBuffer = std::make_shared<brush::WindingVertexBuffer>();
+	}
+
+	if (_vertexBufferNeedsUpdate || _vertexBufferSlot == brush::WindingVertexBuffer::NO_SLOT)
+	{
+		_vertexBufferSlot = _vertexBuffer->update(_vertexBufferSlot, *this);
+		_vertexBufferNeedsUpdate = false;
+	}
+}
+
+void Winding::bindVertexBuffer() const
+{
+	updateVertexBuffer();
+	_vertexBuffer->bind();
+
+	// All pointers are offsets into the buffer, the slot is selected by the first vertex
+	glVertexPointer(3, GL_FLOAT, sizeof(WindingRenderVertex),
+		attributeOffset(offsetof(WindingRenderVertex, vertex)));
+}
+
+void Winding::drawWireframe() const
+{
+	if (!empty())
+	{
+		bindVertexBuffer();
+
+		glDrawArrays(GL_LINE_LOOP, _vertexBuffer->getFirstVertex(_vertexBufferSlot), GLsizei(size()));
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
+}
 
+void Winding::setAttributePointers(const RenderInfo& info) const
+{
     // Our vertex colours are always white, if requested
     glDisableClientState(GL_COLOR_ARRAY);
     if (info.checkFlag(RENDER_VERTEX_COLOUR))
@@ -78,12 +151,7 @@ void Winding::render(const RenderInfo& info) const
         glColor3f(1, 1, 1);
     }
 
-	// A shortcut pointer to the first array element to avoid
-	// massive calls to std::vector<>::begin()
-	const WindingVertex& firstElement = front();
-
-	// Set the vertex pointer first
-	glVertexPointer(3, GL_DOUBLE, sizeof(WindingVertex), &firstElement.vertex);
+	const GLsizei stride = sizeof(WindingRenderVertex);
 
     // Check render flags. Multiple flags may be set, so the order matters.
     if (info.checkFlag(RENDER_TEXTURE_CUBEMAP))
@@ -93,7 +161,7 @@ void Winding::render(const RenderInfo& info) const
         // etc.
         glEnableClientState(GL_TEXTURE_COORD_ARRAY);
         glTexCoordPointer(
-            3, GL_DOUBLE, sizeof(WindingVertex), &firstElement.vertex
+            3, GL_FLOAT, stride, attributeOffset(offsetof(WindingRenderVertex, vertex))
         );
     }
 	else if (info.checkFlag(RENDER_BUMP))
@@ -101,16 +169,16 @@ void Winding::render(const RenderInfo& info) const
         // Lighting mode, submit normals, tangents and texcoords to the shader
         // program.
 		glVertexAttribPointer(
-            ATTR_NORMAL, 3, GL_DOUBLE, 0, sizeof(WindingVertex), &firstElement.normal
+            ATTR_NORMAL, 3, GL_FLOAT, 0, stride, attributeOffset(offsetof(WindingRenderVertex, normal))
         );
 		glVertexAttribPointer(
-            ATTR_TEXCOORD, 2, GL_DOUBLE, 0, sizeof(WindingVertex), &firstElement.texcoord
+            ATTR_TEXCOORD, 2, GL_FLOAT, 0, stride, attributeOffset(offsetof(WindingRenderVertex, texcoord))
         );
 		glVertexAttribPointer(
-            ATTR_TANGENT, 3, GL_DOUBLE, 0, sizeof(WindingVertex), &firstElement.tangent
+            ATTR_TANGENT, 3, GL_FLOAT, 0, stride, attributeOffset(offsetof(WindingRenderVertex, tangent))
         );
 		glVertexAttribPointer(
-            ATTR_BITANGENT, 3, GL_DOUBLE, 0, sizeof(WindingVertex), &firstElement.bitangent
+            ATTR_BITANGENT, 3, GL_FLOAT, 0, stride, attributeOffset(offsetof(WindingRenderVertex, bitangent))
         );
 	}
 	else
@@ -118,7 +186,7 @@ void Winding::render(const RenderInfo& info) const
         // Submit normals in lighting mode
 		if (info.checkFlag(RENDER_LIGHTING))
         {
-			glNormalPointer(GL_DOUBLE, sizeof(WindingVertex), &firstElement.normal);
+			glNormalPointer(GL_FLOAT, stride, attributeOffset(offsetof(WindingRenderVertex, normal)));
 		}
 
         // Set texture coordinates in 2D texture mode
@@ -126,15 +194,74 @@ void Winding::render(const RenderInfo& info) const
         {
             glEnableClientState(GL_TEXTURE_COORD_ARRAY);
             glTexCoordPointer(
-                2, GL_DOUBLE, sizeof(WindingVertex), &firstElement.texcoord
+                2, GL_FLOAT, stride, attributeOffset(offsetof(WindingRenderVertex, texcoord))
             );
 		}
 	}
+}
+
+void Winding::render(const RenderInfo& info) const
+{
+    // Do not render if there are no points
+	if (empty())
+    {
+		return;
+	}
+
+	bindVertexBuffer();
+	setAttributePointers(info);
 
     // Submit all data to OpenGL
-	glDrawArrays(GL_POLYGON, 0, GLsizei(size()));
+	glDrawArrays(GL_POLYGON, _vertexBuffer->getFirstVertex(_vertexBufferSlot), GLsizei(size()));
 
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	// Other renderables are submitting their data from client memory
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+const void* Winding::getBatchKey() const
+{
+	updateVertexBuffer();
+	return _vertexBuffer.get();
+}
+
+std::size_t Winding::renderBatch(const RenderInfo& info, const BatchEntry* entries, std::size_t count) const
+{
+	// All windings of the batch share our buffer, their changes are uploaded at once
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		static_cast<const Winding*>(entries[i].renderable)->updateVertexBuffer();
+	}
+
+	bindVertexBuffer();
+	setAttributePointers(info);
+
+	std::size_t drawCalls = 0;
+
+	// The windings sharing the same transform are drawn in a single call
+	for (std::size_t i = 0; i < count; /* in-loop */)
+	{
+		const Matrix4& transform = *entries[i].transform;
+
+		for (; i < count && entries[i].transform->isAffineEqual(transform); ++i)
+		{
+			const auto& winding = *static_cast<const Winding*>(entries[i].renderable);
+			_vertexBuffer->addToDraw(winding._vertexBufferSlot);
+		}
+
+		glPushMatrix();
+		glMultMatrixd(transform);
+		_vertexBuffer->drawMultiple(GL_POLYGON);
+		glPopMatrix();
+
+		++drawCalls;
+	}
+
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return drawCalls;
 }
 
 void Winding::testSelect(SelectionTest& test, SelectionIntersection& best)
@@ -151,6 +278,8 @@ void Winding::updateNormals(const Vector3& normal)
 	{
 		i->normal = normal;
 	}
+
+	invalidateVertexBuffer();
 }
 
 AABB Winding::aabb() const
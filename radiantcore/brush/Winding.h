@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "debugging/debugging.h"
 
 #include <vector>
+#include <GL/glew.h>
 
 #include "iclipper.h"
 #include "irender.h"
@@ -33,6 +34,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "math/Vector2.h"
 #include "math/Vector3.h"
+#include "WindingVertexBuffer.h"
 
 const double ON_EPSILON	= 1.0 / (1 << 8);
 
@@ -44,7 +46,33 @@ class Winding :
 	public IWinding,
     public OpenGLRenderable
 {
+private:
+	// Single-precision copy of the vertices in a slot of a GL buffer object.
+	// The buffer is assigned by the owning face, or a private one is created
+	// on the first render call. The slot is only refilled after the winding changed.
+	mutable brush::WindingVertexBuffer::Ptr _vertexBuffer;
+	mutable std::size_t _vertexBufferSlot;
+	mutable bool _vertexBufferNeedsUpdate;
+
 public:
+	Winding();
+
+	// Copies the vertices, the buffer slot is not shared
+	Winding(const Winding& other);
+	Winding& operator=(const Winding& other);
+
+	~Winding();
+
+	// Marks the GL buffer as outdated, to be called after changing the vertices.
+	// This happens automatically in updateNormals().
+	void invalidateVertexBuffer()
+	{
+		_vertexBufferNeedsUpdate = true;
+	}
+
+	// Moves the vertices to the given buffer, which can be shared with other windings
+	void setVertexBuffer(const brush::WindingVertexBuffer::Ptr& buffer);
+
 	/** greebo: Calculates the AABB of this winding
 	 */
 	AABB aabb() const;
@@ -56,7 +84,11 @@ public:
 	void updateNormals(const Vector3& normal);
 
 	// Submits this winding to OpenGL
-	void render(const RenderInfo& info) const;
+	void render(const RenderInfo& info) const override;
+
+	// Windings in the same buffer are drawn together
+	const void* getBatchKey() const override;
+	std::size_t renderBatch(const RenderInfo& info, const BatchEntry* entries, std::size_t count) const override;
 
 	// Submits the wireframe render commands to OpenGL
 	void drawWireframe() const;
@@ -96,6 +128,16 @@ public:
 
 	/// \brief Returns true if any point in \p w1 is in front of plane2, or any point in \p w2 is in front of plane1
 	static bool planesConcave(const Winding& w1, const Winding& w2, const Plane3& plane1, const Plane3& plane2);
+
+private:
+	// Copies the vertices to the buffer slot if needed
+	void updateVertexBuffer() const;
+
+	// Uploads and binds the buffer, and sets the vertex pointer to it
+	void bindVertexBuffer() const;
+
+	// Points the attributes requested by the render flags to the bound buffer
+	void setAttributePointers(const RenderInfo& info) const;
 };
 
 #endif
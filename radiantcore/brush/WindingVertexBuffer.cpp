@@ -0,0 +1,232 @@
+#include "WindingVertexBuffer.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include "Winding.h"
+#include "render/VBO.h"
+
+namespace brush
+{
+
+namespace
+{
+	// Don't bother compacting small buffers
+	const std::size_t MIN_UNUSED_VERTICES_TO_COMPACT = 1024;
+
+	inline void copyToFloats(const Vector3& source, GLfloat* target)
+	{
+		target[0] = static_cast<GLfloat>(source.x());
+		target[1] = static_cast<GLfloat>(source.y());
+		target[2] = static_cast<GLfloat>(source.z());
+	}
+}
+
+WindingVertexBuffer::WindingVertexBuffer() :
+	_unusedVertices(0),
+	_dirtyBegin(0),
+	_dirtyEnd(0),
+	_buffer(0),
+	_bufferCapacity(0)
+{}
+
+WindingVertexBuffer::~WindingVertexBuffer()
+{
+	render::deleteVBOLater(_buffer);
+}
+
+WindingVertexBuffer::Ptr WindingVertexBuffer::ForMaterial(const std::string& materialName)
+{
+	static std::mutex mutex;
+	static std::map<std::string, std::weak_ptr<WindingVertexBuffer>> buffers;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto& existing = buffers[materialName];
+	auto buffer = existing.lock();
+
+	if (!buffer)
+	{
+		buffer = std::make_shared<WindingVertexBuffer>();
+		existing = buffer;
+	}
+
+	return buffer;
+}
+
+std::size_t WindingVertexBuffer::update(std::size_t slot, const Winding& winding)
+{
+	if (slot != NO_SLOT && _slots[slot].capacity < winding.size())
+	{
+		// The winding grew, it needs to move to a larger range
+		release(slot);
+		slot = NO_SLOT;
+	}
+
+	if (slot == NO_SLOT)
+	{
+		slot = allocate(winding.size());
+	}
+
+	Slot& target = _slots[slot];
+
+	_unusedVertices += target.size;
+	_unusedVertices -= winding.size();
+	target.size = winding.size();
+
+	for (std::size_t i = 0; i < winding.size(); ++i)
+	{
+		const WindingVertex& source = winding[i];
+		WindingRenderVertex& vertex = _vertices[target.offset + i];
+
+		copyToFloats(source.vertex, vertex.vertex);
+		vertex.texcoord[0] = static_cast<GLfloat>(source.texcoord.x());
+		vertex.texcoord[1] = static_cast<GLfloat>(source.texcoord.y());
+		copyToFloats(source.tangent, vertex.tangent);
+		copyToFloats(source.bitangent, vertex.bitangent);
+		copyToFloats(source.normal, vertex.normal);
+	}
+
+	markDirty(target.offset, target.offset + target.size);
+
+	return slot;
+}
+
+void WindingVertexBuffer::release(std::size_t slot)
+{
+	Slot& released = _slots[slot];
+
+	_unusedVertices += released.size;
+	released.capacity = 0;
+	released.size = 0;
+
+	_freeSlots.push_back(slot);
+}
+
+std::size_t WindingVertexBuffer::allocate(std::size_t size)
+{
+	if (_unusedVertices >= MIN_UNUSED_VERTICES_TO_COMPACT && _unusedVertices * 2 > _vertices.size())
+	{
+		compact();
+	}
+
+	std::size_t slot = _slots.size();
+
+	if (_freeSlots.empty())
+	{
+		_slots.emplace_back();
+	}
+	else
+	{
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+
+	// New vertices are always appended, they're counted as unused until written
+	_slots[slot] = Slot{ _vertices.size(), size, 0 };
+	_vertices.resize(_vertices.size() + size);
+	_unusedVertices += size;
+
+	return slot;
+}
+
+void WindingVertexBuffer::compact()
+{
+	std::vector<std::size_t> order;
+	order.reserve(_slots.size());
+
+	for (std::size_t i = 0; i < _slots.size(); ++i)
+	{
+		if (_slots[i].capacity > 0)
+		{
+			order.push_back(i);
+		}
+	}
+
+	// Keep the remaining slots in their current order
+	std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+	{
+		return _slots[a].offset < _slots[b].offset;
+	});
+
+	std::size_t offset = 0;
+
+	for (auto i : order)
+	{
+		Slot& slot = _slots[i];
+
+		std::copy(_vertices.begin() + slot.offset, _vertices.begin() + slot.offset + slot.size,
+			_vertices.begin() + offset);
+
+		slot.offset = offset;
+		slot.capacity = slot.size;
+		offset += slot.size;
+	}
+
+	_vertices.resize(offset);
+	_unusedVertices = 0;
+
+	markDirty(0, _vertices.size());
+}
+
+void WindingVertexBuffer::markDirty(std::size_t begin, std::size_t end)
+{
+	if (_dirtyBegin == _dirtyEnd)
+	{
+		_dirtyBegin = begin;
+		_dirtyEnd = end;
+		return;
+	}
+
+	_dirtyBegin = std::min(_dirtyBegin, begin);
+	_dirtyEnd = std::max(_dirtyEnd, end);
+}
+
+void WindingVertexBuffer::bind()
+{
+	if (_buffer == 0)
+	{
+		glGenBuffers(1, &_buffer);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+	if (_bufferCapacity < _vertices.size())
+	{
+		// Grow with some headroom, the data store needs to be filled again
+		_bufferCapacity = std::max<std::size_t>(_vertices.capacity(), 64);
+		glBufferData(GL_ARRAY_BUFFER, _bufferCapacity * sizeof(WindingRenderVertex), nullptr, GL_DYNAMIC_DRAW);
+
+		markDirty(0, _vertices.size());
+	}
+
+	if (_dirtyBegin < _dirtyEnd)
+	{
+		render::replaceVBODataRange(GL_ARRAY_BUFFER, _buffer, _vertices, _dirtyBegin, _dirtyEnd - _dirtyBegin);
+	}
+
+	_dirtyBegin = _dirtyEnd = 0;
+}
+
+void WindingVertexBuffer::addToDraw(std::size_t slot)
+{
+	const Slot& drawn = _slots[slot];
+
+	if (drawn.size == 0) return;
+
+	_firsts.push_back(static_cast<GLint>(drawn.offset));
+	_counts.push_back(static_cast<GLsizei>(drawn.size));
+}
+
+void WindingVertexBuffer::drawMultiple(GLenum mode)
+{
+	if (!_firsts.empty())
+	{
+		glMultiDrawArrays(mode, _firsts.data(), _counts.data(), static_cast<GLsizei>(_firsts.size()));
+	}
+
+	_firsts.clear();
+	_counts.clear();
+}
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+class Winding;
+
+namespace brush
+{
+
+// Layout of the winding vertices in the GL buffer, these are converted
+// to single precision once instead of by the driver in every frame
+struct WindingRenderVertex
+{
+	GLfloat vertex[3];
+	GLfloat texcoord[2];
+	GLfloat tangent[3];
+	GLfloat bitangent[3];
+	GLfloat normal[3];
+};
+
+/**
+ * A GL buffer object holding the vertices of many windings, such that
+ * the brush faces using the same material can be drawn in a single call.
+ *
+ * Each winding occupies a slot, which is a range of vertices in the buffer.
+ * The vertices are staged in client memory, and only the part that changed
+ * since the last draw is uploaded. Slots of windings which grew are moved to
+ * the end, the buffer is compacted when too much space is left unused.
+ *
+ * All methods except release() require the GL context to be current, which
+ * means they're only called from the render functions.
+ */
+class WindingVertexBuffer
+{
+public:
+	typedef std::shared_ptr<WindingVertexBuffer> Ptr;
+
+	static const std::size_t NO_SLOT = static_cast<std::size_t>(-1);
+
+private:
+	struct Slot
+	{
+		std::size_t offset;
+		std::size_t capacity;
+		std::size_t size;
+	};
+	std::vector<Slot> _slots;
+	std::vector<std::size_t> _freeSlots;
+
+	std::vector<WindingRenderVertex> _vertices;
+
+	// Number of vertices in _vertices not belonging to any slot
+	std::size_t _unusedVertices;
+
+	// The vertex range which needs to be uploaded before the next draw
+	std::size_t _dirtyBegin;
+	std::size_t _dirtyEnd;
+
+	GLuint _buffer;
+	std::size_t _bufferCapacity;
+
+	// Draw call arguments, keep their capacity between frames
+	std::vector<GLint> _firsts;
+	std::vector<GLsizei> _counts;
+
+public:
+	WindingVertexBuffer();
+
+	// The GL buffer is queued for deletion
+	~WindingVertexBuffer();
+
+	// Returns the buffer shared by all faces using the given material
+	static Ptr ForMaterial(const std::string& materialName);
+
+	// Copies the vertices of the winding into the given slot, allocating a
+	// new one if necessary. Returns the slot the vertices ended up in.
+	std::size_t update(std::size_t slot, const Winding& winding);
+
+	// Gives up the given slot, can be called without a GL context
+	void release(std::size_t slot);
+
+	// Uploads all the changes and binds the buffer to GL_ARRAY_BUFFER
+	void bind();
+
+	// The index of the first vertex of the given slot, as used in glDrawArrays
+	GLint getFirstVertex(std::size_t slot) const
+	{
+		return static_cast<GLint>(_slots[slot].offset);
+	}
+
+	// Adds the given slot to the next drawMultiple() call
+	void addToDraw(std::size_t slot);
+
+	// Draws all slots added through addToDraw() in one call, the buffer needs to be bound
+	void drawMultiple(GLenum mode);
+
+private:
+	std::size_t allocate(std::size_t size);
+	void markDirty(std::size_t begin, std::size_t end);
+
+	// Moves all slots next to each other, removing the unused vertices in between
+	void compact();
+};
+
+}
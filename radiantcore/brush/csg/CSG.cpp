@@ -1,6 +1,7 @@
 #include "CSG.h"
 
 #include <map>
+#include <set>
 
 #include "i18n.h"
 #include "itextstream.h"
@@ -10,6 +11,7 @@
 #include "ientity.h"
 
 #include "scenelib.h"
+#include "selectionlib.h"
 #include "shaderlib.h"
 
 #include "registry/registry.h"
@@ -17,6 +19,10 @@
 #include "brush/Brush.h"
 #include "brush/BrushNode.h"
 #include "brush/BrushVisit.h"
+#include "brush/BrushWindings.h"
+#include "math/PlaneMap.h"
+#include "render/BoundsVolumeTest.h"
+#include "scene/ParallelChunks.h"
 #include "selection/algorithm/Primitives.h"
 #include "messages/NotificationMessage.h"
 #include "command/ExecutionNotPossible.h"
@@ -29,64 +35,119 @@ namespace algorithm
 
 const std::string RKEY_EMIT_CSG_SUBTRACT_WARNING("user/ui/brush/emitCSGSubtractWarning");
 
+namespace
+{
+
+// Fragmenting a target builds windings for every overlapping subtracted brush,
+// the most expensive work item here
+constexpr std::size_t MIN_TARGETS_PER_THREAD = 16;
+
+// Evaluating a hollow shell builds the windings of one brush, a copy of the
+// source brush with an extra face
+constexpr std::size_t MIN_SHELLS_PER_THREAD = 32;
+
+// A concavity test only checks the vertices of one face against another plane
+constexpr std::size_t MIN_MERGE_FACES_PER_THREAD = 64;
+
+}
+
 void hollowBrush(const BrushNodePtr& sourceBrush, bool makeRoom)
 {
-	// Hollow the brush using the current grid size
-    sourceBrush->getBrush().forEachFace([&] (Face& face)
-    {
-        if (!face.contributes())
-        {
-            return;
-        }
+	hollowBrushes({ sourceBrush }, makeRoom);
+}
 
-        scene::INodePtr parent = sourceBrush->getParent();
+void hollowBrushes(const std::vector<BrushNodePtr>& sourceBrushes, bool makeRoom)
+{
+	float offset = GlobalGrid().getGridSize();
 
-        scene::INodePtr newNode = GlobalBrushCreator().createBrush();
-        BrushNodePtr brushNode = std::dynamic_pointer_cast<BrushNode>(newNode);
-        assert(brushNode);
+	// The wall brushes along with their source brush. They are set up outside
+	// the scene, such that their windings can be built on several threads.
+	std::vector<std::pair<BrushNodePtr, scene::INodePtr>> shells;
 
-        float offset = GlobalGrid().getGridSize();
+	for (const auto& sourceBrush : sourceBrushes)
+	{
+		const Brush& source = sourceBrush->getBrush();
+		source.evaluateBRep();
 
-		if (makeRoom)
+		for (std::size_t i = 0; i < source.getNumFaces(); ++i)
 		{
-			face.getPlane().offset(offset);
-		}
+			const Face& face = *(*(source.begin() + i));
 
-        // Add the child to the same parent as the source brush
-        parent->addChildNode(brushNode);
+			if (!face.contributes())
+			{
+				continue;
+			}
 
-        // Move the child brushes to the same layer as their source
-        brushNode->assignToLayers(sourceBrush->getLayers());
+			scene::INodePtr newNode = GlobalBrushCreator().createBrush();
+			Brush& brush = *Node_getBrush(newNode);
+
+			// Copy all faces from the source brush
+			brush.copy(source);
+
+			if (makeRoom)
+			{
+				Face& outerFace = *(*(brush.begin() + i));
+				outerFace.getPlane().offset(offset);
+				outerFace.planeChanged();
+			}
 
-        // Copy all faces from the source brush
-        brushNode->getBrush().copy(sourceBrush->getBrush());
+			FacePtr newFace = brush.addFace(face);
 
-		if (makeRoom)
+			if (newFace != 0)
+			{
+				newFace->flipWinding();
+
+				if (!makeRoom)
+				{
+					newFace->getPlane().offset(offset);
+				}
+
+				newFace->planeChanged();
+			}
+
+			shells.emplace_back(sourceBrush, newNode);
+		}
+	}
+
+	auto evaluateShells = [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
 		{
-			face.getPlane().offset(-offset);
+			Node_getBrush(shells[i].second)->evaluateBRep();
 		}
+	};
 
-        Node_setSelected(brushNode, true);
+	scene::parallelForChunks(shells.size(), MIN_SHELLS_PER_THREAD, evaluateShells);
+
+	for (const auto& shell : shells)
+	{
+		Node_getBrush(shell.second)->removeEmptyFaces();
+	}
 
-        FacePtr newFace = brushNode->getBrush().addFace(face);
+	// Rebuild the windings of the shells which have lost some faces
+	scene::parallelForChunks(shells.size(), MIN_SHELLS_PER_THREAD, evaluateShells);
 
-        if (newFace != 0)
-        {
-            newFace->flipWinding();
+	// Insert the shells and remove the source brushes, reporting the selection changes at once
+	selection::ScopedBulkSelectionChange bulkChange;
 
-			if (!makeRoom)
-			{
-	            newFace->getPlane().offset(offset);
-			}
+	for (std::size_t i = 0; i < shells.size(); ++i)
+	{
+		const BrushNodePtr& sourceBrush = shells[i].first;
 
-            newFace->planeChanged();
-        }
+		// Add the child to the same parent as the source brush
+		sourceBrush->getParent()->addChildNode(shells[i].second);
 
-        brushNode->getBrush().removeEmptyFaces();
-    });
+		// Move the child brushes to the same layer as their source
+		shells[i].second->assignToLayers(sourceBrush->getLayers());
 
-	// Now unselect and remove the source brush from the scene
-	scene::removeNodeFromParent(sourceBrush);
+		Node_setSelected(shells[i].second, true);
+
+		// Now unselect and remove the source brush from the scene
+		if (i + 1 == shells.size() || shells[i + 1].first != sourceBrush)
+		{
+			scene::removeNodeFromParent(sourceBrush);
+		}
+	}
 }
 
 void hollowSelectedBrushes(const cmd::ArgumentList& args) {
@@ -95,12 +156,9 @@ void hollowSelectedBrushes(const cmd::ArgumentList& args) {
 	// Find all brushes
 	BrushPtrVector brushes = selection::algorithm::getSelectedBrushes();
 
-	// Cycle through the brushes and hollow them
+	// Hollow them all at once
 	// We assume that all these selected brushes are visible as well.
-	for (const BrushNodePtr& brush : brushes)
-	{
-		hollowBrush(brush, false);
-	}
+	hollowBrushes(brushes, false);
 
 	SceneChangeNotify();
 }
@@ -111,25 +169,197 @@ void makeRoomForSelectedBrushes(const cmd::ArgumentList& args) {
 	// Find all brushes
 	BrushPtrVector brushes = selection::algorithm::getSelectedBrushes();
 
-	// Cycle through the brushes and hollow them
+	// Hollow them all at once
 	// We assume that all these selected brushes are visible as well.
-	for (std::size_t i = 0; i < brushes.size(); ++i)
-	{
-		hollowBrush(brushes[i], true);
-	}
+	hollowBrushes(brushes, true);
 
 	SceneChangeNotify();
 }
 
+namespace
+{
+
+/**
+ * The geometry of a brush, defined by its face planes only. The windings are
+ * built by the same functions as in Brush::buildWindings(), such that the CSG
+ * fragments can be calculated on worker threads without creating any nodes,
+ * faces or shaders.
+ */
+class BrushPlanes
+{
+private:
+	std::vector<Plane3> _planes;
+
+	// The winding of each face, with less than 3 vertices for faces not contributing
+	mutable std::vector<Winding> _windings;
+	mutable AABB _bounds;
+	mutable bool _needsEvaluation;
+
+public:
+	BrushPlanes(const Brush& brush) :
+		_needsEvaluation(true)
+	{
+		_planes.reserve(brush.getNumFaces());
+
+		for (const auto& face : brush)
+		{
+			_planes.push_back(face->plane3());
+		}
+	}
+
+	// Returns false if the brush has reached the maximum number of faces
+	bool addPlane(const Plane3& plane)
+	{
+		if (_planes.size() == brush::c_brush_maxFaces)
+		{
+			return false;
+		}
+
+		_planes.push_back(plane);
+		_needsEvaluation = true;
+
+		return true;
+	}
+
+	const AABB& getBounds() const
+	{
+		evaluate();
+		return _bounds;
+	}
+
+	BrushSplitType classifyPlane(const Plane3& plane) const
+	{
+		evaluate();
+
+		BrushSplitType split;
+
+		for (const auto& winding : _windings)
+		{
+			if (winding.size() < 3) continue;
+
+			for (const auto& vertex : winding)
+			{
+				++split.counts[Winding::classifyDistance(plane.distanceToPoint(vertex.vertex), ON_EPSILON)];
+			}
+		}
+
+		return split;
+	}
+
+private:
+	void evaluate() const
+	{
+		if (!_needsEvaluation) return;
+
+		_needsEvaluation = false;
+
+		_bounds = AABB();
+		_windings.resize(_planes.size());
+
+		std::vector<bool> usable(_planes.size());
+
+		for (std::size_t i = 0; i < _planes.size(); ++i)
+		{
+			usable[i] = _planes[i].isValid() && planeIsUnique(i);
+		}
+
+		auto getPlane = [&](std::size_t i) -> const Plane3& { return _planes[i]; };
+		auto isPlaneUsable = [&](std::size_t i) { return usable[i]; };
+		auto getWinding = [&](std::size_t i) -> Winding& { return _windings[i]; };
+
+		for (std::size_t i = 0; i < _planes.size(); ++i)
+		{
+			if (!usable[i])
+			{
+				_windings[i].resize(0);
+				continue;
+			}
+
+			windingForClipPlane(_windings[i], _planes[i], _planes.size(), getPlane, isPlaneUsable,
+				Brush::m_maxWorldCoord + 1);
+
+			for (const auto& vertex : _windings[i])
+			{
+				_bounds.includePoint(vertex.vertex);
+			}
+		}
+
+		bool degenerate = !windingsAreBounded(_windings.size(), getWinding);
+
+		if (!degenerate)
+		{
+			cleanUpWindings(_windings.size(), getWinding);
+		}
+
+		std::size_t numContributing = 0;
+		std::size_t numVertices = 0;
+
+		for (const auto& winding : _windings)
+		{
+			if (winding.size() > 2)
+			{
+				++numContributing;
+			}
+
+			numVertices += winding.size();
+		}
+
+		// Same conditions as in Brush::buildBRep(), degenerate brushes have no windings
+		if (degenerate || numContributing < 4 || numVertices % 2 != 0)
+		{
+			for (auto& winding : _windings)
+			{
+				winding.resize(0);
+			}
+		}
+	}
+
+	bool planeIsUnique(std::size_t index) const
+	{
+		for (std::size_t i = 0; i < _planes.size(); ++i)
+		{
+			if (index != i && !plane3_inside(_planes[index], _planes[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+// A piece of a target brush, defined by the faces added to a copy of it
+struct BrushFragment
+{
+	BrushPlanes planes;
+
+	// The faces of the subtracted brushes, with their plane flipped or not
+	std::vector<std::pair<const Face*, bool>> addedFaces;
+
+	BrushFragment(const Brush& target) :
+		planes(target)
+	{}
+
+	void addFace(const Face& face, bool flipped)
+	{
+		const Plane3& plane = face.plane3();
+
+		if (planes.addPlane(flipped ? Plane3(-plane.normal(), -plane.dist()) : plane))
+		{
+			addedFaces.emplace_back(&face, flipped);
+		}
+	}
+};
+
 // Returns true if fragments have been inserted into the given ret_fragments list
-bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVector& ret_fragments)
+bool Brush_subtract(const BrushFragment& brush, const Brush& other, std::vector<BrushFragment>& ret_fragments)
 {
-	if (brush->getBrush().localAABB().intersects(other.localAABB()))
+	if (brush.planes.getBounds().intersects(other.localAABB()))
 	{
-		BrushPtrVector fragments;
+		std::vector<BrushFragment> fragments;
 		fragments.reserve(other.getNumFaces());
 
-		BrushNodePtr back = std::dynamic_pointer_cast<BrushNode>(brush->clone());
+		BrushFragment back(brush);
 
 		for (Brush::const_iterator i(other.begin()); i != other.end(); ++i)
 		{
@@ -137,20 +367,14 @@ bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVecto
 
 			if (!face.contributes()) continue;
 
-			BrushSplitType split = back->getBrush().classifyPlane(face.plane3());
+			BrushSplitType split = back.planes.classifyPlane(face.plane3());
 
 			if (split.counts[ePlaneFront] != 0 && split.counts[ePlaneBack] != 0)
 			{
-				fragments.push_back(std::dynamic_pointer_cast<BrushNode>(back->clone()));
+				fragments.push_back(back);
+				fragments.back().addFace(face, true);
 
-				FacePtr newFace = fragments.back()->getBrush().addFace(face);
-
-				if (newFace != 0)
-				{
-					newFace->flipWinding();
-				}
-
-				back->getBrush().addFace(face);
+				back.addFace(face, false);
 			}
 			else if (split.counts[ePlaneBack] == 0)
 			{
@@ -165,112 +389,154 @@ bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVecto
 	return false;
 }
 
-class SubtractBrushesFromUnselected :
-	public scene::NodeVisitor
+// The outcome of subtracting the selected brushes from one unselected brush
+struct SubtractionResult
 {
-	const BrushPtrVector& _brushlist;
-	std::size_t& _before;
-	std::size_t& _after;
+	BrushNodePtr target;
+	std::vector<BrushFragment> fragments;
+	bool changed = false;
+};
 
-	BrushPtrVector _unselectedBrushes;
+// Fragments the target of the given result, only reading from the involved brushes
+void subtractBrushes(SubtractionResult& result, const BrushPtrVector& brushlist)
+{
+	std::vector<BrushFragment> buffer[2];
+	std::size_t swap = 0;
 
-public:
-	SubtractBrushesFromUnselected(const BrushPtrVector& brushlist, std::size_t& before, std::size_t& after) :
-		_brushlist(brushlist),
-		_before(before),
-		_after(after)
-	{}
+	buffer[swap].emplace_back(result.target->getBrush());
 
-	bool pre(const scene::INodePtr& node) override
+	// Iterate over all selected brushes
+	for (const auto& selectedBrush : brushlist)
 	{
-		if (!node->visible())
+		for (const auto& target : buffer[swap])
 		{
-			return false;
-		}
-
-		if (Node_isBrush(node) && !Node_isSelected(node))
-		{
-			_unselectedBrushes.emplace_back(std::dynamic_pointer_cast<BrushNode>(node));
+			if (Brush_subtract(target, selectedBrush->getBrush(), buffer[1 - swap]))
+			{
+				result.changed = true;
+			}
+			else
+			{
+				buffer[1 - swap].push_back(target);
+			}
 		}
 
-		return true;
+		buffer[swap].clear();
+		swap = 1 - swap;
 	}
 
-	void processUnselectedBrushes()
+	if (result.changed)
 	{
-		for (const auto& node : _unselectedBrushes)
-		{
-			processNode(node);
-		}
+		result.fragments.swap(buffer[swap]);
 	}
+}
 
-private:
-	void processNode(const BrushNodePtr& brushNode)
-	{
-		// Get the parent of this brush
-		scene::INodePtr parent = brushNode->getParent();
-		assert(parent); // parent must not be NULL
+// Collects the visible unselected brushes overlapping any of the given brushes,
+// using the space partition instead of traversing the whole scene
+std::vector<BrushNodePtr> findSubtractionTargets(const BrushPtrVector& brushlist)
+{
+	std::vector<BrushNodePtr> targets;
+	std::set<scene::INode*> visited;
 
-		BrushPtrVector buffer[2];
-		std::size_t swap = 0;
+	for (const auto& selectedBrush : brushlist)
+	{
+		render::BoundsVolumeTest volume(selectedBrush->getBrush().localAABB());
 
-		BrushNodePtr original = std::dynamic_pointer_cast<BrushNode>(brushNode->clone());
+		GlobalSceneGraph().foreachVisibleNodeInVolume(volume, [&](const scene::INodePtr& node)
+		{
+			// The members of a space partition node are not culled individually
+			if (!Node_isBrush(node) || Node_isSelected(node) ||
+				volume.TestAABB(node->worldAABB()) == VOLUME_OUTSIDE)
+			{
+				return true;
+			}
 
-		//Brush* original = new Brush(*brush);
-		buffer[swap].push_back(original);
+			// Brushes of hidden entities are not considered either
+			auto parent = node->getParent();
 
-		// Iterate over all selected brushes
-		for (const auto& selectedBrush : _brushlist)
-		{
-			for (const auto& target : buffer[swap])
+			if (parent && parent->visible() && visited.insert(node.get()).second)
 			{
-				if (Brush_subtract(target, selectedBrush->getBrush(), buffer[1 - swap]))
-				{
-					// greebo: Delete not necessary, nodes get deleted automatically by clear() below
-					// delete (*j);
-				}
-				else
-				{
-					buffer[1 - swap].push_back(target);
-				}
+				targets.emplace_back(std::dynamic_pointer_cast<BrushNode>(node));
 			}
 
-			buffer[swap].clear();
-			swap = 1 - swap;
-		}
+			return true;
+		});
+	}
 
-		BrushPtrVector& out = buffer[swap];
+	return targets;
+}
 
-		if (out.size() == 1 && out.back() == original)
+void subtractBrushesFromTargets(const BrushPtrVector& brushlist, std::size_t& before, std::size_t& after)
+{
+	std::vector<SubtractionResult> results;
+
+	for (const auto& target : findSubtractionTargets(brushlist))
+	{
+		// Make sure the windings are up to date before the worker threads read them
+		target->getBrush().evaluateBRep();
+
+		results.emplace_back();
+		results.back().target = target;
+	}
+
+	for (const auto& selectedBrush : brushlist)
+	{
+		selectedBrush->getBrush().evaluateBRep();
+	}
+
+	scene::parallelForChunks(results.size(), MIN_TARGETS_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
 		{
-			// greebo: shared_ptr is taking care of this
-			//delete original;
+			subtractBrushes(results[i], brushlist);
 		}
-		else
+	});
+
+	// Replace the fragmented brushes, on this thread and within the current undoable command
+	for (const auto& result : results)
+	{
+		if (!result.changed) continue;
+
+		const BrushNodePtr& brushNode = result.target;
+
+		// Get the parent of this brush
+		scene::INodePtr parent = brushNode->getParent();
+		assert(parent); // parent must not be NULL
+
+		before++;
+
+		for (const auto& fragment : result.fragments)
 		{
-			_before++;
+			after++;
 
-			for (BrushPtrVector::const_iterator i = out.begin(); i != out.end(); ++i)
-			{
-				_after++;
+			scene::INodePtr newBrush = GlobalBrushCreator().createBrush();
 
-				scene::INodePtr newBrush = GlobalBrushCreator().createBrush();
+			parent->addChildNode(newBrush);
 
-				parent->addChildNode(newBrush);
+			// Move the new Brush to the same layers as the source node
+			newBrush->assignToLayers(brushNode->getLayers());
 
-				// Move the new Brush to the same layers as the source node
-				newBrush->assignToLayers(brushNode->getLayers());
+			Brush* brush = Node_getBrush(newBrush);
+			brush->copy(brushNode->getBrush());
 
-				(*i)->getBrush().removeEmptyFaces();
-				ASSERT_MESSAGE(!(*i)->getBrush().empty(), "brush left with no faces after subtract");
+			for (const auto& addedFace : fragment.addedFaces)
+			{
+				FacePtr newFace = brush->addFace(*addedFace.first);
 
-				Node_getBrush(newBrush)->copy((*i)->getBrush());
+				if (newFace && addedFace.second)
+				{
+					newFace->flipWinding();
+				}
 			}
 
-			scene::removeNodeFromParent(brushNode);
+			brush->removeEmptyFaces();
+			ASSERT_MESSAGE(!brush->empty(), "brush left with no faces after subtract");
 		}
+
+		scene::removeNodeFromParent(brushNode);
 	}
-};
+}
+
+}
 
 void subtractBrushesFromUnselected(const cmd::ArgumentList& args)
 {
@@ -302,10 +568,7 @@ void subtractBrushesFromUnselected(const cmd::ArgumentList& args)
 	std::size_t before = 0;
 	std::size_t after = 0;
 
-	SubtractBrushesFromUnselected walker(brushes, before, after);
-	GlobalSceneGraph().root()->traverse(walker);
-
-	walker.processUnselectedBrushes();
+	subtractBrushesFromTargets(brushes, before, after);
 
 	rMessage() << "CSG Subtract: Result: "
 		<< after << " fragment" << (after == 1 ? "" : "s")
@@ -314,83 +577,158 @@ void subtractBrushesFromUnselected(const cmd::ArgumentList& args)
 	SceneChangeNotify();
 }
 
-// greebo: TODO: Make this a member method of the Brush class
-bool Brush_merge(Brush& brush, const BrushPtrVector& in, bool onlyshape) {
-	// gather potential outer faces
-	typedef std::vector<const Face*> FaceList;
-	FaceList faces;
+namespace
+{
+
+// The brushes of one entity to be merged, and the faces of the resulting brush
+struct MergeGroup
+{
+	BrushPtrVector brushes;
+
+	// The outer faces, one per plane
+	std::vector<const Face*> faces;
+
+	// The outer faces including the ones with a duplicate plane,
+	// these all need to be behind the planes of the resulting brush
+	std::vector<const Face*> candidates;
+
+	bool mergeable = true;
+};
+
+// Collects the outer faces of the group, sets the mergeable flag to false if the result
+// is known to be impossible already. Whether the result is convex is tested separately.
+void collectMergeFaces(MergeGroup& group, bool onlyshape)
+{
+	// All face planes, along with the index of the brush they belong to
+	PlaneMap<std::size_t> planes;
 
-	for (BrushPtrVector::const_iterator i(in.begin()); i != in.end(); ++i) {
-		(*i)->getBrush().evaluateBRep();
+	for (std::size_t i = 0; i < group.brushes.size(); ++i)
+	{
+		const Brush& brush = group.brushes[i]->getBrush();
+		brush.evaluateBRep();
+
+		for (const auto& face : brush)
+		{
+			planes.insert(face->plane3(), i);
+		}
+	}
 
-		for (Brush::const_iterator j((*i)->getBrush().begin()); j != (*i)->getBrush().end(); ++j) {
-			if (!(*j)->contributes()) {
+	// The planes of the outer faces, along with their index in group.faces
+	PlaneMap<std::size_t> outerPlanes;
+
+	for (std::size_t i = 0; i < group.brushes.size(); ++i)
+	{
+		for (const auto& face : group.brushes[i]->getBrush())
+		{
+			if (!face->contributes())
+			{
 				continue;
 			}
 
-			const Face& face1 = *(*j);
+			// skip faces opposing a face of another brush
+			bool opposed = !planes.foreachEqual(-face->plane3(), [&](std::size_t brushIndex)
+			{
+				return brushIndex == i; // don't test a brush against itself
+			});
 
-			bool skip = false;
+			if (opposed)
+			{
+				continue;
+			}
 
-			// test faces of all input brushes
-			//!\todo SPEEDUP: Flag already-skip faces and only test brushes from i+1 upwards.
-			for (BrushPtrVector::const_iterator k(in.begin()); !skip && k != in.end(); ++k) {
-				if (k != i) { // don't test a brush against itself
-					for (Brush::const_iterator l((*k)->getBrush().begin()); !skip && l != (*k)->getBrush().end(); ++l) {
-						const Face& face2 = *(*l);
+			// Use the first of the faces equal to this one
+			std::size_t duplicate = group.faces.size();
 
-						// face opposes another face
-						if (face1.plane3() == -face2.plane3()) {
-							// skip opposing planes
-							skip  = true;
-							break;
-						}
-					}
+			outerPlanes.foreachEqual(face->plane3(), [&](std::size_t index)
+			{
+				duplicate = std::min(duplicate, index);
+				return true;
+			});
+
+			if (duplicate < group.faces.size())
+			{
+				// if the texture/shader references should be the same but are not
+				if (!onlyshape && !shader_equal(
+					face->getFaceShader().getMaterialName(),
+					group.faces[duplicate]->getFaceShader().getMaterialName()))
+				{
+					group.mergeable = false;
+					return;
 				}
 			}
+			else
+			{
+				outerPlanes.insert(face->plane3(), group.faces.size());
+				group.faces.push_back(face.get());
+			}
 
-			// check faces already stored
-			for (FaceList::const_iterator m = faces.begin(); !skip && m != faces.end(); ++m) {
-				const Face& face2 = *(*m);
-
-				// face equals another face
-				if (face1.plane3() == face2.plane3()) {
-					// if the texture/shader references should be the same but are not
-					if (!onlyshape && !shader_equal(
-                            face1.getFaceShader().getMaterialName(),
-                            face2.getFaceShader().getMaterialName()
-                        ))
-                    {
-						return false;
-					}
-
-					// skip duplicate planes
-					skip = true;
-					break;
-				}
+			group.candidates.push_back(face.get());
+		}
+	}
 
-				// face1 plane intersects face2 winding or vice versa
-				if (Winding::planesConcave(face1.getWinding(), face2.getWinding(), face1.plane3(), face2.plane3())) {
-					// result would not be convex
-					return false;
-				}
-			}
+	if (group.faces.size() > brush::c_brush_maxFaces)
+	{
+		// result would have too many sides
+		group.mergeable = false;
+	}
+}
 
-			if (!skip) {
-				faces.push_back(&face1);
-			}
+// Returns true if the given candidate face is sticking out of the merged brush
+bool isConcave(const MergeGroup& group, const Face& candidate)
+{
+	for (const Face* face : group.faces)
+	{
+		// face plane intersects candidate winding or vice versa
+		if (face != &candidate && Winding::planesConcave(candidate.getWinding(),
+			face->getWinding(), candidate.plane3(), face->plane3()))
+		{
+			return true;
 		}
 	}
 
-	for (FaceList::const_iterator i = faces.begin(); i != faces.end(); ++i) {
-		if (!brush.addFace(*(*i))) {
-			// result would have too many sides
-			return false;
+	return false;
+}
+
+// Determines the outer faces of all groups, and whether the merged brushes would be convex
+void evaluateMergeGroups(std::vector<MergeGroup>& groups, bool onlyshape)
+{
+	// The candidate faces to test, identified by group and index
+	std::vector<std::pair<std::size_t, std::size_t>> tests;
+
+	for (std::size_t i = 0; i < groups.size(); ++i)
+	{
+		collectMergeFaces(groups[i], onlyshape);
+
+		if (!groups[i].mergeable) continue;
+
+		for (std::size_t candidate = 0; candidate < groups[i].candidates.size(); ++candidate)
+		{
+			tests.emplace_back(i, candidate);
+		}
+	}
+
+	// The faces are only read from here on, the tests of all groups can run at once
+	std::vector<char> concave(tests.size(), 0);
+
+	scene::parallelForChunks(tests.size(), MIN_MERGE_FACES_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const MergeGroup& group = groups[tests[i].first];
+			concave[i] = isConcave(group, *group.candidates[tests[i].second]);
+		}
+	});
+
+	for (std::size_t i = 0; i < tests.size(); ++i)
+	{
+		if (concave[i])
+		{
+			// result would not be convex
+			groups[tests[i].first].mergeable = false;
 		}
 	}
+}
 
-	brush.removeEmptyFaces();
-	return true;
 }
 
 void mergeSelectedBrushes(const cmd::ArgumentList& args)
@@ -418,34 +756,42 @@ void mergeSelectedBrushes(const cmd::ArgumentList& args)
 		brushesByEntity[parent].emplace_back(brushNode);
 	}
 
-	bool selectionIsSuitable = false;
-	// At least one group should have more than two members
+	// Only groups of at least two brushes are considered
+	std::vector<MergeGroup> groups;
+
 	for (const auto& pair : brushesByEntity)
 	{
 		if (pair.second.size() >= 2)
 		{
-			selectionIsSuitable = true;
-			break;
+			groups.emplace_back();
+			groups.back().brushes = pair.second;
 		}
 	}
 
-	if (!selectionIsSuitable)
+	if (groups.empty())
 	{
 		throw cmd::ExecutionNotPossible(_("CSG Merge: At least two brushes sharing of the same entity have to be selected."));
 	}
 
 	UndoableCommand undo("mergeSelectedBrushes");
 
+	// Attempt to merge the brushes of each group
+	evaluateMergeGroups(groups, true);
+
+	selection::ScopedBulkSelectionChange bulkChange;
+
 	bool anythingMerged = false;
-	for (const auto& pair : brushesByEntity)
+	for (const auto& group : groups)
 	{
-		if (pair.second.size() < 2)
+		if (!group.mergeable)
 		{
 			continue;
 		}
 
+		anythingMerged = true;
+
 		// Take the last selected node as reference for layers and parent
-		auto lastBrush = pair.second.back();
+		auto lastBrush = group.brushes.back();
 		auto parent = lastBrush->getParent();
 
 		assert(Node_isEntity(parent));
@@ -462,18 +808,17 @@ void mergeSelectedBrushes(const cmd::ArgumentList& args)
 		// Get the contained brush
 		Brush* brush = Node_getBrush(newBrush);
 
-		// Attempt to merge the selected brushes into the new one
-		if (!Brush_merge(*brush, pair.second, true))
+		for (const Face* face : group.faces)
 		{
-			continue;
+			brush->addFace(*face);
 		}
 
-		anythingMerged = true;
+		brush->removeEmptyFaces();
 
 		ASSERT_MESSAGE(!brush->empty(), "brush left with no faces after merge");
 
 		// Remove the original brushes
-		for (const auto& brush : pair.second)
+		for (const auto& brush : group.brushes)
 		{
 			scene::removeNodeFromParent(brush);
 		}
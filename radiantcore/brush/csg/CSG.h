@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "iclipper.h"
 #include "icommandsystem.h"
 #include "math/Plane3.h"
@@ -24,6 +25,13 @@ namespace algorithm {
  */
 void hollowBrush(const BrushNodePtr& sourceBrush, bool makeRoom);
 
+/**
+ * Hollows all the given brushes at once. The windings of the resulting
+ * brushes are built on several threads before they are inserted into
+ * the scene, all of them are selected.
+ */
+void hollowBrushes(const std::vector<BrushNodePtr>& sourceBrushes, bool makeRoom);
+
 /**
  * greebo: Hollows all currently selected brushes.
  */
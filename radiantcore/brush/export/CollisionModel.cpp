@@ -1,5 +1,9 @@
 #include "CollisionModel.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 #include "itextstream.h"
 #include "iselection.h"
 #include "ientity.h"
@@ -7,6 +11,8 @@
 #include "gamelib.h"
 #include "brush/Brush.h"
 #include "brush/Winding.h"
+#include "math/Hash.h"
+#include "scene/ParallelChunks.h"
 
 namespace cmutil {
 
@@ -19,6 +25,22 @@ namespace cmutil {
 		// greebo: These are the empirical brush size factors (I think they work)
 		const std::size_t SIZEOF_BRUSH = 44;
 		const std::size_t SIZEOF_FACE = 16;
+
+		// Snapping takes a few microseconds per brush (a handful of faces with
+		// their windings), a few dozen brushes are needed to justify a thread
+		const std::size_t MIN_BRUSHES_PER_THREAD = 64;
+
+		// The geometry of a single face, as needed to add its polygon
+		struct FaceGeometry
+		{
+			std::vector<Vector3> snappedVertices;
+			AABB bounds;
+		};
+
+		bool isNaN(const Vector3& vertex)
+		{
+			return std::isnan(vertex.x()) || std::isnan(vertex.y()) || std::isnan(vertex.z());
+		}
 	}
 
 // Writes the given Vector3 in the format ( 0 1 2 ) to the given stream
@@ -76,21 +98,43 @@ std::ostream& operator<< (std::ostream& st, const BrushStruc b) {
 	return st;
 }
 
-CollisionModel::CollisionModel() {
+std::size_t CollisionModel::VertexHash::operator()(const Vector3& vertex) const
+{
+	// Adding zero turns -0 into +0, both are comparing equal
+	std::hash<double> hashDouble;
+	std::size_t hash = hashDouble(vertex.x() + 0.0);
+
+	math::combineHash(hash, hashDouble(vertex.y() + 0.0));
+	math::combineHash(hash, hashDouble(vertex.z() + 0.0));
+
+	return hash;
+}
+
+std::size_t CollisionModel::EdgeHash::operator()(const std::pair<std::size_t, std::size_t>& edge) const
+{
+	std::size_t hash = std::hash<std::size_t>()(edge.first);
+	math::combineHash(hash, std::hash<std::size_t>()(edge.second));
+
+	return hash;
+}
+
+CollisionModel::CollisionModel() :
+	_collisionShader(game::current::getValue<std::string>(GKEY_COLLISION_SHADER))
+{
 	// Create the "NULL" edge (numVertices = 0)
 	_edges[0] = Edge(0);
+	_edgeIndices.emplace(std::make_pair(std::size_t(0), std::size_t(0)), 0);
 }
 
 int CollisionModel::findVertex(const Vector3& vertex) const {
-	for (VertexMap::const_iterator i = _vertices.begin();
-		i != _vertices.end();
-		++i)
-	{
-		if (i->second == vertex) {
-			return static_cast<int>(i->first);
-		}
+	// Vertices containing NaN are never equal to anything
+	if (isNaN(vertex)) {
+		return -1;
 	}
-	return -1;
+
+	auto found = _vertexIndices.find(vertex);
+
+	return found != _vertexIndices.end() ? static_cast<int>(found->second) : -1;
 }
 
 std::size_t CollisionModel::addVertex(const Vector3& vertex)
@@ -106,6 +150,10 @@ std::size_t CollisionModel::addVertex(const Vector3& vertex)
 		std::size_t lastIndex = _vertices.size();
 		_vertices[lastIndex] = snapped;
 
+		if (!isNaN(snapped)) {
+			_vertexIndices.emplace(snapped, lastIndex);
+		}
+
 		return lastIndex;
 	}
 	else {
@@ -115,20 +163,21 @@ std::size_t CollisionModel::addVertex(const Vector3& vertex)
 }
 
 int CollisionModel::findEdge(const Edge& edge) const {
-	for (EdgeMap::const_iterator i = _edges.begin();
-		 i != _edges.end();
-		 i++)
+	// The edge with the lowest index wins, if it matches in
+	// both directions the direction match takes precedence
+	auto direct = _edgeIndices.find(std::make_pair(edge.from, edge.to));
+	auto opposite = _edgeIndices.find(std::make_pair(edge.to, edge.from));
+
+	if (direct != _edgeIndices.end() &&
+		(opposite == _edgeIndices.end() || direct->second <= opposite->second))
 	{
-		// Direction match?
-		if (i->second.from == edge.from && i->second.to == edge.to) {
-			return static_cast<int>(i->first);
-		}
+		return static_cast<int>(direct->second);
+	}
 
-		// Opposite direction match?
-		if (i->second.from == edge.to && i->second.to == edge.from) {
-			return -static_cast<int>(i->first);
-		}
+	if (opposite != _edgeIndices.end()) {
+		return -static_cast<int>(opposite->second);
 	}
+
 	return 0;
 }
 
@@ -140,6 +189,10 @@ std::size_t CollisionModel::addEdge(const Edge& edge) {
 		// NULL edge found, insert the edge with a new index
 		std::size_t edgeIndex = _edges.size();
 		_edges[edgeIndex] = edge;
+
+		// An existing entry keeps its lower index
+		_edgeIndices.emplace(std::make_pair(edge.from, edge.to), edgeIndex);
+
 		return edgeIndex;
 	}
 	else {
@@ -148,42 +201,64 @@ std::size_t CollisionModel::addEdge(const Edge& edge) {
 }
 
 int CollisionModel::findPolygon(const EdgeList& otherEdges) {
-	for (std::size_t p = 0; p < _polygons.size(); p++) {
+	// Polygons with edges can only match if they are sharing at least one edge index
+	std::vector<std::size_t> candidates;
+
+	if (otherEdges.empty()) {
+		candidates = _polygonsWithoutEdges;
+	}
+	else {
+		for (std::size_t j = 0; j < otherEdges.size(); j++) {
+			auto found = _polygonsByEdge.find(abs(otherEdges[j]));
+
+			if (found != _polygonsByEdge.end()) {
+				candidates.insert(candidates.end(), found->second.begin(), found->second.end());
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+
+	for (std::size_t p : candidates) {
 		// Check if the edge count matches
-		if (otherEdges.size() == _polygons[p].numEdges) {
-			// The match count
-			std::size_t matches = 0;
-
-			// See through the current polygon and count the matches
-			for (std::size_t i = 0; i < _polygons[p].edges.size(); i++) {
-				for (std::size_t j = 0; j < otherEdges.size(); j++) {
-					if (abs(_polygons[p].edges[i]) == abs(otherEdges[j])) {
-						matches++;
-					}
+		if (_polygonRemoved[p] || otherEdges.size() != _polygons[p].numEdges) {
+			continue;
+		}
+
+		// The match count
+		std::size_t matches = 0;
+
+		// See through the current polygon and count the matches
+		for (std::size_t i = 0; i < _polygons[p].edges.size(); i++) {
+			for (std::size_t j = 0; j < otherEdges.size(); j++) {
+				if (abs(_polygons[p].edges[i]) == abs(otherEdges[j])) {
+					matches++;
 				}
 			}
+		}
 
-			// If the polygons are the same, all the edge indices matched
-			if (matches == otherEdges.size()) {
-				// Remove the duplicate polygon
-				PolygonList::iterator i = _polygons.begin() + p;
-				_polygons.erase(i);
-				rMessage() << "CollisionModel: Removed duplicate polygon.\n";
-				return static_cast<int>(p);
-			}
+		// If the polygons are the same, all the edge indices matched
+		if (matches == otherEdges.size()) {
+			// Remove the duplicate polygon
+			_polygonRemoved[p] = true;
+			rMessage() << "CollisionModel: Removed duplicate polygon.\n";
+			return static_cast<int>(p);
 		}
 	}
+
 	return -1;
 }
 
 void CollisionModel::addPolygon(
-	const Face& face,
+	const Plane3& plane,
+	const AABB& bounds,
 	const VertexList& vertexList)
 {
 	Polygon poly;
 
 	// Cycle from the beginning to the end-1 and add the edges
-	for (std::size_t i = 0; i < vertexList.size()-1; i++) {
+	for (std::size_t i = 0; i + 1 < vertexList.size(); i++) {
 		Edge edge;
 		edge.from = vertexList[i];
 		edge.to = vertexList[i+1];
@@ -194,30 +269,52 @@ void CollisionModel::addPolygon(
 	}
 
 	if (findPolygon(poly.edges) == -1) {
-		AABB faceAABB = face.getWinding().aabb();
-
 		poly.numEdges = poly.edges.size();
-		poly.plane = face.plane3();
-		poly.min = faceAABB.origin - faceAABB.extents;
-		poly.max = faceAABB.origin + faceAABB.extents;
+		poly.plane = plane;
+		poly.min = bounds.origin - bounds.extents;
+		poly.max = bounds.origin + bounds.extents;
 		//poly.shader = face.GetShader();
-		poly.shader = game::current::getValue<std::string>(GKEY_COLLISION_SHADER);
+		poly.shader = _collisionShader;
+
+		std::size_t polygonIndex = _polygons.size();
+
+		if (poly.edges.empty()) {
+			_polygonsWithoutEdges.push_back(polygonIndex);
+		}
+
+		// Register the polygon once for each edge index it's using
+		std::vector<int> edgeIndices;
+
+		for (std::size_t i = 0; i < poly.edges.size(); i++) {
+			edgeIndices.push_back(abs(poly.edges[i]));
+		}
+
+		std::sort(edgeIndices.begin(), edgeIndices.end());
+		edgeIndices.erase(std::unique(edgeIndices.begin(), edgeIndices.end()), edgeIndices.end());
+
+		for (int edgeIndex : edgeIndices) {
+			_polygonsByEdge[edgeIndex].push_back(polygonIndex);
+		}
 
 		_polygons.push_back(poly);
+		_polygonRemoved.push_back(false);
 	}
 }
 
 VertexList CollisionModel::addWinding(
-	const Winding& winding)
+	const std::vector<Vector3>& winding)
 {
 	VertexList vertexList;
 
-	for (Winding::const_iterator i = winding.begin(); i != winding.end(); ++i) {
+	for (std::size_t i = 0; i < winding.size(); ++i) {
 		// Create a vertexId and add it to the stack
-		vertexList.push_back(addVertex(i->vertex));
+		vertexList.push_back(addVertex(winding[i]));
 	}
+
 	// Now add the first vertex a second time to the end of the list
-	vertexList.push_back(addVertex(winding.begin()->vertex));
+	if (!winding.empty()) {
+		vertexList.push_back(addVertex(winding.front()));
+	}
 
 	if (vertexList.size() > 1) {
 		Edge edge;
@@ -239,31 +336,72 @@ VertexList CollisionModel::addWinding(
 }
 
 void CollisionModel::addBrush(Brush& brush) {
-	BrushStruc b;
+	addBrushes({ &brush });
+}
 
-	// The number of faces
-	b.numFaces = brush.getNumFaces();
+void CollisionModel::addBrushes(const std::vector<Brush*>& brushes) {
+	std::vector<BrushStruc> brushStrucs(brushes.size());
 
-	// Get the AABB of this brush
-	AABB brushAABB = brush.localAABB();
+	// Evaluate the brushes here, the worker threads are only reading them
+	for (std::size_t i = 0; i < brushes.size(); i++) {
+		const Brush& brush = *brushes[i];
+		BrushStruc& b = brushStrucs[i];
 
-	b.min = brushAABB.origin - brushAABB.extents;
-	b.max = brushAABB.origin + brushAABB.extents;
+		// The number of faces
+		b.numFaces = brush.getNumFaces();
 
-	// Populate the FaceList
-	for (Brush::const_iterator i = brush.begin(); i != brush.end(); i++) {
-		// Store the plane into the brush
-		b.planes.push_back((*i)->plane3());
+		// Get the AABB of this brush
+		AABB brushAABB = brush.localAABB();
 
-		// Parse the winding of this Face for vertices/edges
-		VertexList vertexList = addWinding((*i)->getWinding());
+		b.min = brushAABB.origin - brushAABB.extents;
+		b.max = brushAABB.origin + brushAABB.extents;
 
-		// Pass the Face& and the VertexList to create the polygon
-		addPolygon(*(*i), vertexList);
+		// Store the face planes into the brush
+		for (Brush::const_iterator f = brush.begin(); f != brush.end(); f++) {
+			b.planes.push_back((*f)->plane3());
+		}
 	}
 
-	// Store the BrushStruc into the list
-	_brushes.push_back(b);
+	// Snap the winding vertices of all faces, distributing the brushes over several threads
+	std::vector<std::vector<FaceGeometry>> faceGeometry(brushes.size());
+
+	scene::parallelForChunks(brushes.size(), MIN_BRUSHES_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; i++)
+		{
+			const Brush& brush = *brushes[i];
+
+			for (Brush::const_iterator f = brush.begin(); f != brush.end(); f++)
+			{
+				const Winding& winding = (*f)->getWinding();
+
+				faceGeometry[i].emplace_back();
+				FaceGeometry& face = faceGeometry[i].back();
+
+				for (Winding::const_iterator v = winding.begin(); v != winding.end(); ++v)
+				{
+					face.snappedVertices.push_back(v->vertex.getSnapped(MAX_PRECISION));
+					face.bounds.includePoint(v->vertex);
+				}
+			}
+		}
+	});
+
+	// Add the geometry in the order of the brushes, the indices depend on it
+	for (std::size_t i = 0; i < brushes.size(); i++) {
+		BrushStruc& b = brushStrucs[i];
+
+		for (std::size_t f = 0; f < faceGeometry[i].size(); f++) {
+			// Parse the winding of this Face for vertices/edges
+			VertexList vertexList = addWinding(faceGeometry[i][f].snappedVertices);
+
+			// Pass the plane, bounds and the VertexList to create the polygon
+			addPolygon(b.planes[f], faceGeometry[i][f].bounds, vertexList);
+		}
+
+		// Store the BrushStruc into the list
+		_brushes.push_back(b);
+	}
 }
 
 void CollisionModel::setModel(const std::string& model) {
@@ -318,7 +456,9 @@ std::ostream& operator<<(std::ostream& st, const CollisionModel& cm) {
 	// Export the polygons
 	st << "\tpolygons {\n";
 	for (std::size_t i = 0; i < cm._polygons.size(); i++) {
-		st << "\t" << cm._polygons[i] << "\n";
+		if (!cm._polygonRemoved[i]) {
+			st << "\t" << cm._polygons[i] << "\n";
+		}
 	}
 	st << "\t}\n";
 
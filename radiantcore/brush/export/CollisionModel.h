@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Geometry.h"
+#include "math/AABB.h"
 #include <memory>
+#include <unordered_map>
 
 class Winding;
 class Brush;
@@ -11,12 +13,36 @@ namespace cmutil {
 
 class CollisionModel
 {
+	struct VertexHash
+	{
+		std::size_t operator()(const Vector3& vertex) const;
+	};
+
+	struct EdgeHash
+	{
+		std::size_t operator()(const std::pair<std::size_t, std::size_t>& edge) const;
+	};
+
 	// The container instances with all the vertices/edges/faces
 	VertexMap _vertices;
 	EdgeMap _edges;
 	PolygonList _polygons;
 	BrushList _brushes;
 
+	// Lookup tables: the index of each snapped vertex, the first index
+	// of each directed edge and the polygons referencing an edge index
+	std::unordered_map<Vector3, std::size_t, VertexHash> _vertexIndices;
+	std::unordered_map<std::pair<std::size_t, std::size_t>, std::size_t, EdgeHash> _edgeIndices;
+	std::unordered_map<std::size_t, std::vector<std::size_t>> _polygonsByEdge;
+
+	// Polygons without any edge, they are not referenced by _polygonsByEdge
+	std::vector<std::size_t> _polygonsWithoutEdges;
+
+	// Duplicate polygons are flagged as removed instead of erasing them from the list
+	std::vector<bool> _polygonRemoved;
+
+	std::string _collisionShader;
+
 	std::string _model;
 
 public:
@@ -24,6 +50,13 @@ public:
 
 	void addBrush(Brush& brush);
 
+	/** 
+	 * Adds the given brushes in the given order, with the same result as calling 
+	 * addBrush() for each of them. The geometry of the brushes is gathered on
+	 * several threads, the brushes must not be modified during this call.
+	 */
+	void addBrushes(const std::vector<Brush*>& brushes);
+
 	/** greebo: Stream insertion operator, use this to write
 	 * the collision model into a file. Qualified as "friend" to allow the access
 	 * of private members and the first function argument to be std::ostream.
@@ -56,11 +89,12 @@ private:
 
 	/** greebo: "Parses" the given Winding and adds its
 	 * 			geometry info (vertices, edges, polys) into the maps.
+	 * 			The winding vertices are passed already snapped.
 	 *
 	 * @returns: the VertexList defining the Winding points in a
 	 * 			 closed loop (last vertexId = first vertexId)
 	 */
-	VertexList addWinding(const Winding& winding);
+	VertexList addWinding(const std::vector<Vector3>& winding);
 
 	/** greebo: Adds the given edge to the internal edge map
 	 * and returns its index. If the edge already exists,
@@ -86,12 +120,12 @@ private:
 	 */
 	int findPolygon(const EdgeList& otherEdges);
 
-	/** greebo: Adds a polygon basing on the given face & vertexlist.
+	/** greebo: Adds a polygon basing on the given face plane, bounds & vertexlist.
 	 * 			Be sure to add the first vertex a second time
 	 * 			to the end of the pass a "closed" winding.
 	 * 			Duplicate polygons are not added.
 	 */
-	void addPolygon(const Face& face, const VertexList& vertexList);
+	void addPolygon(const Plane3& plane, const AABB& bounds, const VertexList& vertexList);
 };
 
 typedef std::shared_ptr<CollisionModel> CollisionModelPtr;
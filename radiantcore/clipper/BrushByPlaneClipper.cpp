@@ -1,11 +1,20 @@
 #include "BrushByPlaneClipper.h"
 
 #include "scenelib.h"
+#include "selectionlib.h"
 #include "brush/BrushNode.h"
+#include "scene/ParallelChunks.h"
 
 namespace algorithm
 {
 
+namespace
+{
+	// Classifying a brush only tests its evaluated winding vertices against
+	// the plane, which is cheap enough to need a few dozen brushes per thread
+	const std::size_t MIN_CLASSIFICATIONS_PER_THREAD = 64;
+}
+
 BrushByPlaneClipper::BrushByPlaneClipper(const Vector3& p0, const Vector3& p1, 
 										 const Vector3& p2, EBrushSplit split) :
 		_p0(p0),
@@ -25,30 +34,51 @@ void BrushByPlaneClipper::split(const BrushPtrVector& brushes)
 		return;
 	}
 
+	BrushPtrVector candidates;
+
 	for (const BrushNodePtr& node : brushes)
 	{
 		// Don't clip invisible nodes
-		if (!node->visible())
+		if (!node->visible() || !node->getParent())
 		{
 			continue;
 		}
 
-		Brush& brush = node->getBrush();
+		// Evaluate the brush here, the worker threads are only reading it
+		node->getBrush().evaluateTransform();
+		node->getBrush().evaluateBRep();
 
-		scene::INodePtr parent = node->getParent();
+		candidates.push_back(node);
+	}
+
+	// Classify the brushes against the plane, distributing them over several threads
+	std::vector<BrushSplitType> splits(candidates.size());
 
-		if (!parent)
+	scene::parallelForChunks(candidates.size(), MIN_CLASSIFICATIONS_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
 		{
-			continue;
+			splits[i] = candidates[i]->getBrush().classifyPlane(_split == eFront ? -plane : plane);
 		}
+	});
+
+	// Report the selection of all fragments at once
+	selection::ScopedBulkSelectionChange bulkChange;
+
+	for (std::size_t i = 0; i < candidates.size(); ++i)
+	{
+		const BrushNodePtr& node = candidates[i];
+		Brush& brush = node->getBrush();
 
-		// greebo: Analyse the brush to find out which shader is the most used one
-		getMostUsedTexturing(brush);
+		scene::INodePtr parent = node->getParent();
 
-		BrushSplitType split = brush.classifyPlane(_split == eFront ? -plane : plane);
+		const BrushSplitType& split = splits[i];
 
 		if (split.counts[ePlaneBack] > 0 && split.counts[ePlaneFront] > 0)
 		{
+			// greebo: Analyse the brush to find out which shader is the most used one
+			getMostUsedTexturing(brush);
+
 			// the plane intersects this brush
 			if (_split == eFrontAndBack)
 			{
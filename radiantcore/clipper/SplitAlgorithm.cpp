@@ -2,38 +2,46 @@
 
 #include "iselection.h"
 #include "brush/BrushNode.h"
+#include "scene/ParallelChunks.h"
 #include "selection/algorithm/Primitives.h"
 #include "BrushByPlaneClipper.h"
 
 namespace algorithm
 {
 
-class BrushSetClipPlane :
-	public SelectionSystem::Visitor
+namespace
 {
-	Plane3 _plane;
-public:
-	BrushSetClipPlane(const Plane3& plane) :
-		_plane(plane)
-	{}
+	// A clip plane winding is chopped by every face of the brush, which costs
+	// several times a plane classification, fewer brushes fill a thread
+	const std::size_t MIN_CLIP_PLANES_PER_THREAD = 16;
+}
 
-	virtual ~BrushSetClipPlane() {}
+void setBrushClipPlane(const Plane3& plane)
+{
+	BrushPtrVector brushes;
 
-	void visit(const scene::INodePtr& node) const override
+	GlobalSelectionSystem().foreachSelected([&](const scene::INodePtr& node)
 	{
 		BrushNodePtr brush = std::dynamic_pointer_cast<BrushNode>(node);
 
 		if (brush && node->visible())
 		{
-			brush->setClipPlane(_plane);
+			// Evaluate the brush here, the worker threads are only reading it
+			brush->getBrush().evaluateTransform();
+			brush->getBrush().evaluateBRep();
+
+			brushes.push_back(brush);
 		}
-	}
-};
+	});
 
-void setBrushClipPlane(const Plane3& plane)
-{
-	BrushSetClipPlane walker(plane);
-	GlobalSelectionSystem().foreachSelected(walker);
+	// Calculate the clip plane windings, distributing the brushes over several threads
+	scene::parallelForChunks(brushes.size(), MIN_CLIP_PLANES_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			brushes[i]->setClipPlane(plane);
+		}
+	});
 }
 
 void splitBrushesByPlane(const Vector3 planePoints[3], EBrushSplit split)
@@ -23,6 +23,7 @@ EntityNode::EntityNode(const IEntityClassPtr& eclass) :
 	_modelKey(*this),
 	_keyObservers(_spawnArgs),
 	_shaderParms(_keyObservers, _colourKey),
+	_spawnArgsObserver(_spawnArgs, std::bind(&EntityNode::invalidateFingerprint, this)),
 	_direction(1,0,0)
 {
 }
@@ -43,6 +44,7 @@ EntityNode::EntityNode(const EntityNode& other) :
 	_modelKey(*this),
 	_keyObservers(_spawnArgs),
 	_shaderParms(_keyObservers, _colourKey),
+	_spawnArgsObserver(_spawnArgs, std::bind(&EntityNode::invalidateFingerprint, this)),
 	_direction(1,0,0)
 {
 }
@@ -204,7 +206,27 @@ const Vector3& EntityNode::getDirection() const
 	return _direction;
 }
 
-std::string EntityNode::getFingerprint()
+std::string EntityNode::getFingerprint(scene::FingerprintHash hash)
+{
+    return _fingerprints.get(hash, [&]()
+    {
+        return hash == scene::FingerprintHash::Fast ?
+            calculateFingerprint<math::FastHash>(hash) : calculateFingerprint<math::Hash>(hash);
+    });
+}
+
+void EntityNode::onChildFingerprintChanged()
+{
+    invalidateFingerprint();
+}
+
+void EntityNode::invalidateFingerprint()
+{
+    scene::invalidateFingerprint(_fingerprints, *this);
+}
+
+template<typename HashType>
+std::string EntityNode::calculateFingerprint(scene::FingerprintHash childHash)
 {
     std::map<std::string, std::string> sortedKeyValues;
 
@@ -215,7 +237,7 @@ std::string EntityNode::getFingerprint()
         sortedKeyValues.emplace(string::to_lower_copy(key), string::to_lower_copy(value));
     }, false);
 
-    math::Hash hash;
+    HashType hash;
 
     for (const auto& pair : sortedKeyValues)
     {
@@ -232,7 +254,7 @@ std::string EntityNode::getFingerprint()
 
         if (comparable)
         {
-            childFingerprints.insert(comparable->getFingerprint());
+            childFingerprints.insert(comparable->getFingerprint(childHash));
         }
 
         return true;
@@ -319,12 +341,16 @@ void EntityNode::onChildAdded(const scene::INodePtr& child)
 	child->setRenderEntity(this);
 
 	Node::onChildAdded(child);
+
+	invalidateFingerprint();
 }
 
 void EntityNode::onChildRemoved(const scene::INodePtr& child)
 {
 	Node::onChildRemoved(child);
 
+	invalidateFingerprint();
+
 	// Leave the renderEntity on the child until this point - this has to happen after onChildRemoved()
 
 	// greebo: Double-check that we're the currently assigned renderentity - in some cases nodes on the undostack
@@ -7,6 +7,7 @@
 #include "Bounded.h"
 
 #include "scene/SelectableNode.h"
+#include "scene/FingerprintCache.h"
 #include "transformlib.h"
 
 #include "NamespaceManager.h"
@@ -17,6 +18,7 @@
 #include "ShaderParms.h"
 
 #include "KeyObserverMap.h"
+#include "SpawnArgsObserver.h"
 
 namespace entity
 {
@@ -70,6 +72,11 @@ protected:
 	// Helper class observing the "shaderParmNN" spawnargs and caching their values
 	ShaderParms _shaderParms;
 
+	// The fingerprints combining the key values and the ones of the child nodes,
+	// dropped by the spawnargs observer and on any change of the children
+	scene::FingerprintCache _fingerprints;
+	SpawnArgsObserver _spawnArgsObserver;
+
 	// This entity's main direction, usually determined by the angle/rotation keys
 	Vector3 _direction;
 
@@ -116,7 +123,9 @@ public:
     Matrix4& localToParent() override { return _localToParent; }
 
     // IComparableNode implementation
-    std::string getFingerprint() override;
+    using scene::IComparableNode::getFingerprint;
+    std::string getFingerprint(scene::FingerprintHash hash) override;
+    void onChildFingerprintChanged() override;
 
 	// SelectionTestable implementation
 	virtual void testSelect(Selector& selector, SelectionTest& test) override;
@@ -186,6 +195,12 @@ private:
 	// Routine used by the destructor, should be non-virtual
 	void destruct();
 
+	// Combines the key values with the (cached) fingerprints of the child nodes
+	template<typename HashType>
+	std::string calculateFingerprint(scene::FingerprintHash childHash);
+
+	void invalidateFingerprint();
+
 	// Private function target - wraps to virtual protected signal
 	void _modelKeyChanged(const std::string& value);
 
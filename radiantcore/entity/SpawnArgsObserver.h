@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ientity.h"
+#include <functional>
+
+namespace entity
+{
+
+/**
+ * Invokes a callback whenever a key value of the observed entity is inserted,
+ * changed or removed, including the changes done by undo and redo.
+ * Inherited spawnargs are not observed.
+ */
+class SpawnArgsObserver :
+	public Entity::Observer,
+	public KeyObserver
+{
+private:
+	Entity& _entity;
+	std::function<void()> _callback;
+
+public:
+	SpawnArgsObserver(Entity& entity, const std::function<void()>& callback) :
+		_entity(entity),
+		_callback(callback)
+	{
+		_entity.attachObserver(this);
+	}
+
+	~SpawnArgsObserver()
+	{
+		_entity.detachObserver(this);
+	}
+
+	// Entity::Observer implementation, the key value notifies us about its changes
+	void onKeyInsert(const std::string& key, EntityKeyValue& value) override
+	{
+		value.attach(*this);
+	}
+
+	void onKeyErase(const std::string& key, EntityKeyValue& value) override
+	{
+		value.detach(*this);
+	}
+
+	// KeyObserver implementation, also invoked on attach and detach
+	void onKeyValueChanged(const std::string& newValue) override
+	{
+		_callback();
+	}
+};
+
+}
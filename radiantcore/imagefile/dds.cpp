@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <stdlib.h>
 #include <algorithm>
 #include <map>
+#include <memory>
 
 #include "ifilesystem.h"
 #include "iarchive.h"
@@ -56,8 +57,11 @@ typedef std::vector<MipMapInfo> MipMapInfoList;
 // Image subclass for DDS images
 class DDSImage: public Image, public util::Noncopyable
 {
-    // The actual pixels
-    mutable std::vector<uint8_t> _pixelData;
+    // The actual pixels. This is deliberately not a std::vector, the buffer
+    // is filled straight from the input stream so there is no point in
+    // zero-initialising it first.
+    std::unique_ptr<uint8_t[]> _pixelData;
+    std::size_t _size;
 
     // The GL format of the texture data, and a boolean flag to indicate if we
     // need to upload with glCompressedTexImage2D rather than glTexImage2D
@@ -70,9 +74,19 @@ class DDSImage: public Image, public util::Noncopyable
 
 public:
 
-    // Pass the required memory size to the constructor
-    DDSImage(std::size_t size): _pixelData(size)
-    {}
+    // Construct with the complete mipmap chain layout, the buffer is sized to
+    // hold all of the levels contiguously
+    DDSImage(MipMapInfoList&& mipMapInfo) :
+        _size(0),
+        _mipMapInfo(std::move(mipMapInfo))
+    {
+        if (!_mipMapInfo.empty())
+        {
+            _size = _mipMapInfo.back().offset + _mipMapInfo.back().size;
+        }
+
+        _pixelData.reset(new uint8_t[_size]);
+    }
 
     // Set the compression format
     void setFormat(GLenum format, bool compressed)
@@ -81,20 +95,30 @@ public:
         _compressed = compressed;
     }
 
-    // Add a new mipmap with the given parameters and return a pointer to its
-    // allocated byte data
-    uint8_t* addMipMap(const MipMapInfo& info)
+    // Total size of the pixel buffer (all mipmaps) in bytes
+    std::size_t getDataSize() const
     {
-        // Store MipMapInfo metadata in our list
-        _mipMapInfo.push_back(info);
+        return _size;
+    }
 
-        // Return the absolute pointer to the new mipmap's byte data
-        assert(info.offset < _pixelData.size());
-        return _pixelData.data() + info.offset;
+    // Offset of the first byte after the given mipmap
+    std::size_t getMipMapEnd(std::size_t level) const
+    {
+        return _mipMapInfo[level].offset + _mipMapInfo[level].size;
+    }
+
+    // Discard all mipmaps from the given level onwards, used if the file
+    // turned out to not contain the full chain advertised in its header
+    void truncateMipMaps(std::size_t numLevels)
+    {
+        if (numLevels < _mipMapInfo.size())
+        {
+            _mipMapInfo.resize(numLevels);
+        }
     }
 
     /* Image implementation */
-    uint8_t* getPixels() const override { return _pixelData.data(); }
+    uint8_t* getPixels() const override { return _pixelData.get(); }
     std::size_t getWidth(std::size_t level = 0) const override
     {
         return _mipMapInfo[level].width;
@@ -131,7 +155,7 @@ public:
                     static_cast<GLsizei>(mipMap.width),
                     static_cast<GLsizei>(mipMap.height),
                     0, static_cast<GLsizei>(mipMap.size),
-                    _pixelData.data() + mipMap.offset
+                    _pixelData.get() + mipMap.offset
                 );
 
                 // If the upload failed but this is not level 0, we can fall
@@ -159,7 +183,7 @@ public:
                     static_cast<GLsizei>(mipMap.width),
                     static_cast<GLsizei>(mipMap.height),
                     0, _format, GL_UNSIGNED_BYTE,
-                    _pixelData.data() + mipMap.offset
+                    _pixelData.get() + mipMap.offset
                 );
             }
 
@@ -228,7 +252,7 @@ DDSImagePtr LoadDDSFromStream(InputStream& stream)
     int width = header.getWidth(), height = header.getHeight();
     std::string compressionFormat = header.getCompressionFormat();
     int bitDepth = header.getRGBBits();
-    std::size_t mipMapCount = header.getMipMapCount();
+    std::size_t mipMapCount = std::max(header.getMipMapCount(), 1);
 
     MipMapInfoList mipMapInfo;
     mipMapInfo.resize(mipMapCount);
@@ -236,7 +260,6 @@ DDSImagePtr LoadDDSFromStream(InputStream& stream)
     // Calculate the total memory requirements (greebo: DXT1 has 8 bytes per block)
     std::size_t blockBytes = (compressionFormat == "DXT1") ? 8 : 16;
 
-    std::size_t size = 0;
     std::size_t offset = 0;
 
     for (std::size_t i = 0; i < mipMapCount; ++i)
@@ -259,16 +282,13 @@ DDSImagePtr LoadDDSFromStream(InputStream& stream)
         // Update the offset for the next mipmap
         offset += mipMap.size;
 
-        // Increase the size counter
-        size += mipMap.size;
-
         // Go to the next mipmap
         width = std::max(width/2, 1);
         height = std::max(height/2, 1);
     }
 
-    // Allocate a new DDS image with that size
-    DDSImagePtr image(new DDSImage(size));
+    // Allocate a new DDS image holding the whole chain
+    DDSImagePtr image(new DDSImage(std::move(mipMapInfo)));
 
     // Set the format of this DDS image
     if (GL_FMT_FOR_FOURCC.count(compressionFormat) == 1) {
@@ -282,18 +302,32 @@ DDSImagePtr LoadDDSFromStream(InputStream& stream)
         return {};
     }
 
-    // Load the mipmaps into the allocated memory
-    for (std::size_t i = 0; i < mipMapInfo.size(); ++i)
+    // The mipmaps are stored back to back in the file, in the same layout
+    // we're using in memory, so read them all in one go
+    std::size_t bytesRead = stream.read(
+        reinterpret_cast<byteType*>(image->getPixels()), image->getDataSize()
+    );
+
+    if (bytesRead < image->getDataSize())
     {
-        // Appaned a new mipmap and store the offset
-        const MipMapInfo& mipMap = mipMapInfo[i];
-        uint8_t* mipMapBytes = image->addMipMap(mipMap);
-
-        // Read the data into the DDSImage's memory
-        std::size_t bytesRead = stream.read(
-            reinterpret_cast<byteType*>(mipMapBytes), mipMap.size
-        );
-        assert(bytesRead == mipMap.size);
+        // Find out how many complete mipmaps we got
+        std::size_t completeLevels = 0;
+
+        while (completeLevels < image->getLevels() &&
+               image->getMipMapEnd(completeLevels) <= bytesRead)
+        {
+            ++completeLevels;
+        }
+
+        if (completeLevels == 0)
+        {
+            rError() << "DDS file is truncated, no complete image data" << std::endl;
+            return {};
+        }
+
+        rWarning() << "DDS file is truncated, using " << completeLevels
+                   << " of " << image->getLevels() << " mipmaps" << std::endl;
+        image->truncateMipMaps(completeLevels);
     }
 
     return image;
@@ -105,9 +105,6 @@ void Map::loadMapResourceFromLocation(const MapLocation& location)
     rMessage() << "Loading map from " << location.path <<
         (location.isArchive ? " [" + location.archiveRelativePath + "]" : "") << std::endl;
 
-	// Map loading started
-	emitMapEvent(MapLoading);
-
     // Abort any ongoing merge
     abortMergeOperation();
 
@@ -120,6 +117,9 @@ void Map::loadMapResourceFromLocation(const MapLocation& location)
         return;
     }
 
+	// Map loading started, every path from here on emits MapLoaded
+	emitMapEvent(MapLoading);
+
     try
     {
         util::ScopeTimer timer("map load");
@@ -1195,8 +1195,9 @@ void Map::startMergeOperation(const std::string& sourceMap)
     {
         if (sourceMapResource->load())
         {
-            // Compare the scenes and get the report
-            auto result = scene::merge::GraphComparer::Compare(sourceMapResource->getRootNode(), getRoot());
+            // Compare the scenes and get the report, the fingerprints are not leaving this session
+            auto result = scene::merge::GraphComparer::Compare(sourceMapResource->getRootNode(), getRoot(),
+                scene::FingerprintHash::Fast);
 
             // Create the merge actions
             _mergeOperation = scene::merge::MergeOperation::CreateFromComparisonResult(*result);
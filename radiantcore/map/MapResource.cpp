@@ -439,8 +439,7 @@ void MapResource::saveFile(const MapFormat& format, const scene::IMapRootNodePtr
 	rMessage() << "success" << std::endl;
 
 	// Check the total count of nodes to traverse
-	NodeCounter counter;
-	traverse(root, counter);
+	NodeCounter counter(root);
 		
 	// Create our main MapExporter walker, and pass the desired 
 	// format to it. The constructor will prepare the scene
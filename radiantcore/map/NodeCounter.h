@@ -3,34 +3,40 @@
 #include "inode.h"
 #include "ientity.h"
 #include "scenelib.h"
+#include "scene/ParallelTraversal.h"
 
 namespace map
 {
 
-class NodeCounter :
-    public scene::NodeVisitor
+// Counts the primitives and entities below the given root on construction
+class NodeCounter
 {
 private:
     std::size_t _count;
+
 public:
-    NodeCounter() :
-        _count(0)
+    NodeCounter(const scene::INodePtr& root) :
+        _count(scene::foreachNodeParallel<std::size_t>(root, CountNode, Sum))
     {}
 
-    bool pre(const scene::INodePtr& node)
+    std::size_t getCount() const
+    {
+        return _count;
+    }
+
+private:
+    static void CountNode(const scene::INodePtr& node, std::size_t& count)
     {
         if (Node_isPrimitive(node) || Node_isEntity(node))
         {
-            _count++;
+            count++;
         }
-
-        return true;
     }
 
-    std::size_t getCount() const
+    static void Sum(std::size_t& target, std::size_t&& source)
     {
-        return _count;
+        target += source;
     }
 };
 
-}
\ No newline at end of file
+}
@@ -85,9 +85,9 @@ void StaticModelNode::setModel(const StaticModelPtr& model) {
 }
 
 // LitObject test function
-bool StaticModelNode::intersectsLight(const RendererLight& light) const
+const AABB& StaticModelNode::getLitObjectBounds() const
 {
-    return light.lightAABB().intersects(worldAABB());
+    return worldAABB();
 }
 
 void StaticModelNode::renderSolid(RenderableCollector& collector, const VolumeTest& volume) const
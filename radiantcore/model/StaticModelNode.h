@@ -64,6 +64,12 @@ public:
 	// SelectionTestable implementation
 	void testSelect(Selector& selector, SelectionTest& test) override;
 
+	// The surfaces guard their selection hierarchies
+	bool supportsConcurrentSelectionTest() const override
+	{
+		return true;
+	}
+
 	virtual std::string name() const override;
 	Type getNodeType() const override;
 
@@ -71,13 +77,19 @@ public:
 	void setModel(const StaticModelPtr& model);
 
 	// LitObject test function
-	bool intersectsLight(const RendererLight& light) const override;
+	const AABB& getLitObjectBounds() const override;
 
 	// Renderable implementation
   	void renderSolid(RenderableCollector& collector, const VolumeTest& volume) const override;
 	void renderWireframe(RenderableCollector& collector, const VolumeTest& volume) const override;
 	void setRenderSystem(const RenderSystemPtr& renderSystem) override;
 
+	// renderSolid() is only reading from the model
+	bool supportsConcurrentSubmission() const override
+	{
+		return true;
+	}
+
 	std::size_t getHighlightFlags() override
 	{
 		return Highlight::NoHighlight; // models are never highlighted themselves
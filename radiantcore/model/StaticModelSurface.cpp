@@ -7,18 +7,28 @@
 #include "iselectiontest.h"
 #include "irenderable.h"
 #include "gamelib.h"
+#include "render/VBO.h"
 
 #include "string/replace.h"
 
 namespace model
 {
 
+namespace
+{
+	inline const GLvoid* bufferOffset(std::size_t offset)
+	{
+		return reinterpret_cast<const GLvoid*>(offset);
+	}
+}
+
 StaticModelSurface::StaticModelSurface(std::vector<ArbitraryMeshVertex>&& vertices, std::vector<unsigned int>&& indices) :
     _vertices(vertices),
     _indices(indices),
     _dlRegular(0),
     _dlProgramVcol(0),
-    _dlProgramNoVCol(0)
+    _dlProgramNoVCol(0),
+    _sharedGeometry(std::make_shared<SharedGeometry>())
 {
     // Expand the local AABB to include all vertices
     for (const auto& vertex : _vertices)
@@ -38,7 +48,8 @@ StaticModelSurface::StaticModelSurface(const StaticModelSurface& other) :
 	_localAABB(other._localAABB),
 	_dlRegular(0),
 	_dlProgramVcol(0),
-	_dlProgramNoVCol(0)
+	_dlProgramNoVCol(0),
+	_sharedGeometry(other._sharedGeometry)
 {
 	createDisplayLists();
 }
@@ -51,6 +62,13 @@ StaticModelSurface::~StaticModelSurface()
 	glDeleteLists(_dlProgramVcol, 1);
 }
 
+StaticModelSurface::SharedGeometry::~SharedGeometry()
+{
+	// Might be called without a current GL context, the render system deletes them
+	render::deleteVBOLater(vertexBuffer);
+	render::deleteVBOLater(indexBuffer);
+}
+
 // Tangent calculation
 void StaticModelSurface::calculateTangents()
 {
@@ -99,6 +117,93 @@ void StaticModelSurface::render(const RenderInfo& info) const
 	}
 }
 
+const void* StaticModelSurface::getBatchKey() const
+{
+	return _sharedGeometry.get();
+}
+
+std::size_t StaticModelSurface::renderBatch(const RenderInfo& info, const BatchEntry* entries, std::size_t count) const
+{
+	if (_indices.empty()) return 0;
+
+	// The geometry is bound only once for all instances
+	if (_sharedGeometry->vertexBuffer == 0)
+	{
+		_sharedGeometry->vertexBuffer = render::makeVBOFromArray(GL_ARRAY_BUFFER, _vertices);
+		_sharedGeometry->indexBuffer = render::makeVBOFromArray(GL_ELEMENT_ARRAY_BUFFER, _indices);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, _sharedGeometry->vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _sharedGeometry->indexBuffer);
+
+	const GLsizei stride = sizeof(ArbitraryMeshVertex);
+
+	glVertexPointer(3, GL_DOUBLE, stride, bufferOffset(offsetof(ArbitraryMeshVertex, vertex)));
+
+	// Submit the same attributes as the display lists
+	if (info.checkFlag(RENDER_PROGRAM))
+	{
+		glVertexAttribPointer(ATTR_TEXCOORD, 2, GL_DOUBLE, GL_FALSE, stride,
+			bufferOffset(offsetof(ArbitraryMeshVertex, texcoord)));
+		glVertexAttribPointer(ATTR_TANGENT, 3, GL_DOUBLE, GL_FALSE, stride,
+			bufferOffset(offsetof(ArbitraryMeshVertex, tangent)));
+		glVertexAttribPointer(ATTR_BITANGENT, 3, GL_DOUBLE, GL_FALSE, stride,
+			bufferOffset(offsetof(ArbitraryMeshVertex, bitangent)));
+		glVertexAttribPointer(ATTR_NORMAL, 3, GL_DOUBLE, GL_FALSE, stride,
+			bufferOffset(offsetof(ArbitraryMeshVertex, normal)));
+
+		if (info.checkFlag(RENDER_VERTEX_COLOUR))
+		{
+			glEnableClientState(GL_COLOR_ARRAY);
+			glColorPointer(3, GL_DOUBLE, stride, bufferOffset(offsetof(ArbitraryMeshVertex, colour)));
+		}
+	}
+	else
+	{
+		if (info.checkFlag(RENDER_LIGHTING))
+		{
+			glNormalPointer(GL_DOUBLE, stride, bufferOffset(offsetof(ArbitraryMeshVertex, normal)));
+		}
+
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_DOUBLE, stride, bufferOffset(offsetof(ArbitraryMeshVertex, texcoord)));
+	}
+
+	const GLsizei numIndices = static_cast<GLsizei>(_indices.size());
+	std::size_t drawCalls = 0;
+
+	auto instancing = info.getInstancedDrawing();
+
+	if (instancing && instancing->begin(entries, count))
+	{
+		glDrawElementsInstanced(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(count));
+		instancing->end();
+
+		drawCalls = 1;
+	}
+	else
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			glPushMatrix();
+			glMultMatrixd(*entries[i].transform);
+			glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr);
+			glPopMatrix();
+		}
+
+		drawCalls = count;
+	}
+
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+
+	// Other renderables are submitting their data from client memory
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	return drawCalls;
+}
+
 // Construct a list for GLProgram mode, either with or without vertex colour
 GLuint StaticModelSurface::compileProgramList(bool includeColour)
 {
@@ -175,16 +280,25 @@ void StaticModelSurface::testSelect(Selector& selector, SelectionTest& test,
 {
 	if (!_vertices.empty() && !_indices.empty())
 	{
+		VertexPointer vertices(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex));
+
+		// The hierarchy is built once for all copies sharing this geometry
+		auto& geometry = *_sharedGeometry;
+
+		{
+			std::lock_guard<std::mutex> lock(geometry.selectionBVHMutex);
+
+			if (geometry.selectionBVH.empty())
+			{
+				geometry.selectionBVH.build(vertices, IndexPointer(&_indices[0], _indices.size()));
+			}
+		}
+
 		// Test for triangle selection
 		test.BeginMesh(localToWorld, twoSided);
 		SelectionIntersection result;
 
-		test.TestTriangles(
-			VertexPointer(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex)),
-      		IndexPointer(&_indices[0],
-      					 IndexPointer::index_type(_indices.size())),
-			result
-		);
+		geometry.selectionBVH.testSelect(test, localToWorld, vertices, result);
 
 		// Add the intersection to the selector if it is valid
 		if(result.isValid()) {
@@ -328,6 +442,10 @@ void StaticModelSurface::applyScale(const Vector3& scale, const StaticModelSurfa
 	glDeleteLists(_dlProgramVcol, 1);
 
 	createDisplayLists();
+
+	// This surface is no longer sharing the geometry of its copies, the
+	// buffers and the selection hierarchy are rebuilt on the next use
+	_sharedGeometry = std::make_shared<SharedGeometry>();
 }
 
 } // namespace model
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include "GLProgramAttributes.h"
 #include "render.h"
 #include "math/AABB.h"
+#include "selection/TriangleBVH.h"
 
 #include "ishaders.h"
 #include "imodelsurface.h"
@@ -59,6 +62,23 @@ private:
 	GLuint _dlProgramVcol;
     GLuint _dlProgramNoVCol;
 
+	// Copies of a surface keep sharing this until their geometry is changed,
+	// such that the instances of a model are batched together and drawn
+	// from the same buffer objects, which are created on demand.
+	struct SharedGeometry
+	{
+		GLuint vertexBuffer = 0;
+		GLuint indexBuffer = 0;
+
+		// Hierarchy used to speed up selection tests, built on demand.
+		// The copies of a surface can be tested on several threads at once.
+		selection::TriangleBVH selectionBVH;
+		std::mutex selectionBVHMutex;
+
+		~SharedGeometry();
+	};
+	std::shared_ptr<SharedGeometry> _sharedGeometry;
+
 private:
 	// Calculate tangent and bitangent vectors for all vertices.
 	void calculateTangents();
@@ -81,6 +101,10 @@ public:
 	 */
 	void render(const RenderInfo& info) const;
 
+	// Instances are drawn from shared buffer objects
+	const void* getBatchKey() const override;
+	std::size_t renderBatch(const RenderInfo& info, const BatchEntry* entries, std::size_t count) const override;
+
 	/** Get the containing AABB for this surface.
 	 */
 	const AABB& getAABB() const {
@@ -8,6 +8,10 @@
 #include "math/Quaternion.h"
 #include "math/Ray.h"
 #include "MD5DataStructures.h"
+#include "MD5Skinning.h"
+#include "scene/ParallelChunks.h"
+
+#include <algorithm>
 
 namespace md5 {
 
@@ -384,9 +388,55 @@ void MD5Model::updateAnim(std::size_t time)
 	// Update our joint hierarchy first
 	_skeleton.update(_anim, time);
 
+	std::size_t numJoints = 0;
+
+	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	{
+		i->surface->beginSkinning();
+		numJoints = std::max(numJoints, i->surface->getNumSkinningJoints());
+	}
+
+	JointMatrices joints;
+	joints.update(_skeleton, numJoints);
+
+	// Split the surfaces into vertex ranges, which are skinned in parallel
+	constexpr std::size_t VERTICES_PER_RANGE = 1024;
+	static_assert(VERTICES_PER_RANGE % PackedWeights::BLOCK_SIZE == 0, "Ranges must start at a block boundary");
+
+	struct VertexRange
+	{
+		MD5Surface* surface;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	std::vector<VertexRange> ranges;
+
+	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	{
+		std::size_t surfaceVertices = static_cast<std::size_t>(i->surface->getNumVertices());
+
+		for (std::size_t begin = 0; begin < surfaceVertices; begin += VERTICES_PER_RANGE)
+		{
+			ranges.push_back({ i->surface.get(), begin, std::min(begin + VERTICES_PER_RANGE, surfaceVertices) });
+		}
+	}
+
+	// Don't spawn threads for small models, this is about 4096 vertices per thread
+	constexpr std::size_t MIN_RANGES_PER_THREAD = 4;
+
+	scene::parallelForChunks(ranges.size(), MIN_RANGES_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			ranges[i].surface->skinVertices(joints, ranges[i].begin, ranges[i].end);
+		}
+	});
+
+	// Bounds are updated right away, normals and display lists when they're needed
 	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
 	{
-		i->surface->updateToSkeleton(_skeleton);
+		i->surface->updateGeometry();
 	}
 }
 
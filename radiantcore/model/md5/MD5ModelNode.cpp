@@ -67,9 +67,9 @@ bool MD5ModelNode::getIntersection(const Ray& ray, Vector3& intersection)
     return _model->getIntersection(ray, intersection, localToWorld());
 }
 
-bool MD5ModelNode::intersectsLight(const RendererLight& light) const
+const AABB& MD5ModelNode::getLitObjectBounds() const
 {
-    return light.lightAABB().intersects(worldAABB());
+    return worldAABB();
 }
 
 void MD5ModelNode::renderSolid(RenderableCollector& collector, const VolumeTest& volume) const
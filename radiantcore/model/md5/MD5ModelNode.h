@@ -48,7 +48,7 @@ public:
 	bool getIntersection(const Ray& ray, Vector3& intersection) override;
 
 	// LitObject implementation
-	bool intersectsLight(const RendererLight& light) const override;
+	const AABB& getLitObjectBounds() const override;
 
 	// Renderable implementation
 	void renderSolid(RenderableCollector& collector, const VolumeTest& volume) const override;
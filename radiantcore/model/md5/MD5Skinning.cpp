@@ -0,0 +1,219 @@
+#include "MD5Skinning.h"
+
+#include <algorithm>
+#include <cassert>
+#include "MD5Skeleton.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MD5_SKINNING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace md5
+{
+
+void JointMatrices::update(const MD5Skeleton& skeleton, std::size_t minJoints)
+{
+	resize(skeleton.size(), minJoints);
+
+	for (std::size_t i = 0; i < skeleton.size(); ++i)
+	{
+		const IMD5Anim::Key& key = skeleton.getKey(i);
+		set(i, key.orientation, key.origin);
+	}
+}
+
+void JointMatrices::update(const MD5Joints& joints, std::size_t minJoints)
+{
+	resize(joints.size(), minJoints);
+
+	for (std::size_t i = 0; i < joints.size(); ++i)
+	{
+		set(i, joints[i].rotation, joints[i].position);
+	}
+}
+
+void JointMatrices::resize(std::size_t numJoints, std::size_t minJoints)
+{
+	// Joints without a transform are collapsing the vertices to the origin
+	_rows.assign(std::max({ numJoints, minJoints, std::size_t(1) }) * FLOATS_PER_JOINT, 0.0f);
+}
+
+void JointMatrices::set(std::size_t index, const Quaternion& rotation, const Vector3& origin)
+{
+	// Same terms as in Quaternion::transformPoint, which doesn't require a unit quaternion
+	double xx = rotation.x() * rotation.x();
+	double yy = rotation.y() * rotation.y();
+	double zz = rotation.z() * rotation.z();
+	double ww = rotation.w() * rotation.w();
+
+	double xy2 = rotation.x() * rotation.y() * 2;
+	double xz2 = rotation.x() * rotation.z() * 2;
+	double xw2 = rotation.x() * rotation.w() * 2;
+	double yz2 = rotation.y() * rotation.z() * 2;
+	double yw2 = rotation.y() * rotation.w() * 2;
+	double zw2 = rotation.z() * rotation.w() * 2;
+
+	const double rows[FLOATS_PER_JOINT] =
+	{
+		ww + xx - yy - zz, xy2 - zw2, xz2 + yw2, origin.x(),
+		xy2 + zw2, ww - xx + yy - zz, yz2 - xw2, origin.y(),
+		xz2 - yw2, yz2 + xw2, ww - xx - yy + zz, origin.z(),
+	};
+
+	float* target = _rows.data() + index * FLOATS_PER_JOINT;
+
+	for (std::size_t i = 0; i < FLOATS_PER_JOINT; ++i)
+	{
+		target[i] = static_cast<float>(rows[i]);
+	}
+}
+
+PackedWeights::PackedWeights() :
+	_numVertices(0),
+	_numJoints(0)
+{}
+
+void PackedWeights::build(const MD5Mesh& mesh)
+{
+	_numVertices = mesh.vertices.size();
+	_numJoints = 0;
+
+	std::size_t numBlocks = (_numVertices + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	_blockSlots.assign(1, 0);
+	_blockSlots.reserve(numBlocks + 1);
+
+	for (std::size_t block = 0; block < numBlocks; ++block)
+	{
+		std::size_t numSlots = 0;
+
+		for (std::size_t v = block * BLOCK_SIZE; v < std::min((block + 1) * BLOCK_SIZE, _numVertices); ++v)
+		{
+			numSlots = std::max(numSlots, mesh.vertices[v].weight_count);
+		}
+
+		_blockSlots.push_back(_blockSlots.back() + numSlots);
+	}
+
+	// Padding elements are null weights referring to the first joint
+	std::size_t numElements = _blockSlots.back() * BLOCK_SIZE;
+
+	_x.assign(numElements, 0.0f);
+	_y.assign(numElements, 0.0f);
+	_z.assign(numElements, 0.0f);
+	_t.assign(numElements, 0.0f);
+	_joints.assign(numElements, 0);
+
+	for (std::size_t v = 0; v < _numVertices; ++v)
+	{
+		const MD5Vert& vert = mesh.vertices[v];
+		std::size_t firstSlot = _blockSlots[v / BLOCK_SIZE];
+		std::size_t lane = v % BLOCK_SIZE;
+
+		for (std::size_t k = 0; k < vert.weight_count; ++k)
+		{
+			const MD5Weight& weight = mesh.weights[vert.weight_index + k];
+			std::size_t element = (firstSlot + k) * BLOCK_SIZE + lane;
+
+			_x[element] = static_cast<float>(weight.v.x());
+			_y[element] = static_cast<float>(weight.v.y());
+			_z[element] = static_cast<float>(weight.v.z());
+			_t[element] = weight.t;
+			_joints[element] = static_cast<std::uint32_t>(weight.joint);
+
+			_numJoints = std::max(_numJoints, weight.joint + 1);
+		}
+	}
+}
+
+void PackedWeights::skinVertices(const JointMatrices& joints, std::size_t begin, std::size_t end,
+	std::vector<ArbitraryMeshVertex>& vertices) const
+{
+	assert(begin % BLOCK_SIZE == 0);
+	assert(end <= _numVertices && vertices.size() >= _numVertices);
+	assert(joints.size() >= _numJoints && joints.size() > 0);
+
+	for (std::size_t block = begin / BLOCK_SIZE; block * BLOCK_SIZE < end; ++block)
+	{
+		float outX[BLOCK_SIZE];
+		float outY[BLOCK_SIZE];
+		float outZ[BLOCK_SIZE];
+
+#ifdef MD5_SKINNING_USE_SSE2
+		__m128 sumX = _mm_setzero_ps();
+		__m128 sumY = _mm_setzero_ps();
+		__m128 sumZ = _mm_setzero_ps();
+
+		for (std::size_t slot = _blockSlots[block]; slot < _blockSlots[block + 1]; ++slot)
+		{
+			std::size_t element = slot * BLOCK_SIZE;
+
+			const float* joint0 = joints.getJoint(_joints[element]);
+			const float* joint1 = joints.getJoint(_joints[element + 1]);
+			const float* joint2 = joints.getJoint(_joints[element + 2]);
+			const float* joint3 = joints.getJoint(_joints[element + 3]);
+
+			__m128 x = _mm_loadu_ps(_x.data() + element);
+			__m128 y = _mm_loadu_ps(_y.data() + element);
+			__m128 z = _mm_loadu_ps(_z.data() + element);
+			__m128 t = _mm_loadu_ps(_t.data() + element);
+
+			// Transposing one matrix row of the four joints yields
+			// the three rotation coefficients and the translation
+			__m128 result[3];
+
+			for (std::size_t row = 0; row < 3; ++row)
+			{
+				__m128 a = _mm_loadu_ps(joint0 + row * 4);
+				__m128 b = _mm_loadu_ps(joint1 + row * 4);
+				__m128 c = _mm_loadu_ps(joint2 + row * 4);
+				__m128 d = _mm_loadu_ps(joint3 + row * 4);
+
+				_MM_TRANSPOSE4_PS(a, b, c, d);
+
+				result[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)),
+					_mm_add_ps(_mm_mul_ps(c, z), d));
+			}
+
+			sumX = _mm_add_ps(sumX, _mm_mul_ps(result[0], t));
+			sumY = _mm_add_ps(sumY, _mm_mul_ps(result[1], t));
+			sumZ = _mm_add_ps(sumZ, _mm_mul_ps(result[2], t));
+		}
+
+		_mm_storeu_ps(outX, sumX);
+		_mm_storeu_ps(outY, sumY);
+		_mm_storeu_ps(outZ, sumZ);
+#else
+		for (std::size_t lane = 0; lane < BLOCK_SIZE; ++lane)
+		{
+			outX[lane] = outY[lane] = outZ[lane] = 0;
+		}
+
+		for (std::size_t slot = _blockSlots[block]; slot < _blockSlots[block + 1]; ++slot)
+		{
+			for (std::size_t lane = 0; lane < BLOCK_SIZE; ++lane)
+			{
+				std::size_t element = slot * BLOCK_SIZE + lane;
+				const float* m = joints.getJoint(_joints[element]);
+
+				float x = _x[element];
+				float y = _y[element];
+				float z = _z[element];
+				float t = _t[element];
+
+				outX[lane] += (m[0] * x + m[1] * y + m[2] * z + m[3]) * t;
+				outY[lane] += (m[4] * x + m[5] * y + m[6] * z + m[7]) * t;
+				outZ[lane] += (m[8] * x + m[9] * y + m[10] * z + m[11]) * t;
+			}
+		}
+#endif
+
+		for (std::size_t lane = 0; lane < BLOCK_SIZE && block * BLOCK_SIZE + lane < end; ++lane)
+		{
+			vertices[block * BLOCK_SIZE + lane].vertex = Vertex3f(outX[lane], outY[lane], outZ[lane]);
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "render/ArbitraryMeshVertex.h"
+
+#include "MD5DataStructures.h"
+
+namespace md5
+{
+
+class MD5Skeleton;
+
+/**
+ * The joint transforms of a skeleton pose in single precision. Each joint
+ * is stored as the three rows of a 3x4 matrix (rotation and translation),
+ * such that the transforms of several joints can be loaded and transposed
+ * into SIMD registers by the skinning code.
+ */
+class JointMatrices
+{
+public:
+	static constexpr std::size_t FLOATS_PER_JOINT = 12;
+
+private:
+	std::vector<float> _rows;
+
+public:
+	// Set up the transforms of the given animated skeleton. The array is filled up with
+	// null transforms up to the given number of joints, there is always at least one joint.
+	void update(const MD5Skeleton& skeleton, std::size_t minJoints);
+
+	// Set up the transforms of the bind pose defined in the .md5mesh file
+	void update(const MD5Joints& joints, std::size_t minJoints);
+
+	std::size_t size() const
+	{
+		return _rows.size() / FLOATS_PER_JOINT;
+	}
+
+	const float* getJoint(std::size_t index) const
+	{
+		return _rows.data() + index * FLOATS_PER_JOINT;
+	}
+
+private:
+	void resize(std::size_t numJoints, std::size_t minJoints);
+	void set(std::size_t index, const Quaternion& rotation, const Vector3& origin);
+};
+
+/**
+ * The weights of an MD5 mesh, rearranged for skinning four vertices at once.
+ *
+ * The vertices are grouped into blocks of BLOCK_SIZE. Each block has as many
+ * weight slots as the vertex with the most weights in it, every slot holds
+ * one weight per vertex in structure-of-arrays layout. Vertices with fewer
+ * weights are padded with null weights.
+ */
+class PackedWeights
+{
+public:
+	static constexpr std::size_t BLOCK_SIZE = 4;
+
+private:
+	std::size_t _numVertices;
+
+	// One more than the highest referenced joint index
+	std::size_t _numJoints;
+
+	// The first slot of each block, followed by the total number of slots
+	std::vector<std::size_t> _blockSlots;
+
+	// The weight data, BLOCK_SIZE elements per slot
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+	std::vector<float> _t;
+	std::vector<std::uint32_t> _joints;
+
+public:
+	PackedWeights();
+
+	void build(const MD5Mesh& mesh);
+
+	std::size_t getNumVertices() const
+	{
+		return _numVertices;
+	}
+
+	// The number of joints the given JointMatrices need to provide
+	std::size_t getNumJoints() const
+	{
+		return _numJoints;
+	}
+
+	/**
+	 * Calculates the positions of the vertices in the range [begin, end) and
+	 * writes them to the given array. The begin index must be a multiple of
+	 * BLOCK_SIZE. Different ranges can be processed by several threads at once.
+	 */
+	void skinVertices(const JointMatrices& joints, std::size_t begin, std::size_t end,
+		std::vector<ArbitraryMeshVertex>& vertices) const;
+};
+typedef std::shared_ptr<PackedWeights> PackedWeightsPtr;
+
+} // namespace
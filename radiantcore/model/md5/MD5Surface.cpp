@@ -18,16 +18,26 @@ inline VertexPointer vertexpointer_arbitrarymeshvertex(const ArbitraryMeshVertex
 MD5Surface::MD5Surface() :
 	_originalShaderName(""),
 	_mesh(new MD5Mesh),
+	_packedWeights(new PackedWeights),
 	_normalList(0),
-	_lightingList(0)
+	_lightingList(0),
+	_normalsChanged(true),
+	_tangentsChanged(true),
+	_normalListChanged(true),
+	_lightingListChanged(true)
 {}
 
 MD5Surface::MD5Surface(const MD5Surface& other) :
 	_aabb_local(other._aabb_local),
 	_originalShaderName(other._originalShaderName),
 	_mesh(other._mesh),
+	_packedWeights(other._packedWeights),
 	_normalList(0),
-	_lightingList(0)
+	_lightingList(0),
+	_normalsChanged(true),
+	_tangentsChanged(true),
+	_normalListChanged(true),
+	_lightingListChanged(true)
 {}
 
 // Destructor
@@ -46,6 +56,35 @@ void MD5Surface::updateGeometry()
 		_aabb_local.includePoint(i->vertex);
 	}
 
+	_normalsChanged = true;
+	_tangentsChanged = true;
+	_normalListChanged = true;
+	_lightingListChanged = true;
+}
+
+void MD5Surface::updateNormalsAndTangents()
+{
+	if (_normalsChanged)
+	{
+		_normalsChanged = false;
+		buildVertexNormals();
+	}
+
+	if (_tangentsChanged)
+	{
+		_tangentsChanged = false;
+		buildVertexTangents();
+	}
+}
+
+void MD5Surface::buildVertexTangents()
+{
+	for (Vertices::iterator i = _vertices.begin(); i != _vertices.end(); ++i)
+	{
+		i->tangent = Normal3f(0, 0, 0);
+		i->bitangent = Normal3f(0, 0, 0);
+	}
+
 	for (Indices::iterator i = _indices.begin();
 		 i != _indices.end();
 		 i += 3)
@@ -64,29 +103,52 @@ void MD5Surface::updateGeometry()
 		i->tangent.normalise();
 		i->bitangent.normalise();
 	}
-
-	// Build the display lists
-	createDisplayLists();
 }
 
 // Back-end render
 void MD5Surface::render(const RenderInfo& info) const
 {
+	// The display lists are rebuilt on demand, such that animated surfaces
+	// only get their normals and tangents calculated for the modes they're drawn in
+	auto& self = const_cast<MD5Surface&>(*this);
+
 	if (info.checkFlag(RENDER_BUMP))
     {
+		if (_lightingListChanged)
+		{
+			self.updateNormalsAndTangents();
+			self.createLightingList();
+		}
+
 		glCallList(_lightingList);
 	}
 	else
     {
+		if (_normalListChanged)
+		{
+			// Tangents are not used by this list
+			if (_normalsChanged)
+			{
+				self._normalsChanged = false;
+				self.buildVertexNormals();
+			}
+
+			self.createNormalList();
+		}
+
 		glCallList(_normalList);
 	}
 }
 
-// Construct the display lists
-void MD5Surface::createDisplayLists()
+// Construct the display list for lighting mode
+void MD5Surface::createLightingList()
 {
-    // Release old display lists first
-    releaseDisplayLists();
+	_lightingListChanged = false;
+
+	if (_lightingList != 0)
+	{
+		glDeleteLists(_lightingList, 1);
+	}
 
 	// Create the list for lighting mode
 	_lightingList = glGenLists(1);
@@ -114,6 +176,17 @@ void MD5Surface::createDisplayLists()
 	glEnd();
 
 	glEndList();
+}
+
+// Construct the display list for flat-shaded (unlit) mode
+void MD5Surface::createNormalList()
+{
+	_normalListChanged = false;
+
+	if (_normalList != 0)
+	{
+		glDeleteLists(_normalList, 1);
+	}
 
 	// Generate the list for flat-shaded (unlit) mode
 	_normalList = glGenLists(1);
@@ -152,6 +225,9 @@ void MD5Surface::releaseDisplayLists()
         glDeleteLists(_lightingList, 1);
         _lightingList = 0;
     }
+
+    _normalListChanged = true;
+    _lightingListChanged = true;
 }
 
 // Selection test
@@ -236,6 +312,8 @@ int MD5Surface::getNumTriangles() const
 const ArbitraryMeshVertex& MD5Surface::getVertex(int vertexIndex) const
 {
 	assert(vertexIndex >= 0 && vertexIndex < static_cast<int>(_vertices.size()));
+
+	const_cast<MD5Surface&>(*this).updateNormalsAndTangents();
 	return _vertices[vertexIndex];
 }
 
@@ -243,6 +321,8 @@ model::ModelPolygon MD5Surface::getPolygon(int polygonIndex) const
 {
 	assert(polygonIndex >= 0 && polygonIndex*3 < static_cast<int>(_indices.size()));
 
+	const_cast<MD5Surface&>(*this).updateNormalsAndTangents();
+
 	model::ModelPolygon poly;
 
 	poly.a = _vertices[_indices[polygonIndex*3]];
@@ -254,6 +334,7 @@ model::ModelPolygon MD5Surface::getPolygon(int polygonIndex) const
 
 const std::vector<ArbitraryMeshVertex>& MD5Surface::getVertexArray() const
 {
+	const_cast<MD5Surface&>(*this).updateNormalsAndTangents();
 	return _vertices;
 }
 
@@ -279,70 +360,35 @@ void MD5Surface::setActiveMaterial(const std::string& activeMaterial)
 
 void MD5Surface::updateToDefaultPose(const MD5Joints& joints)
 {
-	if (_vertices.size() != _mesh->vertices.size())
-	{
-		_vertices.resize(_mesh->vertices.size());
-	}
-
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
-	{
-		MD5Vert& vert = _mesh->vertices[j];
-
-		Vector3 skinned(0, 0, 0);
-
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
-		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const MD5Joint& joint = joints[weight.joint];
-
-			Vector3 rotatedPoint = joint.rotation.transformPoint(weight.v);
-			skinned += (rotatedPoint + joint.position) * weight.t;
-		}
-
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
-	}
+	JointMatrices matrices;
+	matrices.update(joints, getNumSkinningJoints());
 
-	// Ensure the index array is ok
-	if (_indices.empty())
-	{
-		buildIndexArray();
-	}
+	beginSkinning();
+	skinVertices(matrices, 0, _vertices.size());
+	updateGeometry();
+}
 
-	buildVertexNormals();
+void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
+{
+	JointMatrices matrices;
+	matrices.update(skeleton, getNumSkinningJoints());
 
+	beginSkinning();
+	skinVertices(matrices, 0, _vertices.size());
 	updateGeometry();
 }
 
-void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
+void MD5Surface::beginSkinning()
 {
-	// Ensure we have all vertices allocated
+	// Ensure we have all vertices allocated, the texture coordinates stay the same
 	if (_vertices.size() != _mesh->vertices.size())
 	{
 		_vertices.resize(_mesh->vertices.size());
-	}
-
-	// Deform vertices to fit the skeleton
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
-	{
-		MD5Vert& vert = _mesh->vertices[j];
-
-		Vector3 skinned(0, 0, 0);
 
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
+		for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
 		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const IMD5Anim::Key& key = skeleton.getKey(weight.joint);
-			//const Joint& joint = skeleton.getJoint(weight.joint);
-
-			Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
-			skinned += (rotatedPoint + key.origin) * weight.t;
+			_vertices[j].texcoord = TexCoord2f(_mesh->vertices[j].u, _mesh->vertices[j].v);
 		}
-
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
 	}
 
 	// Ensure the index array is ok
@@ -351,13 +397,30 @@ void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
 		buildIndexArray();
 	}
 
-	buildVertexNormals();
+	// The weights need to be in sync with the mesh
+	if (_packedWeights->getNumVertices() != _mesh->vertices.size())
+	{
+		_packedWeights->build(*_mesh);
+	}
+}
+
+void MD5Surface::skinVertices(const JointMatrices& joints, std::size_t begin, std::size_t end)
+{
+	_packedWeights->skinVertices(joints, begin, std::min(end, _vertices.size()), _vertices);
+}
 
-	updateGeometry();
+std::size_t MD5Surface::getNumSkinningJoints() const
+{
+	return _packedWeights->getNumJoints();
 }
 
 void MD5Surface::buildVertexNormals()
 {
+	for (Vertices::iterator j = _vertices.begin(); j != _vertices.end(); ++j)
+	{
+		j->normal = Normal3f(0, 0, 0);
+	}
+
 	for (Indices::iterator j = _indices.begin(); j != _indices.end(); j += 3)
 	{
 		ArbitraryMeshVertex& a = _vertices[*(j + 0)];
@@ -487,6 +550,9 @@ void MD5Surface::parseFromTokens(parser::DefTokeniser& tok)
 	// ----- END OF MESH DECL -----
 
 	tok.assertNextToken("}");
+
+	// Arrange the parsed weights for skinning
+	_packedWeights->build(mesh);
 }
 
 } // namespace md5
@@ -10,6 +10,7 @@
 #include "imodelsurface.h"
 
 #include "MD5DataStructures.h"
+#include "MD5Skinning.h"
 #include "parser/DefTokeniser.h"
 
 class Ray;
@@ -40,6 +41,9 @@ private:
 	// Several MD5Surfaces can share the same mesh
 	MD5MeshPtr _mesh;
 
+	// The mesh weights arranged for skinning, shared along with the mesh
+	PackedWeightsPtr _packedWeights;
+
 	// Our render data
 	Vertices _vertices;
 	Indices _indices;
@@ -48,10 +52,21 @@ private:
 	GLuint _normalList;
 	GLuint _lightingList;
 
+	// The vectors and display lists derived from the vertex positions are
+	// only updated when they are actually needed, these flags are set
+	// whenever the positions are changing.
+	bool _normalsChanged;
+	bool _tangentsChanged;
+	bool _normalListChanged;
+	bool _lightingListChanged;
+
 private:
 
-	// Create the display lists
-	void createDisplayLists();
+	// Create the display list for the flat-shaded (unlit) mode
+	void createNormalList();
+
+	// Create the display list for the lighting mode
+	void createLightingList();
 
     // Frees any display list in use
     void releaseDisplayLists();
@@ -59,6 +74,12 @@ private:
 	// Re-calculate the normal vectors
 	void buildVertexNormals();
 
+	// Re-calculate the tangent and bitangent vectors
+	void buildVertexTangents();
+
+	// Bring the normals and tangents up to date, if the vertices have been changed
+	void updateNormalsAndTangents();
+
 public:
 
 	/**
@@ -80,7 +101,8 @@ public:
 	void setDefaultMaterial(const std::string& name);
 	
 	/**
-	 * Calculate the AABB and build the display lists for rendering.
+	 * Calculate the AABB after the vertices have been changed. Normals, tangents
+	 * and display lists are rebuilt on demand, when they're requested next time.
 	 */
 	void updateGeometry();
 
@@ -91,6 +113,19 @@ public:
 	// Updates this mesh to the state of the given skeleton
 	void updateToSkeleton(const MD5Skeleton& skeleton);
 
+	/**
+	 * Skinning in several steps, used by MD5Model to distribute the work
+	 * across threads: beginSkinning() prepares the vertex array, after which
+	 * skinVertices() can be called for separate vertex ranges concurrently.
+	 * Any range must start at a multiple of PackedWeights::BLOCK_SIZE.
+	 * updateGeometry() completes the update.
+	 */
+	void beginSkinning();
+	void skinVertices(const JointMatrices& joints, std::size_t begin, std::size_t end);
+
+	// The number of joints the JointMatrices passed to skinVertices() need to provide
+	std::size_t getNumSkinningJoints() const;
+
 	// Applies the given Skin to this surface.
 	void applySkin(const ModelSkin& skin);
 
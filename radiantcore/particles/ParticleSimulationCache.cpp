@@ -0,0 +1,113 @@
+#include "ParticleSimulationCache.h"
+
+#include <algorithm>
+#include <functional>
+#include "math/Hash.h"
+
+namespace particles
+{
+
+bool ParticleSimulationCache::Key::operator==(const Key& other) const
+{
+	return stage == other.stage && bunchIndex == other.bunchIndex && seed == other.seed &&
+		time == other.time && viewRotation == other.viewRotation &&
+		direction == other.direction && entityColour == other.entityColour;
+}
+
+std::size_t ParticleSimulationCache::KeyHash::operator()(const Key& key) const
+{
+	// The view rotation is the same for most entries of a frame, it's left to operator==
+	std::size_t hash = std::hash<const IStageDef*>()(key.stage);
+
+	math::combineHash(hash, key.bunchIndex);
+	math::combineHash(hash, static_cast<std::size_t>(key.seed));
+	math::combineHash(hash, key.time);
+	math::combineHash(hash, math::hashVector3(key.direction, 3));
+
+	return hash;
+}
+
+ParticleSimulationCache::ParticleSimulationCache() :
+	_results(MAX_QUADS, [](const std::shared_ptr<Quads>& quads)
+	{
+		// Empty results are counted as well, to limit the number of entries
+		return std::max<std::size_t>(quads->size(), 1);
+	},
+	[this](std::shared_ptr<Quads>&& quads)
+	{
+		recycle(std::move(quads));
+	})
+{}
+
+ParticleSimulationCache::QuadsPtr ParticleSimulationCache::find(const Key& key)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	auto cached = _results.find(key);
+
+	return cached != nullptr ? *cached : QuadsPtr();
+}
+
+std::shared_ptr<ParticleSimulationCache::Quads> ParticleSimulationCache::acquireBuffer()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	if (_freeBuffers.empty())
+	{
+		return std::make_shared<Quads>();
+	}
+
+	auto buffer = std::move(_freeBuffers.back());
+	_freeBuffers.pop_back();
+
+	return buffer;
+}
+
+ParticleSimulationCache::QuadsPtr ParticleSimulationCache::insert(const Key& key, const std::shared_ptr<Quads>& quads)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// Keeps the existing entry if another thread has been faster
+	auto cached = _results.insert(key, std::shared_ptr<Quads>(quads));
+
+	// Results exceeding the limit on their own are not cached
+	return cached != nullptr ? *cached : quads;
+}
+
+std::size_t ParticleSimulationCache::getHitCount() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _results.getHitCount();
+}
+
+std::size_t ParticleSimulationCache::getMissCount() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _results.getMissCount();
+}
+
+void ParticleSimulationCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_results.clear();
+	_freeBuffers.clear();
+}
+
+ParticleSimulationCache& ParticleSimulationCache::Instance()
+{
+	static ParticleSimulationCache _instance;
+	return _instance;
+}
+
+void ParticleSimulationCache::recycle(std::shared_ptr<Quads>&& quads)
+{
+	// Buffers still referenced by a bunch can't be touched
+	if (quads.use_count() == 1 && _freeBuffers.size() < MAX_FREE_BUFFERS)
+	{
+		quads->clear();
+		_freeBuffers.emplace_back(std::move(quads));
+	}
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "iparticlestage.h"
+#include "math/Matrix4.h"
+#include "math/Vector2.h"
+#include "math/Vector3.h"
+#include "math/Vector4.h"
+#include "ParticleRenderInfo.h"
+#include "ParticleQuad.h"
+#include "util/LRUCache.h"
+
+namespace particles
+{
+
+/**
+ * Keeps the quads recently generated by particle bunches, such that bunches
+ * with the same input share one copy of their geometry. This is the case for
+ * all emitters of the same particle def facing the same direction, for an
+ * emitter rendered in several views, or while the render time is paused.
+ *
+ * The least recently used results are dropped when the total number of
+ * cached quads exceeds the limit. Their buffers are recycled for the next
+ * simulations.
+ *
+ * All methods can be called from several threads at once.
+ */
+class ParticleSimulationCache
+{
+public:
+	typedef std::vector<ParticleQuad> Quads;
+	typedef std::shared_ptr<const Quads> QuadsPtr;
+
+	// Everything a bunch simulation depends on
+	struct Key
+	{
+		const IStageDef* stage;
+		std::size_t bunchIndex;
+		Rand48::result_type seed;
+		std::size_t time;
+		Matrix4 viewRotation;
+		Vector3 direction;
+		Vector3 entityColour;
+
+		bool operator==(const Key& other) const;
+	};
+
+private:
+	// The upper limit of the cached quads (about 25 MB)
+	static constexpr std::size_t MAX_QUADS = 1 << 16;
+
+	// The upper limit of the buffers kept around for recycling
+	static constexpr std::size_t MAX_FREE_BUFFERS = 256;
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const;
+	};
+
+	util::LRUCache<Key, std::shared_ptr<Quads>, KeyHash> _results;
+
+	// Empty buffers, ready to be reused
+	std::vector<std::shared_ptr<Quads>> _freeBuffers;
+
+	mutable std::mutex _lock;
+
+public:
+	ParticleSimulationCache();
+
+	// Returns the cached quads for the given input, or NULL
+	QuadsPtr find(const Key& key);
+
+	// Returns an empty buffer to generate quads into
+	std::shared_ptr<Quads> acquireBuffer();
+
+	/**
+	 * Stores the quads generated for the given input and returns the cached
+	 * quads. These are different from the passed ones if another thread
+	 * has stored a result for the same input in the meantime.
+	 */
+	QuadsPtr insert(const Key& key, const std::shared_ptr<Quads>& quads);
+
+	// Number of find() calls returning a cached result / returning NULL
+	std::size_t getHitCount() const;
+	std::size_t getMissCount() const;
+
+	void clear();
+
+	static ParticleSimulationCache& Instance();
+
+private:
+	// Moves the buffer of a dropped result to the free list, unless it's used somewhere else
+	void recycle(std::shared_ptr<Quads>&& quads);
+};
+
+}
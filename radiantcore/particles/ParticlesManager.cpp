@@ -4,6 +4,7 @@
 #include "StageDef.h"
 #include "ParticleNode.h"
 #include "RenderableParticle.h"
+#include "ParticleSimulationCache.h"
 
 #include "icommandsystem.h"
 #include "ieventmanager.h"
@@ -112,6 +113,16 @@ IRenderableParticlePtr ParticlesManager::getRenderableParticle(const std::string
 	}
 }
 
+std::size_t ParticlesManager::getSimulationCacheHitCount() const
+{
+	return ParticleSimulationCache::Instance().getHitCount();
+}
+
+std::size_t ParticlesManager::getSimulationCacheMissCount() const
+{
+	return ParticleSimulationCache::Instance().getMissCount();
+}
+
 IParticleDefPtr ParticlesManager::findOrInsertParticleDef(const std::string& name)
 {
     ensureDefsLoaded();
@@ -42,6 +42,9 @@ public:
     IRenderableParticlePtr getRenderableParticle(const std::string& name) override;
     IParticleNodePtr createParticleNode(const std::string& name) override;
 
+	std::size_t getSimulationCacheHitCount() const override;
+	std::size_t getSimulationCacheMissCount() const override;
+
 	void reloadParticleDefs() override;
 
 	void saveParticleDef(const std::string& particle) override;
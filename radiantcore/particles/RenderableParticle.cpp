@@ -1,11 +1,14 @@
 #include "RenderableParticle.h"
 
+#include <functional>
+#include "ParticleSimulationCache.h"
+
 namespace particles
 {
 
 RenderableParticle::RenderableParticle(const IParticleDefPtr& particleDef) :
 	_particleDef(), // don't initialise the ptr yet
-	_random(rand()), // use a random seed
+	_random(), // seeded in setupStages()
 	_direction(0,0,1), // default direction
 	_entityColour(1,1,1) // default entity colour
 {
@@ -31,9 +34,6 @@ void RenderableParticle::update(const Matrix4& viewRotation)
 	// Invalidate our bounds information
 	_bounds = AABB();
 
-	// Make sure all shaders are constructed
-	ensureShaders(*renderSystem);
-
 	// greebo: Use the inverse matrix of the incoming matrix, this is enough to compensate
 	// the camera rotation.
 	Matrix4 invViewRotation = viewRotation.getInverse();
@@ -92,6 +92,13 @@ void RenderableParticle::renderWireframe(RenderableCollector& collector, const V
 void RenderableParticle::setRenderSystem(const RenderSystemPtr& renderSystem)
 {
 	_renderSystem = renderSystem;
+
+	// Capture the shaders right away, such that update() only needs to
+	// simulate the stages
+	if (renderSystem)
+	{
+		ensureShaders(*renderSystem);
+	}
 }
 
 const IParticleDefPtr& RenderableParticle::getParticleDef() const
@@ -112,7 +119,7 @@ void RenderableParticle::setParticleDef(const IParticleDefPtr& def)
 	{
 		// Start monitoring this particle for reload events
 		_defConnection = _particleDef->signal_changed().connect(
-            sigc::mem_fun(this, &RenderableParticle::setupStages)
+            sigc::mem_fun(this, &RenderableParticle::onParticleDefChanged)
         );
 	}
 
@@ -159,13 +166,26 @@ void RenderableParticle::calculateBounds()
 	}
 }
 
-// Sort stages into groups sharing a material, without capturing the shader yet
+void RenderableParticle::onParticleDefChanged()
+{
+	// The stage defs have been modified in place, cached quads are outdated
+	ParticleSimulationCache::Instance().clear();
+
+	setupStages();
+}
+
+// Sort stages into groups sharing a material, shaders are captured if a rendersystem is set
 void RenderableParticle::setupStages()
 {
 	_shaderMap.clear();
 
 	if (_particleDef == NULL) return; // nothing to do.
 
+	// All emitters of this def get the same bunch seeds, which stay the same
+	// when the def is modified. Emitters facing the same direction at the
+	// same time look identical and are sharing one simulation.
+	_random.seed(static_cast<Rand48::result_type>(std::hash<std::string>()(_particleDef->getName())));
+
 	for (std::size_t i = 0; i < _particleDef->getNumStages(); ++i)
 	{
 		const IStageDef& stage = _particleDef->getStage(i);
@@ -181,6 +201,13 @@ void RenderableParticle::setupStages()
 		RenderableParticleStagePtr renderableStage(new RenderableParticleStage(stage, _random, _direction, _entityColour));
 		_shaderMap[materialName].stages.push_back(renderableStage);
 	}
+
+	RenderSystemPtr renderSystem = _renderSystem.lock();
+
+	if (renderSystem)
+	{
+		ensureShaders(*renderSystem);
+	}
 }
 
 // Capture all shaders, if necessary
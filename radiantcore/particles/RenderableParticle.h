@@ -39,6 +39,8 @@ class RenderableParticle : public IRenderableParticle,
 	// The random number generator, this is used to generate "constant"
 	// starting values for each bunch of particles. This enables us
 	// to go back in time when rendering the particle stage.
+	// It is seeded from the particle def name, such that all emitters
+	// of the same def can share their simulation results.
 	Rand48 _random;
 
 	// The particle direction, usually set by the emitter entity or the preview
@@ -90,9 +92,12 @@ public:
 private:
 	void calculateBounds();
 
-	// Sort stages into groups sharing a material, without capturing the shader yet
+	// Sort stages into groups sharing a material, shaders are captured if a rendersystem is set
 	void setupStages();
 
+	// Invoked when the particle def has been modified
+	void onParticleDefChanged();
+
 	// Capture all shaders, if necessary
 	void ensureShaders(RenderSystem& renderSystem);
 };
@@ -2,6 +2,7 @@
 
 #include "itextstream.h"
 #include "math/pi.h"
+#include "ParticleSimulationCache.h"
 
 #include "string/string.h"
 
@@ -13,7 +14,6 @@ RenderableParticleBunch::RenderableParticleBunch(std::size_t index,
     const Vector3& direction, const Vector3& entityColour) :
     _index(index),
     _stage(stage),
-    _quads(),
     _randSeed(randSeed),
     _distributeParticlesRandomly(_stage.getRandomDistribution()),
     _offset(_stage.getOffset()),
@@ -27,8 +27,33 @@ RenderableParticleBunch::RenderableParticleBunch(std::size_t index,
 void RenderableParticleBunch::update(std::size_t time)
 {
     _bounds = AABB();
-    _quads.clear();
 
+    // The simulation is fully defined by these values, all emitters
+    // of the same particle def are producing the same quads
+    ParticleSimulationCache::Key key
+    {
+        &_stage, _index, _randSeed, time, _viewRotation, _direction, _entityColour
+    };
+
+    auto& cache = ParticleSimulationCache::Instance();
+
+    _quads = cache.find(key);
+
+    if (_quads)
+    {
+        return;
+    }
+
+    _buffer = cache.acquireBuffer();
+
+    generateQuads(time);
+
+    _quads = cache.insert(key, _buffer);
+    _buffer.reset();
+}
+
+void RenderableParticleBunch::generateQuads(std::size_t time)
+{
     // Length of one cycle (duration + deadtime)
     std::size_t cycleMsec = static_cast<std::size_t>(_stage.getCycleMsec());
 
@@ -38,7 +63,7 @@ void RenderableParticleBunch::update(std::size_t time)
     }
 
     // Reserve enough space for all the particles (non-animated case)
-    _quads.reserve(_stage.getCount() * 4);
+    _buffer->reserve(_stage.getCount() * 4);
 
     // Normalise the global input time into local cycle time
     // The cycleTime may be larger than the _stage.cycleMsec argument if bunching is turned off
@@ -153,17 +178,17 @@ void RenderableParticleBunch::update(std::size_t time)
 
 void RenderableParticleBunch::render(const RenderInfo& info) const
 {
-    if (_quads.empty()) return;
+    if (!_quads || _quads->empty()) return;
 
     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     glEnableClientState(GL_COLOR_ARRAY);
 
-    glVertexPointer(3, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].vertex));
-    glTexCoordPointer(2, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].texcoord));
-    glNormalPointer(GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].normal));
-    glColorPointer(4, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].colour));
+    glVertexPointer(3, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads->front().verts[0].vertex));
+    glTexCoordPointer(2, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads->front().verts[0].texcoord));
+    glNormalPointer(GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads->front().verts[0].normal));
+    glColorPointer(4, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads->front().verts[0].colour));
 
-    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_quads.size())*4);
+    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_quads->size())*4);
 
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -565,9 +590,9 @@ void RenderableParticleBunch::pushQuad(ParticleRenderInfo& particle, const Vecto
     // finally translate it to its position.
     const Vector3& normal = _viewRotation.zCol().getVector3();
 
-    _quads.push_back(ParticleQuad(particle.size, particle.aspect, particle.angle, colour, normal, s0, sWidth));
-    _quads.back().transform(_viewRotation);
-    _quads.back().translate(particle.origin);
+    _buffer->push_back(ParticleQuad(particle.size, particle.aspect, particle.angle, colour, normal, s0, sWidth));
+    _buffer->back().transform(_viewRotation);
+    _buffer->back().translate(particle.origin);
 }
 
 void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, std::size_t stageDurationMsec)
@@ -648,10 +673,10 @@ void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, s
                 // Glue the first row of vertices to the last quad, if applicable
                 if (i > 1)
                 {
-                    snapQuads(curQuad, *(_quads.end()-2));
+                    snapQuads(curQuad, *(_buffer->end()-2));
                 }
 
-                _quads.push_back(curQuad);
+                _buffer->push_back(curQuad);
 
                 // "Next" quad, re-use the curQuad structure
                 curQuad.assignColour(aimedParticle.nextColour);
@@ -661,20 +686,20 @@ void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, s
 
                 if (i > 1)
                 {
-                    snapQuads(curQuad, *(_quads.end()-2));
+                    snapQuads(curQuad, *(_buffer->end()-2));
                 }
 
-                _quads.push_back(curQuad);
+                _buffer->push_back(curQuad);
             }
             else
             {
                 if (i > 1)
                 {
-                    snapQuads(curQuad, _quads.back());
+                    snapQuads(curQuad, _buffer->back());
                 }
 
                 // Non-animated case
-                _quads.push_back(curQuad);
+                _buffer->push_back(curQuad);
             }
         }
 
@@ -702,7 +727,9 @@ void RenderableParticleBunch::snapQuads(ParticleQuad& curQuad, ParticleQuad& pre
 
 void RenderableParticleBunch::calculateBounds()
 {
-    for (Quads::const_iterator i = _quads.begin(); i != _quads.end(); ++i)
+    if (!_quads) return;
+
+    for (Quads::const_iterator i = _quads->begin(); i != _quads->end(); ++i)
     {
         _bounds.includePoint(i->verts[0].vertex);
         _bounds.includePoint(i->verts[1].vertex);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include "irender.h"
 #include "iparticlestage.h"
 
@@ -27,9 +28,12 @@ class RenderableParticleBunch : public OpenGLRenderable
 	// The stage this bunch is part of
 	const IStageDef& _stage;
 
-	// The quads of this particle bunch
+	// The quads of this particle bunch, shared with all bunches of the same input
 	typedef std::vector<ParticleQuad> Quads;
-	Quads _quads;
+	std::shared_ptr<const Quads> _quads;
+
+	// The buffer the quads are written to while they are generated
+	std::shared_ptr<Quads> _buffer;
 
 	// The seed for our local randomiser, as passed by the parent stage
 	Rand48::result_type _randSeed;
@@ -71,6 +75,7 @@ public:
 
 	// Update the particle geometry and render information.
 	// Time is specified in stage time without offset,in msecs.
+	// The geometry is taken from the ParticleSimulationCache if possible.
 	void update(std::size_t time);
 
 	void render(const RenderInfo& info) const;
@@ -78,6 +83,9 @@ public:
 	const AABB& getBounds();
 
 private:
+	// Runs the simulation for the given time, writing the quads to _buffer
+	void generateQuads(std::size_t time);
+
 	// Time is measured in seconds!
 	float integrate(const IParticleParameter& param, float time)
 	{
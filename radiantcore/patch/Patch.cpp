@@ -18,6 +18,9 @@
 
 #include "PatchSavedState.h"
 #include "PatchNode.h"
+#include "PatchTesselationCache.h"
+
+#include <atomic>
 
 // ====== Helper Functions ==================================================================
 
@@ -55,6 +58,7 @@ Patch::Patch(PatchNode& node) :
     _renderableLattice(GL_LINES, _latticeIndices, _ctrl_vertices),
     _transformChanged(false),
     _tesselationChanged(true),
+    _meshPrepared(false),
     _shader(texdef_name_default())
 {
     construct();
@@ -76,6 +80,7 @@ Patch::Patch(const Patch& other, PatchNode& node) :
     _renderableLattice(GL_LINES, _latticeIndices, _ctrl_vertices),
     _transformChanged(false),
     _tesselationChanged(true),
+    _meshPrepared(false),
     _shader(other._shader.getMaterialName())
 {
     // Initalise the default values
@@ -239,7 +244,7 @@ void Patch::setRenderSystem(const RenderSystemPtr& renderSystem)
 
 // Implementation of the abstract method of SelectionTestable
 // Called to test if the patch can be selected by the mouse pointer
-void Patch::testSelect(Selector& selector, SelectionTest& test)
+void Patch::testSelect(Selector& selector, SelectionTest& test, const Matrix4& localToWorld)
 {
     // ensure the tesselation is up to date
     updateTesselation();
@@ -247,14 +252,31 @@ void Patch::testSelect(Selector& selector, SelectionTest& test)
     // The updateTesselation routine might have produced a degenerate patch, catch this
     if (_mesh.vertices.empty()) return;
 
-    SelectionIntersection best;
-    IndexPointer::index_type* pIndex = &_mesh.indices.front();
+    auto vertices = vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front());
+
+    if (_selectionBVH.empty())
+    {
+        // Split the quad strips into the same triangles TestQuadStrip() is testing
+        std::vector<IndexPointer::index_type> triangles;
+        triangles.reserve(_mesh.numStrips * (_mesh.lenStrips - 2) * 3);
 
-    for (std::size_t s=0; s<_mesh.numStrips; s++) {
-        test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()), IndexPointer(pIndex, _mesh.lenStrips), best);
-        pIndex += _mesh.lenStrips;
+        for (std::size_t s = 0; s < _mesh.numStrips; ++s)
+        {
+            const RenderIndex* strip = &_mesh.indices[s * _mesh.lenStrips];
+
+            for (std::size_t i = 0; i + 3 < _mesh.lenStrips; i += 2)
+            {
+                triangles.insert(triangles.end(), { strip[i], strip[i + 1], strip[i + 2] });
+                triangles.insert(triangles.end(), { strip[i + 2], strip[i + 1], strip[i + 3] });
+            }
+        }
+
+        _selectionBVH.build(vertices, IndexPointer(triangles.data(), triangles.size()));
     }
 
+    SelectionIntersection best;
+    _selectionBVH.testSelect(test, localToWorld, vertices, best);
+
     if (best.isValid()) {
         selector.addIntersection(best);
     }
@@ -286,6 +308,7 @@ void Patch::transformChanged()
 {
     _transformChanged = true;
     _tesselationChanged = true;
+    _meshPrepared = false;
 }
 
 // Called to evaluate the transform
@@ -313,6 +336,7 @@ void Patch::freezeTransform()
 
     // Save the transformed working set array over _ctrl
     _ctrl = _ctrlTransformed;
+    _node.invalidateFingerprint();
 
     // Don't call controlPointsChanged() here since that one will re-apply the
     // current transformation matrix, possible the second time.
@@ -326,11 +350,27 @@ void Patch::freezeTransform()
 }
 
 // callback for changed control points
+namespace
+{
+    std::atomic<bool> _tesselationDeferred(false);
+}
+
+void Patch::setTesselationDeferred(bool deferred)
+{
+    _tesselationDeferred = deferred;
+}
+
 void Patch::controlPointsChanged()
 {
+    _node.invalidateFingerprint();
+
     transformChanged();
     evaluateTransform();
-    updateTesselation();
+
+    if (!_tesselationDeferred)
+    {
+        updateTesselation();
+    }
 
     for (Observers::iterator i = _observers.begin(); i != _observers.end();)
     {
@@ -409,6 +449,8 @@ const PatchControl& Patch::ctrlAt(std::size_t row, std::size_t col) const {
 // called just before an action to save the undo state
 void Patch::undoSave()
 {
+    _node.invalidateFingerprint();
+
     // Notify the undo observer to save this patch state
     if (_undoStateSaver != NULL)
     {
@@ -524,6 +566,10 @@ void Patch::updateTesselation()
     if (!_tesselationChanged) return;
 
     _tesselationChanged = false;
+    _selectionBVH.clear();
+
+    bool meshPrepared = _meshPrepared;
+    _meshPrepared = false;
 
     _ctrl_vertices.clear();
     _latticeIndices.clear();
@@ -535,8 +581,12 @@ void Patch::updateTesselation()
         return;
     }
 
-    // Run the tesselation code
-    _mesh.generate(_width, _height, _ctrlTransformed, subdivisionsFixed(), getSubdivisions());
+    // Run the tesselation code, unless this has already been done
+    if (!meshPrepared)
+    {
+        patch::TesselationCache::Instance().generate(_mesh, _width, _height, _ctrlTransformed,
+            subdivisionsFixed(), getSubdivisions());
+    }
 
     updateAABB();
 
@@ -568,6 +618,11 @@ void Patch::updateTesselation()
 
     _solidRenderable.queueUpdate();
 
+    for (auto& levelOfDetail : _levelsOfDetail)
+    {
+        levelOfDetail.changed = true;
+    }
+
     if (_patchDef3)
     {
         _fixedWireframeRenderable.queueUpdate();
@@ -578,6 +633,36 @@ void Patch::updateTesselation()
     }
 }
 
+void Patch::prepareTesselation()
+{
+    if (!_tesselationChanged || _meshPrepared || !isValid()) return;
+
+    patch::TesselationCache::Instance().generate(_mesh, _width, _height, _ctrlTransformed,
+        subdivisionsFixed(), getSubdivisions());
+
+    _meshPrepared = true;
+}
+
+const RenderablePatchSolid& Patch::getSolidRenderable(std::size_t levelOfDetail)
+{
+    if (levelOfDetail == 0 || _mesh.vertices.empty())
+    {
+        return _solidRenderable;
+    }
+
+    levelOfDetail = std::min(levelOfDetail, NUM_LEVELS_OF_DETAIL - 1);
+    auto& lod = _levelsOfDetail[levelOfDetail - 1];
+
+    if (lod.changed)
+    {
+        lod.changed = false;
+        lod.mesh.generateLevelOfDetail(_mesh, std::size_t(1) << levelOfDetail);
+        lod.renderable.queueUpdate();
+    }
+
+    return lod.renderable;
+}
+
 void Patch::invertMatrix()
 {
   undoSave();
@@ -1861,17 +1946,28 @@ PatchRenderIndices Patch::getRenderIndices() const
 }
 
 PatchMesh Patch::getTesselatedPatchMesh() const
+{
+    return getLevelOfDetailMesh(0);
+}
+
+PatchMesh Patch::getLevelOfDetailMesh(std::size_t levelOfDetail) const
 {
     // Ensure the tesselation is up to date
     const_cast<Patch&>(*this).updateTesselation();
 
+    // The coarser meshes are generated on demand
+    const_cast<Patch&>(*this).getSolidRenderable(levelOfDetail);
+
+    const PatchTesselation& source = levelOfDetail == 0 || _mesh.vertices.empty() ? _mesh :
+        _levelsOfDetail[std::min(levelOfDetail, NUM_LEVELS_OF_DETAIL - 1) - 1].mesh;
+
     PatchMesh mesh;
 
-    mesh.width = _mesh.width;
-    mesh.height = _mesh.height;
+    mesh.width = source.width;
+    mesh.height = source.height;
 
-    for (std::vector<ArbitraryMeshVertex>::const_iterator i = _mesh.vertices.begin();
-        i != _mesh.vertices.end(); ++i)
+    for (std::vector<ArbitraryMeshVertex>::const_iterator i = source.vertices.begin();
+        i != source.vertices.end(); ++i)
     {
         VertexNT v;
 
@@ -2772,6 +2868,8 @@ bool Patch::getIntersection(const Ray& ray, Vector3& intersection)
 
 void Patch::textureChanged()
 {
+    _node.invalidateFingerprint();
+
     for (Observers::iterator i = _observers.begin(); i != _observers.end();)
     {
         (*i++)->onPatchTextureChanged();
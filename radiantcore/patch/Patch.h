@@ -16,6 +16,7 @@
 #include "brush/TexDef.h"
 #include "brush/FacePlane.h"
 #include "brush/Face.h"
+#include "selection/TriangleBVH.h"
 #include <sigc++/signal.h>
 
 // Enable to render the vertex normal/tangent/bitangent vectors in the cam view
@@ -64,6 +65,33 @@ class Patch :
 	RenderablePatchFixedWireframe _fixedWireframeRenderable;
     RenderablePatchVectorsNTB _renderableNTBVectors;
 
+public:
+	// The number of solid tesselations available for rendering, including the full one
+	static constexpr std::size_t NUM_LEVELS_OF_DETAIL = 3;
+
+private:
+	// A coarser version of the tesselation, used to render distant patches.
+	// Level n uses every (2^n)-th row and column of the full mesh.
+	struct LevelOfDetail
+	{
+		PatchTesselation mesh;
+		RenderablePatchSolid renderable;
+
+		// TRUE if the mesh needs to be generated from the full one
+		bool changed;
+
+		LevelOfDetail() :
+			renderable(mesh),
+			changed(true)
+		{}
+	};
+
+	// The levels 1 and above, generated on demand
+	LevelOfDetail _levelsOfDetail[NUM_LEVELS_OF_DETAIL - 1];
+
+	// The triangles of the tesselation for selection tests, built on demand
+	selection::TriangleBVH _selectionBVH;
+
 	// The shader states for the control points and the lattice
 	ShaderPtr _pointShader;
 	ShaderPtr _latticeShader;
@@ -82,6 +110,9 @@ class Patch :
 	// TRUE if the patch tesselation needs an update
 	bool _tesselationChanged;
 
+	// TRUE if the mesh has already been generated by prepareTesselation()
+	bool _meshPrepared;
+
 	// The rendersystem we're attached to, to acquire materials
 	RenderSystemWeakPtr _renderSystem;
 
@@ -134,7 +165,7 @@ public:
 
 	// Implementation of the abstract method of SelectionTestable
 	// Called to test if the patch can be selected by the mouse pointer
-	void testSelect(Selector& selector, SelectionTest& test);
+	void testSelect(Selector& selector, SelectionTest& test, const Matrix4& localToWorld);
 
 	// Transform this patch as defined by the transformation matrix <matrix>
 	void transform(const Matrix4& matrix);
@@ -198,6 +229,7 @@ public:
 
 	// Returns a copy of the tesselated geometry
 	PatchMesh getTesselatedPatchMesh() const override;
+	PatchMesh getLevelOfDetailMesh(std::size_t levelOfDetail) const override;
 
 	// Get the current control point array
 	PatchControlArray& getControlPoints();
@@ -359,12 +391,35 @@ public:
 	// Static signal holder, signal is emitted after any patch texture has changed
 	static sigc::signal<void>& signal_patchTextureChanged();
 
+	// Brings the tesselation and everything derived from it up to date
+	void updateTesselation();
+
+	/**
+	 * Generates the tesselated mesh if it is outdated, without updating
+	 * anything else. This is safe to be called for different patches from several
+	 * threads at once, the next updateTesselation() call completes the update.
+	 */
+	void prepareTesselation();
+
+	/**
+	 * While set, controlPointsChanged() doesn't update the tesselation,
+	 * which is left to the next updateTesselation() call. This is used
+	 * during map loading, to tesselate all patches at once afterwards.
+	 */
+	static void setTesselationDeferred(bool deferred);
+
+	/**
+	 * Returns the solid renderable of the given level of detail, 0 being the
+	 * full tesselation. Coarser meshes are derived from the full one on first
+	 * use, they are only meant for drawing: selection and tracing always
+	 * operate on the full tesselation.
+	 */
+	const RenderablePatchSolid& getSolidRenderable(std::size_t levelOfDetail);
+
 private:
 	// This notifies the surfaceinspector/patchinspector about the texture change
 	void textureChanged();
 
-	void updateTesselation();
-
 	// greebo: checks, if the shader name is valid
 	void check_shader();
 
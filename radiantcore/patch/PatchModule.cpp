@@ -9,6 +9,7 @@
 #include "i18n.h"
 
 #include "PatchNode.h"
+#include "PatchTesselationCache.h"
 
 #include "patch/algorithm/Prefab.h"
 #include "patch/algorithm/General.h"
@@ -43,6 +44,16 @@ IPatchSettings& PatchModule::getSettings()
 	return *_settings;
 }
 
+std::size_t PatchModule::getTesselationCacheHitCount() const
+{
+	return TesselationCache::Instance().getHitCount();
+}
+
+std::size_t PatchModule::getTesselationCacheMissCount() const
+{
+	return TesselationCache::Instance().getMissCount();
+}
+
 const std::string& PatchModule::getName() const
 {
 	static std::string _name(MODULE_PATCH);
@@ -57,6 +68,7 @@ const StringSet& PatchModule::getDependencies() const
 	{
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
 		_dependencies.insert(MODULE_RENDERSYSTEM);
+		_dependencies.insert(MODULE_MAP);
 	}
 
 	return _dependencies;
@@ -76,11 +88,34 @@ void PatchModule::initialiseModule(const IApplicationContext& ctx)
 
 	_patchTextureChanged = Patch::signal_patchTextureChanged().connect(
 		[] { radiant::TextureChangedMessage::Send(); });
+
+	_mapEventConn = GlobalMapModule().signal_mapEvent().connect(
+		sigc::mem_fun(*this, &PatchModule::onMapEvent));
 }
 
 void PatchModule::shutdownModule()
 {
 	_patchTextureChanged.disconnect();
+	_mapEventConn.disconnect();
+}
+
+void PatchModule::onMapEvent(IMap::MapEvent ev)
+{
+	if (ev == IMap::MapLoading)
+	{
+		// Tesselate the patches all at once when the map is done loading
+		Patch::setTesselationDeferred(true);
+	}
+	else if (ev == IMap::MapLoaded)
+	{
+		Patch::setTesselationDeferred(false);
+		algorithm::prepareTesselations(GlobalMapModule().getRoot());
+	}
+	else if (ev == IMap::MapUnloaded)
+	{
+		Patch::setTesselationDeferred(false);
+		TesselationCache::Instance().clear();
+	}
 }
 
 void PatchModule::registerPatchCommands()
@@ -2,6 +2,7 @@
 
 #include <sigc++/connection.h>
 #include "ipatch.h"
+#include "imap.h"
 #include "PatchSettings.h"
 
 namespace patch
@@ -14,6 +15,7 @@ private:
 	std::unique_ptr<PatchSettings> _settings;
 
 	sigc::connection _patchTextureChanged;
+	sigc::connection _mapEventConn;
 
 public:
 	// PatchCreator implementation
@@ -21,6 +23,9 @@ public:
 
 	IPatchSettings& getSettings() override;
 
+	std::size_t getTesselationCacheHitCount() const override;
+	std::size_t getTesselationCacheMissCount() const override;
+
 	// RegisterableModule implementation
 	const std::string& getName() const override;
 	const StringSet& getDependencies() const override;
@@ -29,6 +34,7 @@ public:
 
 private:
 	void registerPatchCommands();
+	void onMapEvent(IMap::MapEvent ev);
 };
 
 }
@@ -1,11 +1,15 @@
 #include "PatchNode.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "ifilter.h"
 #include "ientity.h"
 #include "iradiant.h"
 #include "icounter.h"
 #include "math/Frustum.h"
 #include "math/Hash.h"
+#include "patch/LevelOfDetail.h"
 
 // Construct a PatchNode with no arguments
 PatchNode::PatchNode(patch::PatchDefType type) :
@@ -46,7 +50,22 @@ scene::INode::Type PatchNode::getNodeType() const
 	return Type::Patch;
 }
 
-std::string PatchNode::getFingerprint()
+std::string PatchNode::getFingerprint(scene::FingerprintHash hash)
+{
+    return _fingerprints.get(hash, [&]()
+    {
+        return hash == scene::FingerprintHash::Fast ?
+            calculateFingerprint<math::FastHash>() : calculateFingerprint<math::Hash>();
+    });
+}
+
+void PatchNode::invalidateFingerprint()
+{
+    scene::invalidateFingerprint(_fingerprints, *this);
+}
+
+template<typename HashType>
+std::string PatchNode::calculateFingerprint() const
 {
     constexpr std::size_t SignificantDigits = scene::SignificantFingerprintDoubleDigits;
 
@@ -55,7 +74,7 @@ std::string PatchNode::getFingerprint()
         return std::string(); // empty patches produce an empty fingerprint
     }
 
-    math::Hash hash;
+    HashType hash;
 
     // Width & Height
     hash.addSizet(m_patch.getHeight());
@@ -156,7 +175,15 @@ void PatchNode::testSelect(Selector& selector, SelectionTest& test)
     test.BeginMesh(localToWorld(), isTwosided);
 
     // Pass the selection test call to the patch
-    m_patch.testSelect(selector, test);
+    m_patch.testSelect(selector, test, localToWorld());
+}
+
+bool PatchNode::supportsConcurrentSelectionTest() const
+{
+    // A pending tesselation update is notifying the scene about changed bounds,
+    // this needs to happen on the main thread. The selection hierarchy of
+    // the patch is only used by one thread at a time.
+    return !m_patch._tesselationChanged;
 }
 
 void PatchNode::selectPlanes(Selector& selector, SelectionTest& test, const PlaneCallback& selectedPlaneCallback) {
@@ -300,8 +327,8 @@ bool PatchNode::getIntersection(const Ray& ray, Vector3& intersection)
 	return m_patch.getIntersection(ray, intersection);
 }
 
-bool PatchNode::intersectsLight(const RendererLight& light) const {
-	return light.lightAABB().intersects(worldAABB());
+const AABB& PatchNode::getLitObjectBounds() const {
+	return worldAABB();
 }
 
 void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& volume) const
@@ -315,9 +342,10 @@ void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& vo
 
 	assert(_renderEntity); // patches rendered without parent - no way!
 
-    // Render the patch itself
+    // Render the patch itself, distant patches are using a coarser mesh
     collector.addRenderable(
-        *m_patch._shader.getGLShader(), m_patch._solidRenderable,
+        *m_patch._shader.getGLShader(),
+        const_cast<Patch&>(m_patch).getSolidRenderable(getLevelOfDetail(volume)),
         localToWorld(), this, _renderEntity
     );
 
@@ -329,6 +357,41 @@ void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& vo
 	renderComponentsSelected(collector, volume);
 }
 
+namespace
+{
+    // The number of views remembering their level of detail
+    const std::size_t MAX_LEVEL_OF_DETAIL_VIEWS = 4;
+}
+
+std::size_t PatchNode::getLevelOfDetail(const VolumeTest& volume) const
+{
+    // Each view keeps its own level, the most recently used view comes first
+    auto view = std::find_if(_levelsOfDetail.begin(), _levelsOfDetail.end(),
+        [&](const ViewLevelOfDetail& entry) { return entry.view == &volume; });
+
+    if (view == _levelsOfDetail.end())
+    {
+        if (_levelsOfDetail.size() >= MAX_LEVEL_OF_DETAIL_VIEWS)
+        {
+            _levelsOfDetail.pop_back();
+        }
+
+        view = _levelsOfDetail.insert(_levelsOfDetail.begin(), ViewLevelOfDetail{ &volume, 0 });
+    }
+    else if (view != _levelsOfDetail.begin())
+    {
+        std::rotate(_levelsOfDetail.begin(), view, std::next(view));
+        view = _levelsOfDetail.begin();
+    }
+
+    const auto& mesh = m_patch._mesh;
+
+    view->level = patch::chooseLevelOfDetail(worldAABB(), std::max(mesh.width, mesh.height),
+        Patch::NUM_LEVELS_OF_DETAIL, volume, view->level);
+
+    return view->level;
+}
+
 void PatchNode::renderWireframe(RenderableCollector& collector, const VolumeTest& volume) const
 {
 	// Don't render invisible shaders
@@ -7,6 +7,7 @@
 #include "imap.h"
 #include "Patch.h"
 #include "scene/SelectableNode.h"
+#include "scene/FingerprintCache.h"
 #include "PatchControlInstance.h"
 #include "dragplanes.h"
 
@@ -35,6 +36,9 @@ class PatchNode :
 	// An array of renderable points
 	mutable RenderablePointVector m_render_selected;
 
+	// Declared before the patch, which invalidates it during construction
+	scene::FingerprintCache _fingerprints;
+
 	Patch m_patch;
 
 	// An internal AABB variable to calculate the bounding box of the selected components (has to be mutable)
@@ -47,6 +51,16 @@ class PatchNode :
     // If true, the _untransformedOrigin member needs an update
     bool _untransformedOriginChanged;
 
+    // The level of detail this patch has last been rendered with in a view
+    struct ViewLevelOfDetail
+    {
+        const VolumeTest* view;
+        std::size_t level;
+    };
+
+    // The levels of the recently used views, the view objects are only compared
+    mutable std::vector<ViewLevelOfDetail> _levelsOfDetail;
+
 public:
 	// Construct a PatchNode with no arguments
 	PatchNode(patch::PatchDefType type);
@@ -63,7 +77,11 @@ public:
 	Type getNodeType() const override;
 
     // IComparableNode implementation
-    std::string getFingerprint() override;
+    using scene::IComparableNode::getFingerprint;
+    std::string getFingerprint(scene::FingerprintHash hash) override;
+
+    // Drops the cached fingerprints, called by the Patch before and after any change
+    void invalidateFingerprint();
 
 	// Bounded implementation
 	const AABB& localAABB() const override;
@@ -77,6 +95,7 @@ public:
 
 	// Test the Patch instance for selection (SelectionTestable)
 	void testSelect(Selector& selector, SelectionTest& test) override;
+	bool supportsConcurrentSelectionTest() const override;
 
 	// Check if the drag planes pass the given selection test (and select them of course and call the callback)
 	void selectPlanes(Selector& selector, SelectionTest& test, const PlaneCallback& selectedPlaneCallback) override;
@@ -124,7 +143,7 @@ public:
 	void selectedChangedComponent(const ISelectable& selectable);
 
 	// LitObject implementation
-	bool intersectsLight(const RendererLight& light) const override;
+	const AABB& getLitObjectBounds() const override;
 
 	// Renderable implementation
 
@@ -153,6 +172,9 @@ protected:
     void _applyTransformation() override;
 
 private:
+	template<typename HashType>
+	std::string calculateFingerprint() const;
+
 	// Transforms the patch components with the given transformation matrix
 	void transformComponents(const Matrix4& matrix);
 
@@ -162,6 +184,9 @@ private:
 
 	// greebo: Renders the selected components. This is called by the above two render functions
 	void renderComponentsSelected(RenderableCollector& collector, const VolumeTest& volume) const;
+
+	// Chooses the level of detail to render the patch with, based on its size on screen
+	std::size_t getLevelOfDetail(const VolumeTest& volume) const;
 };
 typedef std::shared_ptr<PatchNode> PatchNodePtr;
 typedef std::weak_ptr<PatchNode> PatchNodeWeakPtr;
@@ -197,67 +197,63 @@ void PatchTesselation::generateNormals()
 	}
 }
 
-void PatchTesselation::sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out) const
+namespace
 {
-	double vCtrl[3][8];
 
-	// find the control points for the v coordinate
-	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
-	{
-		for (std::size_t axis = 0; axis < 8; axis++)
-		{
-			double a, b, c;
+// The interpolated attributes of a vertex: 3 vertex, 3 normal and 2 texcoord components
+constexpr std::size_t NUM_ATTRIBUTES = 8;
 
-			if (axis < 3)
-			{
-				a = ctrl[0][vPoint].vertex[axis];
-				b = ctrl[1][vPoint].vertex[axis];
-				c = ctrl[2][vPoint].vertex[axis];
-			}
-			else if (axis < 6)
-			{
-				a = ctrl[0][vPoint].normal[axis - 3];
-				b = ctrl[1][vPoint].normal[axis - 3];
-				c = ctrl[2][vPoint].normal[axis - 3];
-			}
-			else
-			{
-				a = ctrl[0][vPoint].texcoord[axis - 6];
-				b = ctrl[1][vPoint].texcoord[axis - 6];
-				c = ctrl[2][vPoint].texcoord[axis - 6];
-			}
+inline void loadAttributes(const ArbitraryMeshVertex& vertex, double attributes[NUM_ATTRIBUTES])
+{
+	for (std::size_t axis = 0; axis < 3; axis++)
+	{
+		attributes[axis] = vertex.vertex[axis];
+		attributes[axis + 3] = vertex.normal[axis];
+	}
 
-			double qA = a - 2.0 * b + c;
-			double qB = 2.0 * b - 2.0 * a;
-			double qC = a;
+	attributes[6] = vertex.texcoord[0];
+	attributes[7] = vertex.texcoord[1];
+}
 
-			vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
-		}
+inline void storeAttributes(const double attributes[NUM_ATTRIBUTES], ArbitraryMeshVertex& vertex)
+{
+	for (std::size_t axis = 0; axis < 3; axis++)
+	{
+		vertex.vertex[axis] = attributes[axis];
+		vertex.normal[axis] = attributes[axis + 3];
 	}
 
-	// interpolate the v value
-	for (std::size_t axis = 0; axis < 8; axis++)
-	{
-		double a = vCtrl[0][axis];
-		double b = vCtrl[1][axis];
-		double c = vCtrl[2][axis];
-		double qA = a - 2.0 * b + c;
-		double qB = 2.0 * b - 2.0 * a;
-		double qC = a;
+	vertex.texcoord[0] = attributes[6];
+	vertex.texcoord[1] = attributes[7];
+}
 
-		if (axis < 3)
-		{
-			out.vertex[axis] = qA * v * v + qB * v + qC;
-		}
-		else if (axis < 6)
+// Coefficients of the quadratic curves through three sets of attributes,
+// such that the curve value at t is (a * t * t + b * t + c)
+struct QuadraticCoefficients
+{
+	double a[NUM_ATTRIBUTES];
+	double b[NUM_ATTRIBUTES];
+	double c[NUM_ATTRIBUTES];
+
+	void set(const double p0[NUM_ATTRIBUTES], const double p1[NUM_ATTRIBUTES], const double p2[NUM_ATTRIBUTES])
+	{
+		for (std::size_t axis = 0; axis < NUM_ATTRIBUTES; axis++)
 		{
-			out.normal[axis - 3] = qA * v * v + qB * v + qC;
+			a[axis] = p0[axis] - 2.0 * p1[axis] + p2[axis];
+			b[axis] = 2.0 * p1[axis] - 2.0 * p0[axis];
+			c[axis] = p0[axis];
 		}
-		else
+	}
+
+	void evaluate(float t, double result[NUM_ATTRIBUTES]) const
+	{
+		for (std::size_t axis = 0; axis < NUM_ATTRIBUTES; axis++)
 		{
-			out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
+			result[axis] = a[axis] * t * t + b[axis] * t + c[axis];
 		}
 	}
+};
+
 }
 
 void PatchTesselation::sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3],
@@ -268,14 +264,47 @@ void PatchTesselation::sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3],
 	horzSub++;
 	vertSub++;
 
+	// The attributes are processed in fixed-size arrays, which lets the compiler
+	// vectorise the inner loops. The curves in u direction only depend on the
+	// control points, so their coefficients are calculated once per sub-patch,
+	// the ones in v direction once per column.
+	QuadraticCoefficients uCurves[3];
+
+	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+	{
+		double p0[NUM_ATTRIBUTES], p1[NUM_ATTRIBUTES], p2[NUM_ATTRIBUTES];
+
+		loadAttributes(ctrl[0][vPoint], p0);
+		loadAttributes(ctrl[1][vPoint], p1);
+		loadAttributes(ctrl[2][vPoint], p2);
+
+		uCurves[vPoint].set(p0, p1, p2);
+	}
+
 	for (std::size_t i = 0; i < horzSub; i++)
 	{
+		float u = static_cast<float>(i) / (horzSub - 1);
+
+		// find the control points for the v coordinate
+		double vCtrl[3][NUM_ATTRIBUTES];
+
+		for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+		{
+			uCurves[vPoint].evaluate(u, vCtrl[vPoint]);
+		}
+
+		QuadraticCoefficients vCurve;
+		vCurve.set(vCtrl[0], vCtrl[1], vCtrl[2]);
+
+		// interpolate the v values
 		for (std::size_t j = 0; j < vertSub; j++)
 		{
-			float u = static_cast<float>(i) / (horzSub - 1);
 			float v = static_cast<float>(j) / (vertSub - 1);
 
-			sampleSinglePatchPoint(ctrl, u, v, outVerts[((baseRow + j) * w) + i + baseCol]);
+			double result[NUM_ATTRIBUTES];
+			vCurve.evaluate(v, result);
+
+			storeAttributes(result, outVerts[((baseRow + j) * w) + i + baseCol]);
 		}
 	}
 }
@@ -883,3 +912,55 @@ void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight,
 	// With indices in place we can derive the tangent/bitangent vectors
 	deriveTangents();
 }
+
+namespace
+{
+
+// Returns the rows or columns of a mesh of the given size to be kept, using the given step
+std::vector<std::size_t> getLevelOfDetailSamples(std::size_t size, std::size_t step)
+{
+	std::vector<std::size_t> samples;
+
+	for (std::size_t i = 0; i + 1 < size; i += step)
+	{
+		samples.push_back(i);
+	}
+
+	samples.push_back(size - 1);
+
+	return samples;
+}
+
+}
+
+void PatchTesselation::generateLevelOfDetail(const PatchTesselation& source, std::size_t step)
+{
+	if (source.vertices.empty() || source.width == 0 || source.height == 0)
+	{
+		clear();
+		return;
+	}
+
+	auto columns = getLevelOfDetailSamples(source.width, std::max<std::size_t>(step, 1));
+	auto rows = getLevelOfDetailSamples(source.height, std::max<std::size_t>(step, 1));
+
+	width = columns.size();
+	height = rows.size();
+
+	_maxWidth = width;
+	_maxHeight = height;
+
+	// The source vertices are already equipped with normals and tangents,
+	// these stay valid for the subset of them
+	vertices.resize(width * height);
+
+	for (std::size_t h = 0; h < height; h++)
+	{
+		for (std::size_t w = 0; w < width; w++)
+		{
+			vertices[h*width + w] = source.vertices[rows[h] * source.width + columns[w]];
+		}
+	}
+
+	generateIndices();
+}
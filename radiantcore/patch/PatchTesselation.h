@@ -48,6 +48,10 @@ public:
 	void generate(std::size_t width, std::size_t height, const PatchControlArray& controlPoints, 
 		bool subdivionsFixed, const Subdivisions& subdivs);
 
+	// Generates a coarser version of the given mesh, using every step-th row and column of it.
+	// The outermost rows and columns are always kept, such that the patch borders are unchanged.
+	void generateLevelOfDetail(const PatchTesselation& source, std::size_t step);
+
 private:
 	// Private methods used for tesselation, modeled after the patch subdivision code found in idTech4
 	void generateIndices();
@@ -66,7 +70,6 @@ private:
 	void sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3], std::size_t baseCol, std::size_t baseRow, 
 		std::size_t width, std::size_t horzSub, std::size_t vertSub, 
 		std::vector<ArbitraryMeshVertex>& outVerts) const;
-	void sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out) const;
 	void deriveTangents();
 	void deriveFaceTangents(std::vector<FaceTangents>& faceTangents);
 };
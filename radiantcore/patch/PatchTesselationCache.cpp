@@ -0,0 +1,118 @@
+#include "PatchTesselationCache.h"
+
+#include <functional>
+#include "math/Hash.h"
+
+namespace patch
+{
+
+bool TesselationCache::Key::operator==(const Key& other) const
+{
+	if (width != other.width || height != other.height || subdivisionsFixed != other.subdivisionsFixed ||
+		controlPoints.size() != other.controlPoints.size())
+	{
+		return false;
+	}
+
+	// The subdivisions are ignored by the tesselation code if they're not fixed
+	if (subdivisionsFixed && subdivisions != other.subdivisions)
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i < controlPoints.size(); ++i)
+	{
+		if (controlPoints[i].vertex != other.controlPoints[i].vertex ||
+			controlPoints[i].texcoord != other.controlPoints[i].texcoord)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::size_t TesselationCache::KeyHash::operator()(const Key& key) const
+{
+	// Hash the exact values, since the result needs to be exactly the same as the generated one
+	std::hash<double> hashDouble;
+
+	std::size_t hash = key.width;
+	math::combineHash(hash, key.height);
+	math::combineHash(hash, key.subdivisionsFixed ? 1 : 0);
+
+	if (key.subdivisionsFixed)
+	{
+		math::combineHash(hash, key.subdivisions.x());
+		math::combineHash(hash, key.subdivisions.y());
+	}
+
+	for (const PatchControl& control : key.controlPoints)
+	{
+		math::combineHash(hash, hashDouble(control.vertex.x()));
+		math::combineHash(hash, hashDouble(control.vertex.y()));
+		math::combineHash(hash, hashDouble(control.vertex.z()));
+		math::combineHash(hash, hashDouble(control.texcoord.x()));
+		math::combineHash(hash, hashDouble(control.texcoord.y()));
+	}
+
+	return hash;
+}
+
+TesselationCache::TesselationCache() :
+	_tesselations(MAX_VERTICES, [](const PatchTesselation& tesselation)
+	{
+		return tesselation.vertices.size();
+	})
+{}
+
+void TesselationCache::generate(PatchTesselation& tesselation, std::size_t width, std::size_t height,
+	const PatchControlArray& controlPoints, bool subdivisionsFixed, const Subdivisions& subdivisions)
+{
+	Key key{ width, height, controlPoints, subdivisionsFixed, subdivisions };
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto cached = _tesselations.find(key);
+
+		if (cached != nullptr)
+		{
+			tesselation = *cached;
+			return;
+		}
+	}
+
+	// Run the tesselation code outside the lock, other threads might need the cache meanwhile
+	tesselation.generate(width, height, controlPoints, subdivisionsFixed, subdivisions);
+
+	// Keeps the existing entry if another thread added the same input in the meantime
+	std::lock_guard<std::mutex> lock(_lock);
+	_tesselations.insert(key, PatchTesselation(tesselation));
+}
+
+std::size_t TesselationCache::getHitCount() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _tesselations.getHitCount();
+}
+
+std::size_t TesselationCache::getMissCount() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _tesselations.getMissCount();
+}
+
+void TesselationCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_tesselations.clear();
+}
+
+TesselationCache& TesselationCache::Instance()
+{
+	static TesselationCache _instance;
+	return _instance;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mutex>
+#include "PatchControl.h"
+#include "PatchTesselation.h"
+#include "util/LRUCache.h"
+
+namespace patch
+{
+
+/**
+ * Keeps the recently generated patch tesselations, keyed by the control
+ * points and subdivision settings they have been generated from. Patches
+ * with the same input (e.g. patches restored by undo or redo) receive a
+ * copy of the cached result instead of running the tesselation code again.
+ *
+ * The least recently used tesselations are dropped when the total number
+ * of cached vertices exceeds the limit.
+ *
+ * All methods can be called from several threads at once.
+ */
+class TesselationCache
+{
+private:
+	// The upper limit of the cached vertices (about 35 MB)
+	static constexpr std::size_t MAX_VERTICES = 1 << 18;
+
+	// The input a tesselation has been generated from
+	struct Key
+	{
+		std::size_t width;
+		std::size_t height;
+		PatchControlArray controlPoints;
+		bool subdivisionsFixed;
+		Subdivisions subdivisions;
+
+		bool operator==(const Key& other) const;
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const;
+	};
+
+	util::LRUCache<Key, PatchTesselation, KeyHash> _tesselations;
+
+	mutable std::mutex _lock;
+
+public:
+	TesselationCache();
+
+	/**
+	 * Fills in the tesselation for the given patch input, which is
+	 * either copied from the cache or generated and added to it.
+	 */
+	void generate(PatchTesselation& tesselation, std::size_t width, std::size_t height,
+		const PatchControlArray& controlPoints, bool subdivisionsFixed, const Subdivisions& subdivisions);
+
+	// Number of generate() calls served from the cache / by running the tesselation code
+	std::size_t getHitCount() const;
+	std::size_t getMissCount() const;
+
+	void clear();
+
+	static TesselationCache& Instance();
+};
+
+}
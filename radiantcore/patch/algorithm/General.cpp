@@ -14,6 +14,7 @@
 #include "selectionlib.h"
 #include "command/ExecutionFailure.h"
 #include "patch/PatchIterators.h"
+#include "scene/ParallelChunks.h"
 
 #include <map>
 
@@ -449,6 +450,40 @@ void weldSelectedPatches(const cmd::ArgumentList& args)
     }
 }
 
+void prepareTesselations(const scene::INodePtr& root)
+{
+	std::vector<Patch*> patches;
+
+	root->foreachNode([&](const scene::INodePtr& node)
+	{
+		auto patch = Node_getPatch(node);
+
+		if (patch != nullptr)
+		{
+			patches.push_back(patch);
+		}
+
+		return true;
+	});
+
+	// Don't spawn threads for a handful of patches
+	constexpr std::size_t MIN_PATCHES_PER_THREAD = 64;
+
+	scene::parallelForChunks(patches.size(), MIN_PATCHES_PER_THREAD, [&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			patches[i]->prepareTesselation();
+		}
+	});
+
+	// Update the rest (bounds, lattice) on this thread, the meshes are already there
+	for (Patch* patch : patches)
+	{
+		patch->updateTesselation();
+	}
+}
+
 } // namespace
 
 } // namespace
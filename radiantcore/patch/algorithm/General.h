@@ -1,6 +1,7 @@
 #pragma once
 
 #include "icommandsystem.h"
+#include "inode.h"
 #include <memory>
 
 class PatchNode;
@@ -29,6 +30,12 @@ void bulge(const cmd::ArgumentList& args);
 
 void weldSelectedPatches(const cmd::ArgumentList& args);
 
+/**
+ * Generates the outdated tesselations of all patches below the given root,
+ * using several threads at once, then completes their update on this thread.
+ */
+void prepareTesselations(const scene::INodePtr& root);
+
 } // namespace
 
 } // namespace
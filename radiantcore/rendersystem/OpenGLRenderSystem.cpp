@@ -4,13 +4,19 @@
 #include "igl.h"
 #include "itextstream.h"
 #include "iradiant.h"
+#include "iscenegraph.h"
 
 #include "math/Matrix4.h"
 #include "module/StaticModule.h"
 #include "backend/GLProgramFactory.h"
 #include "debugging/debugging.h"
+#include "render/VBO.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <functional>
+#include <map>
 
 namespace render {
 
@@ -34,6 +40,98 @@ namespace {
           0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
           0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55
     };
+
+    double getMillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string escapeJsonString(const std::string& input)
+    {
+        std::string result;
+
+        for (char c : input)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result += '\\';
+                result += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                result += ' ';
+            }
+            else
+            {
+                result += c;
+            }
+        }
+
+        return result;
+    }
+
+    void writeCounters(std::ostream& stream, const RenderPassProfile& counters)
+    {
+        stream << "\"milliseconds\": " << counters.milliseconds
+            << ", \"drawCalls\": " << counters.drawCalls
+            << ", \"instances\": " << counters.instances
+            << ", \"stateChanges\": " << counters.stateChanges
+            << ", \"textureBinds\": " << counters.textureBinds
+            << ", \"programSwitches\": " << counters.programSwitches;
+    }
+
+    // Writes the profile as JSON, with the passes grouped by their shader
+    void writeFrameProfile(std::ostream& stream, const RenderFrameProfile& profile)
+    {
+        // Sum up the passes of each shader, keeping the order of their first appearance
+        std::vector<RenderPassProfile> shaders;
+        std::map<std::string, std::size_t> shaderIndices;
+
+        for (const auto& pass : profile.passes)
+        {
+            auto found = shaderIndices.emplace(pass.shader, shaders.size());
+
+            if (found.second)
+            {
+                shaders.emplace_back();
+                shaders.back().shader = pass.shader;
+            }
+
+            auto& shader = shaders[found.first->second];
+
+            shader.milliseconds += pass.milliseconds;
+            shader.drawCalls += pass.drawCalls;
+            shader.instances += pass.instances;
+            shader.stateChanges += pass.stateChanges;
+            shader.textureBinds += pass.textureBinds;
+            shader.programSwitches += pass.programSwitches;
+        }
+
+        stream << "{\n  \"milliseconds\": " << profile.milliseconds << ",\n  \"shaders\": [";
+
+        for (std::size_t i = 0; i < shaders.size(); ++i)
+        {
+            stream << (i > 0 ? ",\n" : "\n") << "    { \"name\": \"" << escapeJsonString(shaders[i].shader) << "\", ";
+            writeCounters(stream, shaders[i]);
+            stream << ", \"passes\": [";
+
+            bool first = true;
+
+            for (const auto& pass : profile.passes)
+            {
+                if (pass.shader != shaders[i].shader) continue;
+
+                stream << (first ? "" : ", ") << "{ ";
+                writeCounters(stream, pass);
+                stream << " }";
+                first = false;
+            }
+
+            stream << "] }";
+        }
+
+        stream << "\n  ]\n}\n";
+    }
 }
 
 /**
@@ -45,6 +143,9 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
     _glProgramFactory(std::make_shared<GLProgramFactory>()),
     _currentShaderProgram(SHADER_PROGRAM_NONE),
     _time(0),
+    _allocationCount(0),
+    _lastFrameAllocationCount(0),
+    _lastFrameUploadedBytes(0),
     m_traverseRenderablesMutex(false)
 {
     bool shouldRealise = false;
@@ -122,6 +223,12 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
                                const Matrix4& projection,
                                const Vector3& viewer)
 {
+    auto start = std::chrono::steady_clock::now();
+    auto uploadedBytesBefore = getTotalUploadedVBOBytes();
+
+    // Buffers released since the last frame, now that the context is current
+    deleteQueuedVBOs();
+
     glPushAttrib(GL_ALL_ATTRIB_BITS);
 
     // Set the projection and modelview matrices
@@ -202,6 +309,34 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
     glHint(GL_FOG_HINT, GL_NICEST);
     glDisable(GL_FOG);
 
+    if (_profileCallback)
+    {
+        // Release the callback first, it might request another profile
+        auto callback = std::move(_profileCallback);
+        _profileCallback = nullptr;
+
+        RenderFrameProfile profile;
+        renderPassesProfiled(current, globalstate, viewer, profile);
+
+        profile.milliseconds = getMillisecondsSince(start);
+        callback(profile);
+    }
+    else
+    {
+        renderPasses(current, globalstate, viewer);
+    }
+
+    // This frame is complete, including the buffers used during render
+    _lastFrameAllocationCount = _allocationCount;
+    _allocationCount = 0;
+
+    _lastFrameUploadedBytes = getTotalUploadedVBOBytes() - uploadedBytesBefore;
+
+    glPopAttrib();
+}
+
+void OpenGLRenderSystem::renderPasses(OpenGLState& current, RenderStateFlags globalstate, const Vector3& viewer)
+{
     // Iterate over the sorted mapping between OpenGLStates and their
     // OpenGLShaderPasses (containing the renderable geometry), and render the
     // contents of each bucket. Each pass is passed a reference to the "current"
@@ -216,8 +351,29 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
             i->second->render(current, globalstate, viewer, _time);
         }
     }
+}
 
-    glPopAttrib();
+void OpenGLRenderSystem::renderPassesProfiled(OpenGLState& current, RenderStateFlags globalstate,
+    const Vector3& viewer, RenderFrameProfile& profile)
+{
+    // Same as renderPasses(), but each pass is counting into its own profile
+    for (const auto& pair : _state_sorted)
+    {
+        OpenGLShaderPass& pass = *pair.second;
+
+        if (pass.empty()) continue;
+
+        profile.passes.emplace_back();
+        profile.passes.back().shader = pass.getOwner().getName();
+
+        auto start = std::chrono::steady_clock::now();
+
+        pass.setProfile(&profile.passes.back());
+        pass.render(current, globalstate, viewer, _time);
+        pass.setProfile(nullptr);
+
+        profile.passes.back().milliseconds = getMillisecondsSince(start);
+    }
 }
 
 void OpenGLRenderSystem::realise()
@@ -268,6 +424,11 @@ void OpenGLRenderSystem::unrealise()
         // Unrealise the GLPrograms
         _glProgramFactory->unrealise();
     }
+
+    if (GlobalOpenGLContext().getSharedContext())
+    {
+        _instancedDrawing.destroy();
+    }
 }
 
 GLProgramFactory& OpenGLRenderSystem::getGLProgramFactory()
@@ -285,6 +446,67 @@ void OpenGLRenderSystem::setTime(std::size_t milliSeconds)
     _time = milliSeconds;
 }
 
+std::size_t OpenGLRenderSystem::getLastFrameAllocationCount() const
+{
+    return _lastFrameAllocationCount;
+}
+
+std::size_t OpenGLRenderSystem::getLastFrameUploadedBytes() const
+{
+    return _lastFrameUploadedBytes;
+}
+
+void OpenGLRenderSystem::profileNextFrame(const std::function<void(const RenderFrameProfile&)>& callback)
+{
+    _profileCallback = callback;
+}
+
+void OpenGLRenderSystem::profileRenderFrameCmd(const cmd::ArgumentList& args)
+{
+    std::string filename = !args.empty() ? args[0].getString() :
+        module::GlobalModuleRegistry().getApplicationContext().getSettingsPath() + "renderprofile.json";
+
+    profileNextFrame([=](const RenderFrameProfile& profile)
+    {
+        std::ofstream stream(filename);
+
+        if (!stream)
+        {
+            rError() << "Cannot write the render profile to " << filename << std::endl;
+            return;
+        }
+
+        writeFrameProfile(stream, profile);
+
+        // Give a short summary of the most expensive passes in the console
+        std::vector<const RenderPassProfile*> passes;
+
+        for (const auto& pass : profile.passes)
+        {
+            passes.push_back(&pass);
+        }
+
+        std::size_t count = std::min<std::size_t>(passes.size(), 10);
+
+        std::partial_sort(passes.begin(), passes.begin() + count, passes.end(),
+            [](const RenderPassProfile* a, const RenderPassProfile* b) { return a->milliseconds > b->milliseconds; });
+
+        rMessage() << "Render profile written to " << filename << ", frame time: " << profile.milliseconds
+            << " ms, most expensive passes:" << std::endl;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            rMessage() << "  " << passes[i]->shader << ": " << passes[i]->milliseconds << " ms, "
+                << passes[i]->drawCalls << " draw calls, " << passes[i]->stateChanges << " state changes, "
+                << passes[i]->textureBinds << " texture binds, " << passes[i]->programSwitches
+                << " program switches" << std::endl;
+        }
+    });
+
+    // Trigger a redraw of all views
+    GlobalSceneGraph().sceneChanged();
+}
+
 RenderSystem::ShaderProgram OpenGLRenderSystem::getCurrentShaderProgram() const
 {
     return _currentShaderProgram;
@@ -402,6 +624,8 @@ const StringSet& OpenGLRenderSystem::getDependencies() const
 	{
 		_dependencies.insert(MODULE_SHADERSYSTEM);
 		_dependencies.insert(MODULE_SHARED_GL_CONTEXT);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_SCENEGRAPH);
 	}
 
     return _dependencies;
@@ -429,6 +653,10 @@ void OpenGLRenderSystem::initialiseModule(const IApplicationContext& ctx)
 
     _sharedContextDestroyed = GlobalOpenGLContext().signal_sharedContextDestroyed()
         .connect(sigc::mem_fun(this, &OpenGLRenderSystem::unrealise));
+
+    GlobalCommandSystem().addCommand("ProfileRenderFrame",
+        std::bind(&OpenGLRenderSystem::profileRenderFrameCmd, this, std::placeholders::_1),
+        { cmd::ARGTYPE_STRING | cmd::ARGTYPE_OPTIONAL });
 }
 
 void OpenGLRenderSystem::shutdownModule()
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "irender.h"
+#include "icommandsystem.h"
 #include <sigc++/connection.h>
 #include <map>
+#include <memory>
 #include "imodule.h"
 #include "backend/OpenGLStateManager.h"
 #include "backend/OpenGLShader.h"
 #include "backend/OpenGLStateLess.h"
+#include "backend/GLInstancedDrawing.h"
 
 namespace render
 {
@@ -37,12 +40,25 @@ class OpenGLRenderSystem
     // Current shader program in use
     ShaderProgram _currentShaderProgram;
 
+	// Used by the shader passes to draw batches of the same geometry
+	GLInstancedDrawing _instancedDrawing;
+
 	// Map of OpenGLState references, with access functions.
 	OpenGLStates _state_sorted;
 
 	// Render time
 	std::size_t _time;
 
+	// Renderable buffer growth since the last render() call, and during the last frame
+	std::size_t _allocationCount;
+	std::size_t _lastFrameAllocationCount;
+
+	// Bytes uploaded to buffer objects during the last render() call
+	std::size_t _lastFrameUploadedBytes;
+
+	// Set by profileNextFrame(), receives the profile of the next render() call
+	std::function<void(const RenderFrameProfile&)> _profileCallback;
+
 	sigc::signal<void> _sigExtensionsInitialised;
 
 	sigc::connection _materialDefsLoaded;
@@ -74,6 +90,21 @@ public:
 	std::size_t getTime() const override;
 	void setTime(std::size_t milliSeconds) override;
 
+	std::size_t getLastFrameAllocationCount() const override;
+	std::size_t getLastFrameUploadedBytes() const override;
+	void profileNextFrame(const std::function<void(const RenderFrameProfile&)>& callback) override;
+
+	GLInstancedDrawing& getInstancedDrawing()
+	{
+		return _instancedDrawing;
+	}
+
+	// Called by the shader passes when one of their buffers is growing
+	void countBufferAllocation()
+	{
+		++_allocationCount;
+	}
+
     ShaderProgram getCurrentShaderProgram() const override;
     void setShaderProgram(ShaderProgram prog) override;
 
@@ -101,6 +132,14 @@ public:
     virtual const StringSet& getDependencies() const override;
     virtual void initialiseModule(const IApplicationContext& ctx) override;
     virtual void shutdownModule() override;
+
+private:
+	void renderPasses(OpenGLState& current, RenderStateFlags globalstate, const Vector3& viewer);
+	void renderPassesProfiled(OpenGLState& current, RenderStateFlags globalstate, const Vector3& viewer,
+		RenderFrameProfile& profile);
+
+	// Command profiling the next frame, writing the result to a JSON file
+	void profileRenderFrameCmd(const cmd::ArgumentList& args);
 };
 typedef std::shared_ptr<OpenGLRenderSystem> OpenGLRenderSystemPtr;
 
@@ -0,0 +1,137 @@
+#include "GLInstancedDrawing.h"
+
+#include "GLProgramFactory.h"
+#include "GLProgramAttributes.h"
+#include "itextstream.h"
+#include "math/Matrix4.h"
+#include "debugging/gl.h"
+#include "render/VBO.h"
+
+namespace render
+{
+
+namespace
+{
+    const char* INSTANCING_VP_FILENAME = "instancing_vp.glsl";
+
+    // A mat4 attribute occupies four consecutive locations, one per column
+    const GLuint NUM_TRANSFORM_COLUMNS = 4;
+}
+
+GLInstancedDrawing::GLInstancedDrawing() :
+    _program(0),
+    _locLighting(-1),
+    _locLight0(-1),
+    _locLight1(-1),
+    _unsupported(false),
+    _transformBuffer(0),
+    _transformBufferSize(0)
+{}
+
+bool GLInstancedDrawing::ensureProgram()
+{
+    if (_program != 0) return true;
+    if (_unsupported) return false;
+
+    if (!GLEW_VERSION_3_3)
+    {
+        rMessage() << "[renderer] Instanced drawing requires OpenGL 3.3" << std::endl;
+        _unsupported = true;
+        return false;
+    }
+
+    try
+    {
+        _program = GLProgramFactory::createGLSLProgram(INSTANCING_VP_FILENAME, std::string());
+    }
+    catch (const std::runtime_error& ex)
+    {
+        rError() << "[renderer] Failed to create the instancing program: " << ex.what() << std::endl;
+        _unsupported = true;
+        return false;
+    }
+
+    // Bind the transform to the reserved locations and re-link
+    glBindAttribLocation(_program, ATTR_INSTANCE_TRANSFORM, "attr_InstanceTransform");
+    glLinkProgram(_program);
+
+    _locLighting = glGetUniformLocation(_program, "u_lighting");
+    _locLight0 = glGetUniformLocation(_program, "u_light0");
+    _locLight1 = glGetUniformLocation(_program, "u_light1");
+
+    debug::assertNoGlErrors();
+
+    return true;
+}
+
+bool GLInstancedDrawing::begin(const OpenGLRenderable::BatchEntry* entries, std::size_t count)
+{
+    if (!ensureProgram()) return false;
+
+    _transforms.resize(count * 16);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Matrix4& transform = *entries[i].transform;
+
+        for (std::size_t j = 0; j < 16; ++j)
+        {
+            _transforms[i * 16 + j] = static_cast<GLfloat>(transform[j]);
+        }
+    }
+
+    uploadVBOData(GL_ARRAY_BUFFER, _transformBuffer, _transformBufferSize, _transforms);
+
+    for (GLuint column = 0; column < NUM_TRANSFORM_COLUMNS; ++column)
+    {
+        GLuint location = ATTR_INSTANCE_TRANSFORM + column;
+
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat),
+            reinterpret_cast<const GLvoid*>(column * 4 * sizeof(GLfloat)));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    // The renderable sets up its own vertex arrays
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(_program);
+
+    // The program is emulating the fixed-function lighting which is active
+    glUniform1i(_locLighting, glIsEnabled(GL_LIGHTING) ? 1 : 0);
+    glUniform1i(_locLight0, glIsEnabled(GL_LIGHT0) ? 1 : 0);
+    glUniform1i(_locLight1, glIsEnabled(GL_LIGHT1) ? 1 : 0);
+
+    debug::assertNoGlErrors();
+
+    return true;
+}
+
+void GLInstancedDrawing::end()
+{
+    glUseProgram(0);
+
+    for (GLuint column = 0; column < NUM_TRANSFORM_COLUMNS; ++column)
+    {
+        GLuint location = ATTR_INSTANCE_TRANSFORM + column;
+
+        glVertexAttribDivisor(location, 0);
+        glDisableVertexAttribArray(location);
+    }
+
+    debug::assertNoGlErrors();
+}
+
+void GLInstancedDrawing::destroy()
+{
+    if (_program != 0)
+    {
+        glDeleteProgram(_program);
+        _program = 0;
+    }
+
+    deleteVBO(_transformBuffer);
+    _transformBufferSize = 0;
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "irender.h"
+#include "igl.h"
+
+#include <vector>
+
+namespace render
+{
+
+/**
+ * Backend implementation of the InstancedDrawing interface, owning the
+ * vertex program reading the per-instance transforms and the buffer they're
+ * uploaded to. Requires OpenGL 3.3, the GL objects are created on first use.
+ */
+class GLInstancedDrawing final :
+    public InstancedDrawing
+{
+private:
+    // The vertex-only program, 0 if not created yet
+    GLuint _program;
+
+    GLint _locLighting;
+    GLint _locLight0;
+    GLint _locLight1;
+
+    // Set if the context doesn't support instancing or the program failed to build
+    bool _unsupported;
+
+    // Single precision transforms of the current batch, keeps its capacity
+    std::vector<GLfloat> _transforms;
+
+    GLuint _transformBuffer;
+    GLsizei _transformBufferSize;
+
+public:
+    GLInstancedDrawing();
+
+    bool begin(const OpenGLRenderable::BatchEntry* entries, std::size_t count) override;
+    void end() override;
+
+    // Releases the GL objects, requires a current GL context
+    void destroy();
+
+private:
+    bool ensureProgram();
+};
+
+}
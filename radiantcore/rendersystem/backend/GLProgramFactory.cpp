@@ -187,35 +187,32 @@ GLuint GLProgramFactory::createGLSLProgram(const std::string& vFile,
     // Create the parent program object
     GLuint program = glCreateProgram();
 
-    // Create the shader objects
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Load the source files as NULL-terminated strings and pass the text to
-    // OpenGL
-    CharBufPtr vertexSrc = getFileAsBuffer(vFile, true);
-    CharBufPtr fragSrc = getFileAsBuffer(fFile, true);
+    // Load the source file as NULL-terminated string and pass the text to
+    // OpenGL, then compile and attach the shader
+    auto attachShader = [&](GLenum type, const std::string& filename)
+    {
+        GLuint shader = glCreateShader(type);
 
-    const char* csVertex = &vertexSrc->front();
-    const char* csFragment = &fragSrc->front();
+        CharBufPtr source = getFileAsBuffer(filename, true);
+        const char* csSource = &source->front();
 
-    glShaderSource(vertexShader, 1, &csVertex, NULL);
-    glShaderSource(fragmentShader, 1, &csFragment, NULL);
-    debug::assertNoGlErrors();
+        glShaderSource(shader, 1, &csSource, NULL);
+        debug::assertNoGlErrors();
 
-    // Compile the shaders
-    glCompileShader(vertexShader);
-    assertShaderCompiled(vertexShader);
+        glCompileShader(shader);
+        assertShaderCompiled(shader);
 
-    glCompileShader(fragmentShader);
-    assertShaderCompiled(fragmentShader);
+        glAttachShader(program, shader);
+        debug::assertNoGlErrors();
+    };
 
-    debug::assertNoGlErrors();
+    attachShader(GL_VERTEX_SHADER, vFile);
 
-    // Attach and link the program object itself
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    debug::assertNoGlErrors();
+    // Vertex-only programs leave the fragments to the fixed-function pipeline
+    if (!fFile.empty())
+    {
+        attachShader(GL_FRAGMENT_SHADER, fFile);
+    }
 
     glLinkProgram(program);
 
@@ -89,7 +89,8 @@ public:
      * Relative filename for the vertex shader code.
      *
      * \param fFile
-     * Relative filename for the fragment shader code
+     * Relative filename for the fragment shader code, can be empty to use
+     * fixed-function fragment processing.
      *
      * \return
      * The program object id for subsequent binding with glUseProgram(). The
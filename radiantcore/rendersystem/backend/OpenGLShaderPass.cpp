@@ -1,5 +1,9 @@
 #include "OpenGLShaderPass.h"
 #include "OpenGLShader.h"
+#include "../OpenGLRenderSystem.h"
+
+#include <algorithm>
+#include <iterator>
 
 #include "math/Matrix4.h"
 #include "math/AABB.h"
@@ -30,6 +34,8 @@ void OpenGLShaderPass::setTextureState(GLint& current,
         glBindTexture(textureMode, texture);
         debug::assertNoGlErrors();
         current = texture;
+
+        if (_profile) ++_profile->textureBinds;
     }
 }
 
@@ -43,6 +49,8 @@ void OpenGLShaderPass::setTextureState(GLint& current,
         glBindTexture(textureMode, texture);
         debug::assertNoGlErrors();
         current = texture;
+
+        if (_profile) ++_profile->textureBinds;
     }
 }
 
@@ -82,6 +90,20 @@ inline void evaluateStage(const IShaderLayer::Ptr& stage, std::size_t time, cons
     }
 }
 
+// Determine the face direction for the given object transform
+inline void setFrontFace(const OpenGLState& current, const Matrix4& transform)
+{
+    if (current.testRenderFlag(RENDER_CULLFACE)
+        && transform.getHandedness() == Matrix4::RIGHTHANDED)
+    {
+        glFrontFace(GL_CW);
+    }
+    else
+    {
+        glFrontFace(GL_CCW);
+    }
+}
+
 } // namespace
 
 // GL state enabling/disabling helpers
@@ -251,6 +273,8 @@ void OpenGLShaderPass::applyState(OpenGLState& current,
                                   std::size_t time,
                                   const IRenderEntity* entity)
 {
+    if (_profile) ++_profile->stateChanges;
+
     // Evaluate any shader expressions
     if (_glState.stage0)
     {
@@ -520,6 +544,8 @@ void OpenGLShaderPass::activateShaderProgram(OpenGLState& current)
     {
         current.glProgram = _glState.glProgram;
         current.glProgram->enable();
+
+        if (_profile) ++_profile->programSwitches;
     }
 }
 
@@ -539,26 +565,13 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                      const RendererLight* light,
                                      const IRenderEntity* entity)
 {
-    if (entity)
+    if (_renderables.size() == _renderables.capacity())
     {
-        // Find or insert the render entity in our map
-        auto i = _renderables.find(entity);
-        if (i == _renderables.end())
-        {
-            i = _renderables.insert(std::make_pair(entity, Renderables())).first;
-        }
-
-        // Add this renderable to the list of renderables associated with the entity
-        i->second.push_back(
-            TransformedRenderable(renderable, modelview, light, entity)
-        );
-    }
-    else
-    {
-        _renderablesWithoutEntity.push_back(
-            TransformedRenderable(renderable, modelview, light, nullptr)
-        );
+        // The vector is going to grow, let the render system count this
+        _owner.getRenderSystem().countBufferAllocation();
     }
+
+    _renderables.emplace_back(renderable, modelview, light, entity);
 }
 
 // Render the bucket contents
@@ -576,28 +589,71 @@ void OpenGLShaderPass::render(OpenGLState& current,
     // Apply our state to the current state object
     applyState(current, flagsMask, viewer, time, NULL);
 
-    if (!_renderablesWithoutEntity.empty())
+    if (_sortKeys.capacity() < _renderables.size())
+    {
+        _owner.getRenderSystem().countBufferAllocation();
+    }
+
+    // Group the renderables by entity, the ones without entity are sorted to the front
+    _sortKeys.clear();
+
+    bool batching = supportsBatching();
+    bool groupByEntity = !batching || !isEntityIndependent();
+
+    for (std::size_t i = 0; i < _renderables.size(); ++i)
+    {
+        const TransformedRenderable& r = _renderables[i];
+
+        _sortKeys.push_back(SortKey{
+            groupByEntity ? r.entity : nullptr,
+            batching ? r.renderable->getBatchKey() : nullptr,
+            static_cast<std::uint32_t>(i)
+        });
+    }
+
+    // Usually most of the renderables of a pass are submitted by the same entity in a row
+    if (!std::is_sorted(_sortKeys.begin(), _sortKeys.end()))
     {
-        renderAllContained(_renderablesWithoutEntity, current, viewer, time);
+        std::sort(_sortKeys.begin(), _sortKeys.end());
     }
 
-    for (RenderablesByEntity::const_iterator i = _renderables.begin();
-         i != _renderables.end();
-         ++i)
+    for (auto group = _sortKeys.cbegin(); group != _sortKeys.cend(); /* in-loop */)
     {
-        // Apply our state to the current state object
-        applyState(current, flagsMask, viewer, time, i->first);
+        const IRenderEntity* entity = group->entity;
 
-        if (!stateIsActive())
+        auto groupEnd = std::find_if(group, _sortKeys.cend(),
+            [&](const SortKey& key) { return key.entity != entity; });
+
+        if (entity != nullptr)
         {
-            continue;
+            // Apply our state to the current state object
+            applyState(current, flagsMask, viewer, time, entity);
         }
 
-        renderAllContained(i->second, current, viewer, time);
+        if (entity == nullptr || stateIsActive())
+        {
+            renderAllContained(group, groupEnd, current, viewer, time);
+        }
+
+        group = groupEnd;
     }
 
-    _renderablesWithoutEntity.clear();
+    // Keep the capacity for the next frame
     _renderables.clear();
+    _sortKeys.clear();
+}
+
+bool OpenGLShaderPass::supportsBatching() const
+{
+    // Blended geometry needs to be drawn in the order of submission
+    return !_glState.testRenderFlag(RENDER_BLEND);
+}
+
+bool OpenGLShaderPass::isEntityIndependent() const
+{
+    // Shader stages are evaluated per entity
+    return !_glState.stage0 && !_glState.stage1 && !_glState.stage2 &&
+        !_glState.stage3 && !_glState.stage4;
 }
 
 bool OpenGLShaderPass::stateIsActive()
@@ -665,7 +721,8 @@ void OpenGLShaderPass::setUpLightingCalculation(OpenGLState& current,
 }
 
 // Flush renderables
-void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
+void OpenGLShaderPass::renderAllContained(SortKeys::const_iterator begin,
+                                          SortKeys::const_iterator end,
                                           OpenGLState& current,
                                           const Vector3& viewer,
                                           std::size_t time)
@@ -675,9 +732,65 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
 
     glPushMatrix();
 
-    // Iterate over each transformed renderable in the vector
-    for (const TransformedRenderable& r : renderables)
+    // Iterate over each transformed renderable in the range
+    for (auto key = begin; key != end; /* in-loop */)
     {
+        const TransformedRenderable& r = _renderables[key->index];
+
+        // Renderables with the same batch key are sorted next to each other,
+        // these are drawn together unless they need their own lighting setup
+        auto batchEnd = std::next(key);
+
+        if (key->batch && !(current.glProgram && r.light))
+        {
+            batchEnd = std::find_if(batchEnd, end, [&](const SortKey& other)
+            {
+                const TransformedRenderable& entry = _renderables[other.index];
+
+                return other.batch != key->batch || (current.glProgram && entry.light) ||
+                    entry.transform.getHandedness() != r.transform.getHandedness();
+            });
+        }
+
+        if (std::distance(key, batchEnd) > 1)
+        {
+            if (_batch.capacity() < static_cast<std::size_t>(std::distance(key, batchEnd)))
+            {
+                _owner.getRenderSystem().countBufferAllocation();
+            }
+
+            _batch.clear();
+
+            for (auto entry = key; entry != batchEnd; ++entry)
+            {
+                const TransformedRenderable& batched = _renderables[entry->index];
+                _batch.push_back(OpenGLRenderable::BatchEntry{ batched.renderable, &batched.transform });
+            }
+
+            // The batch transforms are applied on top of the view
+            transform = nullptr;
+            glPopMatrix();
+            glPushMatrix();
+            setFrontFace(current, r.transform);
+
+            // Instancing replaces the vertex processing, which is only
+            // possible if there's no program or texture coordinate generation
+            InstancedDrawing* instancing = !current.glProgram && current.cubeMapMode == IShaderLayer::CUBE_MAP_NONE ?
+                &_owner.getRenderSystem().getInstancedDrawing() : nullptr;
+
+            RenderInfo info(current.getRenderFlags(), viewer, current.cubeMapMode, instancing);
+            auto drawCalls = r.renderable->renderBatch(info, _batch.data(), _batch.size());
+
+            if (_profile)
+            {
+                _profile->drawCalls += drawCalls;
+                _profile->instances += _batch.size();
+            }
+
+            key = batchEnd;
+            continue;
+        }
+
         // If the current iteration's transform matrix was different from the
         // last, apply it and store for the next iteration
         if (!transform || !transform->isAffineEqual(r.transform))
@@ -687,16 +800,7 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
             glPushMatrix();
             glMultMatrixd(*transform);
 
-            // Determine the face direction
-            if (current.testRenderFlag(RENDER_CULLFACE)
-                && transform->getHandedness() == Matrix4::RIGHTHANDED)
-            {
-                glFrontFace(GL_CW);
-            }
-            else
-            {
-                glFrontFace(GL_CCW);
-            }
+            setFrontFace(current, *transform);
         }
 
         // If we are using a lighting program and this renderable is lit, set
@@ -710,6 +814,10 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
         // Render the renderable
         RenderInfo info(current.getRenderFlags(), viewer, current.cubeMapMode);
         r.renderable->render(info);
+
+        if (_profile) ++_profile->drawCalls;
+
+        ++key;
     }
 
     // Cleanup
@@ -4,8 +4,9 @@
 #include "math/Matrix4.h"
 #include "iglrender.h"
 
+#include <cstdint>
+#include <functional>
 #include <vector>
-#include <map>
 
 /* FORWARD DECLS */
 class Matrix4;
@@ -42,7 +43,7 @@ protected:
     	const OpenGLRenderable* renderable;
 
     	// The modelview transform for this renderable
-    	const Matrix4 transform;
+    	Matrix4 transform;
 
 		// The light falling on this obejct
     	const RendererLight* light;
@@ -62,13 +63,45 @@ protected:
 		{}
 	};
 
-	// Vector of transformed renderables using this state
+	// Vector of transformed renderables using this state, in submission order.
+	// It's cleared after rendering, but keeps its capacity for the next frame.
 	typedef std::vector<TransformedRenderable> Renderables;
-	Renderables _renderablesWithoutEntity;
+	Renderables _renderables;
+
+	// The renderables are grouped by their entity before rendering, which is done
+	// by sorting this (small) key array instead of moving the renderables around.
+	// The index is part of the key, so the submission order within each group is kept.
+	// If the pass allows it, the entity is left out, and the renderables within
+	// a group are additionally grouped by their batch key.
+	struct SortKey
+	{
+		const IRenderEntity* entity;
+		const void* batch;
+		std::uint32_t index;
+
+		bool operator<(const SortKey& other) const
+		{
+			if (entity != other.entity)
+			{
+				return std::less<const IRenderEntity*>()(entity, other.entity);
+			}
+
+			if (batch != other.batch)
+			{
+				return std::less<const void*>()(batch, other.batch);
+			}
+
+			return index < other.index;
+		}
+	};
+	typedef std::vector<SortKey> SortKeys;
+	SortKeys _sortKeys;
+
+	// The batch being rendered, keeps its capacity
+	std::vector<OpenGLRenderable::BatchEntry> _batch;
 
-	// Renderables sorted by RenderEntity
-	typedef std::map<const IRenderEntity*, Renderables> RenderablesByEntity;
-	RenderablesByEntity _renderables;
+	// Receives the counters while a frame is profiled, NULL otherwise
+	RenderPassProfile* _profile;
 
 protected:
 
@@ -95,8 +128,16 @@ protected:
 
 	void setupTextureMatrix(GLenum textureUnit, const IShaderLayer::Ptr& stage);
 
-	// Render all of the given TransformedRenderables
-	void renderAllContained(const Renderables& renderables,
+	// Returns true if the renderables of this pass can be drawn in any order,
+	// as required for batching
+	bool supportsBatching() const;
+
+	// Returns true if the state of this pass doesn't depend on the entity
+	bool isEntityIndependent() const;
+
+	// Render all TransformedRenderables referenced by the given key range
+	void renderAllContained(SortKeys::const_iterator begin,
+							SortKeys::const_iterator end,
 							OpenGLState& current,
 						    const Vector3& viewer,
 							std::size_t time);
@@ -135,7 +176,8 @@ protected:
 public:
 
 	OpenGLShaderPass(OpenGLShader& owner) :
-		_owner(owner)
+		_owner(owner),
+		_profile(nullptr)
 	{}
 
 	/**
@@ -191,12 +233,26 @@ public:
 				const Vector3& viewer,
 				std::size_t time);
 
+	/**
+	 * Set the profile to count the state changes and draw calls of the
+	 * following render() calls in, or NULL to stop profiling.
+	 */
+	void setProfile(RenderPassProfile* profile)
+	{
+		_profile = profile;
+	}
+
+	const OpenGLShader& getOwner() const
+	{
+		return _owner;
+	}
+
 	/**
 	 * Returns true if this shaderpass doesn't have anything to render.
 	 */
 	bool empty() const
 	{
-		return _renderables.empty() && _renderablesWithoutEntity.empty();
+		return _renderables.empty();
 	}
 
 	friend std::ostream& operator<<(std::ostream& st, const OpenGLShaderPass& self);
@@ -0,0 +1,460 @@
+#include "AABBTree.h"
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include "inode.h"
+
+#include "AABBTreeNode.h"
+
+namespace scene
+{
+
+namespace
+{
+	// Leaves exceeding this number of members after a link() are split in two
+	const std::size_t MAX_LEAF_MEMBERS = 16;
+
+	// A tree build doesn't try to split ranges of this size or smaller
+	const std::size_t MIN_BUILD_LEAF_MEMBERS = 4;
+
+	// Number of bins used to evaluate the split candidates during a build
+	const std::size_t NUM_BINS = 16;
+
+	// Subtrees with more items than this are built on a separate thread
+	const std::size_t PARALLEL_BUILD_THRESHOLD = 1024;
+
+	// Safety limit, ranges are turned into a leaf at this depth
+	const std::size_t MAX_BUILD_DEPTH = 64;
+
+	// Surface area of the given bounds (up to a constant factor)
+	inline double getArea(const AABB& bounds)
+	{
+		if (!bounds.isValid()) return 0;
+
+		const Vector3& e = bounds.extents;
+		return e.x() * e.y() + e.y() * e.z() + e.z() * e.x();
+	}
+
+	inline AABB getUnion(const AABB& a, const AABB& b)
+	{
+		AABB result(a);
+		result.includeAABB(b);
+		return result;
+	}
+}
+
+AABBTree::AABBTree() :
+	_root(std::make_shared<AABBTreeNode>())
+{}
+
+void AABBTree::link(const scene::INodePtr& sceneNode)
+{
+	// Make sure we don't do double-links
+	assert(_nodeMapping.find(sceneNode.get()) == _nodeMapping.end());
+
+	AABB bounds = sceneNode->worldAABB();
+
+	insertIntoTree(sceneNode, bounds);
+}
+
+void AABBTree::linkAll(const std::vector<scene::INodePtr>& sceneNodes)
+{
+	// Batches larger than the existing tree are worth a full rebuild,
+	// it produces a much better tree than inserting them one by one
+	if (sceneNodes.size() > 1 && sceneNodes.size() >= _nodeMapping.size())
+	{
+		rebuild(sceneNodes);
+		return;
+	}
+
+	for (const scene::INodePtr& sceneNode : sceneNodes)
+	{
+		link(sceneNode);
+	}
+}
+
+bool AABBTree::unlink(const scene::INodePtr& sceneNode)
+{
+	NodeMapping::iterator found = _nodeMapping.find(sceneNode.get());
+
+	if (found == _nodeMapping.end())
+	{
+		return false;
+	}
+
+	AABBTreeNode* node = found->second.node;
+
+	node->_members.erase(found->second.member);
+	_nodeMapping.erase(found);
+
+	if (node != _root.get() && node->_members.empty())
+	{
+		collapseLeaf(*node);
+	}
+	else
+	{
+		refitUpwards(node);
+	}
+
+	return true;
+}
+
+ISPNodePtr AABBTree::getRoot() const
+{
+	return _root;
+}
+
+void AABBTree::addMember(AABBTreeNode& node, const INodePtr& sceneNode, const AABB& bounds)
+{
+	node._members.push_back(sceneNode);
+
+	std::pair<NodeMapping::iterator, bool> result = _nodeMapping.emplace(sceneNode.get(),
+		MappedMember{ &node, std::prev(node._members.end()), bounds });
+
+	assert(result.second);
+}
+
+void AABBTree::insertIntoTree(const INodePtr& sceneNode, const AABB& bounds)
+{
+	// Nodes without valid bounds are kept at the root, they're always visited
+	if (!bounds.isValid())
+	{
+		addMember(*_root, sceneNode, bounds);
+		return;
+	}
+
+	// Empty tree, create the first leaf
+	if (_root->isLeaf())
+	{
+		_root->_children.push_back(std::make_shared<AABBTreeNode>(_root.get()));
+	}
+
+	// Descend into the child requiring the smallest growth
+	AABBTreeNode* node = &_root->getChild(0);
+
+	while (!node->isLeaf())
+	{
+		AABBTreeNode& first = node->getChild(0);
+		AABBTreeNode& second = node->getChild(1);
+
+		double firstGrowth = getArea(getUnion(first._bounds, bounds)) - getArea(first._bounds);
+		double secondGrowth = getArea(getUnion(second._bounds, bounds)) - getArea(second._bounds);
+
+		if (firstGrowth < secondGrowth ||
+			(firstGrowth == secondGrowth && getArea(first._bounds) <= getArea(second._bounds)))
+		{
+			node = &first;
+		}
+		else
+		{
+			node = &second;
+		}
+	}
+
+	addMember(*node, sceneNode, bounds);
+
+	// The bounds can only grow by adding a member
+	for (AABBTreeNode* n = node; n != nullptr; n = n->_parent)
+	{
+		n->_bounds.includeAABB(bounds);
+		n->updateChildBounds();
+	}
+
+	splitLeafIfRequired(*node);
+}
+
+void AABBTree::splitLeafIfRequired(AABBTreeNode& leaf)
+{
+	if (leaf._members.size() <= MAX_LEAF_MEMBERS)
+	{
+		return;
+	}
+
+	// Take the members out of the leaf
+	BuildItems items;
+	items.reserve(leaf._members.size());
+
+	for (const INodePtr& member : leaf._members)
+	{
+		NodeMapping::iterator found = _nodeMapping.find(member.get());
+		assert(found != _nodeMapping.end());
+
+		items.push_back(BuildItem{ member, found->second.bounds, nullptr, {} });
+		_nodeMapping.erase(found);
+	}
+
+	leaf._members.clear();
+
+	// Split at the median along the longest axis
+	const Vector3& extents = leaf._bounds.extents;
+	std::size_t axis = extents.x() >= extents.y() ?
+		(extents.x() >= extents.z() ? 0 : 2) :
+		(extents.y() >= extents.z() ? 1 : 2);
+
+	auto middle = items.begin() + items.size() / 2;
+
+	std::nth_element(items.begin(), middle, items.end(), [&](const BuildItem& a, const BuildItem& b)
+	{
+		return a.bounds.origin[axis] < b.bounds.origin[axis];
+	});
+
+	// The leaf turns into an inner node, its bounds are unchanged
+	for (auto range : { std::make_pair(items.begin(), middle), std::make_pair(middle, items.end()) })
+	{
+		auto child = std::make_shared<AABBTreeNode>(&leaf);
+		leaf._children.push_back(child);
+
+		for (auto i = range.first; i != range.second; ++i)
+		{
+			addMember(*child, i->node, i->bounds);
+			child->_bounds.includeAABB(i->bounds);
+		}
+	}
+
+	leaf.updateChildBounds();
+}
+
+void AABBTree::collapseLeaf(AABBTreeNode& leaf)
+{
+	AABBTreeNode* parent = leaf._parent;
+	assert(parent != nullptr);
+
+	if (parent == _root.get())
+	{
+		// This was the last leaf in the tree
+		_root->_children.clear();
+		refitUpwards(_root.get());
+		return;
+	}
+
+	// Move the sibling up to take the parent's place
+	ISPNodePtr sibling = parent->_children[0].get() == &leaf ? parent->_children[1] : parent->_children[0];
+	AABBTreeNode* grandParent = parent->_parent;
+
+	static_cast<AABBTreeNode&>(*sibling)._parent = grandParent;
+
+	// This destroys the parent and the leaf, don't touch them afterwards
+	std::replace_if(grandParent->_children.begin(), grandParent->_children.end(),
+		[&](const ISPNodePtr& child) { return child.get() == parent; }, sibling);
+
+	refitUpwards(grandParent);
+}
+
+void AABBTree::refitUpwards(AABBTreeNode* node)
+{
+	for (; node != nullptr; node = node->_parent)
+	{
+		AABB bounds;
+
+		for (const ISPNodePtr& child : node->_children)
+		{
+			bounds.includeAABB(child->getBounds());
+		}
+
+		for (const INodePtr& member : node->_members)
+		{
+			bounds.includeAABB(_nodeMapping.find(member.get())->second.bounds);
+		}
+
+		node->_bounds = bounds;
+		node->updateChildBounds();
+	}
+}
+
+void AABBTree::rebuild(const std::vector<scene::INodePtr>& additionalNodes)
+{
+	// Evaluate all the bounds first, this might cause some nodes to re-link
+	// themselves through nodeBoundsChanged() before we start
+	std::vector<AABB> additionalBounds;
+	additionalBounds.reserve(additionalNodes.size());
+
+	for (const INodePtr& node : additionalNodes)
+	{
+		additionalBounds.push_back(node->worldAABB());
+	}
+
+	BuildItems items;
+	items.reserve(_nodeMapping.size() + additionalNodes.size());
+
+	// Collect the existing members, except for the ones at the root
+	for (NodeMapping::iterator i = _nodeMapping.begin(); i != _nodeMapping.end(); /* in-loop */)
+	{
+		if (i->second.node == _root.get())
+		{
+			++i;
+			continue;
+		}
+
+		items.push_back(BuildItem{ *i->second.member, i->second.bounds, nullptr, {} });
+		_nodeMapping.erase(i++);
+	}
+
+	_root->_children.clear();
+
+	for (std::size_t i = 0; i < additionalNodes.size(); ++i)
+	{
+		const INodePtr& node = additionalNodes[i];
+
+		assert(_nodeMapping.find(node.get()) == _nodeMapping.end());
+
+		if (!additionalBounds[i].isValid())
+		{
+			addMember(*_root, node, additionalBounds[i]);
+			continue;
+		}
+
+		items.push_back(BuildItem{ node, additionalBounds[i], nullptr, {} });
+	}
+
+	if (!items.empty())
+	{
+		_root->_children.push_back(BuildSubtree(items.begin(), items.end(), _root.get(), 0));
+
+		// The build stored the member positions, fill the lookup table
+		_nodeMapping.reserve(_nodeMapping.size() + items.size());
+
+		for (const BuildItem& item : items)
+		{
+			_nodeMapping.emplace(item.node.get(), MappedMember{ item.leaf, item.member, item.bounds });
+		}
+	}
+
+	refitUpwards(_root.get());
+}
+
+AABBTreeNodePtr AABBTree::BuildSubtree(BuildItems::iterator begin, BuildItems::iterator end,
+	AABBTreeNode* parent, std::size_t depth)
+{
+	auto node = std::make_shared<AABBTreeNode>(parent);
+	std::size_t count = std::distance(begin, end);
+
+	// Calculate the node bounds and the range of the item centroids
+	AABB centroidBounds;
+
+	for (auto i = begin; i != end; ++i)
+	{
+		node->_bounds.includeAABB(i->bounds);
+		centroidBounds.includePoint(i->bounds.origin);
+	}
+
+	// Find the axis with the largest centroid spread
+	const Vector3& spread = centroidBounds.extents;
+	std::size_t axis = spread.x() >= spread.y() ?
+		(spread.x() >= spread.z() ? 0 : 2) :
+		(spread.y() >= spread.z() ? 1 : 2);
+
+	auto middle = end;
+
+	if (count > MIN_BUILD_LEAF_MEMBERS && depth < MAX_BUILD_DEPTH && spread[axis] > 0)
+	{
+		// Sort the items into bins along that axis
+		double binMin = centroidBounds.origin[axis] - spread[axis];
+		double binScale = NUM_BINS / (2 * spread[axis]);
+
+		auto getBin = [&](const BuildItem& item)
+		{
+			auto bin = static_cast<std::size_t>((item.bounds.origin[axis] - binMin) * binScale);
+			return std::min(bin, NUM_BINS - 1);
+		};
+
+		AABB binBounds[NUM_BINS];
+		std::size_t binCounts[NUM_BINS] = { 0 };
+
+		for (auto i = begin; i != end; ++i)
+		{
+			std::size_t bin = getBin(*i);
+			binBounds[bin].includeAABB(i->bounds);
+			++binCounts[bin];
+		}
+
+		// Sweep from the right to have the cost of the right-hand sides ready
+		double rightCost[NUM_BINS];
+		AABB rightBounds;
+		std::size_t rightCount = 0;
+
+		for (std::size_t bin = NUM_BINS - 1; bin > 0; --bin)
+		{
+			rightBounds.includeAABB(binBounds[bin]);
+			rightCount += binCounts[bin];
+			rightCost[bin] = rightCount * getArea(rightBounds);
+		}
+
+		// Sweep from the left to find the cheapest split position
+		double bestCost = count * getArea(node->_bounds);
+		std::size_t bestSplit = 0;
+		AABB leftBounds;
+		std::size_t leftCount = 0;
+
+		for (std::size_t bin = 0; bin < NUM_BINS - 1; ++bin)
+		{
+			leftBounds.includeAABB(binBounds[bin]);
+			leftCount += binCounts[bin];
+
+			double cost = leftCount * getArea(leftBounds) + rightCost[bin + 1];
+
+			if (leftCount > 0 && leftCount < count && cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = bin + 1;
+			}
+		}
+
+		if (bestSplit > 0)
+		{
+			middle = std::partition(begin, end, [&](const BuildItem& item)
+			{
+				return getBin(item) < bestSplit;
+			});
+		}
+		else if (count > MAX_LEAF_MEMBERS)
+		{
+			// Splitting is not paying off, but the range is too large for a leaf
+			middle = begin + count / 2;
+
+			std::nth_element(begin, middle, end, [&](const BuildItem& a, const BuildItem& b)
+			{
+				return a.bounds.origin[axis] < b.bounds.origin[axis];
+			});
+		}
+	}
+	else if (count > MAX_LEAF_MEMBERS && depth < MAX_BUILD_DEPTH)
+	{
+		// All centroids are in the same spot, split the range in two
+		middle = begin + count / 2;
+	}
+
+	if (middle == end || middle == begin)
+	{
+		// Create a leaf node with all the items
+		for (auto i = begin; i != end; ++i)
+		{
+			node->_members.push_back(i->node);
+			i->leaf = node.get();
+			i->member = std::prev(node->_members.end());
+		}
+
+		return node;
+	}
+
+	// Build the two subtrees, large ones in parallel
+	if (count > PARALLEL_BUILD_THRESHOLD)
+	{
+		auto left = std::async(std::launch::async, BuildSubtree, begin, middle, node.get(), depth + 1);
+		auto right = BuildSubtree(middle, end, node.get(), depth + 1);
+
+		node->_children.push_back(left.get());
+		node->_children.push_back(right);
+	}
+	else
+	{
+		node->_children.push_back(BuildSubtree(begin, middle, node.get(), depth + 1));
+		node->_children.push_back(BuildSubtree(middle, end, node.get(), depth + 1));
+	}
+
+	node->updateChildBounds();
+
+	return node;
+}
+
+} // namespace
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ispacepartition.h"
+#include "math/AABB.h"
+#include <unordered_map>
+
+namespace scene
+{
+
+class AABBTreeNode;
+typedef std::shared_ptr<AABBTreeNode> AABBTreeNodePtr;
+
+/**
+ * A bounding volume hierarchy used as alternative to the Octree.
+ *
+ * The hierarchy is a binary tree of tightly fitting bounding boxes. A large
+ * batch of nodes (like a freshly loaded map) is sorted into a new tree using
+ * the surface area heuristic over a fixed number of bins, the independent
+ * subtrees of that build are processed in parallel.
+ *
+ * Single nodes are linked into the leaf which requires the smallest bounds
+ * growth, and overfull leaves are split in two. Unlinking a node shrinks the
+ * bounds of its leaf and all its parents, and empty leaves are collapsed.
+ * Since SceneGraph::nodeBoundsChanged() is doing unlink() + link(), the tree
+ * is refitted incrementally on every bounds change.
+ *
+ * In contrast to the Octree, large nodes are not stuck at the top of the
+ * tree, and every node can be culled away individually.
+ */
+class AABBTree :
+	public ISpacePartitionSystem
+{
+private:
+	// The root node, never changes during the lifetime of this tree
+	AABBTreeNodePtr _root;
+
+	// The leaf a scene node is linked to, its position in the member list
+	// and the bounds it had at linking time
+	struct MappedMember
+	{
+		AABBTreeNode* node;
+		ISPNode::MemberList::iterator member;
+		AABB bounds;
+	};
+
+	typedef std::unordered_map<const INode*, MappedMember> NodeMapping;
+	NodeMapping _nodeMapping;
+
+	// Scene node and its bounds, as used during a tree build. The leaf
+	// and member position are filled in by the build.
+	struct BuildItem
+	{
+		INodePtr node;
+		AABB bounds;
+		AABBTreeNode* leaf;
+		ISPNode::MemberList::iterator member;
+	};
+	typedef std::vector<BuildItem> BuildItems;
+
+public:
+	AABBTree();
+
+	void link(const scene::INodePtr& sceneNode) override;
+	void linkAll(const std::vector<scene::INodePtr>& sceneNodes) override;
+	bool unlink(const scene::INodePtr& sceneNode) override;
+
+	ISPNodePtr getRoot() const override;
+
+private:
+	// Descends into the best-fitting leaf and adds the member there
+	void insertIntoTree(const INodePtr& sceneNode, const AABB& bounds);
+
+	void addMember(AABBTreeNode& node, const INodePtr& sceneNode, const AABB& bounds);
+
+	// Splits the given leaf into two if it exceeds the member threshold
+	void splitLeafIfRequired(AABBTreeNode& leaf);
+
+	// Removes the given (empty) leaf from the tree, its sibling takes the parent's place
+	void collapseLeaf(AABBTreeNode& leaf);
+
+	// Recalculates the bounds of the given node and all its parents
+	void refitUpwards(AABBTreeNode* node);
+
+	// Discards the whole tree and rebuilds it from the given nodes plus all existing members
+	void rebuild(const std::vector<scene::INodePtr>& additionalNodes);
+
+	// Creates a subtree for the given item range, can be called from any thread
+	static AABBTreeNodePtr BuildSubtree(BuildItems::iterator begin, BuildItems::iterator end,
+		AABBTreeNode* parent, std::size_t depth);
+};
+
+} // namespace
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "inode.h"
+#include "ispacepartition.h"
+#include "math/AABB.h"
+#include "math/PackedAABBs.h"
+
+namespace scene
+{
+
+class AABBTreeNode;
+typedef std::shared_ptr<AABBTreeNode> AABBTreeNodePtr;
+
+/**
+ * A node of the AABBTree space partition.
+ *
+ * Inner nodes have exactly two children and no members, leaf nodes have no
+ * children and host a small number of members. The bounds of every node are
+ * tightly fitted around its contents, unlike the fixed cubes of the Octree.
+ *
+ * The tree's root node is a special case: it has at most one child (the top
+ * of the actual hierarchy), and its members are the scene::INodes without
+ * valid bounds, which are visited by every traversal.
+ *
+ * The nodes are managed by the owning AABBTree, which takes care of
+ * keeping the bounds and its lookup table up to date.
+ */
+class AABBTreeNode :
+	public ISPNode,
+	public std::enable_shared_from_this<AABBTreeNode>
+{
+private:
+	// The tight bounds of all members and children
+	AABB _bounds;
+
+	// The parent node, the parent owns this node, so a raw pointer is sufficient
+	AABBTreeNode* _parent;
+
+	// The child nodes (2 or 0, 1 or 0 for the root)
+	NodeList _children;
+
+	// The bounds of the child nodes, kept in sync by the AABBTree
+	PackedAABBs _childBounds;
+
+	// The scene::INodePtrs contained in this node
+	MemberList _members;
+
+	friend class AABBTree;
+
+public:
+	AABBTreeNode(AABBTreeNode* parent = nullptr) :
+		_parent(parent)
+	{}
+
+	ISPNodePtr getParent() const override
+	{
+		return _parent != nullptr ? _parent->shared_from_this() : ISPNodePtr();
+	}
+
+	const AABB& getBounds() const override
+	{
+		return _bounds;
+	}
+
+	const NodeList& getChildNodes() const override
+	{
+		return _children;
+	}
+
+	const PackedAABBs& getChildBounds() const override
+	{
+		return _childBounds;
+	}
+
+	bool isLeaf() const override
+	{
+		return _children.empty();
+	}
+
+	const MemberList& getMembers() const override
+	{
+		return _members;
+	}
+
+private:
+	AABBTreeNode& getChild(std::size_t index) const
+	{
+		return static_cast<AABBTreeNode&>(*_children[index]);
+	}
+
+	// Copies the current child bounds into the packed array
+	void updateChildBounds()
+	{
+		_childBounds.resize(_children.size());
+
+		for (std::size_t i = 0; i < _children.size(); ++i)
+		{
+			_childBounds.set(i, _children[i]->getBounds());
+		}
+	}
+};
+
+} // namespace
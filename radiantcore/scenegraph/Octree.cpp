@@ -29,20 +29,56 @@ Octree::~Octree()
 void Octree::link(const scene::INodePtr& sceneNode)
 {
 	// Make sure we don't do double-links
-	assert(_nodeMapping.find(sceneNode) == _nodeMapping.end());
+	assert(_nodeMapping.find(sceneNode.get()) == _nodeMapping.end());
 
 	// Make sure the root node is large enough
-	ensureRootSize(sceneNode);
+	ensureRootSize(sceneNode->worldAABB());
 
 	// Root node size is adjusted, let's link the node into the smallest encompassing octant
 	_root->linkRecursively(sceneNode);
 }
 
-void Octree::ensureRootSize(const scene::INodePtr& sceneNode)
+void Octree::linkAll(const std::vector<scene::INodePtr>& sceneNodes)
 {
-	// Check if sceneNode exceeds the root node's bounds
-	const AABB& aabb = sceneNode->worldAABB();
+	if (sceneNodes.size() < 2)
+	{
+		for (const scene::INodePtr& sceneNode : sceneNodes)
+		{
+			link(sceneNode);
+		}
+
+		return;
+	}
+
+	// Grow the root node once, such that it is encompassing all of the nodes
+	AABB combinedBounds;
+
+	for (const scene::INodePtr& sceneNode : sceneNodes)
+	{
+		assert(_nodeMapping.find(sceneNode.get()) == _nodeMapping.end());
+		combinedBounds.includeAABB(sceneNode->worldAABB());
+	}
+
+	ensureRootSize(combinedBounds);
+
+	// Sort the nodes into the existing octants first, without subdividing.
+	// Nodes that have been linked in the meantime (due to bounds re-evaluation)
+	// are skipped.
+	for (const scene::INodePtr& sceneNode : sceneNodes)
+	{
+		if (_nodeMapping.find(sceneNode.get()) == _nodeMapping.end())
+		{
+			_root->linkRecursively(sceneNode, false);
+		}
+	}
 
+	// Now split all the octants that exceeded the threshold in one pass
+	_root->subdivideRecursively();
+}
+
+void Octree::ensureRootSize(const AABB& aabb)
+{
+	// Check if the bounds exceed the root node's bounds
 	if (!aabb.isValid()) return; // skip this for invalid bounds
 
 	while (!_root->getBounds().contains(aabb))
@@ -108,12 +144,12 @@ void Octree::ensureRootSize(const scene::INodePtr& sceneNode)
 // Unlink this node from the SP tree
 bool Octree::unlink(const scene::INodePtr& sceneNode)
 {
-	NodeMapping::iterator found = _nodeMapping.find(sceneNode);
+	NodeMapping::iterator found = _nodeMapping.find(sceneNode.get());
 
 	if (found != _nodeMapping.end())
 	{
 		// Lookup successful, unlink the node (will fire notifyUnlink())
-		found->second->unlink(sceneNode);
+		found->second.node->unlink(found->second.member);
 		return true;
 	}
 
@@ -126,10 +162,11 @@ ISPNodePtr Octree::getRoot() const
 	return _root;
 }
 
-void Octree::notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node)
+void Octree::notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node,
+	const ISPNode::MemberList::iterator& member)
 {
 	std::pair<NodeMapping::iterator, bool> result =
-		_nodeMapping.insert(NodeMapping::value_type(sceneNode, node));
+		_nodeMapping.emplace(sceneNode.get(), MappedMember{ node, member });
 
 	assert(result.second);
 }
@@ -137,20 +174,29 @@ void Octree::notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node)
 void Octree::notifyUnlink(const scene::INodePtr& sceneNode, OctreeNode* node)
 {
 	// Remove the node from the lookup table, if found
-	NodeMapping::iterator found = _nodeMapping.find(sceneNode);
+	NodeMapping::iterator found = _nodeMapping.find(sceneNode.get());
 
 	assert(found != _nodeMapping.end());
 
 	_nodeMapping.erase(found);
 }
 
+void Octree::notifyRelocate(const scene::INodePtr& sceneNode, OctreeNode* node)
+{
+	NodeMapping::iterator found = _nodeMapping.find(sceneNode.get());
+
+	assert(found != _nodeMapping.end());
+
+	found->second.node = node;
+}
+
 #ifdef _DEBUG
 void Octree::notifyErase(OctreeNode* node)
 {
 	// Remove the node from the lookup table, if found
 	for (NodeMapping::iterator i = _nodeMapping.begin(); i != _nodeMapping.end(); ++i)
 	{
-		assert(i->second != node);
+		assert(i->second.node != node);
 	}
 }
 #endif
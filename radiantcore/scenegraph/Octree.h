@@ -2,7 +2,7 @@
 #define _OCTREE_H_
 
 #include "ispacepartition.h"
-#include <map>
+#include <unordered_map>
 
 namespace scene
 {
@@ -36,7 +36,8 @@ typedef std::shared_ptr<OctreeNode> OctreeNodePtr;
  * The Octree maintains a lookup table (NodeMapping) to implement a fast unlink()
  * algorithm. The scene::INodes don't know or care where they are linked to, so
  * it needs a fast lookup to avoid having to traverse the entire tree to find and
- * remove a single node.
+ * remove a single node. The table stores the position in the octant's member list
+ * too, such that unlinking doesn't need to search that list either.
  */
 class Octree :
 	public ISpacePartitionSystem
@@ -45,8 +46,16 @@ private:
 	// The root node of this SP
 	OctreeNodePtr _root;
 
+	// The octree node a scene node is linked to, plus its position in the member list
+	struct MappedMember
+	{
+		OctreeNode* node;
+		ISPNode::MemberList::iterator member;
+	};
+
 	// Maps scene nodes against octree nodes, for fast lookup during unlink
-	typedef std::map<INodePtr, OctreeNode*> NodeMapping;
+	// Keyed by raw pointer, this avoids any refcount traffic during lookups
+	typedef std::unordered_map<const INode*, MappedMember> NodeMapping;
 	NodeMapping _nodeMapping;
 
 public:
@@ -57,6 +66,9 @@ public:
 	// Links this node into the SP tree.
 	void link(const scene::INodePtr& sceneNode);
 
+	// Links all nodes with a single root size adjustment and subdivision pass
+	void linkAll(const std::vector<scene::INodePtr>& sceneNodes);
+
 	// Unlink this node from the SP tree, returns true if found
 	bool unlink(const scene::INodePtr& sceneNode);
 
@@ -64,9 +76,13 @@ public:
 	ISPNodePtr getRoot() const;
 
 	// Callback used by the OctreeNodes to let the tree update its caching structures
-	void notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node);
+	void notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node,
+		const ISPNode::MemberList::iterator& member);
 	void notifyUnlink(const scene::INodePtr& sceneNode, OctreeNode* node);
 
+	// A member has been moved to a different octree node, keeping its list position
+	void notifyRelocate(const scene::INodePtr& sceneNode, OctreeNode* node);
+
 #ifdef _DEBUG
 	// In debug builds, this ensures that no octree node is deleted
 	// while it is still mapped in the NodeMapping table
@@ -77,9 +93,9 @@ private:
 	/**
 	 * This is called whenever a node is linked into the octree
 	 * and ensures that the topmost octree node (the root node) is
-	 * large enough to encompass the scenenode's bounds.
+	 * large enough to encompass the given bounds.
 	 */
-	void ensureRootSize(const scene::INodePtr& sceneNode);
+	void ensureRootSize(const AABB& aabb);
 };
 
 } // namespace scene
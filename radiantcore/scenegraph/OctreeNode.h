@@ -1,9 +1,11 @@
 #ifndef _OCTREE_NODE_H_
 #define _OCTREE_NODE_H_
 
+#include <iterator>
 #include "inode.h"
 #include "ispacepartition.h"
 #include "math/AABB.h"
+#include "math/PackedAABBs.h"
 
 #include "Octree.h"
 
@@ -48,6 +50,9 @@ protected:
 	// The child nodes (8 or 0)
 	NodeList _children;
 
+	// The bounds of the child nodes, these don't change after subdivision
+	PackedAABBs _childBounds;
+
 	// The scene::INodePtrs contained in this octree node
 	MemberList _members;
 
@@ -95,6 +100,11 @@ public:
 		return _children;
 	}
 
+	const PackedAABBs& getChildBounds() const
+	{
+		return _childBounds;
+	}
+
 	// Get a list of members
 	const MemberList& getMembers() const
 	{
@@ -135,6 +145,13 @@ public:
 		_children[5] = OctreeNodePtr(new OctreeNode(_owner, baseLower + x - y, childExtents, shared_from_this()));
 		_children[6] = OctreeNodePtr(new OctreeNode(_owner, baseLower - x - y, childExtents, shared_from_this()));
 		_children[7] = OctreeNodePtr(new OctreeNode(_owner, baseLower - x + y, childExtents, shared_from_this()));
+
+		_childBounds.resize(8);
+
+		for (std::size_t i = 0; i < 8; ++i)
+		{
+			_childBounds.set(i, _children[i]->getBounds());
+		}
 	}
 
 	// Indexing operator to retrieve a certain child
@@ -149,18 +166,15 @@ public:
 	// This method moves all the contents (members) of this node to the "other" target node
 	void relocateMembersTo(OctreeNode& target)
 	{
-		// Copy all members from here to the target
-		target._members.insert(target._members.end(), _members.begin(), _members.end());
-
 		// Notify the Octree about the relocation
 		for (ISPNode::MemberList::iterator i = _members.begin(); i != _members.end(); ++i)
 		{
-			_owner.notifyUnlink(*i, this);
-			_owner.notifyLink(*i, &target);
+			_owner.notifyRelocate(*i, &target);
 		}
 
-		// Clear our own member list
-		_members.clear();
+		// Move all members from here to the target, this keeps the
+		// list iterators stored in the Octree's lookup table valid
+		target._members.splice(target._members.end(), _members);
 	}
 
 	// This method moves all the children of this node to the "other" target node
@@ -173,6 +187,9 @@ public:
 		target._children.swap(_children);
 		_children.clear();
 
+		target._childBounds = std::move(_childBounds);
+		_childBounds.clear();
+
 		target.reparentChildren();
 	}
 
@@ -184,11 +201,13 @@ public:
 		_members.push_back(sceneNode);
 
 		// Notify the Octree to update lookup caches
-		_owner.notifyLink(sceneNode, this);
+		_owner.notifyLink(sceneNode, this, std::prev(_members.end()));
 	}
 
-	// Links the given scene object into the tree
-	OctreeNode* linkRecursively(const scene::INodePtr& sceneNode)
+	// Links the given scene object into the tree. If subdivision is disabled,
+	// the object is added to the smallest existing octant, even if it is exceeding
+	// the member threshold by doing so (see subdivideRecursively()).
+	OctreeNode* linkRecursively(const scene::INodePtr& sceneNode, bool allowSubdivision = true)
 	{
 		const AABB& bounds = sceneNode->worldAABB();
 
@@ -207,76 +226,95 @@ public:
 			if (child.getBounds().contains(bounds))
 			{
 				// Node fits exactly into one of the children, enter recursion
-				return child.linkRecursively(sceneNode);
+				return child.linkRecursively(sceneNode, allowSubdivision);
 			}
 		}
 
 		// Node didn't fit into any of the children, link it here
 		addMember(sceneNode);
 
-		// If this is a leaf, check if we exceeded the subdivision threshold and are large enough
-		if (isLeaf() &&
-			_members.size() >= SUBDIVISION_THRESHOLD &&
-			_bounds.extents.x() > MIN_NODE_EXTENTS)
+		if (allowSubdivision)
 		{
-			// This leaf has enough members to justify a further subdivision, create 8 child nodes
-			subdivide();
-
-			// To avoid concurrent nodeBoundsChanged() calls during this operation, evaluate all
-			// child bounds before trying to re-distribute them over the new childnodes.
-			// Do this in a copy of the members list, it is not guaranteed for the iterators
-			// to stay valid during traversal.
-			{
-				ISPNode::MemberList temp = _members;
-
-				for (ISPNode::MemberList::iterator i = temp.begin();
-					 i != temp.end(); /* in-loop */)
-				{
-					(*i++)->worldAABB();
-				}
-			}
+			subdivideIfRequired();
+		}
 
-			// At this point, all child bounds are calculated, some children might have re-located
-			// themselves to a different node already, so it's possible that the number of members is
-			// below SUBDIVISION_THRESHOLD now. We cannot rely on this, so let's continue anyway.
+		return this;
+	}
 
-			// We cannot use the original _members vector in the loop below (iterator invalidation)...
-			ISPNode::MemberList oldList;
+	// Descends the tree and splits every leaf that exceeded the member threshold
+	void subdivideRecursively()
+	{
+		if (isLeaf())
+		{
+			subdivideIfRequired();
+			return;
+		}
 
-			// ... so create a temporary copy on the stack
-			oldList.swap(_members);
+		// Don't use iterators, the child list might be relocated during re-links
+		for (std::size_t i = 0; i < _children.size(); ++i)
+		{
+			static_cast<OctreeNode&>(*_children[i]).subdivideRecursively();
+		}
+	}
 
-			// Cycle through all the members and distribute them over the children
-			for (ISPNode::MemberList::iterator i = oldList.begin(); i != oldList.end(); ++i)
-			{
-				// Notify the owner about the re-link
-				_owner.notifyUnlink(*i, this);
+	void unlink(const ISPNode::MemberList::iterator& member)
+	{
+		// Keep a reference, the iterator is invalid after erasing
+		scene::INodePtr sceneNode = *member;
 
-				// Call ourselves. The fact that we have 8 children now ensures that we won't be
-				// going down the same code path here again
-				linkRecursively(*i);
-			}
-		}
+		_members.erase(member);
 
-		return this;
+		// Let the Octree know about this
+		_owner.notifyUnlink(sceneNode, this);
 	}
 
-	void unlink(const scene::INodePtr& sceneNode)
+private:
+	// If this is a leaf, check if we exceeded the subdivision threshold and are large enough
+	void subdivideIfRequired()
 	{
-		// Lookup the node in the members list (rather slow lookup)
-		ISPNode::MemberList::iterator found =
-			std::find(_members.begin(), _members.end(), sceneNode);
+		if (!isLeaf() ||
+			_members.size() < SUBDIVISION_THRESHOLD ||
+			_bounds.extents.x() <= MIN_NODE_EXTENTS)
+		{
+			return;
+		}
 
-		if (found != _members.end())
+		// This leaf has enough members to justify a further subdivision, create 8 child nodes
+		subdivide();
+
+		// To avoid concurrent nodeBoundsChanged() calls during this operation, evaluate all
+		// child bounds before trying to re-distribute them over the new childnodes.
+		// Do this in a copy of the members list, it is not guaranteed for the iterators
+		// to stay valid during traversal.
 		{
-			_members.erase(found);
+			ISPNode::MemberList temp = _members;
+
+			for (ISPNode::MemberList::iterator i = temp.begin();
+				 i != temp.end(); /* in-loop */)
+			{
+				(*i++)->worldAABB();
+			}
 		}
 
-		// Let the Octree know about this, regardless whether we found it or not (the Octree relies on this)
-		_owner.notifyUnlink(sceneNode, this);
+		// At this point, all child bounds are calculated, some children might have re-located
+		// themselves to a different node already, so it's possible that the number of members is
+		// below SUBDIVISION_THRESHOLD now. We cannot rely on this, so let's continue anyway.
+
+		// Re-link the members one by one, always taking the first one of the list.
+		// Members that don't fit into any of the children are appended to our list again,
+		// so process exactly as many members as we had before. Working on the live list
+		// (rather than a copy) keeps the Octree lookup table consistent at all times.
+		for (std::size_t count = _members.size(); count > 0 && !_members.empty(); --count)
+		{
+			scene::INodePtr member = _members.front();
+			unlink(_members.begin());
+
+			// The fact that we have 8 children now ensures that we won't be
+			// going down the same code path here again
+			linkRecursively(member);
+		}
 	}
 
-private:
 	// Tells each children who their parent is
 	void reparentChildren()
 	{
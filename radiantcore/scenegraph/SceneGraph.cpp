@@ -1,5 +1,7 @@
 #include "SceneGraph.h"
 
+#include <algorithm>
+
 #include "ivolumetest.h"
 #include "itextstream.h"
 
@@ -7,7 +9,7 @@
 #include "debugging/debugging.h"
 
 #include "math/AABB.h"
-#include "Octree.h"
+#include "math/PackedAABBs.h"
 #include "SceneGraphFactory.h"
 #include "util/ScopedBoolLock.h"
 #include "module/StaticModule.h"
@@ -15,11 +17,13 @@
 namespace scene
 {
 
-SceneGraph::SceneGraph() :
-	_spacePartition(new Octree),
+SceneGraph::SceneGraph(SpacePartitionType spacePartitionType) :
+	_spacePartitionType(spacePartitionType),
+	_spacePartition(createSpacePartitionSystem(spacePartitionType)),
 	_visitedSPNodes(0),
 	_skippedSPNodes(0),
-    _traversalOngoing(false)
+    _traversalOngoing(false),
+    _linkBatchOngoing(false)
 {}
 
 SceneGraph::~SceneGraph()
@@ -86,14 +90,21 @@ void SceneGraph::setRoot(const IMapRootNodePtr& newRoot)
 	_root = newRoot;
 
 	// Refresh the space partition class
-	_spacePartition = ISpacePartitionSystemPtr(new Octree);
+	_spacePartition = createSpacePartitionSystem(_spacePartitionType);
 
 	if (_root)
 	{
-		// New root not NULL, "instantiate" the whole scene
-		GraphPtr self = shared_from_this();
-		InstanceSubgraphWalker instanceWalker(self);
-		_root->traverse(instanceWalker);
+		{
+			// Collect the nodes, they're linked to the space partition afterwards
+			util::ScopedBoolLock batch(_linkBatchOngoing);
+
+			// New root not NULL, "instantiate" the whole scene
+			GraphPtr self = shared_from_this();
+			InstanceSubgraphWalker instanceWalker(self);
+			_root->traverse(instanceWalker);
+		}
+
+		linkPendingNodes();
 	}
 }
 
@@ -119,7 +130,15 @@ void SceneGraph::insert(const INodePtr& node)
 	sceneChanged();
 
 	// Insert this node into our SP tree
-	_spacePartition->link(node);
+	if (_linkBatchOngoing)
+	{
+		_pendingLinks.push_back(node);
+		_pendingLinkSet.insert(node.get());
+	}
+	else
+	{
+		_spacePartition->link(node);
+	}
 
 	// Call the onInsert event on the node
     assert(_root);
@@ -139,7 +158,11 @@ void SceneGraph::erase(const INodePtr& node)
         return;
     }
 
-	_spacePartition->unlink(node);
+	if (!_spacePartition->unlink(node))
+	{
+		// The node might not have been linked yet
+		_pendingLinkSet.erase(node.get());
+	}
 
 	// Fire the onRemove event on the Node
     assert(_root);
@@ -278,9 +301,27 @@ bool SceneGraph::foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& vo
 	// Now consider the children
 	const ISPNode::NodeList& children = node.getChildNodes();
 
-	for (ISPNode::NodeList::const_iterator i = children.begin(); i != children.end(); ++i)
+	if (children.empty())
 	{
-		if (volume.TestAABB((*i)->getBounds()) == VOLUME_OUTSIDE)
+		return true;
+	}
+
+	// Test all child bounds in one go, the usual (up to) 8 children fit into the local array
+	VolumeIntersectionValue localResults[8];
+	std::vector<VolumeIntersectionValue> allocatedResults;
+	VolumeIntersectionValue* results = localResults;
+
+	if (children.size() > 8)
+	{
+		allocatedResults.resize(children.size());
+		results = allocatedResults.data();
+	}
+
+	volume.TestAABBs(node.getChildBounds(), results);
+
+	for (std::size_t i = 0; i < children.size(); ++i)
+	{
+		if (results[i] == VOLUME_OUTSIDE)
 		{
 			// Skip this node, not visible
 			_skippedSPNodes++;
@@ -288,7 +329,7 @@ bool SceneGraph::foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& vo
 		}
 
 		// Traverse all the children too, enter recursion
-		if (!foreachNodeInVolume_r(**i, volume, functor, visitHidden))
+		if (!foreachNodeInVolume_r(*children[i], volume, functor, visitHidden))
 		{
 			// The walker returned false somewhere in the recursion depths, propagate this message
 			return false;
@@ -303,26 +344,82 @@ ISpacePartitionSystemPtr SceneGraph::getSpacePartition()
 	return _spacePartition;
 }
 
+void SceneGraph::setSpacePartitionType(SpacePartitionType type)
+{
+	if (_spacePartitionType == type) return;
+
+	_spacePartitionType = type;
+	_spacePartition = createSpacePartitionSystem(_spacePartitionType);
+
+	if (!_root) return;
+
+	// Re-link all nodes of the current scene
+	std::vector<scene::INodePtr> nodes;
+
+	foreachNode([&](const INodePtr& node)
+	{
+		nodes.push_back(node);
+		return true;
+	});
+
+	_spacePartition->linkAll(nodes);
+}
+
 void SceneGraph::flushActionBuffer()
 {
-    // Do any actions now, in the same order they came in
-    for (NodeAction& action : _actionBuffer)
+    if (_actionBuffer.empty()) return;
+
+    {
+        // Inserted nodes are linked into the space partition in one batch
+        util::ScopedBoolLock batch(_linkBatchOngoing);
+
+        // Do any actions now, in the same order they came in
+        for (NodeAction& action : _actionBuffer)
+        {
+            switch (action.first)
+            {
+            case Insert:
+                insert(action.second);
+                break;
+            case Erase:
+                erase(action.second);
+                break;
+            case BoundsChange:
+                nodeBoundsChanged(action.second);
+                break;
+            };
+        }
+
+        _actionBuffer.clear();
+    }
+
+    linkPendingNodes();
+}
+
+void SceneGraph::linkPendingNodes()
+{
+    // Don't link anything while an outer batch is still collecting
+    if (_linkBatchOngoing || _pendingLinks.empty()) return;
+
+    std::vector<scene::INodePtr> pending;
+    pending.reserve(_pendingLinkSet.size());
+
+    // Skip the nodes erased in the meantime, and link re-inserted ones only once
+    for (const auto& node : _pendingLinks)
     {
-        switch (action.first)
+        if (_pendingLinkSet.erase(node.get()) > 0)
         {
-        case Insert:
-            insert(action.second);
-            break;
-        case Erase:
-            erase(action.second);
-            break;
-        case BoundsChange:
-            nodeBoundsChanged(action.second);
-            break;
-        };
+            pending.push_back(node);
+        }
     }
 
-    _actionBuffer.clear();
+    _pendingLinks.clear();
+    _pendingLinkSet.clear();
+
+    if (!pending.empty())
+    {
+        _spacePartition->linkAll(pending);
+    }
 }
 
 // RegisterableModule implementation
@@ -341,6 +438,8 @@ const StringSet& SceneGraphModule::getDependencies() const
 void SceneGraphModule::initialiseModule(const IApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called" << std::endl;
+
+	setSpacePartitionType(getSpacePartitionTypeFromArgs(ctx));
 }
 
 // Static module instances
@@ -2,6 +2,8 @@
 
 #include <map>
 #include <list>
+#include <vector>
+#include <unordered_set>
 #include <sigc++/signal.h>
 
 #include "iscenegraph.h"
@@ -32,6 +34,7 @@ private:
     IMapRootNodePtr _root;
 
 	// The space partitioning system
+	SpacePartitionType _spacePartitionType;
 	ISpacePartitionSystemPtr _spacePartition;
 
 	std::size_t _visitedSPNodes;
@@ -51,8 +54,17 @@ private:
 
     bool _traversalOngoing;
 
+    // While instantiating a whole subgraph or flushing the action buffer
+    // the nodes are collected and linked into the space partition in one go
+    bool _linkBatchOngoing;
+    std::vector<scene::INodePtr> _pendingLinks;
+
+    // The nodes in _pendingLinks which are still to be linked. Erased nodes
+    // are only removed from this set, their stale entries are skipped later.
+    std::unordered_set<scene::INode*> _pendingLinkSet;
+
 public:
-	SceneGraph();
+	SceneGraph(SpacePartitionType spacePartitionType = SpacePartitionType::Octree);
 
 	~SceneGraph();
 
@@ -92,6 +104,10 @@ public:
     void foreachVisibleNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor) override;
 
     ISpacePartitionSystemPtr getSpacePartition() override;
+
+	// Replaces the space partition with one of the given type, re-linking all nodes
+	void setSpacePartitionType(SpacePartitionType type);
+
 private:
 	void foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor, bool visitHidden);
 
@@ -100,6 +116,9 @@ private:
 							   const INode::VisitorFunc& functor, bool visitHidden);
 
     void flushActionBuffer();
+
+    // Links all nodes collected during a batch into the space partition
+    void linkPendingNodes();
 };
 typedef std::shared_ptr<SceneGraph> SceneGraphPtr;
 
@@ -1,14 +1,70 @@
 #include "SceneGraphFactory.h"
 
 #include "itextstream.h"
+#include "string/predicate.h"
 #include "SceneGraph.h"
+#include "Octree.h"
+#include "AABBTree.h"
 
 namespace scene
 {
 
+namespace
+{
+	const char* const SPACE_PARTITION_ARG = "--space-partition=";
+}
+
+ISpacePartitionSystemPtr createSpacePartitionSystem(SpacePartitionType type)
+{
+	switch (type)
+	{
+	case SpacePartitionType::AABBTree:
+		return std::make_shared<AABBTree>();
+	case SpacePartitionType::Octree:
+	default:
+		return std::make_shared<Octree>();
+	};
+}
+
+SpacePartitionType getSpacePartitionTypeFromArgs(const IApplicationContext& ctx)
+{
+	for (const std::string& arg : ctx.getCmdLineArgs())
+	{
+		if (!string::istarts_with(arg, SPACE_PARTITION_ARG)) continue;
+
+		std::string value = arg.substr(std::char_traits<char>::length(SPACE_PARTITION_ARG));
+
+		if (string::iequals(value, "aabbtree"))
+		{
+			return SpacePartitionType::AABBTree;
+		}
+
+		if (!string::iequals(value, "octree"))
+		{
+			rWarning() << "Unknown space partition type: " << value << ", using the Octree" << std::endl;
+		}
+	}
+
+	return SpacePartitionType::Octree;
+}
+
+SceneGraphFactory::SceneGraphFactory() :
+	_spacePartitionType(SpacePartitionType::Octree)
+{}
+
 GraphPtr SceneGraphFactory::createSceneGraph()
 {
-	return std::make_shared<SceneGraph>();
+	return createSceneGraph(_spacePartitionType);
+}
+
+GraphPtr SceneGraphFactory::createSceneGraph(SpacePartitionType type)
+{
+	return std::make_shared<SceneGraph>(type);
+}
+
+ISpacePartitionSystemPtr SceneGraphFactory::createSpacePartition(SpacePartitionType type)
+{
+	return createSpacePartitionSystem(type);
 }
 
 const std::string& SceneGraphFactory::getName() const
@@ -26,6 +82,8 @@ const StringSet& SceneGraphFactory::getDependencies() const
 void SceneGraphFactory::initialiseModule(const IApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called." << std::endl;
+
+	_spacePartitionType = getSpacePartitionTypeFromArgs(ctx);
 }
 
 } // namespace
@@ -8,8 +8,15 @@ namespace scene
 class SceneGraphFactory :
 	public ISceneGraphFactory
 {
+private:
+	SpacePartitionType _spacePartitionType;
+
 public:
-	GraphPtr createSceneGraph();
+	SceneGraphFactory();
+
+	GraphPtr createSceneGraph() override;
+	GraphPtr createSceneGraph(SpacePartitionType type) override;
+	ISpacePartitionSystemPtr createSpacePartition(SpacePartitionType type) override;
 
 	// RegisterableModule implementation
 	const std::string& getName() const;
@@ -18,4 +25,11 @@ public:
 };
 typedef std::shared_ptr<SceneGraphFactory> SceneGraphFactoryPtr;
 
+// Creates a new space partition system of the given type
+ISpacePartitionSystemPtr createSpacePartitionSystem(SpacePartitionType type);
+
+// Returns the space partition type requested on the command line
+// (--space-partition=octree|aabbtree), defaults to the Octree
+SpacePartitionType getSpacePartitionTypeFromArgs(const IApplicationContext& ctx);
+
 } // namespace
@@ -45,7 +45,8 @@ RadiantSelectionSystem::RadiantSelectionSystem() :
     _mode(ePrimitive),
     _componentMode(eDefault),
     _countPrimitive(0),
-    _countComponent(0)
+    _countComponent(0),
+    _bulkChangeLevel(0)
 {}
 
 const SelectionInfo& RadiantSelectionSystem::getSelectionInfo() {
@@ -75,21 +76,104 @@ void RadiantSelectionSystem::notifyObservers(const scene::INodePtr& node, bool i
     }
 }
 
+void RadiantSelectionSystem::onSelectionChanged(const scene::INodePtr& node, const ISelectable& selectable, bool isComponent)
+{
+    if (_bulkChangeLevel > 0)
+    {
+        (isComponent ? _bulkChangedComponents : _bulkChangedNodes).push_back(node);
+        return;
+    }
+
+    // greebo: Moved this here, the selectionInfo structure should be up to date before calling this
+    _sigSelectionChanged(selectable);
+
+    notifyObservers(node, isComponent);
+}
+
+void RadiantSelectionSystem::beginBulkSelectionChange()
+{
+    ++_bulkChangeLevel;
+}
+
+void RadiantSelectionSystem::endBulkSelectionChange()
+{
+    assert(_bulkChangeLevel > 0);
+
+    if (--_bulkChangeLevel > 0) return;
+
+    // Move the lists out of the way, the observers might start another bulk change
+    std::vector<scene::INodePtr> changedNodes;
+    std::vector<scene::INodePtr> changedComponents;
+    changedNodes.swap(_bulkChangedNodes);
+    changedComponents.swap(_bulkChangedComponents);
+
+    if (changedNodes.empty() && changedComponents.empty()) return;
+
+    // The selectable of the last changed node is passed along with the signal,
+    // the selection info is already reflecting all the changes
+    const auto& lastChanged = changedComponents.empty() ? changedNodes.back() : changedComponents.back();
+    auto selectable = Node_getSelectable(lastChanged);
+
+    if (selectable)
+    {
+        _sigSelectionChanged(*selectable);
+    }
+
+    for (ObserverList::iterator i = _observers.begin(); i != _observers.end(); )
+    {
+        Observer* observer = *i++;
+
+        if (!changedNodes.empty())
+        {
+            observer->selectionChangedInBulk(changedNodes, false);
+        }
+
+        if (!changedComponents.empty())
+        {
+            observer->selectionChangedInBulk(changedComponents, true);
+        }
+    }
+}
+
 void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, SelectionTest& test,
                                              const VolumeTest& view, SelectionSystem::EMode mode,
-                                             SelectionSystem::EComponentMode componentMode)
+                                             SelectionSystem::EComponentMode componentMode,
+                                             bool nearestOnly)
 {
     // The (temporary) storage pool
     SelectionPool selector;
     SelectionPool sel2;
 
+    // Nodes are tested front to back, the traversal can stop as soon as the nearest item is known
+    const SelectionPool* nearestOnlyPool = nearestOnly ? &selector : nullptr;
+
+    // Without early out, all nodes in the volume need to be tested. These tests are
+    // independent of each other and can be spread across several threads.
+    auto testVisibleNodes = [&](SelectionPool& pool, const SelectionPool* earlyOutPool,
+        const SelectionTestWalkerFactory& createWalker)
+    {
+        if (earlyOutPool)
+        {
+            auto walker = createWalker(pool, test);
+            foreachVisibleNodeFrontToBack(view, *walker, earlyOutPool);
+        }
+        else
+        {
+            foreachVisibleNodeInParallel(view, test, pool, createWalker);
+        }
+    };
+
+    auto createEntitySelector = [](Selector& target, SelectionTest& walkerTest)
+    {
+        return std::unique_ptr<scene::Graph::Walker>(new EntitySelector(target, walkerTest));
+    };
+
     switch(mode)
     {
         case eEntity:
         {
-            // Instantiate a walker class which is specialised for selecting entities
-            EntitySelector entityTester(selector, test);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(view, entityTester);
+            // Use a walker class which is specialised for selecting entities
+            testVisibleNodes(selector, nearestOnlyPool, createEntitySelector);
 
             std::for_each(selector.begin(), selector.end(), [&](const auto& p) { targetList.push_back(p.second); });
         }
@@ -101,20 +185,27 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
             if (view.fill() || !higherEntitySelectionPriority())
             {
                 // Test for any visible elements (primitives, entities), but don't select child primitives
-                AnySelector anyTester(selector, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, anyTester);
+                testVisibleNodes(selector, nearestOnlyPool, [](Selector& target, SelectionTest& walkerTest)
+                {
+                    return std::unique_ptr<scene::Graph::Walker>(new AnySelector(target, walkerTest));
+                });
             }
             else
             {
                 // We have an orthoview, here, select entities first
 
                 // First, obtain all the selectable entities
-                EntitySelector entityTester(selector, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, entityTester);
+                testVisibleNodes(selector, nearestOnlyPool, createEntitySelector);
 
-                // Now retrieve all the selectable primitives
-                PrimitiveSelector primitiveTester(sel2, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, primitiveTester);
+                // Now retrieve all the selectable primitives, these are sorted in behind
+                // the entities, so they are not needed if only the nearest item is requested
+                if (!nearestOnly || selector.empty())
+                {
+                    testVisibleNodes(sel2, nearestOnly ? &sel2 : nullptr, [](Selector& target, SelectionTest& walkerTest)
+                    {
+                        return std::unique_ptr<scene::Graph::Walker>(new PrimitiveSelector(target, walkerTest));
+                    });
+                }
             }
 
             // Add the first selection crop to the target vector
@@ -138,8 +229,10 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
         case eGroupPart:
         {
             // Retrieve all the selectable primitives of group nodes
-            GroupChildPrimitiveSelector primitiveTester(selector, test);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(view, primitiveTester);
+            testVisibleNodes(selector, nearestOnlyPool, [](Selector& target, SelectionTest& walkerTest)
+            {
+                return std::unique_ptr<scene::Graph::Walker>(new GroupChildPrimitiveSelector(target, walkerTest));
+            });
 
             // Add the selection crop to the target vector
             std::for_each(selector.begin(), selector.end(), [&](const auto& p) { targetList.push_back(p.second); });
@@ -157,8 +250,10 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
 
         case eMergeAction:
         {
-            MergeActionSelector tester(selector, test);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(view, tester);
+            testVisibleNodes(selector, nearestOnlyPool, [](Selector& target, SelectionTest& walkerTest)
+            {
+                return std::unique_ptr<scene::Graph::Walker>(new MergeActionSelector(target, walkerTest));
+            });
 
             // Add the selection crop to the target vector
             std::for_each(selector.begin(), selector.end(), [&](const auto& p) { targetList.push_back(p.second); });
@@ -370,11 +465,8 @@ void RadiantSelectionSystem::onSelectedChanged(const scene::INodePtr& node, cons
         _selection.erase(node);
     }
 
-	// greebo: Moved this here, the selectionInfo structure should be up to date before calling this
-	_sigSelectionChanged(selectable);
-
     // Notify observers, FALSE = primitive selection change
-    notifyObservers(node, false);
+    onSelectionChanged(node, selectable, false);
 
     // Check if the number of selected primitives in the list matches the value of the selection counter
     ASSERT_MESSAGE(_selection.size() == _countPrimitive, "selection-tracking error");
@@ -407,11 +499,8 @@ void RadiantSelectionSystem::onComponentSelection(const scene::INodePtr& node, c
         _componentSelection.erase(node);
     }
 
-	// Moved here, since the _selectionInfo struct needs to be up to date
-	_sigSelectionChanged(selectable);
-
     // Notify observers, TRUE => this is a component selection change
-    notifyObservers(node, true);
+    onSelectionChanged(node, selectable, true);
 
     // Check if the number of selected components in the list matches the value of the selection counter
     ASSERT_MESSAGE(_componentSelection.size() == _countComponent, "component selection-tracking error");
@@ -441,11 +530,26 @@ scene::INodePtr RadiantSelectionSystem::penultimateSelected()
 // Deselect or select all the instances in the scenegraph and notify the manipulator class as well
 void RadiantSelectionSystem::setSelectedAll(bool selected)
 {
-	GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
-	{
-		Node_setSelected(node, selected);
-		return true;
-	});
+    ScopedBulkSelectionChange bulkChange(*this);
+
+    if (selected)
+    {
+        GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
+        {
+            Node_setSelected(node, selected);
+            return true;
+        });
+    }
+    else
+    {
+        // Only the selected nodes need to be visited, deselecting them modifies the list
+        std::vector<scene::INodePtr> selectedNodes(_selection.begin(), _selection.end());
+
+        for (const auto& node : selectedNodes)
+        {
+            Node_setSelected(node, false);
+        }
+    }
 
     _activeManipulator->setSelected(selected);
 }
@@ -455,6 +559,8 @@ void RadiantSelectionSystem::setSelectedAllComponents(bool selected)
 {
 	const scene::INodePtr& root = GlobalSceneGraph().root();
 
+	ScopedBulkSelectionChange bulkChange(*this);
+
 	if (root)
 	{
 		// Select all components in the scene, be it vertices, edges or faces
@@ -483,7 +589,7 @@ void RadiantSelectionSystem::foreachSelectedComponent(const Visitor& visitor)
          i != _componentSelection.end();
          /* in-loop increment */)
     {
-        visitor.visit((i++)->first);
+        visitor.visit(*i++);
     }
 }
 
@@ -493,7 +599,7 @@ void RadiantSelectionSystem::foreachSelected(const std::function<void(const scen
          i != _selection.end();
          /* in-loop increment */)
     {
-        functor((i++)->first);
+        functor(*i++);
     }
 }
 
@@ -503,7 +609,7 @@ void RadiantSelectionSystem::foreachSelectedComponent(const std::function<void(c
          i != _componentSelection.end();
          /* in-loop increment */)
     {
-        functor((i++)->first);
+        functor(*i++);
     }
 }
 
@@ -515,7 +621,7 @@ void RadiantSelectionSystem::foreachBrush(const std::function<void(Brush&)>& fun
          i != _selection.end();
          /* in-loop increment */)
     {
-		walker.visit((i++)->first); // Handles group nodes recursively
+		walker.visit(*i++); // Handles group nodes recursively
     }
 }
 
@@ -527,7 +633,7 @@ void RadiantSelectionSystem::foreachFace(const std::function<void(IFace&)>& func
          i != _selection.end();
          /* in-loop increment */)
     {
-		walker.visit((i++)->first); // Handles group nodes recursively
+		walker.visit(*i++); // Handles group nodes recursively
     }
 
 	// Handle the component selection too
@@ -542,7 +648,7 @@ void RadiantSelectionSystem::foreachPatch(const std::function<void(IPatch&)>& fu
          i != _selection.end();
          /* in-loop increment */)
     {
-		walker.visit((i++)->first); // Handles group nodes recursively
+		walker.visit(*i++); // Handles group nodes recursively
     }
 }
 
@@ -588,12 +694,15 @@ void RadiantSelectionSystem::selectPoint(SelectionTest& test, EModifier modifier
     // The possible candidates are stored in the SelectablesSet
     SelectablesList candidates;
 
+    // Cycling through the items needs all of them, the other modes just pick the topmost one
+    bool nearestOnly = modifier == SelectionSystem::eToggle || modifier == SelectionSystem::eReplace;
+
     if (face)
     {
         SelectionPool selector;
 
         ComponentSelector selectionTester(selector, test, eFace);
-        GlobalSceneGraph().foreachVisibleNodeInVolume(test.getVolume(), selectionTester);
+        foreachVisibleNodeFrontToBack(test.getVolume(), selectionTester, nearestOnly ? &selector : nullptr);
 
         // Load them all into the vector
         for (SelectionPool::const_iterator i = selector.begin(); i != selector.end(); ++i)
@@ -602,7 +711,7 @@ void RadiantSelectionSystem::selectPoint(SelectionTest& test, EModifier modifier
         }
     }
     else {
-        testSelectScene(candidates, test, test.getVolume(), Mode(), ComponentMode());
+        testSelectScene(candidates, test, test.getVolume(), Mode(), ComponentMode(), nearestOnly);
     }
 
     // Was the selection test successful (have we found anything to select)?
@@ -704,6 +813,9 @@ void RadiantSelectionSystem::performPointSelection(const SelectablesList& candid
 
 void RadiantSelectionSystem::selectArea(SelectionTest& test, SelectionSystem::EModifier modifier, bool face)
 {
+    // Area selections can change a lot of nodes, notify the observers once
+    ScopedBulkSelectionChange bulkChange(*this);
+
     // If we are in replace mode, deselect all the components or previous selections
     if (modifier == SelectionSystem::eReplace)
     {
@@ -1055,7 +1167,7 @@ void RadiantSelectionSystem::shutdownModule()
     {
         // Take a reference to the node and increment the iterator while the
         // iterator is still valid.
-        scene::INodePtr node = (i++)->first;
+        scene::INodePtr node = *i++;
 
         // If this is a selectable node, unselect it (which might remove it from
         // the map and invalidate the original iterator)
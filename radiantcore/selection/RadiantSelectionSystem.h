@@ -63,6 +63,11 @@ private:
 	SelectionListType _selection;
 	SelectionListType _componentSelection;
 
+	// The nesting level of bulk selection changes, and the nodes changed so far
+	std::size_t _bulkChangeLevel;
+	std::vector<scene::INodePtr> _bulkChangedNodes;
+	std::vector<scene::INodePtr> _bulkChangedComponents;
+
 	// The coordinates of the mouse pointer when the manipulation starts
 	Vector2 _deviceStart;
 
@@ -127,6 +132,9 @@ public:
 	void setSelectedAll(bool selected) override;
 	void setSelectedAllComponents(bool selected) override;
 
+	void beginBulkSelectionChange() override;
+	void endBulkSelectionChange() override;
+
 	void foreachSelected(const std::function<void(const scene::INodePtr&)>& functor) override;
 	void foreachSelectedComponent(const Visitor& visitor) override;
 	void foreachSelectedComponent(const std::function<void(const scene::INodePtr&)>& functor) override;
@@ -175,15 +183,21 @@ public:
 
 protected:
 	// Traverses the scene and adds any selectable nodes matching the given SelectionTest to the "targetList".
+	// If nearestOnly is true, only the first element of the list is guaranteed to be correct,
+	// this allows the traversal to stop early.
 	void testSelectScene(SelectablesList& targetList, SelectionTest& test,
 						 const VolumeTest& view, SelectionSystem::EMode mode,
-						 SelectionSystem::EComponentMode componentMode);
+						 SelectionSystem::EComponentMode componentMode, bool nearestOnly = false);
 
 private:
 	bool higherEntitySelectionPriority() const;
 
 	void notifyObservers(const scene::INodePtr& node, bool isComponent);
 
+	// Notifies the observers and emits the selection changed signal, or records
+	// the change until the end of the current bulk change
+	void onSelectionChanged(const scene::INodePtr& node, const ISelectable& selectable, bool isComponent);
+
 	std::size_t getManipulatorIdForType(Manipulator::Type type);
 
 	// Command targets used to connect to the event system
@@ -1,119 +1,67 @@
 #include "SelectedNodeList.h"
 
-const scene::INodePtr& SelectedNodeList::ultimate() {
-	if (size() == 0) {
-		return end()->first; // return invalid iterator
-	}
-
-	std::size_t latestTime(0);
-	iterator latest;
+#include <cassert>
+#include <iterator>
 
-	for (iterator i = begin(); i != end(); i++) {
-		if (i->second > latestTime) {
-			latestTime = i->second;
-			latest = i;
-		}
-	}
+const scene::INodePtr& SelectedNodeList::ultimate() const
+{
+	assert(!_nodes.empty());
+	return _nodes.back();
+}
 
-	return latest->first;
+const scene::INodePtr& SelectedNodeList::penultimate() const
+{
+	assert(_nodes.size() > 1);
+	return *std::prev(_nodes.end(), 2);
 }
 
-const scene::INodePtr& SelectedNodeList::ultimate() const {
-	if (size() == 0) {
-		return end()->first; // return invalid iterator
-	}
+void SelectedNodeList::append(const scene::INodePtr& selected)
+{
+	auto inserted = _nodes.insert(_nodes.end(), selected);
 
-	std::size_t latestTime(0);
-	const_iterator latest;
+	auto result = _index.emplace(selected.get(), Entry{ inserted, 1 });
 
-	for (const_iterator i = begin(); i != end(); i++) {
-		if (i->second > latestTime) {
-			latestTime = i->second;
-			latest = i;
-		}
+	if (!result.second)
+	{
+		// Already in the list, the new occurrence is the latest one
+		result.first->second.latest = inserted;
+		++result.first->second.count;
 	}
-
-	return latest->first;
 }
 
-const scene::INodePtr& SelectedNodeList::penultimate() const {
-	if (size() <= 1) {
-		return end()->first; // return invalid iterator
-	}
+void SelectedNodeList::erase(const scene::INodePtr& selected)
+{
+	auto found = _index.find(selected.get());
 
-	std::size_t ultimateTime(0);
-	std::size_t penUltimateTime(0);
-	const_iterator ultimate;
-	const_iterator penUltimate;
-
-	for (const_iterator i = begin(); i != end(); i++) {
-		if (i->second > ultimateTime) {
-			penUltimateTime = ultimateTime;
-			penUltimate = ultimate;
-
-			ultimateTime = i->second;
-			ultimate = i;
-		}
-		else if (i->second > penUltimateTime) {
-			penUltimateTime = i->second;
-			penUltimate = i;
-		}
-	}
+	assert(found != _index.end());
 
-	return penUltimate->first;
-}
+	if (found == _index.end()) return;
 
-const scene::INodePtr& SelectedNodeList::penultimate() {
-	if (size() <= 1) {
-		return end()->first; // return invalid iterator
-	}
+	Entry& entry = found->second;
 
-	std::size_t ultimateTime(0);
-	std::size_t penUltimateTime(0);
-	iterator ultimate;
-	iterator penUltimate;
-
-	for (iterator i = begin(); i != end(); i++) {
-		if (i->second > ultimateTime) {
-			penUltimateTime = ultimateTime;
-			penUltimate = ultimate;
-
-			ultimateTime = i->second;
-			ultimate = i;
-		}
-		else if (i->second > penUltimateTime) {
-			penUltimateTime = i->second;
-			penUltimate = i;
-		}
+	if (--entry.count == 0)
+	{
+		_nodes.erase(entry.latest);
+		_index.erase(found);
+		return;
 	}
 
-	return penUltimate->first;
-}
-
-void SelectedNodeList::append(const scene::INodePtr& selected) {
-	time++;
-	MapType::insert(value_type(selected, time));
-}
-
-void SelectedNodeList::erase(const scene::INodePtr& selected) {
-	iterator last;
-	std::size_t lastTime(0);
+	// Multiple occurrences are rare, search the one before the removed element
+	auto previous = std::make_reverse_iterator(entry.latest);
 
-	// Lookup the instance selected last
-	for (iterator it = MapType::find(selected);
-		 it != upper_bound(selected) && it != end();
-		 it++)
+	while (previous->get() != selected.get())
 	{
-		if (it->second > lastTime) {
-			last = it;
-			lastTime = it->second;
-		}
+		++previous;
 	}
 
-	assert(last != end());
+	auto removed = entry.latest;
+	entry.latest = std::prev(previous.base());
 
-	// Remove the element selected last, leave the others
-	MapType::erase(last);
+	_nodes.erase(removed);
 }
 
-std::size_t SelectedNodeList::time = 1;
+void SelectedNodeList::clear()
+{
+	_nodes.clear();
+	_index.clear();
+}
@@ -1,49 +1,79 @@
 #ifndef SELECTEDNODELIST_H_
 #define SELECTEDNODELIST_H_
 
-#include <map>
+#include <list>
+#include <unordered_map>
 #include "inode.h"
 
 /**
- * greebo: This container adapts a std::multimap to keep track of
- * all the selected nodes in the scene. Additionally,
- * the insertion order is remembered to allow for retrieval
- * of the ultimate/penultimate selected node.
+ * greebo: This container keeps track of all the selected nodes
+ * in the scene. The nodes are kept in insertion order, which allows
+ * for retrieval of the ultimate/penultimate selected node.
  *
  * It also allows for the same node occuring multiple times in
- * the map at once. On deletion, the node which has been added
+ * the list at once. On deletion, the node which has been added
  * latest is removed.
  *
- * It is not as fast when inserting new elements as std::list but
- * allows for fast lookup of arbitrary nodes.
+ * The nodes are indexed by a hash map, such that appending, removing
+ * and looking up the most recent nodes runs in constant time, also
+ * for selections containing hundreds of thousands of nodes.
  *
- * Also, the map interface is extended by the penultimate() accessor
- * which is needed by the RadiantSelectionSystem.
+ * Removing a node while iterating is allowed, as long as the iterator
+ * is not pointing to the removed node.
  */
-class SelectedNodeList :
-	public std::multimap<scene::INodePtr, std::size_t>
+class SelectedNodeList
 {
-	// Shortcut typedef
-	typedef std::multimap<scene::INodePtr, std::size_t> MapType;
+public:
+	typedef std::list<scene::INodePtr> NodeList;
+	typedef NodeList::const_iterator const_iterator;
+
+private:
+	// All nodes in insertion order
+	NodeList _nodes;
+
+	struct Entry
+	{
+		// The latest occurrence of the node in the list
+		NodeList::iterator latest;
+
+		// The number of occurrences
+		std::size_t count;
+	};
+
+	std::unordered_map<scene::INode*, Entry> _index;
 
-	// This is an ever-incrementing counter, some sort of "insertion time"
-	static std::size_t time;
 public:
+	const_iterator begin() const
+	{
+		return _nodes.begin();
+	}
+
+	const_iterator end() const
+	{
+		return _nodes.end();
+	}
+
+	std::size_t size() const
+	{
+		return _nodes.size();
+	}
+
+	bool empty() const
+	{
+		return _nodes.empty();
+	}
+
 	/**
 	 * greebo: Returns the element which has been inserted last.
-	 *
-	 * Note: Runs in linear time = SLOW
+	 * The list must not be empty.
 	 */
-	const scene::INodePtr& ultimate();
 	const scene::INodePtr& ultimate() const;
 
 	/**
 	 * greebo: Returns the element right before the last selected.
-	 *
-	 * Note: Runs in linear time = SLOW
+	 * The list must contain at least two elements.
 	 */
 	const scene::INodePtr& penultimate() const;
-	const scene::INodePtr& penultimate();
 
 	/**
 	 * greebo: Inserts a new element to this container.
@@ -54,11 +84,13 @@ public:
 
 	/**
 	 * greebo: Removes the node which has been selected last
-	 * from this map. If multiple nodes with the same
-	 * address exist in the map, only the one with the
-	 * highest time is removed, the others are left.
+	 * from this list. If multiple occurrences of the same
+	 * node exist in the list, only the latest one is removed,
+	 * the others are left.
 	 */
 	void erase(const scene::INodePtr& selected);
+
+	void clear();
 };
 
 #endif /*SELECTEDNODELIST_H_*/
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <map>
+#include <vector>
 #include "iselectiontest.h"
 #include "iselectable.h"
 
@@ -29,17 +31,33 @@ private:
 	SelectionIntersection _curIntersection;
 	ISelectable* _curSelectable;
 
+	// Assigned to the selectables added from now on, see merge()
+	std::size_t _curRank;
+
+	struct Candidate
+	{
+		SelectableSortedSet::iterator entry;
+		std::size_t rank;
+	};
+
 	// A set of all current ISelectable* candidates, to prevent double-insertions
 	// The iterator value points to an element in the SelectableSortedSet
 	// to allow for fast lookup and removal.
-	typedef std::map<ISelectable*, SelectableSortedSet::iterator> SelectablesMap;
+	typedef std::map<ISelectable*, Candidate> SelectablesMap;
 	SelectablesMap _currentSelectables;
 
 public:
 	SelectionPool() :
-		_curSelectable(nullptr)
+		_curSelectable(nullptr),
+		_curRank(0)
 	{}
 
+	// The rank is usually the position of the tested node in the scene traversal
+	void setRank(std::size_t rank)
+	{
+		_curRank = rank;
+	}
+
 	// This is called before an entity/patch/brush is tested 
 	// to notify the SelectionPool which Selectable we're talking about.
 	void pushSelectable(ISelectable& selectable) override
@@ -85,10 +103,10 @@ public:
 			// To prevent the "worse" primitive from shadowing the "better" one, perform this check.
 
 			// Check if the intersection is better
-			if (intersection < existing->second->first)
+			if (intersection < existing->second.entry->first)
 			{
 				// Yes, update the map, remove old stuff first
-				_pool.erase(existing->second);
+				_pool.erase(existing->second.entry);
 				_currentSelectables.erase(existing);
 			}
 			else
@@ -105,7 +123,48 @@ public:
 		);
 
 		// Memorise the Selectable for fast lookups
-		_currentSelectables.insert(std::make_pair(selectable, result));
+		_currentSelectables.insert(std::make_pair(selectable, Candidate{ result, _curRank }));
+	}
+
+	/**
+	 * Adds the selectables of the given pools, keeping the better intersection of
+	 * duplicates. Selectables with equal intersections end up ordered by their rank,
+	 * the same way they would have been if they had all been added to a single pool
+	 * in rank order. This doesn't depend on how they were spread across the pools.
+	 */
+	void merge(const std::vector<SelectionPool>& others)
+	{
+		struct Entry
+		{
+			const SelectionIntersection* intersection;
+			std::size_t rank;
+			ISelectable* selectable;
+		};
+
+		std::vector<Entry> entries;
+
+		for (const auto& other : others)
+		{
+			for (const auto& pair : other._pool)
+			{
+				auto rank = other._currentSelectables.find(pair.second)->second.rank;
+				entries.push_back(Entry{ &pair.first, rank, pair.second });
+			}
+		}
+
+		std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+		{
+			if (*a.intersection < *b.intersection) return true;
+			if (*b.intersection < *a.intersection) return false;
+
+			return a.rank < b.rank;
+		});
+
+		for (const auto& entry : entries)
+		{
+			setRank(entry.rank);
+			addSelectable(*entry.intersection, entry.selectable);
+		}
 	}
 
 	const_iterator begin() const
@@ -118,7 +177,7 @@ public:
 		return _pool.end();
 	}
 
-	bool empty()
+	bool empty() const
 	{
 		return _pool.empty();
 	}
@@ -1,5 +1,7 @@
 #include "SelectionTestWalkers.h"
 
+#include <algorithm>
+#include <vector>
 #include "itextstream.h"
 #include "iselectable.h"
 #include "imodel.h"
@@ -7,10 +9,136 @@
 #include "iselectiontest.h"
 #include "entitylib.h"
 #include "debugging/ScenegraphUtils.h"
+#include "scene/ParallelChunks.h"
+#include "selection/TriangleBVH.h"
 
 namespace selection
 {
 
+void foreachVisibleNodeFrontToBack(const VolumeTest& volume, scene::Graph::Walker& walker,
+	const SelectionPool* nearestOnlyPool)
+{
+	struct Candidate
+	{
+		double depth;
+		scene::INodePtr node;
+	};
+
+	std::vector<Candidate> candidates;
+
+	GlobalSceneGraph().foreachVisibleNodeInVolume(volume, [&](const scene::INodePtr& node)
+	{
+		const AABB& bounds = node->worldAABB();
+
+		if (!bounds.isValid())
+		{
+			// No depth available, test these first
+			candidates.push_back({ -1, node });
+			return true;
+		}
+
+		// The members of a space partition node are not culled individually
+		if (volume.TestAABB(bounds) != VOLUME_OUTSIDE)
+		{
+			candidates.push_back({ getNearestDepth(bounds, volume.GetViewProjection()), node });
+		}
+
+		return true;
+	});
+
+	// Nodes of equal depth keep the order of the space partition traversal
+	std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+	{
+		return a.depth < b.depth;
+	});
+
+	for (const auto& candidate : candidates)
+	{
+		if (nearestOnlyPool && !nearestOnlyPool->empty() &&
+			isBehindIntersection(nearestOnlyPool->begin()->first, candidate.depth))
+		{
+			break;
+		}
+
+		if (!walker.visit(candidate.node))
+		{
+			break;
+		}
+	}
+}
+
+namespace
+{
+	// Most nodes are rejected by a bounds test or have few primitives to test,
+	// a thread is only worth it for a few hundred of them
+	constexpr std::size_t MIN_NODES_PER_THREAD = 256;
+}
+
+void foreachVisibleNodeInParallel(const VolumeTest& volume, SelectionTest& test, SelectionPool& pool,
+	const SelectionTestWalkerFactory& createWalker)
+{
+	// Every node is ranked by its position in the traversal
+	struct RankedNode
+	{
+		std::size_t rank;
+		scene::INodePtr node;
+	};
+
+	std::vector<RankedNode> concurrentNodes;
+	std::vector<RankedNode> serialNodes;
+	std::size_t numVisited = 0;
+
+	GlobalSceneGraph().foreachVisibleNodeInVolume(volume, [&](const scene::INodePtr& node)
+	{
+		auto testable = Node_getSelectionTestable(node);
+
+		if (testable && testable->supportsConcurrentSelectionTest())
+		{
+			// Make sure the lazily evaluated transform is up to date before the threads read it
+			node->localToWorld();
+			concurrentNodes.push_back(RankedNode{ numVisited++, node });
+		}
+		else
+		{
+			serialNodes.push_back(RankedNode{ numVisited++, node });
+		}
+
+		return true;
+	});
+
+	std::size_t numChunks = scene::getNumParallelChunks(concurrentNodes.size(), MIN_NODES_PER_THREAD);
+
+	// One pool per chunk, the last one is taking the serially tested nodes
+	std::vector<SelectionPool> pools(numChunks + 1);
+
+	auto testNodes = [&](SelectionPool& target, SelectionTest& nodeTest,
+		std::vector<RankedNode>::const_iterator begin, std::vector<RankedNode>::const_iterator end)
+	{
+		auto walker = createWalker(target, nodeTest);
+
+		for (auto i = begin; i != end; ++i)
+		{
+			target.setRank(i->rank);
+			walker->visit(i->node);
+		}
+	};
+
+	// Anything not supporting concurrent tests is handled right here
+	testNodes(pools.back(), test, serialNodes.begin(), serialNodes.end());
+
+	scene::parallelForChunks(concurrentNodes.size(), MIN_NODES_PER_THREAD,
+		[&](std::size_t chunk, std::size_t begin, std::size_t end)
+	{
+		// The test is keeping the state of the current mesh, every thread needs its own
+		auto chunkTest = test.clone();
+
+		testNodes(pools[chunk], *chunkTest, concurrentNodes.cbegin() + begin, concurrentNodes.cbegin() + end);
+	});
+
+	// Hits with the same intersection are ordered as if all nodes had been tested in traversal order
+	pool.merge(pools);
+}
+
 void SelectionTestWalker::printNodeName(const scene::INodePtr& node)
 {
 	rMessage() << "Node: " << getNameForNodeType(node->getNodeType()) << " ";
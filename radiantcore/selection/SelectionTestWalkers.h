@@ -1,12 +1,42 @@
 #pragma once
 
+#include <functional>
+#include <memory>
 #include "iscenegraph.h"
 #include "iselection.h"
 #include "iselectiontest.h"
+#include "SelectionPool.h"
 
 namespace selection
 {
 
+/**
+ * Visits the visible nodes within the given volume front to back, ordered by
+ * the nearest depth of their world bounds. Nodes outside the volume are skipped.
+ *
+ * If a pool is passed, the traversal ends as soon as the remaining nodes can't
+ * contribute a better intersection than the best one in the pool. This is
+ * meant for point selections which are only interested in the topmost item.
+ */
+void foreachVisibleNodeFrontToBack(const VolumeTest& volume, scene::Graph::Walker& walker,
+	const SelectionPool* nearestOnlyPool = nullptr);
+
+typedef std::function<std::unique_ptr<scene::Graph::Walker>(Selector&, SelectionTest&)> SelectionTestWalkerFactory;
+
+/**
+ * Tests the visible nodes within the given volume, using walkers created by the given factory.
+ *
+ * The nodes supporting concurrent selection tests are split into contiguous ranges
+ * of the space partition traversal, i.e. into groups of neighbouring subtrees, and
+ * tested on several threads. Each thread uses its own walker, SelectionTest and
+ * SelectionPool. All other nodes are tested on the calling thread. The pools are
+ * merged into the given pool afterwards, hits with equal intersections are sorted
+ * by the traversal order of their nodes. The result doesn't depend on the thread
+ * timing or the number of threads.
+ */
+void foreachVisibleNodeInParallel(const VolumeTest& volume, SelectionTest& test, SelectionPool& pool,
+	const SelectionTestWalkerFactory& createWalker);
+
 // Base class for SelectionTesters, provides some convenience methods
 class SelectionTestWalker :
 	public scene::Graph::Walker
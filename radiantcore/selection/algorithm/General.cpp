@@ -479,6 +479,8 @@ public:
 
 void invertSelection(const cmd::ArgumentList& args)
 {
+	ScopedBulkSelectionChange bulkChange;
+
 	if (GlobalSelectionSystem().Mode() == SelectionSystem::eComponent)
 	{
 		InvertComponentSelectionWalker walker(GlobalSelectionSystem().ComponentMode());
@@ -50,6 +50,12 @@ void GroupCycle::selectionChanged(const scene::INodePtr& node, bool isComponent)
 	}
 }
 
+void GroupCycle::selectionChangedInBulk(const std::vector<scene::INodePtr>& nodes, bool isComponent) {
+	if (!isComponent) {
+		rescanSelection();
+	}
+}
+
 void GroupCycle::rescanSelection() {
 	if (_updateActive) {
 		return;
@@ -156,10 +156,14 @@ void createCMFromSelection(const cmd::ArgumentList& args)
 		cmutil::CollisionModelPtr cm(new cmutil::CollisionModel());
 
 		// Add all the brushes to the collision model
+		std::vector<Brush*> cmBrushes;
+
 		for (std::size_t i = 0; i < brushes.size(); i++) {
-			cm->addBrush(brushes[i]->getBrush());
+			cmBrushes.push_back(&brushes[i]->getBrush());
 		}
 
+		cm->addBrushes(cmBrushes);
+
 		std::string basePath = GlobalGameManager().getModPath();
 
 		std::string modelPath = basePath + model;
@@ -417,4 +417,191 @@ TEST_F(Quake3BrushTest, TextureOnAngledBrush)
 }
 #endif
 
+inline WindingVertex createWindingVertex(double x, std::size_t adjacent)
+{
+    WindingVertex vertex;
+    vertex.vertex = Vector3(x, 0, 0);
+    vertex.adjacent = adjacent;
+    return vertex;
+}
+
+inline void expectSameVertices(const IWinding& winding, const std::vector<WindingVertex>& expected)
+{
+    ASSERT_EQ(winding.size(), expected.size());
+
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(winding[i], expected[i]) << "Vertex " << i << " differs";
+    }
+}
+
+TEST(BrushWindingTest, WindingModificationsMatchVector)
+{
+    IWinding winding;
+    std::vector<WindingVertex> expected;
+
+    // Grow beyond the inline storage
+    for (std::size_t i = 0; i < 7; ++i)
+    {
+        winding.push_back(createWindingVertex(i, i));
+        expected.push_back(createWindingVertex(i, i));
+        expectSameVertices(winding, expected);
+    }
+
+    winding.insert(winding.begin() + 2, createWindingVertex(10, 10));
+    expected.insert(expected.begin() + 2, createWindingVertex(10, 10));
+    expectSameVertices(winding, expected);
+
+    winding.erase(winding.begin() + 4);
+    expected.erase(expected.begin() + 4);
+    expectSameVertices(winding, expected);
+
+    winding.erase(winding.begin(), winding.begin() + 3);
+    expected.erase(expected.begin(), expected.begin() + 3);
+    expectSameVertices(winding, expected);
+
+    // Inserting an element of the winding itself
+    winding.push_back(winding.front());
+    expected.push_back(expected.front());
+    expectSameVertices(winding, expected);
+
+    // Copies and moves from heap and inline storage
+    IWinding copy(winding);
+    expectSameVertices(copy, expected);
+
+    IWinding moved(std::move(copy));
+    expectSameVertices(moved, expected);
+    EXPECT_TRUE(copy.empty());
+
+    winding.resize(3);
+    expected.resize(3);
+    expectSameVertices(winding, expected);
+
+    IWinding small;
+    small.push_back(createWindingVertex(20, 20));
+    moved = std::move(small);
+    expectSameVertices(moved, { createWindingVertex(20, 20) });
+
+    moved.swap(winding);
+    expectSameVertices(moved, expected);
+    expectSameVertices(winding, { createWindingVertex(20, 20) });
+
+    winding.resize(0);
+    EXPECT_TRUE(winding.empty());
+}
+
+TEST_F(BrushTest, CubicBrushWindingsAreStoredInline)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto brush = Node_getIBrush(algorithm::createCubicBrush(worldspawn));
+
+    for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+    {
+        const IWinding& winding = brush->getFace(i).getWinding();
+
+        EXPECT_EQ(winding.size(), 4);
+        EXPECT_TRUE(winding.isInline());
+    }
+}
+
+// Counts the heap allocations made for winding storage on this thread during its lifetime.
+// Other allocations of the brush evaluation are not included.
+class WindingStorageAllocationCounter
+{
+private:
+    std::size_t _start;
+
+public:
+    WindingStorageAllocationCounter() :
+        _start(GlobalBrushCreator().getWindingStorageAllocationCount())
+    {}
+
+    std::size_t getCount() const
+    {
+        return GlobalBrushCreator().getWindingStorageAllocationCount() - _start;
+    }
+};
+
+TEST_F(BrushTest, WindingStorageAllocationsPerBrushEvaluation)
+{
+    constexpr std::size_t NumBrushes = 1000;
+    constexpr std::size_t NumEvaluations = 1000;
+    constexpr std::size_t NumSides = 8;
+
+    // An octagonal prism: the side faces fit into the inline storage of the windings,
+    // the top and bottom faces with their 8 vertices need heap storage
+    auto createBrush = []()
+    {
+        // The brushes are not inserted into the scene, no undo or scene bookkeeping involved
+        auto node = GlobalBrushCreator().createBrush();
+        auto& brush = *Node_getIBrush(node);
+
+        for (std::size_t side = 0; side < NumSides; ++side)
+        {
+            auto angle = 2 * math::PI * side / NumSides;
+            brush.addFace(Plane3(cos(angle), sin(angle), 0, 64));
+        }
+
+        brush.addFace(Plane3(0, 0, +1, 64));
+        brush.addFace(Plane3(0, 0, -1, 64));
+
+        return node;
+    };
+
+    // Warm up the clipping buffers of this thread, they might not be used by the tests before
+    Node_getIBrush(createBrush())->evaluateBRep();
+
+    // Evaluate the windings of freshly created brushes, like during map loading
+    std::vector<scene::INodePtr> brushes;
+
+    for (std::size_t i = 0; i < NumBrushes; ++i)
+    {
+        brushes.push_back(createBrush());
+    }
+
+    std::size_t initialAllocations = 0;
+    {
+        WindingStorageAllocationCounter counter;
+
+        for (const auto& node : brushes)
+        {
+            Node_getIBrush(node)->evaluateBRep();
+        }
+
+        initialAllocations = counter.getCount();
+    }
+
+    // Evaluate the same brush over and over, moving one of its faces
+    auto& brush = *Node_getIBrush(brushes.front());
+
+    std::size_t repeatedAllocations = 0;
+    {
+        WindingStorageAllocationCounter counter;
+
+        for (std::size_t i = 0; i < NumEvaluations; ++i)
+        {
+            brush.getFace(0).transform(Matrix4::getTranslation(Vector3(i % 2 == 0 ? 8 : -8, 0, 0)));
+            brush.evaluateBRep();
+        }
+
+        repeatedAllocations = counter.getCount();
+    }
+
+    RecordProperty("InitialEvaluationWindingStorageAllocationsPerBrush", static_cast<int>(initialAllocations / NumBrushes));
+    RecordProperty("RepeatedEvaluationWindingStorageAllocationsPerBrush", static_cast<int>(repeatedAllocations / NumEvaluations));
+
+    // One allocation for each of the top and bottom windings, nothing for the clipping buffers
+    EXPECT_EQ(initialAllocations, 2 * NumBrushes);
+
+    // The windings keep their storage and the clipping buffers come from the warm pool.
+    // This only covers the winding storage, building the B-Rep still allocates its own containers.
+    EXPECT_EQ(repeatedAllocations, 0);
+
+    for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+    {
+        EXPECT_EQ(brush.getFace(i).getWinding().size(), i < NumSides ? 4 : NumSides);
+        EXPECT_EQ(brush.getFace(i).getWinding().isInline(), i < NumSides);
+    }
+}
+
 }
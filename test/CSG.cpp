@@ -1,8 +1,12 @@
 #include "RadiantTest.h"
 
+#include <chrono>
 #include "imap.h"
 #include "ibrush.h"
+#include "iundo.h"
+#include "igrid.h"
 #include "entitylib.h"
+#include "algorithm/Primitives.h"
 #include "algorithm/Scene.h"
 
 namespace test
@@ -10,6 +14,24 @@ namespace test
 
 using CsgTest = RadiantTest;
 
+namespace
+{
+
+std::size_t countBrushes(const scene::INodePtr& parent)
+{
+    std::size_t count = 0;
+
+    parent->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isBrush(node)) ++count;
+        return true;
+    });
+
+    return count;
+}
+
+}
+
 TEST_F(CsgTest, CSGMergeTwoRegularWorldspawnBrushes)
 {
     loadMap("csg_merge.map");
@@ -224,4 +246,171 @@ TEST_F(CsgTest, CSGMergeWithFuncStatic)
     ASSERT_TRUE(walker.getEntityNode()->hasChildNodes());
 }
 
+TEST_F(CsgTest, CSGSubtractFromLargeMap)
+{
+    constexpr int GridSize = 32;
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    for (int i = 0; i < GridSize * GridSize; ++i)
+    {
+        algorithm::createCubicBrush(worldspawn, Vector3((i % GridSize) * 256, (i / GridSize) * 256, 0));
+    }
+
+    // A slab cutting off the top of the cubes in the left half of the grid,
+    // its right side is splitting the cubes of the middle column
+    auto subtractor = GlobalBrushCreator().createBrush();
+    worldspawn->addChildNode(subtractor);
+
+    auto& slab = *Node_getIBrush(subtractor);
+    slab.addFace(Plane3(+1, 0, 0, GridSize / 2 * 256));
+    slab.addFace(Plane3(-1, 0, 0, 128));
+    slab.addFace(Plane3(0, +1, 0, GridSize * 256));
+    slab.addFace(Plane3(0, -1, 0, 128));
+    slab.addFace(Plane3(0, 0, +1, 96));
+    slab.addFace(Plane3(0, 0, -1, -32));
+    slab.setShader("_default");
+    slab.evaluateBRep();
+
+    GlobalSelectionSystem().setSelectedAll(false);
+    Node_setSelected(subtractor, true);
+
+    auto start = std::chrono::steady_clock::now();
+
+    GlobalCommandSystem().executeCommand("CSGSubtract");
+
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    RecordProperty("SubtractMilliseconds", static_cast<int>(millis));
+
+    // The cubes left of the middle column lose their top, the ones
+    // of the middle column are split into two fragments each
+    constexpr std::size_t LeftCubes = GridSize / 2 * GridSize;
+    constexpr std::size_t UntouchedCubes = (GridSize / 2 - 1) * GridSize;
+
+    EXPECT_EQ(countBrushes(worldspawn), UntouchedCubes + LeftCubes + 2 * GridSize + 1);
+    EXPECT_TRUE(subtractor->getParent());
+
+    // No fragment is reaching into the slab
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (node == subtractor) return true;
+
+        const AABB& bounds = node->worldAABB();
+
+        EXPECT_TRUE(bounds.origin.z() + bounds.extents.z() < 32 + 0.1 ||
+            bounds.origin.x() - bounds.extents.x() > GridSize / 2 * 256 - 0.1);
+        return true;
+    });
+
+    // Undo restores the original cubes
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(countBrushes(worldspawn), GridSize * GridSize + 1);
+}
+
+TEST_F(CsgTest, CSGMergeLargeGroup)
+{
+    constexpr int NumBrushes = 256;
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    // A row of adjacent cubes, every inner face is opposing a face of the neighbour
+    for (int i = 0; i < NumBrushes; ++i)
+    {
+        Node_setSelected(algorithm::createCubicBrush(worldspawn, Vector3(i * 128, 0, 0)), true);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    GlobalCommandSystem().executeCommand("CSGMerge");
+
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    RecordProperty("MergeMilliseconds", static_cast<int>(millis));
+
+    ASSERT_EQ(countBrushes(worldspawn), 1);
+
+    auto merged = algorithm::getNthChild(worldspawn, 0);
+    EXPECT_EQ(Node_getIBrush(merged)->getNumFaces(), 6);
+    EXPECT_TRUE(Node_isSelected(merged));
+
+    const AABB& bounds = merged->worldAABB();
+    EXPECT_TRUE(math::isNear(bounds.getOrigin(), Vector3((NumBrushes - 1) * 64, 0, 0), 0.01));
+    EXPECT_TRUE(math::isNear(bounds.getExtents(), Vector3(NumBrushes * 64, 64, 64), 0.01));
+}
+
+TEST_F(CsgTest, CSGMergeOfConcaveSelectionLeavesSceneUnchanged)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    // Three cubes forming an L shape
+    auto first = algorithm::createCubicBrush(worldspawn, Vector3(0, 0, 0));
+    auto second = algorithm::createCubicBrush(worldspawn, Vector3(128, 0, 0));
+    auto third = algorithm::createCubicBrush(worldspawn, Vector3(0, 128, 0));
+
+    Node_setSelected(first, true);
+    Node_setSelected(second, true);
+    Node_setSelected(third, true);
+
+    GlobalCommandSystem().executeCommand("CSGMerge");
+
+    // No brush has been added or removed
+    EXPECT_EQ(countBrushes(worldspawn), 3);
+    EXPECT_TRUE(first->getParent());
+    EXPECT_TRUE(second->getParent());
+    EXPECT_TRUE(third->getParent());
+}
+
+TEST_F(CsgTest, CSGHollowLargeSelection)
+{
+    constexpr int GridSize = 32;
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    for (int i = 0; i < GridSize * GridSize; ++i)
+    {
+        Node_setSelected(algorithm::createCubicBrush(worldspawn,
+            Vector3((i % GridSize) * 256, (i / GridSize) * 256, 0)), true);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    GlobalCommandSystem().executeCommand("CSGHollow");
+
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    RecordProperty("HollowMilliseconds", static_cast<int>(millis));
+
+    // Each cube is replaced by six selected walls
+    EXPECT_EQ(countBrushes(worldspawn), 6 * GridSize * GridSize);
+    EXPECT_EQ(GlobalSelectionSystem().countSelected(), 6 * GridSize * GridSize);
+
+    auto gridSize = GlobalGrid().getGridSize();
+
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        // The walls are as thick as the grid size and lie within their cube
+        EXPECT_EQ(Node_getIBrush(node)->getNumFaces(), 6);
+
+        const AABB& bounds = node->worldAABB();
+        EXPECT_NEAR(std::min({ bounds.extents.x(), bounds.extents.y(), bounds.extents.z() }), gridSize / 2, 0.01);
+        EXPECT_NEAR(std::max({ bounds.extents.x(), bounds.extents.y(), bounds.extents.z() }), 64, 0.01);
+        return true;
+    });
+
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(countBrushes(worldspawn), GridSize * GridSize);
+}
+
 }
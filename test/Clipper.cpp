@@ -0,0 +1,227 @@
+#include "RadiantTest.h"
+
+#include <chrono>
+#include "iclipper.h"
+#include "iselection.h"
+#include "iundo.h"
+#include "imap.h"
+#include "ibrush.h"
+#include "icommandsystem.h"
+#include "algorithm/Primitives.h"
+
+namespace test
+{
+
+using ClipperTest = RadiantTest;
+
+namespace
+{
+
+// Creates a wall of 64x64x64 cubes in the YZ plane, centered at x = 0
+std::vector<scene::INodePtr> createBrushWall(std::size_t size)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    std::vector<scene::INodePtr> brushes;
+
+    for (std::size_t y = 0; y < size; ++y)
+    {
+        for (std::size_t z = 0; z < size; ++z)
+        {
+            brushes.push_back(algorithm::createCubicBrush(worldspawn, Vector3(0, y * 128.0, z * 128.0)));
+        }
+    }
+
+    return brushes;
+}
+
+std::size_t countBrushes(const scene::INodePtr& parent)
+{
+    std::size_t count = 0;
+
+    parent->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isBrush(node)) ++count;
+        return true;
+    });
+
+    return count;
+}
+
+// Activates the clipper and places a vertical clip plane at the given x coordinate
+void setClipPlaneAtX(double x)
+{
+    if (!GlobalClipper().clipMode())
+    {
+        GlobalCommandSystem().executeCommand("ToggleManipulatorMode", std::string("Clip"));
+    }
+
+    // Start over with the first clip point
+    GlobalClipper().onClipMode(true);
+    GlobalClipper().setViewType(XY);
+    GlobalClipper().newClipPoint(Vector3(x, -100000, 0));
+    GlobalClipper().newClipPoint(Vector3(x, 100000, 0));
+}
+
+// Compares the clip plane winding kept by the brush to one calculated from scratch
+void expectClipPlaneWindingIsCurrent(const scene::INodePtr& node)
+{
+    auto brushNode = std::dynamic_pointer_cast<IBrushNode>(node);
+
+    const auto& winding = brushNode->getClipPlaneWinding();
+    auto expected = brushNode->getIBrush().getWindingForPlane(brushNode->getClipPlane());
+
+    ASSERT_EQ(winding.size(), expected.size()) << "Clip plane winding is out of date";
+
+    for (std::size_t i = 0; i < winding.size(); ++i)
+    {
+        EXPECT_EQ(winding[i].vertex, expected[i].vertex) << "Clip plane winding is out of date";
+    }
+}
+
+std::size_t getClipPlaneWindingSize(const scene::INodePtr& node)
+{
+    return std::dynamic_pointer_cast<IBrushNode>(node)->getClipPlaneWinding().size();
+}
+
+}
+
+TEST_F(ClipperTest, SplitLargeSelection)
+{
+    auto brushes = createBrushWall(16);
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    setClipPlaneAtX(0);
+    EXPECT_TRUE(GlobalClipper().clipMode()) << "Clipper should be active";
+
+    for (const auto& brush : brushes)
+    {
+        Node_setSelected(brush, true);
+    }
+
+    GlobalCommandSystem().executeCommand("SplitSelected");
+
+    EXPECT_EQ(countBrushes(worldspawn), 512) << "Each brush should have been split in two";
+    EXPECT_EQ(GlobalSelectionSystem().countSelected(), 512) << "The brushes and their fragments should be selected";
+
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        EXPECT_NEAR(node->worldAABB().getExtents().x(), 32, 0.01) << "Fragment should be half as wide";
+        return true;
+    });
+
+    // The whole split is a single undo step
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(countBrushes(worldspawn), 256) << "Undo should have removed all fragments";
+
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        EXPECT_NEAR(node->worldAABB().getExtents().x(), 64, 0.01) << "Brush should be restored";
+        return true;
+    });
+}
+
+TEST_F(ClipperTest, ClipLargeSelection)
+{
+    auto brushes = createBrushWall(16);
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    setClipPlaneAtX(32);
+
+    for (const auto& brush : brushes)
+    {
+        Node_setSelected(brush, true);
+    }
+
+    GlobalCommandSystem().executeCommand("ClipSelected");
+
+    EXPECT_EQ(countBrushes(worldspawn), 256) << "Clipping should not create any fragments";
+
+    // Depending on the kept side, the brushes are either 96 or 32 units wide now
+    double expectedExtents = 0;
+
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        double extents = node->worldAABB().getExtents().x();
+
+        if (expectedExtents == 0)
+        {
+            expectedExtents = extents;
+            EXPECT_TRUE(std::abs(extents - 48) < 0.01 || std::abs(extents - 16) < 0.01) << "Brush should have been clipped";
+        }
+
+        EXPECT_NEAR(extents, expectedExtents, 0.01) << "All brushes should have been clipped the same way";
+        return true;
+    });
+
+    GlobalUndoSystem().undo();
+
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        EXPECT_NEAR(node->worldAABB().getExtents().x(), 64, 0.01) << "Brush should be restored";
+        return true;
+    });
+}
+
+TEST_F(ClipperTest, MoveClipPlaneThroughLargeSelection)
+{
+    auto brushes = createBrushWall(24);
+
+    for (const auto& brush : brushes)
+    {
+        Node_setSelected(brush, true);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Move the plane along its normal, each step is updating the clip preview twice
+    for (int x = -96; x <= 96; x += 8)
+    {
+        setClipPlaneAtX(x);
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    EXPECT_EQ(GlobalSelectionSystem().countSelected(), brushes.size()) << "Selection should be unchanged";
+
+    RecordProperty("brushes", std::to_string(brushes.size()));
+    RecordProperty("previewMilliseconds", std::to_string(duration.count()));
+
+    // The cubes extend from x = -64 to 64, the planes within 1 unit of their
+    // faces are clipped, the ones further away are culled by their distance
+    for (double x : { 0.0, 63.0, 64.0, 64.5, 65.0, 66.0, -64.0, -64.5, -66.0 })
+    {
+        setClipPlaneAtX(x);
+
+        for (const auto& brush : brushes)
+        {
+            expectClipPlaneWindingIsCurrent(brush);
+        }
+    }
+
+    // A plane touching a face produces the face itself
+    setClipPlaneAtX(64);
+    EXPECT_EQ(getClipPlaneWindingSize(brushes.front()), 4) << "Touching plane should produce the face winding";
+
+    setClipPlaneAtX(66);
+    EXPECT_EQ(getClipPlaneWindingSize(brushes.front()), 0) << "Plane outside the brush should not produce a winding";
+
+    // Changing a brush invalidates its clip plane winding, even if the plane stays the same
+    setClipPlaneAtX(32);
+
+    auto brushNode = std::dynamic_pointer_cast<IBrushNode>(brushes.front());
+    auto plane = brushNode->getClipPlane();
+
+    EXPECT_EQ(getClipPlaneWindingSize(brushes.front()), 4) << "Plane should cut through the brush";
+
+    // Move the +x face of the first cube behind the clip plane
+    brushNode->getIBrush().getFace(0).transform(Matrix4::getTranslation(Vector3(-48, 0, 0)));
+    GlobalClipper().update();
+
+    EXPECT_EQ(brushNode->getClipPlane(), plane) << "Clip plane should be unchanged";
+    EXPECT_EQ(getClipPlaneWindingSize(brushes.front()), 0) << "Winding of the changed brush should have been recalculated";
+    expectClipPlaneWindingIsCurrent(brushes.front());
+    expectClipPlaneWindingIsCurrent(brushes.back());
+}
+
+}
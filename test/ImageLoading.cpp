@@ -1,8 +1,13 @@
 #include "RadiantTest.h"
 
+#include <chrono>
 #include "iimage.h"
 #include "RGBAImage.h"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 // Helpers for examining pixel data
 using RGB8 = BasicVector3<uint8_t>;
 
@@ -146,6 +151,25 @@ TEST_F(ImageLoadingTest, LoadDDSUncompressedMipMaps)
     EXPECT_EQ(img->getHeight(4), 1);
 }
 
+TEST_F(ImageLoadingTest, LoadDDSTruncatedMipMaps)
+{
+    // Same as test_16x16_uncomp_mips.dds, but cut off in the middle of the
+    // fourth mipmap, the loader should keep the three complete levels
+    auto img = loadImage("textures/dds/test_16x16_uncomp_mips_truncated.dds");
+    ASSERT_TRUE(img);
+
+    EXPECT_EQ(img->getWidth(), 16);
+    EXPECT_EQ(img->getHeight(), 16);
+    EXPECT_EQ(img->getLevels(), 3);
+    EXPECT_EQ(img->getWidth(2), 4);
+    EXPECT_EQ(img->getHeight(2), 4);
+
+    // Pixel data of the top level must be intact
+    Pixelator<RGB8> pixels(*img);
+    EXPECT_EQ(pixels(0, 0), RGB8(0, 0, 0));         // border
+    EXPECT_EQ(pixels(8, 8), RGB8(0, 0, 255));       // red centre (BGR)
+}
+
 TEST_F(ImageLoadingTest, LoadDDSUncompressedNPOT)
 {
     auto img = loadImage("textures/dds/test_10x16_uncomp.dds");
@@ -239,4 +263,69 @@ TEST_F(ImageLoadingTest, LoadDDSCompressedBC5MipMaps)
     EXPECT_EQ(img->getGLFormat(), GL_COMPRESSED_RG_RGTC2);
 }
 
-}
\ No newline at end of file
+namespace
+{
+
+// Peak resident memory of this process in kilobytes, or 0 where this is not available
+std::size_t getPeakMemoryKb()
+{
+#ifndef _WIN32
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        // Linux reports kilobytes, macOS reports bytes
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+    }
+#endif
+    return 0;
+}
+
+}
+
+// Not a correctness test: loads all DDS test textures repeatedly and records
+// the load time and the growth of the peak memory, to compare loader revisions
+TEST_F(ImageLoadingTest, DDSLoadBenchmark)
+{
+    const std::vector<std::string> textures
+    {
+        "textures/dds/test_10x16_uncomp.dds",
+        "textures/dds/test_128x128_dxt1.dds",
+        "textures/dds/test_16x16_bc5.dds",
+        "textures/dds/test_16x16_uncomp.dds",
+        "textures/dds/test_16x16_uncomp_mips.dds",
+        "textures/dds/test_60x128_dxt5.dds",
+        "textures/dds/test_60x128_dxt5_mips.dds",
+    };
+
+    constexpr std::size_t Iterations = 500;
+
+    auto peakMemoryBefore = getPeakMemoryKb();
+    auto start = std::chrono::steady_clock::now();
+
+    // Keep the images of the last iteration, they make up the peak memory
+    std::vector<ImagePtr> images;
+
+    for (std::size_t i = 0; i < Iterations; ++i)
+    {
+        images.clear();
+
+        for (const auto& texture : textures)
+        {
+            images.push_back(loadImage(texture));
+            ASSERT_TRUE(images.back()) << "Failed to load " << texture;
+        }
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    RecordProperty("imagesLoaded", std::to_string(Iterations * textures.size()));
+    RecordProperty("microsecondsPerImage", std::to_string(duration.count() / (Iterations * textures.size())));
+    RecordProperty("peakMemoryGrowthKb", std::to_string(getPeakMemoryKb() - peakMemoryBefore));
+}
+
+}
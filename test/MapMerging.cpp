@@ -1,14 +1,22 @@
 #include "RadiantTest.h"
 
+#include <chrono>
+#include <future>
 #include "icommandsystem.h"
+#include "iundo.h"
 #include "itransformable.h"
 #include "ibrush.h"
 #include "imapresource.h"
 #include "ipatch.h"
 #include "icomparablenode.h"
+#include "ientity.h"
+#include "ieclass.h"
 #include "algorithm/Scene.h"
+#include "algorithm/Primitives.h"
 #include "registry/registry.h"
+#include "string/predicate.h"
 #include "scenelib.h"
+#include "scene/Clone.h"
 #include "scene/merge/GraphComparer.h"
 #include "scene/merge/MergeOperation.h"
 #include "scene/merge/ThreeWayMergeOperation.h"
@@ -236,6 +244,202 @@ TEST_F(MapMergeTest, EntityFingerprintInsensitiveToChildOrder)
     EXPECT_EQ(comparable->getFingerprint(), originalFingerprint);
 }
 
+// The fingerprint of a fresh copy of the given node, which has nothing cached yet
+inline std::string getUncachedFingerprint(const scene::INodePtr& node, scene::FingerprintHash hash)
+{
+    auto clone = std::dynamic_pointer_cast<scene::Cloneable>(node)->clone();
+    return std::dynamic_pointer_cast<scene::IComparableNode>(clone)->getFingerprint(hash);
+}
+
+TEST_F(MapMergeTest, BrushFingerprintIsUpdatedByUndo)
+{
+    GlobalCommandSystem().executeCommand("OpenMap", cmd::Argument("maps/fingerprinting.mapx"));
+
+    auto brush = algorithm::findFirstBrushWithMaterial(GlobalMapModule().findOrInsertWorldspawn(), "textures/numbers/1");
+    auto comparable = std::dynamic_pointer_cast<scene::IComparableNode>(brush);
+
+    auto originalFingerprint = comparable->getFingerprint();
+    auto originalFastFingerprint = comparable->getFingerprint(scene::FingerprintHash::Fast);
+
+    {
+        UndoableCommand cmd("changeBrush");
+        Node_getIBrush(brush)->setShader("textures/somethingelse");
+        Node_getIBrush(brush)->getFace(0).flipTexture(0);
+    }
+
+    auto changedFingerprint = comparable->getFingerprint();
+    EXPECT_NE(changedFingerprint, originalFingerprint);
+    EXPECT_NE(comparable->getFingerprint(scene::FingerprintHash::Fast), originalFastFingerprint);
+    EXPECT_EQ(changedFingerprint, getUncachedFingerprint(brush, scene::FingerprintHash::SHA256));
+
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(comparable->getFingerprint(), originalFingerprint) << "Undo should restore the fingerprint";
+    EXPECT_EQ(comparable->getFingerprint(scene::FingerprintHash::Fast), originalFastFingerprint);
+
+    GlobalUndoSystem().redo();
+
+    EXPECT_EQ(comparable->getFingerprint(), changedFingerprint) << "Redo should restore the changed fingerprint";
+
+    // Transforming the brush changes the face planes
+    {
+        UndoableCommand cmd("moveBrush");
+        auto transformable = std::dynamic_pointer_cast<ITransformable>(brush);
+        transformable->setTranslation(Vector3(16, 0, 0));
+        transformable->freezeTransform();
+    }
+
+    EXPECT_NE(comparable->getFingerprint(), changedFingerprint);
+    EXPECT_EQ(comparable->getFingerprint(), getUncachedFingerprint(brush, scene::FingerprintHash::SHA256));
+    EXPECT_EQ(comparable->getFingerprint(scene::FingerprintHash::Fast), getUncachedFingerprint(brush, scene::FingerprintHash::Fast));
+}
+
+TEST_F(MapMergeTest, EntityFingerprintIsUpdatedByChildChangesAndUndo)
+{
+    GlobalCommandSystem().executeCommand("OpenMap", cmd::Argument("maps/fingerprinting.mapx"));
+
+    auto entityNode = algorithm::getEntityByName(GlobalMapModule().getRoot(), "func_static_1");
+    auto comparable = std::dynamic_pointer_cast<scene::IComparableNode>(entityNode);
+    auto entity = std::dynamic_pointer_cast<IEntityNode>(entityNode);
+
+    auto originalFingerprint = comparable->getFingerprint();
+    auto originalFastFingerprint = comparable->getFingerprint(scene::FingerprintHash::Fast);
+
+    scene::INodePtr childBrush;
+    entity->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isBrush(node) && !childBrush)
+        {
+            childBrush = node;
+        }
+
+        return true;
+    });
+    EXPECT_TRUE(childBrush) << "func_static doesn't have any child brushes";
+
+    // Changing the child brush needs to reach the cached values of the entity
+    {
+        UndoableCommand cmd("changeChildBrush");
+        Node_getIBrush(childBrush)->setShader("textures/somethingelse");
+    }
+
+    auto changedFingerprint = comparable->getFingerprint();
+    EXPECT_NE(changedFingerprint, originalFingerprint);
+    EXPECT_NE(comparable->getFingerprint(scene::FingerprintHash::Fast), originalFastFingerprint);
+
+    auto clone = scene::cloneNodeIncludingDescendants(entityNode, scene::PostCloneCallback());
+    EXPECT_EQ(changedFingerprint, std::dynamic_pointer_cast<scene::IComparableNode>(clone)->getFingerprint());
+
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(comparable->getFingerprint(), originalFingerprint) << "Undo should restore the fingerprint";
+    EXPECT_EQ(comparable->getFingerprint(scene::FingerprintHash::Fast), originalFastFingerprint);
+
+    // Undoing a key value change doesn't go through setKeyValue
+    {
+        UndoableCommand cmd("changeKeyValue");
+        entity->getEntity().setKeyValue("dummyspawnarg", "changed");
+    }
+
+    EXPECT_NE(comparable->getFingerprint(), originalFingerprint);
+
+    GlobalUndoSystem().undo();
+
+    EXPECT_EQ(comparable->getFingerprint(), originalFingerprint) << "Undo should restore the fingerprint";
+    EXPECT_EQ(comparable->getFingerprint(scene::FingerprintHash::Fast), originalFastFingerprint);
+}
+
+TEST_F(MapMergeTest, EntityFingerprintsCanBeCalculatedConcurrently)
+{
+    GlobalCommandSystem().executeCommand("OpenMap", cmd::Argument("maps/fingerprinting.mapx"));
+
+    // Nothing has been fingerprinted since loading the map, all caches are empty
+    std::vector<scene::INodePtr> entities;
+    GlobalMapModule().getRoot()->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (node->getNodeType() == scene::INode::Type::Entity)
+        {
+            entities.push_back(node);
+        }
+
+        return true;
+    });
+    EXPECT_GT(entities.size(), 1);
+
+    auto calculateFingerprints = [&]()
+    {
+        std::vector<std::string> fingerprints;
+
+        for (const auto& entity : entities)
+        {
+            fingerprints.push_back(std::dynamic_pointer_cast<scene::IComparableNode>(entity)->getFingerprint(scene::FingerprintHash::Fast));
+        }
+
+        return fingerprints;
+    };
+
+    // The fingerprints of fresh copies, calculated on this thread
+    std::vector<std::string> expected;
+
+    for (const auto& entity : entities)
+    {
+        auto clone = scene::cloneNodeIncludingDescendants(entity, scene::PostCloneCallback());
+        expected.push_back(std::dynamic_pointer_cast<scene::IComparableNode>(clone)->getFingerprint(scene::FingerprintHash::Fast));
+    }
+
+    constexpr std::size_t NumThreads = 4;
+    std::vector<std::future<std::vector<std::string>>> results;
+
+    for (std::size_t i = 0; i < NumThreads; ++i)
+    {
+        results.emplace_back(std::async(std::launch::async, calculateFingerprints));
+    }
+
+    for (auto& result : results)
+    {
+        EXPECT_EQ(result.get(), expected);
+    }
+}
+
+TEST_F(MapMergeTest, FastFingerprintDistinguishesTheSameNodes)
+{
+    GlobalCommandSystem().executeCommand("OpenMap", cmd::Argument("maps/fingerprinting.mapx"));
+
+    std::map<std::string, std::string> fastFingerprintsBySha256;
+    std::set<std::string> fastFingerprints;
+
+    GlobalMapModule().getRoot()->foreachNode([&](const scene::INodePtr& node)
+    {
+        auto comparable = std::dynamic_pointer_cast<scene::IComparableNode>(node);
+
+        if (!comparable) return true;
+
+        auto fastFingerprint = comparable->getFingerprint(scene::FingerprintHash::Fast);
+        auto existing = fastFingerprintsBySha256.emplace(comparable->getFingerprint(), fastFingerprint);
+
+        if (existing.second)
+        {
+            EXPECT_EQ(fastFingerprints.count(fastFingerprint), 0) << "Nodes with different SHA256 fingerprints should have different fast fingerprints";
+            fastFingerprints.insert(fastFingerprint);
+        }
+        else
+        {
+            EXPECT_EQ(existing.first->second, fastFingerprint) << "Nodes with the same SHA256 fingerprint should have the same fast one";
+        }
+
+        EXPECT_EQ(fastFingerprint.empty(), comparable->getFingerprint().empty());
+
+        if (!fastFingerprint.empty())
+        {
+            EXPECT_EQ(fastFingerprint.length(), 32);
+        }
+
+        return true;
+    });
+
+    EXPECT_GT(fastFingerprints.size(), 10) << "The test map should contain a few distinct nodes";
+}
+
 using namespace scene::merge;
 
 inline ComparisonResult::Ptr performComparison(const std::string& targetMap, const std::string& sourceMapPath)
@@ -385,6 +589,72 @@ TEST_F(MapMergeTest, DetectChildPrimitiveChanges)
     EXPECT_EQ(countPrimitiveDifference(diff, ComparisonResult::PrimitiveDifference::Type::PrimitiveRemoved), 3);
 }
 
+TEST_F(MapMergeTest, FastComparisonMatchesSha256Comparison)
+{
+    auto result = performComparison("maps/fingerprinting.mapx", _context.getTestProjectPath() + "maps/fingerprinting_2.mapx");
+    auto fastResult = GraphComparer::Compare(result->getSourceRootNode(), result->getBaseRootNode(), scene::FingerprintHash::Fast);
+
+    EXPECT_EQ(fastResult->equivalentEntities.size(), result->equivalentEntities.size());
+    EXPECT_EQ(fastResult->differingEntities.size(), result->differingEntities.size());
+
+    for (const auto& difference : result->differingEntities)
+    {
+        auto fastDifference = getEntityDifference(fastResult, difference.entityName);
+
+        EXPECT_EQ(fastDifference.type, difference.type) << "Entity " << difference.entityName;
+        EXPECT_EQ(fastDifference.differingKeyValues, difference.differingKeyValues) << "Entity " << difference.entityName;
+
+        for (auto type : { ComparisonResult::PrimitiveDifference::Type::PrimitiveAdded, ComparisonResult::PrimitiveDifference::Type::PrimitiveRemoved })
+        {
+            EXPECT_EQ(countPrimitiveDifference(fastDifference, type), countPrimitiveDifference(difference, type)) << "Entity " << difference.entityName;
+        }
+    }
+}
+
+TEST_F(MapMergeTest, CompareLargeMapWithCachedFingerprints)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    for (int x = 0; x < 32; ++x)
+    {
+        for (int y = 0; y < 32; ++y)
+        {
+            for (int z = 0; z < 4; ++z)
+            {
+                algorithm::createCubicBrush(worldspawn, Vector3(x * 128, y * 128, z * 128));
+            }
+        }
+    }
+
+    auto root = GlobalMapModule().getRoot();
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = GraphComparer::Compare(root, root);
+    auto firstDuration = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(result->differingEntities.empty()) << "The map should be equivalent to itself";
+
+    // The second comparison is picking up the cached fingerprints of the brushes
+    start = std::chrono::steady_clock::now();
+    result = GraphComparer::Compare(root, root);
+    auto secondDuration = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(result->differingEntities.empty()) << "The map should be equivalent to itself";
+
+    start = std::chrono::steady_clock::now();
+    result = GraphComparer::Compare(root, root, scene::FingerprintHash::Fast);
+    auto fastDuration = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(result->differingEntities.empty()) << "The map should be equivalent to itself";
+
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    RecordProperty("firstComparisonMilliseconds", std::to_string(duration_cast<milliseconds>(firstDuration).count()));
+    RecordProperty("cachedComparisonMilliseconds", std::to_string(duration_cast<milliseconds>(secondDuration).count()));
+    RecordProperty("fastComparisonMilliseconds", std::to_string(duration_cast<milliseconds>(fastDuration).count()));
+}
+
 template<typename T>
 std::shared_ptr<T> findAction(const IMergeOperation::Ptr& operation, const std::function<bool(const std::shared_ptr<T>&)>& predicate)
 {
@@ -2183,6 +2453,148 @@ TEST_F(ThreeWayMergeTest, RemovalOfModifiedKeyValue)
     EXPECT_EQ(Node_getEntity(entity)->getKeyValue("extra2"), "");
 }
 
+TEST_F(ThreeWayMergeTest, MergeOperationWithUncachedBaseEntities)
+{
+    // Both comparisons share the base graph and run concurrently. The freshly loaded
+    // base hasn't been fingerprinted yet, repeat it to give conflicting accesses
+    // to its entities a chance to show up.
+    constexpr std::size_t NumRuns = 8;
+
+    for (std::size_t run = 0; run < NumRuns; ++run)
+    {
+        auto baseResource = GlobalMapResourceManager().createFromPath("maps/threeway_merge_base.mapx");
+        EXPECT_TRUE(baseResource->load());
+        auto targetResource = GlobalMapResourceManager().createFromPath("maps/threeway_merge_target_1.mapx");
+        EXPECT_TRUE(targetResource->load());
+        auto sourceResource = GlobalMapResourceManager().createFromPath("maps/threeway_merge_source_1.mapx");
+        EXPECT_TRUE(sourceResource->load());
+
+        auto operation = ThreeWayMergeOperation::Create(baseResource->getRootNode(), sourceResource->getRootNode(), targetResource->getRootNode());
+
+        verifyTargetChanges1(operation->getTargetRoot());
+
+        auto addEntityActionCount = countActions<AddEntityAction>(operation, [](const std::shared_ptr<AddEntityAction>& action)
+        {
+            return Node_getEntity(action->getSourceNodeToAdd())->getKeyValue("name") == "light_2";
+        });
+        EXPECT_EQ(addEntityActionCount, 1) << "light_2 should be added to the target";
+
+        // The cached base fingerprints match the ones of fresh copies
+        baseResource->getRootNode()->foreachNode([&](const scene::INodePtr& node)
+        {
+            if (node->getNodeType() != scene::INode::Type::Entity) return true;
+
+            auto clone = scene::cloneNodeIncludingDescendants(node, scene::PostCloneCallback());
+
+            EXPECT_EQ(std::dynamic_pointer_cast<scene::IComparableNode>(node)->getFingerprint(scene::FingerprintHash::Fast),
+                std::dynamic_pointer_cast<scene::IComparableNode>(clone)->getFingerprint(scene::FingerprintHash::Fast));
+
+            return true;
+        });
+    }
+}
+
+// Adds the same func_statics to the given map, each of them containing a single brush
+void addScaledUpEntities(const scene::IMapRootNodePtr& root, std::size_t count)
+{
+    auto eclass = GlobalEntityClassManager().findClass("func_static");
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto entity = GlobalEntityModule().createEntity(eclass);
+        scene::addNodeToContainer(entity, root);
+
+        entity->getEntity().setKeyValue("name", "scaled_" + std::to_string(i));
+        algorithm::createCubicBrush(entity, Vector3(i * 128.0, 4096, 0), "textures/numbers/1");
+    }
+}
+
+inline bool isScaledUpEntity(const scene::INodePtr& node)
+{
+    return string::starts_with(Node_getEntity(node)->getKeyValue("name"), "scaled_");
+}
+
+TEST_F(ThreeWayMergeTest, ScaledUpMergeOperation)
+{
+    constexpr std::size_t NumEntities = 512;
+
+    auto baseResource = GlobalMapResourceManager().createFromPath("maps/threeway_merge_base.mapx");
+    EXPECT_TRUE(baseResource->load());
+    auto targetResource = GlobalMapResourceManager().createFromPath("maps/threeway_merge_target_1.mapx");
+    EXPECT_TRUE(targetResource->load());
+    auto sourceResource = GlobalMapResourceManager().createFromPath("maps/threeway_merge_source_1.mapx");
+    EXPECT_TRUE(sourceResource->load());
+
+    addScaledUpEntities(baseResource->getRootNode(), NumEntities);
+    addScaledUpEntities(targetResource->getRootNode(), NumEntities);
+    addScaledUpEntities(sourceResource->getRootNode(), NumEntities);
+
+    // Modify a share of the added entities in the source and in the target
+    std::size_t numSourceKeyValues = 0;
+    std::size_t numSourceBrushes = 0;
+
+    for (std::size_t i = 0; i < NumEntities; ++i)
+    {
+        auto name = "scaled_" + std::to_string(i);
+
+        if (i % 2 == 0)
+        {
+            Node_getEntity(algorithm::getEntityByName(sourceResource->getRootNode(), name))->setKeyValue("source_key", name);
+            ++numSourceKeyValues;
+        }
+
+        if (i % 3 == 0)
+        {
+            Node_getEntity(algorithm::getEntityByName(targetResource->getRootNode(), name))->setKeyValue("target_key", name);
+        }
+
+        if (i % 5 == 0)
+        {
+            algorithm::createCubicBrush(algorithm::getEntityByName(sourceResource->getRootNode(), name),
+                Vector3(i * 128.0, 4096, 128), "textures/numbers/2");
+            ++numSourceBrushes;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto operation = ThreeWayMergeOperation::Create(baseResource->getRootNode(), sourceResource->getRootNode(), targetResource->getRootNode());
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    verifyTargetChanges1(operation->getTargetRoot());
+
+    // Every source change to the scaled up entities is accepted, the target changes are left alone
+    auto keyValueActionCount = countActions<AddEntityKeyValueAction>(operation, [](const std::shared_ptr<AddEntityKeyValueAction>& action)
+    {
+        return isScaledUpEntity(action->getAffectedNode());
+    });
+    EXPECT_EQ(keyValueActionCount, numSourceKeyValues);
+
+    auto sourceKeyValueActionCount = countActions<AddEntityKeyValueAction>(operation, [](const std::shared_ptr<AddEntityKeyValueAction>& action)
+    {
+        return action->getKey() == "source_key" && action->getValue() == Node_getEntity(action->getAffectedNode())->getKeyValue("name");
+    });
+    EXPECT_EQ(sourceKeyValueActionCount, numSourceKeyValues) << "Key values should be applied to the entity with the same name";
+
+    auto childActionCount = countActions<AddChildAction>(operation, [](const std::shared_ptr<AddChildAction>& action)
+    {
+        return isScaledUpEntity(action->getParent());
+    });
+    EXPECT_EQ(childActionCount, numSourceBrushes);
+
+    auto otherActionCount = countActions<IMergeAction>(operation, [](const std::shared_ptr<IMergeAction>& action)
+    {
+        auto affectedNode = action->getAffectedNode();
+        return affectedNode && affectedNode->getNodeType() == scene::INode::Type::Entity && isScaledUpEntity(affectedNode) &&
+            !std::dynamic_pointer_cast<AddEntityKeyValueAction>(action);
+    });
+    EXPECT_EQ(otherActionCount, 0) << "Unexpected actions for the scaled up entities";
+
+    RecordProperty("entities", std::to_string(NumEntities));
+    RecordProperty("mergeOperationMilliseconds", std::to_string(duration.count()));
+}
+
 inline std::unique_ptr<ThreeWaySelectionGroupMerger> setupThreeWayGroupMerger(const std::string& baseMap,
     const std::string& sourceMap, const std::string& targetMap)
 {
@@ -1,10 +1,16 @@
 #include "RadiantTest.h"
 
+#include <chrono>
+#include <fstream>
+#include <sstream>
 #include "imodel.h"
 #include "imodelcache.h"
 #include "imap.h"
 #include "ieclass.h"
 #include "ientity.h"
+#include "ibrush.h"
+#include "igroupnode.h"
+#include "gamelib.h"
 #include "algorithm/Primitives.h"
 #include "algorithm/Scene.h"
 #include "scenelib.h"
@@ -531,4 +537,188 @@ TEST_F(ModelExportTest, ExportedModelInheritsLayers)
     fs::remove(fullModelPath);
 }
 
+namespace
+{
+
+std::vector<scene::INodePtr> getChildBrushes(const scene::INodePtr& entity)
+{
+    std::vector<scene::INodePtr> brushes;
+
+    entity->foreachNode([&](const scene::INodePtr& child)
+    {
+        if (Node_isBrush(child))
+        {
+            brushes.push_back(child);
+        }
+        return true;
+    });
+
+    return brushes;
+}
+
+std::string loadTextFile(const std::string& path)
+{
+    std::ifstream input(path);
+    std::stringstream text;
+    text << input.rdbuf();
+
+    return text.str();
+}
+
+std::string exportCollisionModel(const scene::INodePtr& entity, const std::string& model)
+{
+    GlobalSelectionSystem().setSelectedAll(false);
+    Node_setSelected(entity, true);
+
+    GlobalCommandSystem().executeCommand("ExportSelectedAsCollisionModel", model);
+
+    fs::path outputPath = os::replaceExtension(GlobalGameManager().getModPath() + model, ".cm");
+
+    auto text = loadTextFile(outputPath.string());
+    fs::remove(outputPath);
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    return text;
+}
+
+// Exports each func_static with brushes and compares the result to the file
+// <mapName>_<entityName>.cm in the given folder
+void checkCollisionModelsOfMap(const scene::INodePtr& root, const std::string& mapName,
+    const std::string& expectedPath)
+{
+    std::vector<scene::INodePtr> entities;
+
+    root->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isEntity(node) && Node_getGroupNode(node) && !getChildBrushes(node).empty())
+        {
+            entities.push_back(node);
+        }
+        return true;
+    });
+
+    EXPECT_FALSE(entities.empty()) << "No entities with brushes found";
+
+    for (const auto& entity : entities)
+    {
+        auto name = Node_getEntity(entity)->getKeyValue("name");
+        auto expected = loadTextFile(expectedPath + os::removeExtension(mapName) + "_" + name + ".cm");
+
+        EXPECT_FALSE(expected.empty()) << "No expected collision model for " << name;
+        EXPECT_EQ(exportCollisionModel(entity, "maps/cm_export_test.lwo"), expected)
+            << "Collision model of " << name << " in " << mapName << " differs";
+    }
+}
+
+// Returns the number following the given comment in the collision model text, like "/* numVertices = */ 8"
+std::size_t getCollisionModelCount(const std::string& text, const std::string& name)
+{
+    auto marker = "/* " + name + " = */ ";
+    auto position = text.find(marker);
+
+    return position != std::string::npos ? std::stoul(text.substr(position + marker.length())) : 0;
+}
+
+// Returns the number of lines between the opening line of the given block and its closing brace
+std::size_t getCollisionModelBlockSize(const std::string& text, const std::string& block)
+{
+    std::istringstream stream(text);
+    std::string line;
+
+    while (std::getline(stream, line) && line.find("\t" + block + " ") != 0) {}
+
+    std::size_t count = 0;
+
+    while (std::getline(stream, line) && line != "\t}")
+    {
+        // The brush entries span several lines, each one ends with its contents flag
+        if (block != "brushes" || line.find("\"solid\"") != std::string::npos)
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+scene::INodePtr createFuncStaticWithBrushGrid(std::size_t gridSize)
+{
+    auto eclass = GlobalEntityClassManager().findClass("func_static");
+    auto entity = GlobalEntityModule().createEntity(eclass);
+
+    scene::addNodeToContainer(entity, GlobalMapModule().getRoot());
+    Node_getEntity(entity)->setKeyValue("origin", "40 24 8");
+
+    // Adjacent cubes in two layers, sharing vertices, edges and faces
+    for (std::size_t x = 0; x < gridSize; ++x)
+    {
+        for (std::size_t y = 0; y < gridSize; ++y)
+        {
+            for (std::size_t z = 0; z < 2; ++z)
+            {
+                algorithm::createCubicBrush(entity, Vector3(x * 128.0, y * 128.0, z * 128.0));
+            }
+        }
+    }
+
+    return entity;
+}
+
+}
+
+// The expected collision models in test/resources/collision_models/ have been
+// written by the exporter before it was optimised for large entities
+
+TEST_F(ModelExportTest, CollisionModelOfTestMaps)
+{
+    for (auto mapName : { "altar.map", "csg_merge.map", "csg_merge_with_func_static.map" })
+    {
+        loadMap(mapName);
+        checkCollisionModelsOfMap(GlobalMapModule().getRoot(), mapName,
+            _context.getTestResourcePath() + "collision_models/");
+    }
+}
+
+TEST_F(ModelExportTest, CollisionModelOfBrushGrid)
+{
+    auto entity = createFuncStaticWithBrushGrid(8);
+
+    auto expected = loadTextFile(_context.getTestResourcePath() + "collision_models/brush_grid_8.cm");
+
+    EXPECT_FALSE(expected.empty()) << "No expected collision model found";
+    EXPECT_EQ(exportCollisionModel(entity, "maps/cm_export_test.lwo"), expected);
+}
+
+TEST_F(ModelExportTest, CollisionModelOfLargeBrushGrid)
+{
+    constexpr std::size_t GridSize = 32;
+    auto entity = createFuncStaticWithBrushGrid(GridSize);
+
+    auto start = std::chrono::steady_clock::now();
+    auto text = exportCollisionModel(entity, "maps/cm_export_test.lwo");
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    // Two layers of cubes, every grid point is shared by the adjacent cubes
+    constexpr std::size_t NumBrushes = GridSize * GridSize * 2;
+    constexpr std::size_t NumVertices = (GridSize + 1) * (GridSize + 1) * 3;
+
+    // Edges along x and y in the three vertex layers, vertical edges in two, plus the null edge
+    constexpr std::size_t NumEdges = 2 * GridSize * (GridSize + 1) * 3 + (GridSize + 1) * (GridSize + 1) * 2 + 1;
+
+    // The faces shared by two cubes cancel out, leaving the top, bottom and sides of the grid
+    constexpr std::size_t NumPolygons = GridSize * GridSize * 2 + GridSize * 2 * 4;
+
+    EXPECT_EQ(getCollisionModelCount(text, "numVertices"), NumVertices);
+    EXPECT_EQ(getCollisionModelCount(text, "numEdges"), NumEdges);
+    EXPECT_EQ(getCollisionModelCount(text, "brushMemory"), NumBrushes * (6 * 16 + 44));
+    EXPECT_EQ(getCollisionModelBlockSize(text, "vertices"), NumVertices);
+    EXPECT_EQ(getCollisionModelBlockSize(text, "edges"), NumEdges);
+    EXPECT_EQ(getCollisionModelBlockSize(text, "polygons"), NumPolygons);
+    EXPECT_EQ(getCollisionModelBlockSize(text, "brushes"), NumBrushes);
+
+    RecordProperty("brushes", std::to_string(getChildBrushes(entity).size()));
+    RecordProperty("exportMilliseconds", std::to_string(duration.count()));
+}
+
 }
@@ -1,8 +1,11 @@
 #include "RadiantTest.h"
 
+#include <chrono>
 #include <unordered_set>
 #include "imodelsurface.h"
 #include "imodelcache.h"
+#include "imd5anim.h"
+#include "imd5model.h"
 
 #include "render/VertexHashing.h"
 
@@ -12,6 +15,43 @@ namespace test
 using ModelTest = RadiantTest;
 using AseImportTest = ModelTest;
 
+namespace
+{
+
+std::vector<std::vector<Vector3>> getVertexPositions(const model::IModel& model)
+{
+    std::vector<std::vector<Vector3>> positions(model.getSurfaceCount());
+
+    for (int s = 0; s < model.getSurfaceCount(); ++s)
+    {
+        const auto& surface = model.getSurface(s);
+
+        for (int v = 0; v < surface.getNumVertices(); ++v)
+        {
+            positions[s].push_back(surface.getVertex(v).vertex);
+        }
+    }
+
+    return positions;
+}
+
+double getMaximumDistance(const std::vector<std::vector<Vector3>>& a, const std::vector<std::vector<Vector3>>& b)
+{
+    double maximum = 0;
+
+    for (std::size_t s = 0; s < a.size(); ++s)
+    {
+        for (std::size_t v = 0; v < a[s].size(); ++v)
+        {
+            maximum = std::max(maximum, (a[s][v] - b[s][v]).getLength());
+        }
+    }
+
+    return maximum;
+}
+
+}
+
 TEST_F(ModelTest, LwoPolyCount)
 {
     auto model = GlobalModelCache().getModel("models/darkmod/test/unit_cube.lwo");
@@ -453,4 +493,74 @@ TEST_F(ModelTest, LoadFbxModel)
     EXPECT_EQ(model->getPolyCount(), 12);
 }
 
+// The tentacle model and its animation are generated by tools/scripts/generate_tentacle_md5.py
+TEST_F(ModelTest, MD5AnimationSkinning)
+{
+    auto model = GlobalModelCache().getModel("models/md5/tentacle.md5mesh");
+    auto md5Model = std::dynamic_pointer_cast<md5::IMD5Model>(model);
+    ASSERT_TRUE(md5Model);
+
+    EXPECT_EQ(model->getSurfaceCount(), 2);
+    auto bindPose = getVertexPositions(*model);
+
+    auto anim = GlobalAnimationCache().getAnim("models/md5/tentacle_wave.md5anim");
+    ASSERT_TRUE(anim);
+
+    md5Model->setAnim(anim);
+
+    // The first frame of the animation matches the bind pose
+    md5Model->updateAnim(0);
+    EXPECT_LT(getMaximumDistance(getVertexPositions(*model), bindPose), 0.01);
+
+    // Later frames are bending the tentacle
+    md5Model->updateAnim(250);
+    auto bentPose = getVertexPositions(*model);
+    EXPECT_GT(getMaximumDistance(bentPose, bindPose), 1.0);
+
+    // The base ring is attached to the unanimated root joint
+    for (std::size_t v = 0; v < 16; ++v)
+    {
+        EXPECT_LT((bentPose[0][v] - bindPose[0][v]).getLength(), 0.01) << "Vertex " << v;
+    }
+
+    // Normals are brought up to date when requested
+    for (int v = 0; v < model->getSurface(0).getNumVertices(); ++v)
+    {
+        EXPECT_NEAR(model->getSurface(0).getVertex(v).normal.getLength(), 1.0, 0.001) << "Vertex " << v;
+    }
+
+    // Skinning the same time again yields the same vertices
+    md5Model->updateAnim(0);
+    md5Model->updateAnim(250);
+    EXPECT_EQ(getMaximumDistance(getVertexPositions(*model), bentPose), 0);
+
+    // Removing the animation restores the bind pose
+    md5Model->setAnim(md5::IMD5AnimPtr());
+    EXPECT_LT(getMaximumDistance(getVertexPositions(*model), bindPose), 0.01);
+}
+
+TEST_F(ModelTest, MD5AnimationSkinningThroughput)
+{
+    constexpr std::size_t Frames = 500;
+
+    auto model = GlobalModelCache().getModel("models/md5/tentacle.md5mesh");
+    auto md5Model = std::dynamic_pointer_cast<md5::IMD5Model>(model);
+    ASSERT_TRUE(md5Model);
+
+    md5Model->setAnim(GlobalAnimationCache().getAnim("models/md5/tentacle_wave.md5anim"));
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t frame = 0; frame < Frames; ++frame)
+    {
+        md5Model->updateAnim(frame * 1000 / 60);
+    }
+
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    RecordProperty("VerticesPerFrame", model->getVertexCount());
+    RecordProperty("MicrosecondsPerFrame", static_cast<int>(micros / Frames));
+}
+
 }
@@ -0,0 +1,370 @@
+#include "RadiantTest.h"
+
+#include "imap.h"
+#include "ipatch.h"
+#include "iselection.h"
+#include "iundo.h"
+#include "scenelib.h"
+#include "algorithm/View.h"
+#include "patch/LevelOfDetail.h"
+#include "render/CameraView.h"
+#include "render/CamRenderer.h"
+
+namespace test
+{
+
+using PatchTest = RadiantTest;
+
+namespace
+{
+
+// Creates a curved 3x3 patch below the worldspawn
+scene::INodePtr createCurvedPatch()
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto node = GlobalPatchModule().createPatch(patch::PatchDefType::Def2);
+    worldspawn->addChildNode(node);
+
+    auto& patch = *Node_getIPatch(node);
+    patch.setDims(3, 3);
+
+    for (std::size_t row = 0; row < 3; ++row)
+    {
+        for (std::size_t col = 0; col < 3; ++col)
+        {
+            // Raise the middle row and column to get a dome
+            double height = (row == 1 ? 32 : 0) + (col == 1 ? 32 : 0);
+
+            patch.ctrlAt(row, col).vertex = Vector3(col * 64.0, row * 64.0, height);
+            patch.ctrlAt(row, col).texcoord = Vector2(col * 0.5, row * 0.5);
+        }
+    }
+
+    patch.controlPointsChanged();
+
+    return node;
+}
+
+// Creates a flat patch in the shape of a curved band, following a quarter
+// circle from (radius,0,0) to (0,radius,0) with a width of 32 units
+scene::INodePtr createArcPatch(double radius)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto node = GlobalPatchModule().createPatch(patch::PatchDefType::Def2);
+    worldspawn->addChildNode(node);
+
+    auto& patch = *Node_getIPatch(node);
+    patch.setDims(3, 3);
+
+    for (std::size_t row = 0; row < 3; ++row)
+    {
+        // The rows are running along the arc, at increasing radius
+        double rowRadius = radius - 32 + row * 16;
+
+        patch.ctrlAt(row, 0).vertex = Vector3(rowRadius, 0, 0);
+        patch.ctrlAt(row, 1).vertex = Vector3(rowRadius, rowRadius, 0);
+        patch.ctrlAt(row, 2).vertex = Vector3(0, rowRadius, 0);
+
+        for (std::size_t col = 0; col < 3; ++col)
+        {
+            patch.ctrlAt(row, col).texcoord = Vector2(col * 0.5, row * 0.5);
+        }
+    }
+
+    patch.setFixedSubdivisions(true, Subdivisions(8, 2));
+    patch.controlPointsChanged();
+
+    return node;
+}
+
+// A camera looking straight down on the given point from the given height
+render::View constructTopDownCameraView(const Vector3& target, double height)
+{
+    render::View view(true);
+
+    auto farClip = 32768.0f;
+    Matrix4 projection = camera::calculateProjectionMatrix(farClip / 4096.0f, farClip, 75.0f,
+        algorithm::DeviceWidth, algorithm::DeviceHeight);
+    Matrix4 modelview = camera::calculateModelViewMatrix(target + Vector3(0, 0, height), Vector3(-90, 0, 0));
+
+    view.construct(projection, modelview, algorithm::DeviceWidth, algorithm::DeviceHeight);
+
+    return view;
+}
+
+// The patches are using the full tesselation and two coarser ones
+constexpr std::size_t NumLevelsOfDetail = 3;
+
+// Evaluates the quadratic bezier patch defined by the control points at (u,v)
+Vector3 evaluatePatch(const IPatch& patch, double u, double v)
+{
+    auto bernstein = [](std::size_t i, double t)
+    {
+        return i == 0 ? (1 - t) * (1 - t) : i == 1 ? 2 * t * (1 - t) : t * t;
+    };
+
+    Vector3 result(0, 0, 0);
+
+    for (std::size_t row = 0; row < 3; ++row)
+    {
+        for (std::size_t col = 0; col < 3; ++col)
+        {
+            result += patch.ctrlAt(row, col).vertex * bernstein(col, u) * bernstein(row, v);
+        }
+    }
+
+    return result;
+}
+
+}
+
+TEST_F(PatchTest, FixedSubdivisionTesselation)
+{
+    auto node = createCurvedPatch();
+    auto& patch = *Node_getIPatch(node);
+
+    patch.setFixedSubdivisions(true, Subdivisions(4, 3));
+
+    auto mesh = patch.getTesselatedPatchMesh();
+
+    EXPECT_EQ(mesh.width, 5);
+    EXPECT_EQ(mesh.height, 4);
+    ASSERT_EQ(mesh.vertices.size(), mesh.width * mesh.height);
+
+    // Every tesselated vertex needs to be on the curved surface
+    for (std::size_t h = 0; h < mesh.height; ++h)
+    {
+        for (std::size_t w = 0; w < mesh.width; ++w)
+        {
+            const auto& vertex = mesh.vertices[h * mesh.width + w];
+            auto expected = evaluatePatch(patch, w / 4.0, h / 3.0);
+
+            EXPECT_TRUE(math::isNear(vertex.vertex, expected, 0.01)) << "Vertex " << w << "," << h
+                << " is at " << vertex.vertex << ", expected " << expected;
+            EXPECT_NEAR(vertex.texcoord.x(), w / 4.0, 0.001);
+            EXPECT_NEAR(vertex.texcoord.y(), h / 3.0, 0.001);
+        }
+    }
+}
+
+TEST_F(PatchTest, TesselationIsRestoredByUndo)
+{
+    auto node = createCurvedPatch();
+    auto& patch = *Node_getIPatch(node);
+
+    auto original = patch.getTesselatedPatchMesh();
+
+    {
+        UndoableCommand cmd("movePatchVertex");
+
+        patch.undoSave();
+        patch.ctrlAt(1, 1).vertex += Vector3(0, 0, 64);
+        patch.controlPointsChanged();
+    }
+
+    auto modified = patch.getTesselatedPatchMesh();
+    EXPECT_NE(modified.vertices, original.vertices);
+
+    GlobalUndoSystem().undo();
+
+    // The restored tesselation must be exactly the same as before
+    auto restored = patch.getTesselatedPatchMesh();
+
+    EXPECT_EQ(restored.width, original.width);
+    EXPECT_EQ(restored.height, original.height);
+    EXPECT_EQ(restored.vertices, original.vertices);
+}
+
+TEST_F(PatchTest, UnchangedPatchIsTesselatedFromCache)
+{
+    auto node = createCurvedPatch();
+    auto& patch = *Node_getIPatch(node);
+
+    auto original = patch.getTesselatedPatchMesh();
+
+    auto hitsBefore = GlobalPatchModule().getTesselationCacheHitCount();
+    auto missesBefore = GlobalPatchModule().getTesselationCacheMissCount();
+
+    // Signal a change without touching the control points
+    patch.controlPointsChanged();
+    auto retesselated = patch.getTesselatedPatchMesh();
+
+    EXPECT_EQ(GlobalPatchModule().getTesselationCacheHitCount(), hitsBefore + 1);
+    EXPECT_EQ(GlobalPatchModule().getTesselationCacheMissCount(), missesBefore);
+    EXPECT_EQ(retesselated.vertices, original.vertices);
+
+    // A modified patch needs to run the tesselation code
+    patch.ctrlAt(1, 1).vertex += Vector3(0, 0, 16);
+    patch.controlPointsChanged();
+    patch.getTesselatedPatchMesh();
+
+    EXPECT_EQ(GlobalPatchModule().getTesselationCacheHitCount(), hitsBefore + 1);
+    EXPECT_EQ(GlobalPatchModule().getTesselationCacheMissCount(), missesBefore + 1);
+}
+
+TEST_F(PatchTest, LevelOfDetailMeshesAreTakenFromFullTesselation)
+{
+    auto node = createCurvedPatch();
+    auto& patch = *Node_getIPatch(node);
+
+    patch.setFixedSubdivisions(true, Subdivisions(8, 8));
+
+    auto expectSubsetOfFullMesh = [&]()
+    {
+        auto full = patch.getTesselatedPatchMesh();
+        ASSERT_EQ(full.width, 9);
+        ASSERT_EQ(full.height, 9);
+
+        // Level n uses every (2^n)-th row and column
+        for (std::size_t level = 1; level < NumLevelsOfDetail; ++level)
+        {
+            auto step = std::size_t(1) << level;
+            auto mesh = patch.getLevelOfDetailMesh(level);
+
+            ASSERT_EQ(mesh.width, 8 / step + 1);
+            ASSERT_EQ(mesh.height, 8 / step + 1);
+
+            for (std::size_t h = 0; h < mesh.height; ++h)
+            {
+                for (std::size_t w = 0; w < mesh.width; ++w)
+                {
+                    EXPECT_EQ(mesh.vertices[h * mesh.width + w].vertex,
+                        full.vertices[h * step * full.width + w * step].vertex) << "Level " << level;
+                }
+            }
+        }
+    };
+
+    expectSubsetOfFullMesh();
+
+    // The coarser meshes follow changes to the patch
+    patch.ctrlAt(1, 1).vertex += Vector3(0, 0, 64);
+    patch.controlPointsChanged();
+
+    expectSubsetOfFullMesh();
+
+    // Level 0 is the full tesselation
+    EXPECT_EQ(patch.getLevelOfDetailMesh(0).vertices, patch.getTesselatedPatchMesh().vertices);
+}
+
+TEST_F(PatchTest, LevelOfDetailDependsOnDistance)
+{
+    auto node = createArcPatch(256);
+    auto bounds = node->worldAABB();
+    auto meshSize = Node_getIPatch(node)->getTesselatedPatchMesh().width;
+
+    // Close patches use the full tesselation, distant ones the coarsest
+    auto nearView = constructTopDownCameraView(bounds.getOrigin(), 512);
+    EXPECT_EQ(patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, nearView, 0), 0);
+
+    auto farView = constructTopDownCameraView(bounds.getOrigin(), 20000);
+    EXPECT_EQ(patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, farView, 0), NumLevelsOfDetail - 1);
+
+    // The level never gets finer when moving away
+    std::size_t level = 0;
+
+    for (double height = 512; height < 20000; height *= 1.05)
+    {
+        auto view = constructTopDownCameraView(bounds.getOrigin(), height);
+        auto nextLevel = patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, view, level);
+
+        EXPECT_GE(nextLevel, level) << "At height " << height;
+        level = nextLevel;
+    }
+
+    EXPECT_EQ(level, NumLevelsOfDetail - 1);
+
+    // Orthographic views always use the full tesselation
+    render::View orthoView(false);
+    algorithm::constructCenteredOrthoview(orthoView, bounds.getOrigin());
+    EXPECT_EQ(patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, orthoView, 0), 0);
+}
+
+TEST_F(PatchTest, LevelOfDetailHysteresis)
+{
+    auto node = createArcPatch(256);
+    auto bounds = node->worldAABB();
+    auto meshSize = Node_getIPatch(node)->getTesselatedPatchMesh().width;
+
+    // Move away from the patch until the first coarser level is chosen
+    double switchHeight = 512;
+
+    while (patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail,
+        constructTopDownCameraView(bounds.getOrigin(), switchHeight), 0) == 0)
+    {
+        switchHeight *= 1.01;
+        ASSERT_LT(switchHeight, 20000) << "The coarser level is never chosen";
+    }
+
+    // Moving back a bit keeps the coarser level in a view that has been using it,
+    // while a view using the full tesselation is not switching yet
+    auto view = constructTopDownCameraView(bounds.getOrigin(), switchHeight * 0.9);
+
+    EXPECT_EQ(patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, view, 1), 1);
+    EXPECT_EQ(patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, view, 0), 0);
+
+    // Getting close enough switches back to the full tesselation
+    auto nearView = constructTopDownCameraView(bounds.getOrigin(), switchHeight * 0.5);
+    EXPECT_EQ(patch::chooseLevelOfDetail(bounds, meshSize, NumLevelsOfDetail, nearView, 1), 0);
+}
+
+TEST_F(PatchTest, SelectionUsesFullTesselationOfDistantPatch)
+{
+    auto node = createArcPatch(256);
+    auto bounds = node->worldAABB();
+
+    // Render the patch from far away, which generates its coarsest mesh
+    auto farView = constructTopDownCameraView(bounds.getOrigin(), 20000);
+    ASSERT_EQ(patch::chooseLevelOfDetail(bounds, Node_getIPatch(node)->getTesselatedPatchMesh().width,
+        NumLevelsOfDetail, farView, 0), NumLevelsOfDetail - 1);
+
+    render::CamRenderer::HighlightShaders highlightShaders;
+    render::CamRenderer renderer(farView, highlightShaders);
+    node->renderSolid(renderer, farView);
+
+    // This point is on the outer part of the arc, the coarse mesh is cutting
+    // the arc with a straight line there and doesn't cover it
+    render::View orthoView(false);
+    algorithm::constructCenteredOrthoview(orthoView, Vector3(232, 108, 0));
+    auto test = algorithm::constructOrthoviewSelectionTest(orthoView);
+
+    GlobalSelectionSystem().setSelectedAll(false);
+    GlobalSelectionSystem().selectPoint(test, SelectionSystem::eToggle, false);
+
+    EXPECT_TRUE(Node_isSelected(node));
+}
+
+TEST_F(PatchTest, LoadedPatchesAreTesselated)
+{
+    loadMap("altar.map");
+
+    std::size_t numPatches = 0;
+
+    GlobalMapModule().getRoot()->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (!Node_isPatch(node)) return true;
+
+        ++numPatches;
+
+        // The bounds are known right after loading, without rendering anything
+        AABB controlBounds;
+        auto& patch = *Node_getIPatch(node);
+
+        for (std::size_t row = 0; row < patch.getHeight(); ++row)
+        {
+            for (std::size_t col = 0; col < patch.getWidth(); ++col)
+            {
+                controlBounds.includePoint(patch.ctrlAt(row, col).vertex);
+            }
+        }
+
+        EXPECT_EQ(node->localAABB(), controlBounds);
+        EXPECT_FALSE(patch.getTesselatedPatchMesh().vertices.empty());
+
+        return true;
+    });
+
+    EXPECT_GT(numPatches, 0);
+}
+
+}
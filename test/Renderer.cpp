@@ -1,9 +1,28 @@
 #include "RadiantTest.h"
 
 #include "ieclass.h"
+#include "igl.h"
 #include "ientity.h"
 #include "ilightnode.h"
+#include "imap.h"
+#include "imodel.h"
+#include "iparticles.h"
+#include "iparticlestage.h"
+#include "itransformable.h"
+#include "algorithm/Primitives.h"
 #include "math/Matrix4.h"
+#include "render/CamRenderer.h"
+#include "render/DeferredRenderableCollector.h"
+#include "render/LightGrid.h"
+#include "render/NopVolumeTest.h"
+#include "render/RenderableCollectionWalker.h"
+#include "scenelib.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <thread>
 
 namespace test
 {
@@ -194,4 +213,549 @@ TEST_F(RendererTest, SimpleProjectedLight)
     EXPECT_EQ(projT.z(), 1);
 }
 
-}
\ No newline at end of file
+namespace
+{
+
+// Lit object with fixed bounds
+class TestLitObject :
+    public LitObject,
+    public OpenGLRenderable
+{
+private:
+    AABB _bounds;
+
+public:
+    TestLitObject(const AABB& bounds) :
+        _bounds(bounds)
+    {}
+
+    const AABB& getLitObjectBounds() const override
+    {
+        return _bounds;
+    }
+
+    void render(const RenderInfo& info) const override
+    {}
+};
+
+// Shader recording the light lists of the submitted renderables
+class LightListRecordingShader :
+    public Shader
+{
+private:
+    MaterialPtr _material;
+
+public:
+    std::map<const OpenGLRenderable*, std::vector<const RendererLight*>> lightLists;
+
+    std::string getName() const override { return "lightListRecorder"; }
+
+    void addRenderable(const OpenGLRenderable& renderable, const Matrix4& modelview,
+        const LightSources* lights = nullptr, const IRenderEntity* entity = nullptr) override
+    {
+        auto& list = lightLists[&renderable];
+
+        if (lights)
+        {
+            lights->forEachLight([&](const RendererLight& light) { list.push_back(&light); });
+        }
+    }
+
+    void setVisible(bool visible) override {}
+    bool isVisible() const override { return true; }
+    void incrementUsed() override {}
+    void decrementUsed() override {}
+    void attachObserver(Observer& observer) override {}
+    void detachObserver(Observer& observer) override {}
+    bool isRealised() override { return true; }
+    const MaterialPtr& getMaterial() const override { return _material; }
+    unsigned int getFlags() const override { return 0; }
+};
+
+std::vector<AABB> createRandomAABBs(std::mt19937& generator, std::size_t count, double range, double minSize, double maxSize)
+{
+    std::uniform_real_distribution<double> origin(-range, range);
+    std::uniform_real_distribution<double> extents(minSize, maxSize);
+
+    std::vector<AABB> result;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        result.emplace_back(V3(origin(generator), origin(generator), origin(generator)),
+            V3(extents(generator), extents(generator), extents(generator)));
+    }
+
+    return result;
+}
+
+}
+
+TEST_F(RendererTest, LightGridFindsIntersectingLights)
+{
+    std::mt19937 generator(42);
+
+    // A few huge lights which are not stored in the grid cells
+    auto lightBounds = createRandomAABBs(generator, 300, 4096, 16, 512);
+    auto hugeLights = createRandomAABBs(generator, 5, 4096, 2048, 8192);
+    lightBounds.insert(lightBounds.begin() + 100, hugeLights.begin(), hugeLights.end());
+    lightBounds.insert(lightBounds.begin() + 50, AABB()); // invalid bounds
+
+    render::LightGrid grid;
+    grid.update(lightBounds);
+    EXPECT_EQ(grid.size(), lightBounds.size());
+
+    auto objectBounds = createRandomAABBs(generator, 2000, 4096, 1, 256);
+    auto hugeObjects = createRandomAABBs(generator, 5, 4096, 4096, 16384);
+    objectBounds.insert(objectBounds.end(), hugeObjects.begin(), hugeObjects.end());
+
+    for (const auto& bounds : objectBounds)
+    {
+        std::vector<render::LightGrid::LightIndex> expected;
+
+        for (render::LightGrid::LightIndex i = 0; i < lightBounds.size(); ++i)
+        {
+            if (lightBounds[i].intersects(bounds))
+            {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<render::LightGrid::LightIndex> found;
+        grid.foreachIntersectingLight(bounds, [&](render::LightGrid::LightIndex index)
+        {
+            found.push_back(index);
+        });
+
+        EXPECT_EQ(found, expected) << "Object bounds " << bounds;
+    }
+}
+
+TEST_F(RendererTest, CamRendererLightIntersections)
+{
+    constexpr std::size_t NumLights = 400;
+    constexpr std::size_t NumObjects = 50000;
+
+    std::mt19937 generator(7);
+
+    // Fixed scene with point lights spread over a larger area
+    std::vector<Light> lights;
+    std::uniform_real_distribution<double> position(-8192, 8192);
+    std::uniform_real_distribution<double> radius(64, 600);
+
+    for (std::size_t i = 0; i < NumLights; ++i)
+    {
+        lights.push_back(Light::withRadius(V3(radius(generator), radius(generator), radius(generator))));
+        lights.back().entity->setKeyValue("origin",
+            string::to_string(V3(position(generator), position(generator), position(generator))));
+    }
+
+    std::vector<TestLitObject> objects;
+    objects.reserve(NumObjects);
+
+    for (const auto& bounds : createRandomAABBs(generator, NumObjects, 8192, 4, 128))
+    {
+        objects.emplace_back(bounds);
+    }
+
+    render::NopVolumeTest volumeTest;
+    render::CamRenderer::HighlightShaders highlightShaders;
+    render::CamRenderer::PersistentData rendererData;
+
+    // Render two frames, the second one can re-use the light grid and buffers
+    for (auto frame : { "FirstFrame", "SecondFrame" })
+    {
+        LightListRecordingShader shader;
+
+        auto start = std::chrono::steady_clock::now();
+
+        render::CamRenderer renderer(volumeTest, highlightShaders, &rendererData);
+
+        for (const auto& light : lights)
+        {
+            renderer.addLight(light.iLightNode->getRendererLight());
+        }
+
+        for (const auto& object : objects)
+        {
+            renderer.addRenderable(shader, object, Matrix4::getIdentity(), &object);
+        }
+
+        renderer.submitToShaders(true);
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        RecordProperty(std::string(frame) + "FrontEndMilliseconds", static_cast<int>(duration.count()));
+
+        EXPECT_EQ(renderer.getVisibleLights(), static_cast<int>(NumLights));
+
+        if (frame == std::string("SecondFrame"))
+        {
+            EXPECT_EQ(renderer.getAllocationCount(), 0) << "Buffers should be re-used";
+        }
+        ASSERT_EQ(shader.lightLists.size(), objects.size());
+
+        // Compare against testing every light, in submission order
+        std::vector<AABB> lightBounds;
+
+        for (const auto& light : lights)
+        {
+            lightBounds.push_back(light.iLightNode->getRendererLight().lightAABB());
+        }
+
+        for (const auto& object : objects)
+        {
+            std::vector<const RendererLight*> expected;
+
+            for (std::size_t i = 0; i < lights.size(); ++i)
+            {
+                if (lightBounds[i].intersects(object.getLitObjectBounds()))
+                {
+                    expected.push_back(&lights[i].iLightNode->getRendererLight());
+                }
+            }
+
+            EXPECT_EQ(shader.lightLists[&object], expected);
+        }
+    }
+}
+
+
+namespace
+{
+
+// Collects and renders the given nodes in the camera's textured mode,
+// returning the number of bytes uploaded to buffer objects
+std::size_t renderSolid(const std::vector<scene::INodePtr>& nodes)
+{
+    render::NopVolumeTest volumeTest;
+    render::CamRenderer::HighlightShaders highlightShaders;
+    render::CamRenderer renderer(volumeTest, highlightShaders);
+
+    for (const auto& node : nodes)
+    {
+        node->renderSolid(renderer, volumeTest);
+    }
+
+    renderer.submitToShaders(false);
+
+    GlobalRenderSystem().render(RENDER_DEPTHTEST | RENDER_DEPTHWRITE | RENDER_FILL |
+        RENDER_LIGHTING | RENDER_TEXTURE_2D | RENDER_SMOOTH | RENDER_SCALED,
+        Matrix4::getIdentity(), Matrix4::getIdentity(), Vector3(0, 0, 0));
+
+    return GlobalRenderSystem().getLastFrameUploadedBytes();
+}
+
+std::size_t renderSolid(const scene::INodePtr& node)
+{
+    return renderSolid(std::vector<scene::INodePtr>{ node });
+}
+
+}
+
+TEST_F(RendererTest, BrushVerticesAreOnlyUploadedWhenChanged)
+{
+    ASSERT_TRUE(GlobalOpenGLContext().getSharedContext() != nullptr) << "Test requires a GL context";
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto brush = algorithm::createCubicBrush(worldspawn);
+
+    // The first frame needs to upload the windings
+    auto initialUpload = renderSolid(brush);
+    EXPECT_GT(initialUpload, 0);
+
+    // Nothing changed, everything should come from the buffers
+    EXPECT_EQ(renderSolid(brush), 0);
+    EXPECT_EQ(renderSolid(brush), 0);
+
+    // Moving the brush rebuilds the windings, with the same number of vertices
+    auto transformable = Node_getTransformable(brush);
+    transformable->setTranslation(Vector3(16, 0, 0));
+    transformable->freezeTransform();
+
+    EXPECT_EQ(renderSolid(brush), initialUpload);
+    EXPECT_EQ(renderSolid(brush), 0);
+
+    // A texture change is only affecting the texture coordinates, but these are part of the buffers too
+    Node_getIBrush(brush)->getFace(0).shiftTexdef(0.5, 0);
+
+    EXPECT_GT(renderSolid(brush), 0);
+    EXPECT_EQ(renderSolid(brush), 0);
+
+    RecordProperty("InitialUploadBytes", static_cast<int>(initialUpload));
+}
+
+TEST_F(RendererTest, BrushFacesOfTheSameMaterialAreBatched)
+{
+    ASSERT_TRUE(GlobalOpenGLContext().getSharedContext() != nullptr) << "Test requires a GL context";
+
+    constexpr std::size_t NumBrushes = 16;
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    std::vector<scene::INodePtr> brushes;
+
+    for (std::size_t i = 0; i < NumBrushes; ++i)
+    {
+        brushes.push_back(algorithm::createCubicBrush(worldspawn, Vector3(i * 128.0, 0, 0)));
+    }
+
+    std::size_t batchedFaces = 0;
+
+    GlobalRenderSystem().profileNextFrame([&](const RenderFrameProfile& profile)
+    {
+        for (const auto& pass : profile.passes)
+        {
+            if (pass.instances == 0) continue;
+
+            // All faces are drawn from the same buffer with a single call
+            EXPECT_EQ(pass.instances, NumBrushes * 6) << pass.shader;
+            EXPECT_EQ(pass.drawCalls, 1) << pass.shader;
+
+            batchedFaces += pass.instances;
+        }
+    });
+
+    renderSolid(brushes);
+
+    EXPECT_GT(batchedFaces, 0);
+
+    // Removing brushes is releasing their part of the buffer, the others keep theirs
+    for (std::size_t i = 0; i < NumBrushes; i += 2)
+    {
+        scene::removeNodeFromParent(brushes[i]);
+    }
+
+    brushes.erase(std::remove_if(brushes.begin(), brushes.end(),
+        [](const scene::INodePtr& brush) { return !brush->getParent(); }), brushes.end());
+
+    EXPECT_EQ(renderSolid(brushes), 0);
+}
+
+TEST_F(RendererTest, FrameProfileCountsPassWork)
+{
+    ASSERT_TRUE(GlobalOpenGLContext().getSharedContext() != nullptr) << "Test requires a GL context";
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    auto brush = algorithm::createCubicBrush(worldspawn);
+
+    std::size_t invocations = 0;
+    RenderFrameProfile profile;
+
+    GlobalRenderSystem().profileNextFrame([&](const RenderFrameProfile& frame)
+    {
+        ++invocations;
+        profile = frame;
+    });
+
+    renderSolid(brush);
+
+    EXPECT_EQ(invocations, 1);
+    ASSERT_FALSE(profile.passes.empty());
+
+    std::size_t drawCalls = 0;
+    std::size_t stateChanges = 0;
+
+    for (const auto& pass : profile.passes)
+    {
+        EXPECT_FALSE(pass.shader.empty());
+        EXPECT_LE(pass.milliseconds, profile.milliseconds);
+
+        drawCalls += pass.drawCalls;
+        stateChanges += pass.stateChanges;
+    }
+
+    EXPECT_GT(drawCalls, 0);
+    EXPECT_GT(stateChanges, 0);
+
+    // Only a single frame is profiled
+    renderSolid(brush);
+    EXPECT_EQ(invocations, 1);
+}
+
+TEST_F(RendererTest, RepeatedModelsAreDrawnAsInstances)
+{
+    ASSERT_TRUE(GlobalOpenGLContext().getSharedContext() != nullptr) << "Test requires a GL context";
+
+    constexpr std::size_t NumModels = 8;
+
+    // Several func_statics sharing the same model at different places
+    std::vector<scene::INodePtr> models;
+
+    for (std::size_t i = 0; i < NumModels; ++i)
+    {
+        auto funcStatic = createByClassName("func_static");
+        scene::addNodeToContainer(funcStatic, GlobalMapModule().getRoot());
+
+        funcStatic->getEntity().setKeyValue("model", "models/ase/testcube.ase");
+        funcStatic->getEntity().setKeyValue("origin", string::to_string(Vector3(i * 64.0, 0, 0)));
+
+        funcStatic->foreachNode([&](const scene::INodePtr& child)
+        {
+            models.push_back(child);
+            return false;
+        });
+    }
+
+    ASSERT_EQ(models.size(), NumModels);
+
+    auto model = Node_getModel(models.front());
+    ASSERT_TRUE(model);
+    auto numSurfaces = static_cast<std::size_t>(model->getIModel().getSurfaceCount());
+
+    std::size_t drawCalls = 0;
+    std::size_t instances = 0;
+
+    GlobalRenderSystem().profileNextFrame([&](const RenderFrameProfile& profile)
+    {
+        for (const auto& pass : profile.passes)
+        {
+            drawCalls += pass.drawCalls;
+            instances += pass.instances;
+        }
+    });
+
+    renderSolid(models);
+
+    EXPECT_EQ(instances, numSurfaces * NumModels);
+
+    if (GLEW_VERSION_3_3)
+    {
+        // Each surface is drawn with a single instanced call covering all models
+        EXPECT_EQ(drawCalls, numSurfaces);
+    }
+    else
+    {
+        // Without instancing support every model is drawn on its own
+        EXPECT_EQ(drawCalls, numSurfaces * NumModels);
+    }
+}
+
+
+namespace
+{
+
+// Collector storing a readable description of every call it receives
+class SubmissionListCollector :
+    public RenderableCollector
+{
+public:
+    std::vector<std::string> submissions;
+
+    void addRenderable(Shader& shader, const OpenGLRenderable& renderable, const Matrix4& localToWorld,
+        const LitObject* litObject, const IRenderEntity* entity) override
+    {
+        std::ostringstream stream;
+        stream << "Renderable " << &shader << " " << &renderable << " " << localToWorld << " "
+            << litObject << " " << entity;
+        submissions.push_back(stream.str());
+    }
+
+    void addLight(const RendererLight& light) override
+    {
+        std::ostringstream stream;
+        stream << "Light " << &light;
+        submissions.push_back(stream.str());
+    }
+
+    bool supportsFullMaterials() const override
+    {
+        return true;
+    }
+
+    void setHighlightFlag(Highlight::Flags flags, bool enabled) override
+    {
+        submissions.push_back("Highlight " + std::to_string(flags) + (enabled ? " on" : " off"));
+    }
+};
+
+}
+
+TEST_F(RendererTest, ConcurrentCollectionMatchesSerialCollection)
+{
+    loadMap("altar.map");
+
+    // Select something to get highlighted renderables in there too
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+    Node_setSelected(algorithm::createCubicBrush(worldspawn, Vector3(256, 0, 0)), true);
+
+    render::NopVolumeTest volumeTest;
+
+    // Too many nodes per thread to use more than one
+    SubmissionListCollector serial;
+    std::vector<double> serialThreadTimes;
+    render::RenderableCollectionWalker::CollectRenderablesInScene(serial, volumeTest,
+        &serialThreadTimes, std::numeric_limits<std::size_t>::max());
+
+    EXPECT_EQ(serialThreadTimes.size(), 1);
+
+    // Use a few nodes per thread to have all threads involved
+    SubmissionListCollector concurrent;
+    std::vector<double> concurrentThreadTimes;
+    render::RenderableCollectionWalker::CollectRenderablesInScene(concurrent, volumeTest,
+        &concurrentThreadTimes, 4);
+
+    EXPECT_GE(concurrentThreadTimes.size(), 1);
+    EXPECT_LE(concurrentThreadTimes.size(), std::max(std::thread::hardware_concurrency(), 1u));
+
+    EXPECT_FALSE(serial.submissions.empty());
+    EXPECT_EQ(concurrent.submissions, serial.submissions);
+
+    // The deferred collector needs to pass on the same calls
+    render::DeferredRenderableCollector deferred(true);
+    render::RenderableCollectionWalker::CollectRenderablesInScene(deferred, volumeTest,
+        nullptr, std::numeric_limits<std::size_t>::max());
+
+    SubmissionListCollector replayed;
+    deferred.replay(replayed);
+
+    EXPECT_EQ(replayed.submissions, serial.submissions);
+}
+
+TEST_F(RendererTest, ParticleSimulationsAreSharedBetweenEmitters)
+{
+    auto def = GlobalParticlesManager().findOrInsertParticleDef("test/simulation_cache");
+    def->getStage(def->addParticleStage()).setMaterialName("textures/numbers/1");
+
+    auto backend = GlobalRenderSystemFactory().createRenderSystem();
+    backend->setTime(1000);
+
+    auto first = GlobalParticlesManager().getRenderableParticle("test/simulation_cache");
+    auto second = GlobalParticlesManager().getRenderableParticle("test/simulation_cache");
+    first->setRenderSystem(backend);
+    second->setRenderSystem(backend);
+
+    auto hits = GlobalParticlesManager().getSimulationCacheHitCount();
+    auto misses = GlobalParticlesManager().getSimulationCacheMissCount();
+
+    // The first update has to run the simulation of every active bunch
+    first->update(Matrix4::getIdentity());
+
+    auto simulatedBunches = GlobalParticlesManager().getSimulationCacheMissCount() - misses;
+    EXPECT_GT(simulatedBunches, 0) << "No particle bunch has been simulated";
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheHitCount(), hits);
+
+    // Updating the same emitter at the same time is served from the cache
+    first->update(Matrix4::getIdentity());
+
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheHitCount(), hits + simulatedBunches);
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheMissCount(), misses + simulatedBunches);
+
+    // Another emitter of the same def picks up the results of the first one
+    second->update(Matrix4::getIdentity());
+
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheHitCount(), hits + 2 * simulatedBunches);
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheMissCount(), misses + simulatedBunches);
+
+    // Changing the def invalidates the cached results
+    def->getStage(0).setCount(50);
+    first->update(Matrix4::getIdentity());
+
+    auto resimulatedBunches = GlobalParticlesManager().getSimulationCacheMissCount() - misses - simulatedBunches;
+    EXPECT_GT(resimulatedBunches, 0) << "The modified def should be simulated again";
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheHitCount(), hits + 2 * simulatedBunches);
+
+    second->update(Matrix4::getIdentity());
+
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheHitCount(), hits + 2 * simulatedBunches + resimulatedBunches);
+    EXPECT_EQ(GlobalParticlesManager().getSimulationCacheMissCount(), misses + simulatedBunches + resimulatedBunches);
+}
+
+}
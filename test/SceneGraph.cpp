@@ -0,0 +1,401 @@
+#include "RadiantTest.h"
+
+#include <map>
+#include <set>
+#include <random>
+#include "imap.h"
+#include "iscenegraph.h"
+#include "iscenegraphfactory.h"
+#include "ispacepartition.h"
+#include "ivolumetest.h"
+#include "algorithm/Primitives.h"
+#include "algorithm/View.h"
+#include "math/PackedAABBs.h"
+#include "render/View.h"
+#include "scenelib.h"
+#include "scene/BasicRootNode.h"
+#include "scene/ParallelTraversal.h"
+#include "scene/ShaderBreakdown.h"
+#include "scene/EntityBreakdown.h"
+
+namespace test
+{
+
+using SceneGraphTest = RadiantTest;
+
+namespace
+{
+
+// Counts how many times each scene node is linked into the given SP subtree
+void countLinkedNodes(const scene::ISPNode& node, std::map<scene::INode*, std::size_t>& counts)
+{
+    for (const auto& member : node.getMembers())
+    {
+        ++counts[member.get()];
+    }
+
+    for (const auto& child : node.getChildNodes())
+    {
+        countLinkedNodes(*child, counts);
+    }
+}
+
+std::vector<scene::INodePtr> getAllSceneNodes()
+{
+    std::vector<scene::INodePtr> nodes;
+
+    GlobalSceneGraph().foreachNode([&](const scene::INodePtr& node)
+    {
+        nodes.push_back(node);
+        return true;
+    });
+
+    return nodes;
+}
+
+// Checks that every given node is linked exactly once, and no other nodes are linked
+void expectAllNodesLinkedOnce(const scene::ISpacePartitionSystemPtr& spacePartition,
+    const std::vector<scene::INodePtr>& nodes)
+{
+    std::map<scene::INode*, std::size_t> counts;
+    countLinkedNodes(*spacePartition->getRoot(), counts);
+
+    for (const auto& node : nodes)
+    {
+        EXPECT_EQ(counts[node.get()], 1) << "Node " << node->name() << " not linked exactly once";
+    }
+
+    EXPECT_EQ(counts.size(), nodes.size()) << "Space partition contains nodes not in the scene";
+}
+
+void expectAllNodesLinkedOnce()
+{
+    expectAllNodesLinkedOnce(GlobalSceneGraph().getSpacePartition(), getAllSceneNodes());
+}
+
+// Checks that every SP node encloses its members and child nodes, returns the number of SP nodes
+std::size_t expectBoundsEncloseSubtree(const scene::ISPNode& node)
+{
+    std::size_t numNodes = 1;
+
+    for (const auto& member : node.getMembers())
+    {
+        EXPECT_TRUE(node.getBounds().contains(member->worldAABB())) << "Member exceeds its SP node bounds";
+    }
+
+    for (const auto& child : node.getChildNodes())
+    {
+        EXPECT_TRUE(node.getBounds().contains(child->getBounds())) << "Child exceeds its parent SP node bounds";
+        numNodes += expectBoundsEncloseSubtree(*child);
+    }
+
+    return numNodes;
+}
+
+// Collects the members of all SP nodes intersecting the given bounds
+void queryPartition(const scene::ISPNode& node, const AABB& bounds, std::set<scene::INode*>& result)
+{
+    if (!node.getBounds().intersects(bounds)) return;
+
+    for (const auto& member : node.getMembers())
+    {
+        if (member->worldAABB().intersects(bounds))
+        {
+            result.insert(member.get());
+        }
+    }
+
+    for (const auto& child : node.getChildNodes())
+    {
+        queryPartition(*child, bounds, result);
+    }
+}
+
+// Compares the partition query results of the given scene against a scan over all its nodes
+void expectPartitionMatchesBruteForce(const scene::GraphPtr& scene, std::minstd_rand& random)
+{
+    // Evaluate the bounds, this relinks all moved nodes
+    scene->root()->worldAABB();
+
+    std::vector<scene::INodePtr> nodes;
+    scene->foreachNode([&](const scene::INodePtr& node)
+    {
+        nodes.push_back(node);
+        return true;
+    });
+
+    expectAllNodesLinkedOnce(scene->getSpacePartition(), nodes);
+    expectBoundsEncloseSubtree(*scene->getSpacePartition()->getRoot());
+
+    std::uniform_real_distribution<double> coordinate(-4096, 4096);
+    std::uniform_real_distribution<double> extent(16, 1024);
+
+    for (int i = 0; i < 32; ++i)
+    {
+        AABB bounds(Vector3(coordinate(random), coordinate(random), coordinate(random)),
+            Vector3(extent(random), extent(random), extent(random)));
+
+        std::set<scene::INode*> found;
+        queryPartition(*scene->getSpacePartition()->getRoot(), bounds, found);
+
+        std::set<scene::INode*> expected;
+        for (const auto& node : nodes)
+        {
+            if (node->worldAABB().intersects(bounds))
+            {
+                expected.insert(node.get());
+            }
+        }
+
+        EXPECT_EQ(found, expected) << "Query result mismatch for bounds " << bounds.getOrigin();
+    }
+}
+
+struct VolumeTraversalResult
+{
+    std::set<scene::INode*> members;
+    std::size_t visitedSPNodes = 0;
+    std::size_t skippedSPNodes = 0;
+};
+
+// Same algorithm as used by SceneGraph::foreachNodeInVolume
+void traverseVolume(const scene::ISPNode& node, const VolumeTest& volume, VolumeTraversalResult& result)
+{
+    ++result.visitedSPNodes;
+
+    for (const auto& member : node.getMembers())
+    {
+        result.members.insert(member.get());
+    }
+
+    const auto& children = node.getChildNodes();
+    std::vector<VolumeIntersectionValue> intersections(children.size());
+
+    volume.TestAABBs(node.getChildBounds(), intersections.data());
+
+    for (std::size_t i = 0; i < children.size(); ++i)
+    {
+        if (intersections[i] == VOLUME_OUTSIDE)
+        {
+            ++result.skippedSPNodes;
+            continue;
+        }
+
+        traverseVolume(*children[i], volume, result);
+    }
+}
+
+}
+
+TEST_F(SceneGraphTest, SpacePartitionLinksAllNodesAfterMapLoad)
+{
+    loadMap("altar.map");
+
+    expectAllNodesLinkedOnce();
+
+    // The map has enough primitives to let the root octant subdivide
+    EXPECT_FALSE(GlobalSceneGraph().getSpacePartition()->getRoot()->isLeaf());
+}
+
+TEST_F(SceneGraphTest, SpacePartitionRelinksAfterBoundsChange)
+{
+    loadMap("altar.map");
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    // Create enough brushes far away to force root growth and subdivision
+    std::vector<scene::INodePtr> brushes;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        brushes.push_back(algorithm::createCubicBrush(worldspawn, Vector3(4096 + (i % 8) * 256, (i / 8) * 256, 0)));
+    }
+
+    // Trigger bounds evaluation and relinking
+    GlobalSceneGraph().root()->worldAABB();
+    expectAllNodesLinkedOnce();
+
+    // Remove half of the brushes again
+    for (std::size_t i = 0; i < brushes.size(); i += 2)
+    {
+        scene::removeNodeFromParent(brushes[i]);
+    }
+
+    GlobalSceneGraph().root()->worldAABB();
+    expectAllNodesLinkedOnce();
+}
+
+TEST_F(SceneGraphTest, AABBTreeFindsSameNodesAsOctree)
+{
+    loadMap("altar.map");
+
+    auto nodes = getAllSceneNodes();
+
+    auto octree = GlobalSceneGraphFactory().createSpacePartition(scene::SpacePartitionType::Octree);
+    octree->linkAll(nodes);
+    expectAllNodesLinkedOnce(octree, nodes);
+
+    auto aabbTree = GlobalSceneGraphFactory().createSpacePartition(scene::SpacePartitionType::AABBTree);
+    aabbTree->linkAll(nodes);
+    expectAllNodesLinkedOnce(aabbTree, nodes);
+
+    // Look at a part of the map
+    render::View view(false);
+    algorithm::constructCenteredOrthoview(view, GlobalSceneGraph().root()->worldAABB().getOrigin());
+
+    VolumeTraversalResult octreeResult;
+    traverseVolume(*octree->getRoot(), view, octreeResult);
+
+    VolumeTraversalResult aabbTreeResult;
+    traverseVolume(*aabbTree->getRoot(), view, aabbTreeResult);
+
+    // Every node intersecting the volume needs to be found by both
+    for (const auto& node : nodes)
+    {
+        if (view.TestAABB(node->worldAABB()) == VOLUME_OUTSIDE) continue;
+
+        EXPECT_EQ(octreeResult.members.count(node.get()), 1) << "Octree missed " << node->name();
+        EXPECT_EQ(aabbTreeResult.members.count(node.get()), 1) << "AABBTree missed " << node->name();
+    }
+
+    RecordProperty("OctreeVisitedNodes", static_cast<int>(octreeResult.visitedSPNodes));
+    RecordProperty("OctreeSkippedNodes", static_cast<int>(octreeResult.skippedSPNodes));
+    RecordProperty("OctreeVisitedMembers", static_cast<int>(octreeResult.members.size()));
+    RecordProperty("AABBTreeVisitedNodes", static_cast<int>(aabbTreeResult.visitedSPNodes));
+    RecordProperty("AABBTreeSkippedNodes", static_cast<int>(aabbTreeResult.skippedSPNodes));
+    RecordProperty("AABBTreeVisitedMembers", static_cast<int>(aabbTreeResult.members.size()));
+}
+
+TEST_F(SceneGraphTest, AABBTreeMatchesBruteForceAfterSceneChanges)
+{
+    auto scene = GlobalSceneGraphFactory().createSceneGraph(scene::SpacePartitionType::AABBTree);
+    auto root = std::make_shared<scene::BasicRootNode>();
+    scene->setRoot(root);
+
+    std::minstd_rand random(42);
+    std::uniform_real_distribution<double> coordinate(-4096, 4096);
+
+    // Insert the brushes one by one, this is splitting the leaves
+    std::vector<scene::INodePtr> brushes;
+
+    for (int i = 0; i < 256; ++i)
+    {
+        brushes.push_back(algorithm::createCubicBrush(root,
+            Vector3(coordinate(random), coordinate(random), coordinate(random))));
+    }
+
+    expectPartitionMatchesBruteForce(scene, random);
+    auto numSPNodesAfterInsertion = expectBoundsEncloseSubtree(*scene->getSpacePartition()->getRoot());
+    EXPECT_GT(numSPNodesAfterInsertion, 1) << "Leaves should have been split";
+
+    // Move some brushes, every bounds change is unlinking and relinking them
+    for (std::size_t i = 0; i < brushes.size(); i += 3)
+    {
+        auto transformable = Node_getTransformable(brushes[i]);
+        transformable->setType(TRANSFORM_PRIMITIVE);
+        transformable->setTranslation(Vector3(coordinate(random), coordinate(random), coordinate(random)) * 0.5);
+        transformable->freezeTransform();
+    }
+
+    expectPartitionMatchesBruteForce(scene, random);
+
+    // Remove most of the brushes again, the empty leaves are collapsed
+    for (std::size_t i = 0; i < brushes.size(); ++i)
+    {
+        if (i % 8 != 0)
+        {
+            scene::removeNodeFromParent(brushes[i]);
+        }
+    }
+
+    expectPartitionMatchesBruteForce(scene, random);
+    auto numSPNodesAfterRemoval = expectBoundsEncloseSubtree(*scene->getSpacePartition()->getRoot());
+    EXPECT_LT(numSPNodesAfterRemoval, numSPNodesAfterInsertion) << "Empty leaves should have been collapsed";
+
+    // Add a few more to the thinned out tree
+    for (int i = 0; i < 32; ++i)
+    {
+        algorithm::createCubicBrush(root, Vector3(coordinate(random), coordinate(random), coordinate(random)));
+    }
+
+    expectPartitionMatchesBruteForce(scene, random);
+
+    scene->setRoot(scene::IMapRootNodePtr());
+}
+
+TEST_F(SceneGraphTest, ParallelTraversalVisitsNodesInOrder)
+{
+    loadMap("altar.map");
+
+    // Collect the node sequence, one vector per chunk, concatenated in order.
+    // Use small chunks to make sure multiple threads are involved.
+    auto parallelNodes = scene::foreachNodeParallel<std::vector<scene::INodePtr>>(
+        GlobalSceneGraph().root(),
+        [](const scene::INodePtr& node, std::vector<scene::INodePtr>& list)
+        {
+            list.push_back(node);
+        },
+        [](std::vector<scene::INodePtr>& target, std::vector<scene::INodePtr>&& source)
+        {
+            target.insert(target.end(), source.begin(), source.end());
+        }, 8);
+
+    std::vector<scene::INodePtr> serialNodes;
+    GlobalSceneGraph().root()->foreachNode([&](const scene::INodePtr& node)
+    {
+        serialNodes.push_back(node);
+        return true;
+    });
+
+    EXPECT_EQ(parallelNodes, serialNodes);
+}
+
+TEST_F(SceneGraphTest, BreakdownsMatchSerialCount)
+{
+    loadMap("altar.map");
+
+    std::map<std::string, std::size_t> faceCounts;
+    std::map<std::string, std::size_t> patchCounts;
+    std::map<std::string, std::size_t> entityCounts;
+
+    GlobalSceneGraph().root()->foreachNode([&](const scene::INodePtr& node)
+    {
+        if (Node_isBrush(node))
+        {
+            auto brush = Node_getIBrush(node);
+
+            for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+            {
+                faceCounts[brush->getFace(i).getShader()]++;
+            }
+        }
+        else if (Node_isPatch(node))
+        {
+            patchCounts[Node_getIPatch(node)->getShader()]++;
+        }
+        else if (Node_isEntity(node))
+        {
+            entityCounts[Node_getEntity(node)->getEntityClass()->getName()]++;
+        }
+
+        return true;
+    });
+
+    scene::ShaderBreakdown shaderBreakdown;
+
+    for (const auto& pair : shaderBreakdown)
+    {
+        EXPECT_EQ(pair.second.faceCount, faceCounts[pair.first]) << pair.first;
+        EXPECT_EQ(pair.second.patchCount, patchCounts[pair.first]) << pair.first;
+    }
+
+    for (const auto& pair : faceCounts)
+    {
+        EXPECT_EQ(shaderBreakdown.getMap().count(pair.first), 1) << pair.first;
+    }
+
+    scene::EntityBreakdown entityBreakdown;
+    EXPECT_EQ(entityBreakdown.getMap(), entityCounts);
+}
+
+}
@@ -1,6 +1,9 @@
 #include "RadiantTest.h"
 
 #include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
 #include "ishaders.h"
 #include "imap.h"
 #include "ifilter.h"
@@ -10,10 +13,12 @@
 #include "ientity.h"
 #include "ishaders.h"
 #include "ieclass.h"
+#include "icommandsystem.h"
 #include "algorithm/Scene.h"
 #include "algorithm/Primitives.h"
 #include "scenelib.h"
 #include "selectionlib.h"
+#include "scene/Clone.h"
 #include "string/convert.h"
 #include "render/View.h"
 #include "render/CameraView.h"
@@ -499,4 +504,401 @@ TEST_F(CameraViewSelectionTest, TwosidedModelFacingUpIsSelectable)
     performModelSelectionTest("twosided_ivy_facing_up", true);
 }
 
+namespace
+{
+
+// Selector remembering the best intersection of every tested selectable
+class IntersectionCollector :
+    public Selector
+{
+private:
+    ISelectable* _current = nullptr;
+
+public:
+    std::map<ISelectable*, SelectionIntersection> intersections;
+
+    void pushSelectable(ISelectable& selectable) override
+    {
+        _current = &selectable;
+    }
+
+    void popSelectable() override
+    {
+        _current = nullptr;
+    }
+
+    void addIntersection(const SelectionIntersection& intersection) override
+    {
+        intersections[_current].assignIfCloser(intersection);
+    }
+};
+
+// Reference test of a primitive that doesn't rely on the triangle hierarchies
+// of the patches: every triangle of their tesselation is tested one by one.
+void testSelectExhaustively(const scene::INodePtr& node, Selector& selector, ::SelectionTest& test)
+{
+    auto patch = Node_getIPatch(node);
+
+    if (!patch)
+    {
+        // Brushes are testing each face winding anyway
+        Node_getSelectionTestable(node)->testSelect(selector, test);
+        return;
+    }
+
+    auto mesh = patch->getTesselatedPatchMesh();
+    auto renderIndices = patch->getRenderIndices();
+
+    if (mesh.vertices.empty()) return;
+
+    // Split the quad strips into the same triangles TestQuadStrip() is using
+    std::vector<IndexPointer::index_type> triangles;
+
+    for (std::size_t s = 0; s < renderIndices.numStrips; ++s)
+    {
+        const auto* strip = &renderIndices.indices[s * renderIndices.lenStrips];
+
+        for (std::size_t i = 0; i + 3 < renderIndices.lenStrips; i += 2)
+        {
+            triangles.insert(triangles.end(), { strip[i], strip[i + 1], strip[i + 2] });
+            triangles.insert(triangles.end(), { strip[i + 2], strip[i + 1], strip[i + 3] });
+        }
+    }
+
+    auto material = GlobalMaterialManager().getMaterial(patch->getShader());
+    test.BeginMesh(node->localToWorld(), material && material->getCullType() == Material::CULL_NONE);
+
+    SelectionIntersection best;
+    test.TestTriangles(VertexPointer(&mesh.vertices.front().vertex, sizeof(VertexNT)),
+        IndexPointer(triangles.data(), triangles.size()), best);
+
+    if (best.isValid())
+    {
+        selector.addIntersection(best);
+    }
+}
+
+// Scales up the loaded map by placing copies of the worldspawn primitives in a grid,
+// several layers high. Returns the original primitives and assigns the grid spacing.
+std::vector<scene::INodePtr> placeCopiesInGrid(int gridSize, int layers, Vector3& spacing)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    std::vector<scene::INodePtr> originals;
+    worldspawn->foreachNode([&](const scene::INodePtr& node)
+    {
+        originals.push_back(node);
+        return true;
+    });
+
+    spacing = worldspawn->worldAABB().getExtents() * 2 + Vector3(64, 64, 64);
+
+    for (int x = 0; x < gridSize; ++x)
+    {
+        for (int y = 0; y < gridSize; ++y)
+        {
+            for (int z = 0; z < layers; ++z)
+            {
+                if (x == 0 && y == 0 && z == 0) continue;
+
+                for (const auto& original : originals)
+                {
+                    auto clone = scene::cloneNodeIncludingDescendants(original, scene::PostCloneCallback());
+                    worldspawn->addChildNode(clone);
+
+                    auto transformable = Node_getTransformable(clone);
+                    transformable->setTranslation(Vector3(x * spacing.x(), y * spacing.y(), z * spacing.z()));
+                    transformable->freezeTransform();
+                }
+            }
+        }
+    }
+
+    return originals;
+}
+
+}
+
+// Point selection tests the nodes front to back and stops as soon as the
+// topmost item is known, it still has to pick the best intersection
+TEST_F(CameraViewSelectionTest, PointSelectionPicksBestIntersectionInLargeMap)
+{
+    loadMap("selection_test.map");
+
+    constexpr int GridSize = 6;
+    constexpr int Layers = 4;
+
+    Vector3 spacing;
+    auto originals = placeCopiesInGrid(GridSize, Layers, spacing);
+
+    std::size_t numSelections = 0;
+    std::chrono::steady_clock::duration pointSelectionTime(0);
+    std::chrono::steady_clock::duration exhaustiveTestTime(0);
+
+    // Click the center of each primitive in a few grid columns, looking down at all layers
+    for (int column = 0; column < GridSize; ++column)
+    {
+        Vector3 offset(column * spacing.x(), column * spacing.y(), (Layers - 1) * spacing.z() / 2);
+
+        for (const auto& original : originals)
+        {
+            const AABB& bounds = original->worldAABB();
+            AABB columnBounds(bounds.getOrigin() + offset, bounds.getExtents() + Vector3(0, 0, offset.z()));
+
+            render::View view = createView();
+            constructView(view, columnBounds);
+
+            auto rectangle = selection::Rectangle::ConstructFromPoint(Vector2(0, 0), Vector2(8.0 / algorithm::DeviceWidth, 8.0 / algorithm::DeviceHeight));
+            ConstructSelectionTest(view, rectangle);
+
+            SelectionVolume test(view);
+
+            // Test every triangle of every primitive in the volume to get the expected result
+            IntersectionCollector collector;
+
+            auto start = std::chrono::steady_clock::now();
+
+            GlobalSceneGraph().foreachVisibleNodeInVolume(test.getVolume(), [&](const scene::INodePtr& node)
+            {
+                auto selectable = Node_getSelectable(node);
+
+                if (Node_isPrimitive(node) && selectable && Node_getSelectionTestable(node))
+                {
+                    collector.pushSelectable(*selectable);
+                    testSelectExhaustively(node, collector, test);
+                    collector.popSelectable();
+                }
+
+                return true;
+            });
+
+            exhaustiveTestTime += std::chrono::steady_clock::now() - start;
+
+            SelectionIntersection best;
+
+            for (const auto& pair : collector.intersections)
+            {
+                best.assignIfCloser(pair.second);
+            }
+
+            GlobalSelectionSystem().setSelectedAll(false);
+
+            start = std::chrono::steady_clock::now();
+            GlobalSelectionSystem().selectPoint(test, SelectionSystem::eToggle, false);
+            pointSelectionTime += std::chrono::steady_clock::now() - start;
+
+            ++numSelections;
+
+            if (!best.isValid())
+            {
+                EXPECT_EQ(GlobalSelectionSystem().countSelected(), 0);
+                continue;
+            }
+
+            EXPECT_EQ(GlobalSelectionSystem().countSelected(), 1);
+
+            auto selected = Node_getSelectable(GlobalSelectionSystem().ultimateSelected());
+            ASSERT_TRUE(selected);
+
+            // Items with the same intersection are interchangeable
+            EXPECT_FALSE(best < collector.intersections[selected.get()]);
+        }
+    }
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    RecordProperty("Primitives", static_cast<int>(originals.size() * GridSize * GridSize * Layers));
+    RecordProperty("MicrosecondsPerPointSelection", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(pointSelectionTime).count() / numSelections));
+    RecordProperty("MicrosecondsPerExhaustiveTest", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(exhaustiveTestTime).count() / numSelections));
+}
+
+
+// Area selections are testing the nodes on several threads, the result
+// needs to be the same as when testing every node one after the other
+TEST_F(CameraViewSelectionTest, AreaSelectionOfLargeMapSelectsAllIntersectedPrimitives)
+{
+    loadMap("selection_test.map");
+
+    constexpr int GridSize = 8;
+    constexpr int Layers = 4;
+
+    Vector3 spacing;
+    auto originals = placeCopiesInGrid(GridSize, Layers, spacing);
+
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    render::View view = createView();
+    constructView(view, worldspawn->worldAABB());
+
+    // Drag a rectangle covering the center part of the view
+    auto rectangle = selection::Rectangle::ConstructFromArea(Vector2(-0.5, -0.5), Vector2(1, 1));
+    ConstructSelectionTest(view, rectangle);
+
+    SelectionVolume test(view);
+
+    IntersectionCollector collector;
+
+    auto start = std::chrono::steady_clock::now();
+
+    GlobalSceneGraph().foreachVisibleNodeInVolume(test.getVolume(), [&](const scene::INodePtr& node)
+    {
+        auto selectable = Node_getSelectable(node);
+        auto testable = Node_getSelectionTestable(node);
+
+        // Primitives of func_* entities are selecting their parent, leave them out
+        if (Node_isPrimitive(node) && node->getParent() == worldspawn && selectable && testable)
+        {
+            collector.pushSelectable(*selectable);
+            testable->testSelect(collector, test);
+            collector.popSelectable();
+        }
+
+        return true;
+    });
+
+    auto serialTestTime = std::chrono::steady_clock::now() - start;
+
+    std::set<ISelectable*> expected;
+
+    for (const auto& pair : collector.intersections)
+    {
+        if (pair.second.isValid())
+        {
+            expected.insert(pair.first);
+        }
+    }
+
+    EXPECT_GT(expected.size(), 0) << "Test setup failed, the rectangle doesn't hit anything";
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    start = std::chrono::steady_clock::now();
+    GlobalSelectionSystem().selectArea(test, SelectionSystem::eToggle, false);
+    auto areaSelectionTime = std::chrono::steady_clock::now() - start;
+
+    std::set<ISelectable*> selected;
+
+    GlobalSelectionSystem().foreachSelected([&](const scene::INodePtr& node)
+    {
+        if (Node_isPrimitive(node) && node->getParent() == worldspawn)
+        {
+            selected.insert(Node_getSelectable(node).get());
+        }
+    });
+
+    EXPECT_EQ(selected, expected);
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    RecordProperty("Primitives", static_cast<int>(originals.size() * GridSize * GridSize * Layers));
+    RecordProperty("MicrosecondsPerAreaSelection", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(areaSelectionTime).count()));
+    RecordProperty("MicrosecondsPerSerialTest", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(serialTestTime).count()));
+}
+
+
+TEST_F(SelectionTest, UltimateAndPenultimateFollowSelectionOrder)
+{
+    auto worldspawn = GlobalMapModule().findOrInsertWorldspawn();
+
+    auto first = algorithm::createCuboidBrush(worldspawn, AABB(Vector3(0, 0, 0), Vector3(16, 16, 16)));
+    auto second = algorithm::createCuboidBrush(worldspawn, AABB(Vector3(64, 0, 0), Vector3(16, 16, 16)));
+    auto third = algorithm::createCuboidBrush(worldspawn, AABB(Vector3(128, 0, 0), Vector3(16, 16, 16)));
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    Node_setSelected(second, true);
+    Node_setSelected(third, true);
+    Node_setSelected(first, true);
+
+    EXPECT_EQ(GlobalSelectionSystem().ultimateSelected(), first);
+    EXPECT_EQ(GlobalSelectionSystem().penultimateSelected(), third);
+
+    // Deselecting the last one makes the previous ones move up
+    Node_setSelected(first, false);
+
+    EXPECT_EQ(GlobalSelectionSystem().ultimateSelected(), third);
+    EXPECT_EQ(GlobalSelectionSystem().penultimateSelected(), second);
+
+    // Deselecting one in the middle keeps the order of the others
+    Node_setSelected(first, true);
+    Node_setSelected(third, false);
+
+    EXPECT_EQ(GlobalSelectionSystem().ultimateSelected(), first);
+    EXPECT_EQ(GlobalSelectionSystem().penultimateSelected(), second);
+
+    std::vector<scene::INodePtr> visited;
+    GlobalSelectionSystem().foreachSelected([&](const scene::INodePtr& node) { visited.push_back(node); });
+
+    EXPECT_EQ(visited, std::vector<scene::INodePtr>({ second, first }));
+}
+
+// Selecting everything, inverting and deselecting are bulk changes
+// notifying the listeners only once
+TEST_F(SelectionTest, BulkSelectionChangesInLargeMap)
+{
+    loadMap("selection_test.map");
+
+    constexpr int GridSize = 16;
+    constexpr int Layers = 4;
+
+    Vector3 spacing;
+    placeCopiesInGrid(GridSize, Layers, spacing);
+
+    GlobalSelectionSystem().setSelectedAll(false);
+
+    std::size_t signalCount = 0;
+    sigc::connection conn = GlobalSelectionSystem().signal_selectionChanged().connect(
+        [&](const ISelectable&) { ++signalCount; });
+
+    auto start = std::chrono::steady_clock::now();
+    GlobalSelectionSystem().setSelectedAll(true);
+    auto selectAllTime = std::chrono::steady_clock::now() - start;
+
+    auto numSelected = GlobalSelectionSystem().countSelected();
+
+    EXPECT_GT(numSelected, static_cast<std::size_t>(GridSize * GridSize * Layers));
+    EXPECT_EQ(GlobalSelectionSystem().getSelectionInfo().totalCount, numSelected);
+    EXPECT_EQ(signalCount, 1);
+
+    std::size_t numVisited = 0;
+    GlobalSelectionSystem().foreachSelected([&](const scene::INodePtr&) { ++numVisited; });
+    EXPECT_EQ(numVisited, numSelected);
+
+    start = std::chrono::steady_clock::now();
+    GlobalSelectionSystem().setSelectedAll(false);
+    auto deselectAllTime = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(GlobalSelectionSystem().countSelected(), 0);
+    EXPECT_EQ(GlobalSelectionSystem().getSelectionInfo().totalCount, 0);
+    EXPECT_EQ(signalCount, 2);
+
+    // Inverting an empty selection selects the top-level nodes except worldspawn
+    start = std::chrono::steady_clock::now();
+    GlobalCommandSystem().executeCommand("InvertSelection");
+    auto invertTime = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GT(GlobalSelectionSystem().countSelected(), static_cast<std::size_t>(GridSize * GridSize * Layers));
+    EXPECT_LT(GlobalSelectionSystem().countSelected(), numSelected);
+    EXPECT_EQ(signalCount, 3);
+
+    GlobalCommandSystem().executeCommand("InvertSelection");
+
+    EXPECT_EQ(GlobalSelectionSystem().countSelected(), 0);
+    EXPECT_EQ(signalCount, 4);
+
+    conn.disconnect();
+
+    RecordProperty("SelectableNodes", static_cast<int>(numSelected));
+    RecordProperty("MicrosecondsPerSelectAll", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(selectAllTime).count()));
+    RecordProperty("MicrosecondsPerDeselectAll", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(deselectAllTime).count()));
+    RecordProperty("MicrosecondsPerInvertSelection", static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(invertTime).count()));
+}
+
 }
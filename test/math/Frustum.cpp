@@ -0,0 +1,217 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <random>
+#include "math/Frustum.h"
+#include "math/PackedAABBs.h"
+
+namespace test
+{
+
+namespace
+{
+
+// A perspective projection like the one used by the camera view
+Matrix4 getPerspective(double fovY, double aspect, double near, double far)
+{
+    double f = 1.0 / tan(fovY / 2);
+
+    return Matrix4::byColumns(
+        f / aspect, 0, 0, 0,
+        0, f, 0, 0,
+        0, 0, (far + near) / (near - far), -1,
+        0, 0, 2 * far * near / (near - far), 0
+    );
+}
+
+Frustum getRotatedCameraFrustum()
+{
+    Matrix4 modelView = Matrix4::getRotationForEulerXYZDegrees(Vector3(-60, 10, 35));
+    modelView.multiplyBy(Matrix4::getTranslation(Vector3(-320, 1100, -96)));
+
+    return Frustum::createFromViewproj(getPerspective(1.2, 4.0 / 3, 1, 8192).getMultipliedBy(modelView));
+}
+
+std::vector<AABB> getRandomAABBs(std::size_t count, double range, double maxExtents)
+{
+    std::mt19937 generator(1337);
+    std::uniform_real_distribution<double> origin(-range, range);
+    std::uniform_real_distribution<double> extents(0, maxExtents);
+
+    std::vector<AABB> aabbs;
+    aabbs.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        aabbs.emplace_back(Vector3(origin(generator), origin(generator), origin(generator)),
+            Vector3(extents(generator), extents(generator), extents(generator)));
+    }
+
+    return aabbs;
+}
+
+PackedAABBs pack(const std::vector<AABB>& aabbs)
+{
+    PackedAABBs packed;
+
+    for (const AABB& aabb : aabbs)
+    {
+        packed.push_back(aabb);
+    }
+
+    return packed;
+}
+
+}
+
+TEST(MathTest, PackAABBs)
+{
+    PackedAABBs packed;
+    EXPECT_TRUE(packed.empty());
+
+    packed.push_back(AABB(Vector3(10, -20, 30), Vector3(1, 2, 3)));
+    packed.push_back(AABB(Vector3(-1000, 0, 0.5), Vector3(0, 0, 0)));
+    packed.push_back(AABB());
+
+    EXPECT_EQ(packed.size(), 3);
+    EXPECT_EQ(packed.paddedSize() % PackedAABBs::BLOCK_SIZE, 0);
+
+    // The packed boxes must contain the original ones
+    EXPECT_TRUE(packed.get(0).contains(AABB(Vector3(10, -20, 30), Vector3(1, 2, 3))));
+    EXPECT_TRUE(packed.get(1).contains(AABB(Vector3(-1000, 0, 0.5), Vector3(0, 0, 0))));
+
+    // Invalid boxes stay invalid
+    EXPECT_FALSE(packed.get(2).isValid());
+
+    packed.resize(1);
+    EXPECT_EQ(packed.size(), 1);
+    EXPECT_EQ(packed.get(1).extents, Vector3(0, 0, 0)) << "Padding should be reset";
+}
+
+TEST(MathTest, BatchedFrustumTestMatchesSingleTest)
+{
+    auto frustum = getRotatedCameraFrustum();
+    auto aabbs = getRandomAABBs(20000, 8192, 512);
+    auto packed = pack(aabbs);
+
+    std::vector<VolumeIntersectionValue> results(aabbs.size());
+    frustum.testIntersection(packed, results.data());
+
+    std::size_t counts[3] = { 0, 0, 0 };
+    std::size_t mismatches = 0;
+
+    for (std::size_t i = 0; i < aabbs.size(); ++i)
+    {
+        auto expected = frustum.testIntersection(aabbs[i]);
+        ++counts[expected];
+
+        if (results[i] == expected) continue;
+
+        // Differences are only allowed in the conservative direction
+        EXPECT_EQ(results[i], VOLUME_PARTIAL) << "Box " << aabbs[i].origin << " / " << aabbs[i].extents
+            << " expected " << expected;
+        ++mismatches;
+    }
+
+    // Make sure all cases are covered by the test data
+    EXPECT_GT(counts[VOLUME_OUTSIDE], 0);
+    EXPECT_GT(counts[VOLUME_INSIDE], 0);
+    EXPECT_GT(counts[VOLUME_PARTIAL], 0);
+
+    // Only boxes that are practically touching a plane may differ
+    EXPECT_LT(mismatches, aabbs.size() / 1000);
+}
+
+TEST(MathTest, BatchedFrustumTestNeverCullsTouchingBoxes)
+{
+    auto frustum = getRotatedCameraFrustum();
+
+    // Boxes exactly touching the frustum corners from outside
+    std::vector<AABB> aabbs;
+
+    for (auto end : { Frustum::FRONT, Frustum::BACK })
+    {
+        for (auto corner : { Frustum::TOP_LEFT, Frustum::TOP_RIGHT, Frustum::BOTTOM_LEFT, Frustum::BOTTOM_RIGHT })
+        {
+            auto point = frustum.getCornerPoint(end, corner);
+
+            for (double size : { 0.0, 0.125, 16.0 })
+            {
+                for (int x = -1; x <= 1; x += 2)
+                {
+                    for (int y = -1; y <= 1; y += 2)
+                    {
+                        for (int z = -1; z <= 1; z += 2)
+                        {
+                            aabbs.emplace_back(point + Vector3(x, y, z) * size, Vector3(size, size, size));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    auto packed = pack(aabbs);
+    std::vector<VolumeIntersectionValue> results(aabbs.size());
+    frustum.testIntersection(packed, results.data());
+
+    for (std::size_t i = 0; i < aabbs.size(); ++i)
+    {
+        if (frustum.testIntersection(aabbs[i]) != VOLUME_OUTSIDE)
+        {
+            EXPECT_NE(results[i], VOLUME_OUTSIDE) << "Box " << aabbs[i].origin << " / " << aabbs[i].extents;
+        }
+    }
+}
+
+TEST(MathTest, BatchedFrustumTestThroughput)
+{
+    constexpr std::size_t Passes = 50;
+
+    auto frustum = getRotatedCameraFrustum();
+    auto aabbs = getRandomAABBs(65536, 16384, 256);
+    auto packed = pack(aabbs);
+
+    std::vector<VolumeIntersectionValue> results(aabbs.size());
+    std::size_t singleVisible = 0;
+    std::size_t batchedVisible = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t pass = 0; pass < Passes; ++pass)
+    {
+        for (const AABB& aabb : aabbs)
+        {
+            singleVisible += frustum.testIntersection(aabb) != VOLUME_OUTSIDE ? 1 : 0;
+        }
+    }
+
+    auto singleTime = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+
+    for (std::size_t pass = 0; pass < Passes; ++pass)
+    {
+        frustum.testIntersection(packed, results.data());
+
+        for (auto result : results)
+        {
+            batchedVisible += result != VOLUME_OUTSIDE ? 1 : 0;
+        }
+    }
+
+    auto batchedTime = std::chrono::steady_clock::now() - start;
+
+    // The batched test may only find more visible boxes, never less
+    EXPECT_GE(batchedVisible, singleVisible);
+
+    auto getBoxesPerMicrosecond = [&](std::chrono::steady_clock::duration duration)
+    {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return static_cast<int>(aabbs.size() * Passes / std::max<decltype(micros)>(micros, 1));
+    };
+
+    RecordProperty("SingleTestBoxesPerMicrosecond", getBoxesPerMicrosecond(singleTime));
+    RecordProperty("BatchedTestBoxesPerMicrosecond", getBoxesPerMicrosecond(batchedTime));
+}
+
+}
@@ -0,0 +1,150 @@
+#!/usr/bin/python
+# Generates the tentacle.md5mesh and tentacle_wave.md5anim test models used
+# by the MD5 skinning tests in test/Models.cpp.
+#
+# The mesh is a tapering tube along the z axis, skinned to a chain of four
+# joints 32 units apart. Most vertices are blended between the two closest
+# joints, every fifth ring gets a third weight. It contains two meshes with
+# 528 vertices each, enough to be split into several SIMD batches and threads.
+#
+# Usage: generate_tentacle_md5.py [output folder]
+# The output folder defaults to test/resources/tdm/models/md5 of this repository.
+
+import math, os, sys
+
+SEGMENTS = 16   # vertices per ring
+RINGS = 33      # rings along the tentacle
+HEIGHT = 128.0  # length of the tentacle
+
+JOINT_NAMES = ['origin', 'segment1', 'segment2', 'segment3']
+JOINT_Z = [0, 32, 64, 96]
+
+NUM_FRAMES = 24
+
+def fmt(value):
+    text = ('%.6f' % value).rstrip('0').rstrip('.')
+    return '0' if text in ('-0', '') else text
+
+def generateMesh(shader, radius, phase):
+    verts = []
+    weights = []
+    tris = []
+
+    for ring in range(RINGS):
+        z = HEIGHT * ring / (RINGS - 1)
+        ringRadius = radius * (1 - 0.6 * ring / (RINGS - 1))
+
+        for segment in range(SEGMENTS):
+            angle = 2 * math.pi * segment / SEGMENTS + phase
+            position = (ringRadius * math.cos(angle), ringRadius * math.sin(angle), z)
+
+            # Blend between the two closest joints, a few vertices get a third weight
+            f = z / 32.0
+            j0 = min(int(f), 3)
+            j1 = min(j0 + 1, 3)
+            t1 = f - j0 if j1 != j0 else 0
+
+            vertexWeights = [(j0, 1 - t1)]
+
+            if t1 > 0:
+                vertexWeights.append((j1, t1))
+
+            if ring % 5 == 2 and j0 > 0:
+                vertexWeights = [(j, w * 0.8) for j, w in vertexWeights] + [(j0 - 1, 0.2)]
+
+            firstWeight = len(weights)
+
+            for joint, weight in vertexWeights:
+                weights.append((joint, weight, (position[0], position[1], position[2] - JOINT_Z[joint])))
+
+            verts.append((segment / SEGMENTS, ring / (RINGS - 1), firstWeight, len(vertexWeights)))
+
+    for ring in range(RINGS - 1):
+        for segment in range(SEGMENTS):
+            a = ring * SEGMENTS + segment
+            b = ring * SEGMENTS + (segment + 1) % SEGMENTS
+            c = a + SEGMENTS
+            d = b + SEGMENTS
+            tris.append((a, c, b))
+            tris.append((b, c, d))
+
+    lines = ['', 'mesh {', '\tshader "%s"' % shader, '', '\tnumverts %d' % len(verts)]
+
+    for i, v in enumerate(verts):
+        lines.append('\tvert %d ( %s %s ) %d %d' % (i, fmt(v[0]), fmt(v[1]), v[2], v[3]))
+
+    lines += ['', '\tnumtris %d' % len(tris)]
+
+    for i, t in enumerate(tris):
+        lines.append('\ttri %d %d %d %d' % (i, t[0], t[1], t[2]))
+
+    lines += ['', '\tnumweights %d' % len(weights)]
+
+    for i, w in enumerate(weights):
+        lines.append('\tweight %d %d %s ( %s %s %s )' % (i, w[0], fmt(w[1]), fmt(w[2][0]), fmt(w[2][1]), fmt(w[2][2])))
+
+    lines.append('}')
+    return lines
+
+def generateMeshFile():
+    lines = ['MD5Version 10', 'commandline ""', '', 'numJoints 4', 'numMeshes 2', '', 'joints {']
+
+    for i, z in enumerate(JOINT_Z):
+        lines.append('\t"%s"\t%d ( 0 0 %s ) ( 0 0 0 )' % (JOINT_NAMES[i], i - 1, fmt(z)))
+
+    lines.append('}')
+
+    lines += generateMesh('models/md5/tentacle', 16, 0)
+    lines += generateMesh('models/md5/tentacle_suckers', 17, math.pi / SEGMENTS)
+
+    return '\n'.join(lines) + '\n'
+
+# The joints are swinging around the x and y axes, frame 0 is the rest pose
+def generateAnimFile():
+    lines = ['MD5Version 10', 'commandline ""', '', 'numFrames %d' % NUM_FRAMES, 'numJoints 4',
+             'frameRate 24', 'numAnimatedComponents 9', '', 'hierarchy {']
+
+    lines.append('\t"origin"\t-1 0 0')
+
+    for i in range(1, 4):
+        # Flags 56: the three rotation components are animated
+        lines.append('\t"%s"\t%d 56 %d' % (JOINT_NAMES[i], i - 1, (i - 1) * 3))
+
+    lines += ['}', '', 'bounds {']
+
+    for frame in range(NUM_FRAMES):
+        lines.append('\t( -48 -48 0 ) ( 48 48 128 )')
+
+    lines += ['}', '', 'baseframe {', '\t( 0 0 0 ) ( 0 0 0 )']
+
+    for i in range(1, 4):
+        lines.append('\t( 0 0 32 ) ( 0 0 0 )')
+
+    lines += ['}']
+
+    for frame in range(NUM_FRAMES):
+        values = []
+
+        for i in range(1, 4):
+            angleX = 0.35 * math.sin(2 * math.pi * frame / NUM_FRAMES + i * 0.7) * (1 if frame else 0)
+            angleY = 0.2 * math.cos(2 * math.pi * frame / NUM_FRAMES + i) * (1 if frame else 0)
+            values += [math.sin(angleX / 2), math.sin(angleY / 2), 0]
+
+        lines += ['', 'frame %d {' % frame, '\t' + ' '.join(fmt(v) for v in values), '}']
+
+    return '\n'.join(lines) + '\n'
+
+# -----------------------------------------------------------------------------
+# Main script
+
+if len(sys.argv) > 1:
+    outputFolder = sys.argv[1]
+else:
+    outputFolder = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                '..', '..', 'test', 'resources', 'tdm', 'models', 'md5')
+
+with open(os.path.join(outputFolder, 'tentacle.md5mesh'), 'w') as meshFile:
+    meshFile.write(generateMeshFile())
+
+with open(os.path.join(outputFolder, 'tentacle_wave.md5anim'), 'w') as animFile:
+    animFile.write(generateAnimFile())